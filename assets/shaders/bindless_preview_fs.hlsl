@@ -0,0 +1,30 @@
+/**
+ * Samples a texture of the global bindless set, the material pushes the indices instead of binding descriptors
+ * Set and bindings must stay in sync with gfx::bindless_descriptor_set and gfx::bindless_*_binding
+ */
+struct PSInput
+{
+	float4 position : SV_POSITION;
+	float2 texcoord : TEXCOORD0;
+};
+
+/** Device::get_bindless_index of the texture view and sampler */
+struct BindlessIndices
+{
+	uint texture_view_index;
+	uint sampler_index;
+};
+
+[[vk::push_constant]]
+BindlessIndices indices;
+
+[[vk::binding(0, 3)]]
+Texture2D bindless_texture_views[] : register(t0, space3);
+
+[[vk::binding(1, 3)]]
+SamplerState bindless_samplers[] : register(s1, space3);
+
+float4 main(PSInput input) : SV_Target0
+{
+	return bindless_texture_views[indices.texture_view_index].Sample(bindless_samplers[indices.sampler_index], input.texcoord);
+}
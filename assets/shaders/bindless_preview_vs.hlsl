@@ -0,0 +1,24 @@
+/**
+ * Quad in the bottom-right corner of the screen, drawn without vertex buffer (6 vertices)
+ * Used with bindless_preview_fs.hlsl by the bindless sample (--bindless)
+ */
+struct VSOutput
+{
+	float4 position : SV_POSITION;
+	float2 texcoord : TEXCOORD0;
+};
+
+static const float2 corners[6] = {
+	float2(0.0, 0.0), float2(1.0, 0.0), float2(0.0, 1.0),
+	float2(0.0, 1.0), float2(1.0, 0.0), float2(1.0, 1.0),
+};
+
+VSOutput main(uint vertex_id : SV_VertexID)
+{
+	const float2 uv = corners[vertex_id];
+
+	VSOutput output;
+	output.position = float4(lerp(float2(0.55, 0.55), float2(0.95, 0.95), uv), 0.0, 1.0);
+	output.texcoord = uv;
+	return output;
+}
@@ -0,0 +1,21 @@
+/**
+ * Deferred lighting subpass, reads the G-buffer written by gbuffer_fs.hlsl at the current pixel only
+ * so tile-based GPUs never write it to memory
+ * Input attachment indices follow RenderPassInfo::Subpass::input_attachments
+ */
+[[vk::input_attachment_index(0)]] [[vk::binding(0)]]
+SubpassInput gbuffer_albedo;
+
+[[vk::input_attachment_index(1)]] [[vk::binding(1)]]
+SubpassInput gbuffer_normal;
+
+static const float3 light_direction = normalize(float3(0.3, 0.5, 1.0));
+static const float ambient = 0.2;
+
+float4 main(float4 position : SV_POSITION) : SV_Target0
+{
+	const float3 albedo = gbuffer_albedo.SubpassLoad().rgb;
+	const float3 normal = normalize(gbuffer_normal.SubpassLoad().xyz * 2.0 - 1.0);
+	const float diffuse = saturate(dot(normal, light_direction));
+	return float4(albedo * (ambient + (1.0 - ambient) * diffuse), 1.0);
+}
@@ -0,0 +1,8 @@
+/**
+ * Full-screen triangle of the deferred lighting subpass, drawn without vertex buffer
+ */
+float4 main(uint vertex_id : SV_VertexID) : SV_POSITION
+{
+	const float2 uv = float2((vertex_id << 1) & 2, vertex_id & 2);
+	return float4(uv * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -0,0 +1,52 @@
+/**
+ * G-buffer variant of frag.hlsl, used by the deferred sample (--deferred)
+ * Only writes surface attributes, lighting is computed by deferred_lighting_fs.hlsl in the next subpass
+ */
+struct PSInput
+{
+	float4 position : SV_POSITION;
+	float2 texcoord : TEXCOORD0;
+	float3 normal : NORMAL;
+};
+
+struct PSOutput
+{
+	float4 albedo : SV_Target0;
+
+	/** World-space normal remapped to [0, 1] */
+	float4 normal : SV_Target1;
+};
+
+[[vk::binding(1)]]
+SamplerState texture_sampler : register(s1, space0);
+
+[[vk::binding(2)]]
+Texture2D albedo_texture : register(t2, space0);
+
+[[vk::binding(3)]]
+Texture2D normal_texture : register(t3, space0);
+
+/** Set per material, materials without a normal map skip the sample */
+[[vk::constant_id(0)]] const bool use_normal_map = false;
+
+PSOutput main(PSInput input)
+{
+	float3 normal = normalize(input.normal);
+	if(use_normal_map)
+	{
+		/** 
+		 * Meshes have no tangents, the tangent frame is built from the normal alone
+		 * so the detail isn't aligned with the texture coordinates
+		 */
+		const float3 up = abs(normal.z) < 0.999 ? float3(0, 0, 1) : float3(1, 0, 0);
+		const float3 tangent = normalize(cross(up, normal));
+		const float3 bitangent = cross(normal, tangent);
+		const float3 tangent_normal = normal_texture.Sample(texture_sampler, input.texcoord).xyz * 2.0 - 1.0;
+		normal = normalize(tangent_normal.x * tangent + tangent_normal.y * bitangent + tangent_normal.z * normal);
+	}
+
+	PSOutput output;
+	output.albedo = albedo_texture.Sample(texture_sampler, input.texcoord);
+	output.normal = float4(normal * 0.5 + 0.5, 1.0);
+	return output;
+}
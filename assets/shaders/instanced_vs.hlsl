@@ -0,0 +1,48 @@
+/**
+ * Instanced variant of vert.hlsl, used with renderer::InstancedRenderer
+ * The per-instance world matrix is read as 4 columns from the instance buffer (binding 1)
+ * Outputs must stay in sync with frag.hlsl
+ */
+struct VSInput
+{
+	[[vk::location(0)]] float3 position : POSITION;
+	[[vk::location(1)]] float2 texcoord : TEXCOORD0;
+	[[vk::location(2)]] float3 normal : NORMAL;
+	[[vk::location(8)]] float4 instance_world_0 : INSTANCE_WORLD0;
+	[[vk::location(9)]] float4 instance_world_1 : INSTANCE_WORLD1;
+	[[vk::location(10)]] float4 instance_world_2 : INSTANCE_WORLD2;
+	[[vk::location(11)]] float4 instance_world_3 : INSTANCE_WORLD3;
+};
+
+struct VSOutput
+{
+	float4 position : SV_POSITION;
+	float2 texcoord : TEXCOORD0;
+	float3 normal : NORMAL;
+};
+
+/** world holds the mesh dequantization transform, shared by every instance */
+[[vk::binding(0)]]
+cbuffer GlobalData : register(b0, space0)
+{
+	float4x4 world;
+	float4x4 view;
+	float4x4 proj;
+};
+
+VSOutput main(VSInput input)
+{
+	/** Rows of this matrix are the columns written by glm, so mul(v, m) applies the instance transform */
+	const float4x4 instance_world = float4x4(input.instance_world_0,
+		input.instance_world_1,
+		input.instance_world_2,
+		input.instance_world_3);
+
+	const float4 world_position = mul(mul(float4(input.position, 1.0), world), instance_world);
+
+	VSOutput output;
+	output.position = mul(mul(world_position, view), proj);
+	output.texcoord = input.texcoord;
+	output.normal = normalize(mul(mul(input.normal, (float3x3) world), (float3x3) instance_world));
+	return output;
+}
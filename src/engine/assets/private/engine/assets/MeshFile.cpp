@@ -0,0 +1,167 @@
+#include "engine/assets/MeshFile.hpp"
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+namespace cb::assets
+{
+
+namespace detail
+{
+
+uint64_t align_section(const uint64_t in_offset)
+{
+	return (in_offset + MeshFileHeader::section_alignment - 1) & ~(MeshFileHeader::section_alignment - 1);
+}
+
+uint32_t get_index_size(const gfx::IndexType in_type)
+{
+	return in_type == gfx::IndexType::Uint16 ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
+template<typename T>
+std::span<const T> read_table(const std::span<const uint8_t>& in_data, uint64_t& inout_offset, const uint32_t in_count)
+{
+	const std::span<const T> table(reinterpret_cast<const T*>(in_data.data() + inout_offset), in_count);
+	inout_offset += in_count * sizeof(T);
+	return table;
+}
+
+}
+
+cb::Result<MeshFile, MeshFileError> load_mesh_file(const std::string_view& in_path)
+{
+	auto mapping = MappedFile::open(in_path);
+	if(!mapping)
+		return make_error(mapping.get_error() == MappedFileError::CannotOpenFile ? 
+			MeshFileError::CannotOpenFile : MeshFileError::CannotMapFile);
+
+	MeshFile mesh_file;
+	mesh_file.file = std::move(mapping.get_value());
+
+	const std::span<const uint8_t> file_data = mesh_file.file.get_data();
+	if(file_data.size() < sizeof(MeshFileHeader))
+		return make_error(MeshFileError::Truncated);
+
+	memcpy(&mesh_file.header, file_data.data(), sizeof(MeshFileHeader));
+
+	const MeshFileHeader& header = mesh_file.header;
+	if(header.magic != MeshFileHeader::magic_value)
+		return make_error(MeshFileError::InvalidMagic);
+
+	if(header.version != MeshFileHeader::current_version)
+		return make_error(MeshFileError::UnsupportedVersion);
+
+	const uint64_t tables_size = header.stream_count * sizeof(MeshFileStream) +
+		header.attribute_count * sizeof(gfx::VertexInputAttributeDescription) +
+		header.submesh_count * sizeof(MeshFileSubmesh);
+	if(file_data.size() < sizeof(MeshFileHeader) + tables_size)
+		return make_error(MeshFileError::Truncated);
+
+	uint64_t offset = sizeof(MeshFileHeader);
+	mesh_file.streams = detail::read_table<MeshFileStream>(file_data, offset, header.stream_count);
+	mesh_file.attributes = detail::read_table<gfx::VertexInputAttributeDescription>(file_data, offset, header.attribute_count);
+	mesh_file.submeshes = detail::read_table<MeshFileSubmesh>(file_data, offset, header.submesh_count);
+
+	/** Checks are written as count <= remaining / stride so that crafted headers can't overflow them */
+	const uint64_t file_size = file_data.size();
+	for(const auto& stream : mesh_file.streams)
+	{
+		if(stream.offset > file_size || 
+			stream.size > file_size - stream.offset ||
+			stream.stride == 0 ||
+			header.vertex_count > stream.size / stream.stride)
+			return make_error(MeshFileError::Truncated);
+	}
+
+	/** Attributes are fed to the pipeline as is, they must read within a vertex of their stream */
+	for(const auto& attribute : mesh_file.attributes)
+	{
+		if(attribute.binding >= header.stream_count)
+			return make_error(MeshFileError::InvalidAttribute);
+
+		const uint32_t stride = mesh_file.streams[attribute.binding].stride;
+		const uint32_t size = gfx::get_format_texel_size(attribute.format);
+		if(size == 0 || attribute.offset > stride || size > stride - attribute.offset)
+			return make_error(MeshFileError::InvalidAttribute);
+	}
+
+	const uint32_t index_stride = detail::get_index_size(header.index_type);
+	if(header.index_offset > file_size || header.index_count > (file_size - header.index_offset) / index_stride)
+		return make_error(MeshFileError::Truncated);
+
+	for(const auto& submesh : mesh_file.submeshes)
+		if(submesh.first_index > header.index_count || submesh.index_count > header.index_count - submesh.first_index)
+			return make_error(MeshFileError::Truncated);
+
+	mesh_file.indices = file_data.subspan(header.index_offset, 
+		static_cast<uint64_t>(header.index_count) * index_stride);
+
+	return make_result(std::move(mesh_file));
+}
+
+cb::Result<uint64_t, MeshFileError> save_mesh_file(const std::string_view& in_path,
+	const MeshData& in_mesh)
+{
+	CB_CHECK(!in_mesh.streams.empty() && in_mesh.streams[0].stride > 0);
+
+	std::ofstream file(std::string(in_path), std::ios::binary | std::ios::trunc);
+	if(!file.is_open())
+		return make_error(MeshFileError::CannotOpenFile);
+
+	MeshFileHeader header;
+	header.magic = MeshFileHeader::magic_value;
+	header.version = MeshFileHeader::current_version;
+	header.vertex_count = static_cast<uint32_t>(in_mesh.streams[0].data.size() / in_mesh.streams[0].stride);
+	header.index_type = in_mesh.index_type;
+	header.index_count = static_cast<uint32_t>(in_mesh.indices.size() / detail::get_index_size(in_mesh.index_type));
+	header.stream_count = static_cast<uint32_t>(in_mesh.streams.size());
+	header.attribute_count = static_cast<uint32_t>(in_mesh.attributes.size());
+	header.submesh_count = static_cast<uint32_t>(in_mesh.submeshes.size());
+	header.bounds_min = in_mesh.bounds_min;
+	header.bounds_max = in_mesh.bounds_max;
+
+	uint64_t offset = sizeof(MeshFileHeader) + 
+		in_mesh.streams.size() * sizeof(MeshFileStream) + 
+		in_mesh.attributes.size() * sizeof(gfx::VertexInputAttributeDescription) +
+		in_mesh.submeshes.size() * sizeof(MeshFileSubmesh);
+
+	std::vector<MeshFileStream> streams;
+	streams.reserve(in_mesh.streams.size());
+	for(const auto& stream : in_mesh.streams)
+	{
+		offset = detail::align_section(offset);
+		streams.push_back({ offset, stream.data.size(), stream.stride, 0 });
+		offset += stream.data.size();
+	}
+
+	header.index_offset = detail::align_section(offset);
+
+	const auto write_padding = [&]()
+	{
+		static constexpr std::array<char, MeshFileHeader::section_alignment> zeros = {};
+		const uint64_t position = file.tellp();
+		file.write(zeros.data(), detail::align_section(position) - position);
+	};
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(streams.data()), streams.size() * sizeof(MeshFileStream));
+	file.write(reinterpret_cast<const char*>(in_mesh.attributes.data()), 
+		in_mesh.attributes.size() * sizeof(gfx::VertexInputAttributeDescription));
+	file.write(reinterpret_cast<const char*>(in_mesh.submeshes.data()), in_mesh.submeshes.size() * sizeof(MeshFileSubmesh));
+	for(const auto& stream : in_mesh.streams)
+	{
+		write_padding();
+		file.write(reinterpret_cast<const char*>(stream.data.data()), stream.data.size());
+	}
+	write_padding();
+	file.write(reinterpret_cast<const char*>(in_mesh.indices.data()), in_mesh.indices.size());
+
+	if(!file)
+		return make_error(MeshFileError::WriteFailed);
+
+	return make_result(header.index_offset + in_mesh.indices.size());
+}
+
+}
@@ -0,0 +1,78 @@
+#include "engine/assets/TextureFile.hpp"
+#include <cstring>
+#include <fstream>
+#include <string>
+
+namespace cb::assets
+{
+
+cb::Result<TextureFile, TextureFileError> load_texture_file(const std::string_view& in_path)
+{
+	auto mapping = MappedFile::open(in_path);
+	if(!mapping)
+		return make_error(mapping.get_error() == MappedFileError::CannotOpenFile ? 
+			TextureFileError::CannotOpenFile : TextureFileError::CannotMapFile);
+
+	TextureFile texture_file;
+	texture_file.file = std::move(mapping.get_value());
+
+	const std::span<const uint8_t> file_data = texture_file.file.get_data();
+	if(file_data.size() < sizeof(TextureFileHeader))
+		return make_error(TextureFileError::Truncated);
+
+	memcpy(&texture_file.header, file_data.data(), sizeof(TextureFileHeader));
+
+	if(texture_file.header.magic != TextureFileHeader::magic_value)
+		return make_error(TextureFileError::InvalidMagic);
+
+	if(texture_file.header.version != TextureFileHeader::current_version)
+		return make_error(TextureFileError::UnsupportedVersion);
+
+	const uint64_t table_size = texture_file.header.mip_levels * sizeof(TextureFileMip);
+	if(file_data.size() < sizeof(TextureFileHeader) + table_size)
+		return make_error(TextureFileError::Truncated);
+
+	texture_file.mips = { reinterpret_cast<const TextureFileMip*>(file_data.data() + sizeof(TextureFileHeader)), 
+		texture_file.header.mip_levels };
+	texture_file.data = file_data.subspan(sizeof(TextureFileHeader) + table_size);
+
+	/** Written so that crafted offsets and sizes can't overflow */
+	for(const auto& mip : texture_file.mips)
+		if(mip.offset > texture_file.data.size() || mip.size > texture_file.data.size() - mip.offset)
+			return make_error(TextureFileError::Truncated);
+
+	return make_result(std::move(texture_file));
+}
+
+cb::Result<uint64_t, TextureFileError> save_texture_file(const std::string_view& in_path,
+	const TextureFileHeader& in_header,
+	const std::span<const std::vector<uint8_t>>& in_levels)
+{
+	CB_CHECK(in_levels.size() == in_header.mip_levels);
+
+	std::ofstream file(std::string(in_path), std::ios::binary | std::ios::trunc);
+	if(!file.is_open())
+		return make_error(TextureFileError::CannotOpenFile);
+
+	std::vector<TextureFileMip> mips;
+	mips.reserve(in_levels.size());
+
+	uint64_t offset = 0;
+	for(const auto& level : in_levels)
+	{
+		mips.push_back({ offset, level.size() });
+		offset += level.size();
+	}
+
+	file.write(reinterpret_cast<const char*>(&in_header), sizeof(in_header));
+	file.write(reinterpret_cast<const char*>(mips.data()), mips.size() * sizeof(TextureFileMip));
+	for(const auto& level : in_levels)
+		file.write(reinterpret_cast<const char*>(level.data()), level.size());
+
+	if(!file)
+		return make_error(TextureFileError::WriteFailed);
+
+	return make_result(sizeof(in_header) + mips.size() * sizeof(TextureFileMip) + offset);
+}
+
+}
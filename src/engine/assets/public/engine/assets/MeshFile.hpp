@@ -0,0 +1,160 @@
+#pragma once
+
+#include "engine/Core.hpp"
+#include "engine/Result.hpp"
+#include "engine/util/MappedFile.hpp"
+#include "engine/gfx/Command.hpp"
+#include "engine/gfx/GfxPipeline.hpp"
+#include <array>
+#include <span>
+#include <vector>
+#include <string_view>
+
+namespace cb::assets
+{
+
+/**
+ * Binary mesh container (.cbmesh) written by cb-meshcook
+ * Layout: MeshFileHeader, MeshFileStream[stream_count], VertexInputAttributeDescription[attribute_count],
+ * MeshFileSubmesh[submesh_count], then every vertex stream and the index buffer, each aligned to section_alignment
+ * Vertex streams and the index buffer can directly be used as gfx::BufferInfo::initial_data
+ */
+struct MeshFileHeader
+{
+	/** "CBMS" */
+	static constexpr uint32_t magic_value = 0x534D4243;
+	static constexpr uint32_t current_version = 1;
+	static constexpr uint64_t section_alignment = 16;
+
+	uint32_t magic;
+	uint32_t version;
+	uint32_t vertex_count;
+	uint32_t index_count;
+	gfx::IndexType index_type;
+	uint32_t stream_count;
+	uint32_t attribute_count;
+	uint32_t submesh_count;
+	std::array<float, 3> bounds_min;
+	std::array<float, 3> bounds_max;
+
+	/** Offset of the index buffer from the start of the file */
+	uint64_t index_offset;
+};
+
+static_assert(sizeof(MeshFileHeader) == 64);
+
+/**
+ * A vertex buffer, attributes reference it by its index (as the attribute binding)
+ */
+struct MeshFileStream
+{
+	/** Offset from the start of the file */
+	uint64_t offset;
+	uint64_t size;
+	uint32_t stride;
+	uint32_t padding;
+};
+
+/** Attributes are stored as the pipeline vertex input expects them */
+static_assert(sizeof(gfx::VertexInputAttributeDescription) == 16);
+static_assert(std::is_trivially_copyable_v<gfx::VertexInputAttributeDescription>);
+
+struct MeshFileSubmesh
+{
+	uint32_t first_index;
+	uint32_t index_count;
+	int32_t vertex_offset;
+	uint32_t material_index;
+};
+
+enum class MeshFileError
+{
+	CannotOpenFile,
+	CannotMapFile,
+	InvalidMagic,
+	UnsupportedVersion,
+	Truncated,
+	InvalidAttribute,
+	WriteFailed,
+};
+
+/**
+ * A mesh container mapped in memory
+ * Every span points directly into the mapping and is valid as long as the MeshFile is alive
+ */
+struct MeshFile
+{
+	MeshFileHeader header;
+	std::span<const MeshFileStream> streams;
+	std::span<const gfx::VertexInputAttributeDescription> attributes;
+	std::span<const MeshFileSubmesh> submeshes;
+	std::span<const uint8_t> indices;
+	MappedFile file;
+
+	[[nodiscard]] std::span<const uint8_t> get_stream_data(const size_t in_stream) const
+	{
+		return file.get_data().subspan(streams[in_stream].offset, streams[in_stream].size);
+	}
+};
+
+/**
+ * CPU-side mesh, used to write a mesh container
+ */
+struct MeshData
+{
+	struct Stream
+	{
+		uint32_t stride;
+		std::vector<uint8_t> data;
+	};
+
+	gfx::IndexType index_type = gfx::IndexType::Uint32;
+	std::vector<Stream> streams;
+	std::vector<gfx::VertexInputAttributeDescription> attributes;
+	std::vector<MeshFileSubmesh> submeshes;
+	std::vector<uint8_t> indices;
+	std::array<float, 3> bounds_min = {};
+	std::array<float, 3> bounds_max = {};
+};
+
+/**
+ * Map a mesh container, nothing is parsed or copied
+ */
+[[nodiscard]] cb::Result<MeshFile, MeshFileError> load_mesh_file(const std::string_view& in_path);
+
+/**
+ * Write a mesh container
+ * \return Written size in bytes
+ */
+[[nodiscard]] cb::Result<uint64_t, MeshFileError> save_mesh_file(const std::string_view& in_path,
+	const MeshData& in_mesh);
+
+}
+
+namespace std
+{
+
+inline std::string to_string(const cb::assets::MeshFileError& in_error)
+{
+	switch(in_error)
+	{
+	case cb::assets::MeshFileError::CannotOpenFile:
+		return "Cannot open file";
+	case cb::assets::MeshFileError::CannotMapFile:
+		return "Cannot map file";
+	case cb::assets::MeshFileError::InvalidMagic:
+		return "Invalid magic";
+	case cb::assets::MeshFileError::UnsupportedVersion:
+		return "Unsupported version";
+	case cb::assets::MeshFileError::Truncated:
+		return "Truncated file";
+	case cb::assets::MeshFileError::InvalidAttribute:
+		return "Invalid vertex attribute";
+	case cb::assets::MeshFileError::WriteFailed:
+		return "Write failed";
+	}
+
+	return "";
+}
+
+}
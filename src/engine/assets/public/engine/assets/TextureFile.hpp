@@ -0,0 +1,114 @@
+#pragma once
+
+#include "engine/Core.hpp"
+#include "engine/Result.hpp"
+#include "engine/util/MappedFile.hpp"
+#include "engine/gfx/Format.hpp"
+#include "engine/gfx/Texture.hpp"
+#include <span>
+#include <vector>
+#include <string_view>
+
+namespace cb::assets
+{
+
+/**
+ * Binary texture container (.cbtex) written by cb-texcook
+ * Layout: TextureFileHeader, TextureFileMip[mip_levels], then every mip level tightly packed starting from mip 0
+ * The data section can directly be used as gfx::TextureInfo::initial_data
+ * Bump current_version whenever the layout changes, old files are rejected and must be re-cooked
+ */
+struct TextureFileHeader
+{
+	/** "CBTX" */
+	static constexpr uint32_t magic_value = 0x58544243;
+	static constexpr uint32_t current_version = 1;
+
+	uint32_t magic;
+	uint32_t version;
+	gfx::Format format;
+	uint32_t width;
+	uint32_t height;
+	uint32_t depth;
+	uint32_t mip_levels;
+	uint32_t array_layers;
+
+	TextureFileHeader(const gfx::Format in_format = gfx::Format::Undefined,
+		const uint32_t in_width = 0,
+		const uint32_t in_height = 0,
+		const uint32_t in_depth = 1,
+		const uint32_t in_mip_levels = 1,
+		const uint32_t in_array_layers = 1) : magic(magic_value), version(current_version),
+		format(in_format), width(in_width), height(in_height), depth(in_depth),
+		mip_levels(in_mip_levels), array_layers(in_array_layers) {}
+};
+
+/** The mip table is read in place from the mapped file and must stay 8-bytes aligned */
+static_assert(sizeof(TextureFileHeader) % alignof(uint64_t) == 0);
+
+/** Offset relative to the start of the data section, can directly be used as gfx::TextureInfo::initial_data_mips */
+using TextureFileMip = gfx::TextureMipData;
+
+enum class TextureFileError
+{
+	CannotOpenFile,
+	CannotMapFile,
+	InvalidMagic,
+	UnsupportedVersion,
+	Truncated,
+	WriteFailed,
+};
+
+/**
+ * A texture container mapped in memory
+ * mips and data point directly into the mapping and are valid as long as the TextureFile is alive
+ */
+struct TextureFile
+{
+	TextureFileHeader header;
+	std::span<const TextureFileMip> mips;
+	std::span<const uint8_t> data;
+	MappedFile file;
+};
+
+/**
+ * Map a texture container, nothing is decoded or copied
+ */
+[[nodiscard]] cb::Result<TextureFile, TextureFileError> load_texture_file(const std::string_view& in_path);
+
+/**
+ * Write a texture container
+ * \param in_levels Data of each mip level, must contain header.mip_levels entries
+ * \return Written size in bytes
+ */
+[[nodiscard]] cb::Result<uint64_t, TextureFileError> save_texture_file(const std::string_view& in_path,
+	const TextureFileHeader& in_header,
+	const std::span<const std::vector<uint8_t>>& in_levels);
+
+}
+
+namespace std
+{
+
+inline std::string to_string(const cb::assets::TextureFileError& in_error)
+{
+	switch(in_error)
+	{
+	case cb::assets::TextureFileError::CannotOpenFile:
+		return "Cannot open file";
+	case cb::assets::TextureFileError::CannotMapFile:
+		return "Cannot map file";
+	case cb::assets::TextureFileError::InvalidMagic:
+		return "Invalid magic";
+	case cb::assets::TextureFileError::UnsupportedVersion:
+		return "Unsupported version";
+	case cb::assets::TextureFileError::Truncated:
+		return "Truncated file";
+	case cb::assets::TextureFileError::WriteFailed:
+		return "Write failed";
+	}
+
+	return "";
+}
+
+}
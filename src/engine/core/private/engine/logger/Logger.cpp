@@ -3,6 +3,7 @@
 #include "engine/logger/Sink.hpp"
 #include <chrono>
 #include <thread>
+#include <vector>
 #if CB_PLATFORM(WINDOWS)
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
@@ -62,7 +63,9 @@ void log(SeverityFlagBits in_severity, const Category& in_category, const std::s
 		sink->log(message);
 		if(in_severity == SeverityFlagBits::Fatal)
 		{
+#if CB_PLATFORM(WINDOWS)
 			MessageBoxA(nullptr, in_message.c_str(), "Fatal Error", MB_OK | MB_ICONERROR);
+#endif
 			std::terminate();
 		}
 
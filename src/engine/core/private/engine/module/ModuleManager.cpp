@@ -4,6 +4,8 @@
 #if CB_PLATFORM(WINDOWS)
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
+#else
+#include <dlfcn.h>
 #endif
 
 namespace cb
@@ -51,6 +53,26 @@ Result<Module*, LoadModuleResult> load_module_shared(const std::string_view& in_
 
 	module->prepare_module(in_module_name, dll);
 
+	return make_result(module);
+#else
+	std::string path = std::string(CB_MODULE_PREFIX) + std::string(in_module_name.data()) + ".so";
+	void* library = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+	if(!library)
+	{
+		logger::error("Failed to load module library {}: {}", path, dlerror());
+		return make_error(LoadModuleResult::NotFound);
+	}
+
+	auto func = reinterpret_cast<InstantiateModuleFunc>(dlsym(library, func_name.c_str()));
+	if(!func)
+		return make_error(LoadModuleResult::Invalid);
+
+	Module* module = func();
+	if(!module)
+		return make_error(LoadModuleResult::Invalid);
+
+	module->prepare_module(in_module_name, library);
+
 	return make_result(module);
 #endif
 }
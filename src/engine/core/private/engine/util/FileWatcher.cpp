@@ -0,0 +1,151 @@
+#include "engine/util/FileWatcher.hpp"
+#include <algorithm>
+#include <utility>
+#if CB_PLATFORM(WINDOWS)
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#elif CB_PLATFORM(LINUX)
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace cb
+{
+
+FileWatcher::~FileWatcher()
+{
+	close();
+}
+
+#if CB_PLATFORM(LINUX)
+FileWatcher::FileWatcher(FileWatcher&& in_other) noexcept : directory(std::move(in_other.directory)),
+	inotify_fd(std::exchange(in_other.inotify_fd, -1)) {}
+#else
+FileWatcher::FileWatcher(FileWatcher&& in_other) noexcept : directory(std::move(in_other.directory)),
+	notification(std::exchange(in_other.notification, nullptr)), write_times(std::move(in_other.write_times)) {}
+#endif
+
+FileWatcher& FileWatcher::operator=(FileWatcher&& in_other) noexcept
+{
+	if(this != &in_other)
+	{
+		close();
+		directory = std::move(in_other.directory);
+#if CB_PLATFORM(LINUX)
+		inotify_fd = std::exchange(in_other.inotify_fd, -1);
+#else
+		notification = std::exchange(in_other.notification, nullptr);
+		write_times = std::move(in_other.write_times);
+#endif
+	}
+
+	return *this;
+}
+
+cb::Result<FileWatcher, FileWatcherError> FileWatcher::create(const std::string_view& in_directory)
+{
+	FileWatcher watcher;
+	watcher.directory = in_directory;
+
+	std::error_code error;
+	if(!std::filesystem::is_directory(watcher.directory, error))
+		return make_error(FileWatcherError::CannotWatchDirectory);
+
+#if CB_PLATFORM(LINUX)
+	watcher.inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if(watcher.inotify_fd < 0)
+		return make_error(FileWatcherError::CannotWatchDirectory);
+
+	/** Editors either write the file in place or write a temporary file and rename it */
+	if(inotify_add_watch(watcher.inotify_fd, watcher.directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+		return make_error(FileWatcherError::CannotWatchDirectory);
+#else
+#if CB_PLATFORM(WINDOWS)
+	HANDLE notification = FindFirstChangeNotificationA(watcher.directory.c_str(),
+		FALSE,
+		FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+	if(notification == INVALID_HANDLE_VALUE)
+		return make_error(FileWatcherError::CannotWatchDirectory);
+
+	watcher.notification = notification;
+#endif
+	watcher.write_times = watcher.scan();
+#endif
+
+	return make_result(std::move(watcher));
+}
+
+std::vector<std::string> FileWatcher::poll()
+{
+	std::vector<std::string> paths;
+
+#if CB_PLATFORM(LINUX)
+	if(inotify_fd < 0)
+		return paths;
+
+	alignas(inotify_event) char buffer[4096];
+	for(ssize_t size = read(inotify_fd, buffer, sizeof(buffer)); size > 0; size = read(inotify_fd, buffer, sizeof(buffer)))
+	{
+		for(ssize_t offset = 0; offset < size;)
+		{
+			const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+			offset += sizeof(inotify_event) + event->len;
+
+			if(event->len == 0 || (event->mask & IN_ISDIR))
+				continue;
+
+			std::string path = (std::filesystem::path(directory) / event->name).string();
+			if(std::ranges::find(paths, path) == paths.end())
+				paths.emplace_back(std::move(path));
+		}
+	}
+#else
+#if CB_PLATFORM(WINDOWS)
+	if(!notification || WaitForSingleObject(notification, 0) != WAIT_OBJECT_0)
+		return paths;
+
+	FindNextChangeNotification(notification);
+#endif
+
+	auto new_write_times = scan();
+	for(const auto& [path, write_time] : new_write_times)
+	{
+		auto it = write_times.find(path);
+		if(it == write_times.end() || it->second != write_time)
+			paths.emplace_back(path);
+	}
+
+	write_times = std::move(new_write_times);
+#endif
+
+	return paths;
+}
+
+void FileWatcher::close()
+{
+#if CB_PLATFORM(LINUX)
+	if(inotify_fd >= 0)
+		::close(std::exchange(inotify_fd, -1));
+#elif CB_PLATFORM(WINDOWS)
+	if(notification)
+		FindCloseChangeNotification(std::exchange(notification, nullptr));
+#endif
+}
+
+#if !CB_PLATFORM(LINUX)
+robin_hood::unordered_map<std::string, std::filesystem::file_time_type> FileWatcher::scan() const
+{
+	robin_hood::unordered_map<std::string, std::filesystem::file_time_type> times;
+
+	std::error_code error;
+	for(const auto& entry : std::filesystem::directory_iterator(directory, error))
+	{
+		if(entry.is_regular_file(error))
+			times.insert({ entry.path().string(), entry.last_write_time(error) });
+	}
+
+	return times;
+}
+#endif
+
+}
@@ -0,0 +1,90 @@
+#include "engine/util/FrameLimiter.hpp"
+#include <algorithm>
+#include <thread>
+#if CB_PLATFORM(WINDOWS)
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#endif
+
+namespace cb
+{
+
+namespace
+{
+
+/** How early sleeps stop before the deadline, covering the usual wake-up latency of the platform */
+#if CB_PLATFORM(WINDOWS)
+constexpr auto spin_duration = std::chrono::microseconds(1000);
+#else
+constexpr auto spin_duration = std::chrono::microseconds(200);
+#endif
+
+}
+
+FrameLimiter::FrameLimiter(const float in_target_fps)
+{
+#if CB_PLATFORM(WINDOWS)
+	timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+#endif
+
+	set_target_fps(in_target_fps);
+}
+
+FrameLimiter::~FrameLimiter()
+{
+#if CB_PLATFORM(WINDOWS)
+	if(timer)
+		CloseHandle(timer);
+#endif
+}
+
+void FrameLimiter::set_target_fps(const float in_target_fps)
+{
+	target_fps = std::max(in_target_fps, 0.f);
+	target_frame_time = target_fps > 0.f ? 
+		std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / target_fps)) :
+		Clock::duration::zero();
+	next_frame = Clock::now();
+}
+
+void FrameLimiter::wait()
+{
+	if(target_frame_time == Clock::duration::zero())
+		return;
+
+	const auto now = Clock::now();
+	next_frame += target_frame_time;
+	if(now >= next_frame)
+	{
+		next_frame = now;
+		return;
+	}
+
+	if(next_frame - now > spin_duration)
+		sleep(next_frame - now - spin_duration);
+
+	while(Clock::now() < next_frame)
+		std::this_thread::yield();
+}
+
+void FrameLimiter::sleep(const Clock::duration& in_duration)
+{
+#if CB_PLATFORM(WINDOWS)
+	if(timer)
+	{
+		/** Negative due times are relative, in 100 ns units */
+		LARGE_INTEGER due_time;
+		due_time.QuadPart = -static_cast<LONGLONG>(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(in_duration).count() / 100);
+		if(SetWaitableTimerEx(timer, &due_time, 0, nullptr, nullptr, nullptr, 0))
+		{
+			WaitForSingleObject(timer, INFINITE);
+			return;
+		}
+	}
+#endif
+
+	std::this_thread::sleep_for(in_duration);
+}
+
+}
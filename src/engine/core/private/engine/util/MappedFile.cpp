@@ -0,0 +1,127 @@
+#include "engine/util/MappedFile.hpp"
+#include <string>
+#include <utility>
+#if CB_PLATFORM(WINDOWS)
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace cb
+{
+
+MappedFile::~MappedFile()
+{
+	unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& in_other) noexcept : data(std::exchange(in_other.data, nullptr)),
+	size(std::exchange(in_other.size, 0)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& in_other) noexcept
+{
+	if(this != &in_other)
+	{
+		unmap();
+		data = std::exchange(in_other.data, nullptr);
+		size = std::exchange(in_other.size, 0);
+	}
+
+	return *this;
+}
+
+cb::Result<MappedFile, MappedFileError> MappedFile::open(const std::string_view& in_path)
+{
+	const std::string path(in_path);
+
+#if CB_PLATFORM(WINDOWS)
+	HANDLE file = CreateFileA(path.c_str(), 
+		GENERIC_READ, 
+		FILE_SHARE_READ, 
+		nullptr, 
+		OPEN_EXISTING, 
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, 
+		nullptr);
+	if(file == INVALID_HANDLE_VALUE)
+		return make_error(MappedFileError::CannotOpenFile);
+
+	LARGE_INTEGER file_size;
+	if(!GetFileSizeEx(file, &file_size))
+	{
+		CloseHandle(file);
+		return make_error(MappedFileError::CannotOpenFile);
+	}
+
+	/** Zero-sized files can't be mapped */
+	if(file_size.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return make_result(MappedFile());
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+	if(!mapping)
+		return make_error(MappedFileError::CannotMapFile);
+
+	/** The view keeps a reference to the mapping object */
+	void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if(!view)
+		return make_error(MappedFileError::CannotMapFile);
+
+	return make_result(MappedFile(static_cast<const uint8_t*>(view), static_cast<size_t>(file_size.QuadPart)));
+#else
+	const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if(fd < 0)
+		return make_error(MappedFileError::CannotOpenFile);
+
+	struct stat file_stat;
+	if(fstat(fd, &file_stat) != 0)
+	{
+		::close(fd);
+		return make_error(MappedFileError::CannotOpenFile);
+	}
+
+	if(file_stat.st_size == 0)
+	{
+		::close(fd);
+		return make_result(MappedFile());
+	}
+
+	const size_t file_size = static_cast<size_t>(file_stat.st_size);
+
+	/** The mapping keeps a reference to the file */
+	void* view = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if(view == MAP_FAILED)
+		return make_error(MappedFileError::CannotMapFile);
+
+	/** Files are usually read once from start to end (e.g copied to a staging buffer) */
+	posix_madvise(view, file_size, POSIX_MADV_SEQUENTIAL);
+	posix_madvise(view, file_size, POSIX_MADV_WILLNEED);
+
+	return make_result(MappedFile(static_cast<const uint8_t*>(view), file_size));
+#endif
+}
+
+void MappedFile::unmap()
+{
+	if(!data)
+		return;
+
+#if CB_PLATFORM(WINDOWS)
+	UnmapViewOfFile(data);
+#else
+	munmap(const_cast<uint8_t*>(data), size);
+#endif
+
+	data = nullptr;
+	size = 0;
+}
+
+}
@@ -0,0 +1,261 @@
+#include "engine/util/RadixSort.hpp"
+#include <algorithm>
+#include <array>
+#include <barrier>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace cb
+{
+
+namespace
+{
+
+constexpr uint32_t radix_bits = 8;
+constexpr size_t radix_size = 1 << radix_bits;
+constexpr uint32_t radix_passes = 64 / radix_bits;
+
+using Histogram = std::array<size_t, radix_size>;
+
+uint32_t get_digit(const uint64_t in_key, const uint32_t in_pass)
+{
+	return static_cast<uint32_t>(in_key >> (in_pass * radix_bits)) & (radix_size - 1);
+}
+
+/**
+ * Turn per-chunk digit counts into per-chunk scatter offsets, chunks keep their order so the sort stays stable
+ * \return false if every key has the same digit, the pass can then be skipped
+ */
+bool compute_offsets(const std::span<Histogram>& in_histograms, const size_t in_count)
+{
+	size_t offset = 0;
+	for(size_t digit = 0; digit < radix_size; ++digit)
+	{
+		size_t digit_count = 0;
+		for(auto& histogram : in_histograms)
+		{
+			const size_t count = histogram[digit];
+			histogram[digit] = offset;
+			offset += count;
+			digit_count += count;
+		}
+
+		if(digit_count == in_count)
+			return false;
+	}
+
+	return true;
+}
+
+void radix_sort_single_threaded(const std::span<RadixSortEntry>& in_entries,
+	const std::span<RadixSortEntry>& in_scratch)
+{
+	/** Digit counts don't depend on the order, so all passes are counted in a single read */
+	std::array<Histogram, radix_passes> histograms = {};
+	for(const auto& entry : in_entries)
+		for(uint32_t pass = 0; pass < radix_passes; ++pass)
+			histograms[pass][get_digit(entry.key, pass)]++;
+
+	std::span<RadixSortEntry> src = in_entries;
+	std::span<RadixSortEntry> dst = in_scratch;
+	for(uint32_t pass = 0; pass < radix_passes; ++pass)
+	{
+		if(!compute_offsets({ &histograms[pass], 1 }, in_entries.size()))
+			continue;
+
+		for(const auto& entry : src)
+			dst[histograms[pass][get_digit(entry.key, pass)]++] = entry;
+
+		std::swap(src, dst);
+	}
+
+	if(src.data() != in_entries.data())
+		std::copy(src.begin(), src.end(), in_entries.begin());
+}
+
+/**
+ * Each thread counts and scatters its own slice of the source, slices and passes are synchronized with barriers
+ */
+using ParallelFor = std::function<void(const uint32_t, const std::function<void(const uint32_t)>&)>;
+
+void radix_sort_multi_threaded(const std::span<RadixSortEntry>& in_entries,
+	const std::span<RadixSortEntry>& in_scratch,
+	const uint32_t in_thread_count,
+	const ParallelFor& in_parallel_for)
+{
+	std::vector<Histogram> histograms(in_thread_count);
+	std::span<RadixSortEntry> src = in_entries;
+	std::span<RadixSortEntry> dst = in_scratch;
+	uint32_t pass = 0;
+	bool scatter = false;
+
+	std::barrier counted(in_thread_count, [&]() noexcept
+	{
+		scatter = compute_offsets(histograms, in_entries.size());
+	});
+	std::barrier scattered(in_thread_count, [&]() noexcept
+	{
+		if(scatter)
+			std::swap(src, dst);
+		pass++;
+	});
+
+	const size_t slice_size = (in_entries.size() + in_thread_count - 1) / in_thread_count;
+	const auto sort_slice = [&](const uint32_t in_thread)
+	{
+		const size_t begin = std::min(in_thread * slice_size, in_entries.size());
+		const size_t end = std::min(begin + slice_size, in_entries.size());
+		Histogram& histogram = histograms[in_thread];
+
+		while(pass < radix_passes)
+		{
+			histogram.fill(0);
+			for(size_t i = begin; i < end; ++i)
+				histogram[get_digit(src[i].key, pass)]++;
+
+			counted.arrive_and_wait();
+
+			if(scatter)
+			{
+				for(size_t i = begin; i < end; ++i)
+					dst[histogram[get_digit(src[i].key, pass)]++] = src[i];
+			}
+
+			scattered.arrive_and_wait();
+		}
+	};
+
+	in_parallel_for(in_thread_count, sort_slice);
+
+	if(src.data() != in_entries.data())
+		std::copy(src.begin(), src.end(), in_entries.begin());
+}
+
+}
+
+void radix_sort(const std::span<RadixSortEntry>& in_entries,
+	const std::span<RadixSortEntry>& in_scratch,
+	const uint32_t in_max_threads,
+	const size_t in_min_entries_per_thread)
+{
+	CB_CHECK(in_scratch.size() >= in_entries.size())
+
+	const uint32_t thread_count = static_cast<uint32_t>(std::min<size_t>(in_max_threads,
+		in_entries.size() / std::max<size_t>(in_min_entries_per_thread, 1)));
+	if(thread_count > 1)
+	{
+		radix_sort_multi_threaded(in_entries, 
+			in_scratch.first(in_entries.size()), 
+			thread_count,
+			[](const uint32_t in_count, const std::function<void(const uint32_t)>& in_task)
+			{
+				std::vector<std::thread> threads;
+				threads.reserve(in_count - 1);
+				for(uint32_t i = 1; i < in_count; ++i)
+					threads.emplace_back(in_task, i);
+
+				in_task(0);
+
+				for(auto& thread : threads)
+					thread.join();
+			});
+	}
+	else
+	{
+		radix_sort_single_threaded(in_entries, in_scratch.first(in_entries.size()));
+	}
+}
+
+RadixSorter::RadixSorter(const uint32_t in_max_threads, const size_t in_min_entries_per_thread) : 
+	min_entries_per_thread(std::max<size_t>(in_min_entries_per_thread, 1)), task(nullptr), task_count(0), 
+	pending_workers(0), generation(0), stop(false)
+{
+	/** The calling thread takes part in every sort */
+	const uint32_t worker_count = std::max(in_max_threads, 1u) - 1;
+	workers.reserve(worker_count);
+	for(uint32_t i = 0; i < worker_count; ++i)
+		workers.emplace_back([this, i]() { run_worker(i + 1); });
+}
+
+RadixSorter::~RadixSorter()
+{
+	{
+		std::lock_guard lock(mutex);
+		stop = true;
+	}
+	start_condition.notify_all();
+
+	for(auto& worker : workers)
+		worker.join();
+}
+
+void RadixSorter::sort(const std::span<RadixSortEntry>& in_entries, const std::span<RadixSortEntry>& in_scratch)
+{
+	CB_CHECK(in_scratch.size() >= in_entries.size())
+
+	const uint32_t thread_count = static_cast<uint32_t>(std::min<size_t>(get_max_threads(),
+		in_entries.size() / min_entries_per_thread));
+	if(thread_count > 1)
+	{
+		radix_sort_multi_threaded(in_entries, 
+			in_scratch.first(in_entries.size()), 
+			thread_count,
+			[this](const uint32_t in_count, const std::function<void(const uint32_t)>& in_task)
+			{
+				parallel_for(in_count, in_task);
+			});
+	}
+	else
+	{
+		radix_sort_single_threaded(in_entries, in_scratch.first(in_entries.size()));
+	}
+}
+
+void RadixSorter::parallel_for(const uint32_t in_count, const std::function<void(const uint32_t)>& in_task)
+{
+	CB_CHECK(in_count > 0 && in_count <= get_max_threads())
+
+	{
+		std::lock_guard lock(mutex);
+		task = &in_task;
+		task_count = in_count;
+		pending_workers = in_count - 1;
+		generation++;
+	}
+	start_condition.notify_all();
+
+	in_task(0);
+
+	std::unique_lock lock(mutex);
+	done_condition.wait(lock, [&]() { return pending_workers == 0; });
+	task = nullptr;
+}
+
+void RadixSorter::run_worker(const uint32_t in_index)
+{
+	uint64_t last_generation = 0;
+	std::unique_lock lock(mutex);
+	while(true)
+	{
+		start_condition.wait(lock, [&]() { return stop || generation != last_generation; });
+		if(stop)
+			return;
+
+		last_generation = generation;
+
+		/** Workers beyond the thread count of this sort sit it out */
+		if(in_index >= task_count)
+			continue;
+
+		const std::function<void(const uint32_t)>* current_task = task;
+		lock.unlock();
+		(*current_task)(in_index);
+		lock.lock();
+
+		if(--pending_workers == 0)
+			done_condition.notify_one();
+	}
+}
+
+}
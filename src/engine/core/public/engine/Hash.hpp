@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+#include <string_view>
 #include <utility>
 
 namespace cb
@@ -14,4 +16,18 @@ void hash_combine(size_t& seed, const T& v)
 	seed ^= H()(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
 }
 
+/**
+ * 64-bit FNV-1a, usable at compile time and stable across runs and platforms unlike std::hash
+ */
+constexpr uint64_t fnv1a_64(const std::string_view& in_string, uint64_t in_seed = 0xcbf29ce484222325)
+{
+	for(const char c : in_string)
+	{
+		in_seed ^= static_cast<uint8_t>(c);
+		in_seed *= 0x100000001b3;
+	}
+
+	return in_seed;
+}
+
 }
\ No newline at end of file
@@ -5,30 +5,30 @@
  * https://www.fluentcpp.com/2019/05/28/better-macros-better-flags/
  */
 
-/** So for some reason MSVC defined is broken.. */
-#if _MSC_VER >= 1
-#define CB_DEFINED(X) X >= 1
-#else
-#define CB_DEFINED(X) defined(X)
-#endif
+/**
+ * Test the value of a predefined macro, undefined identifiers evaluate to 0 in #if.
+ * defined() can't be used here, a defined() produced by a macro expansion is undefined behavior
+ * and CB_DEFINED(__linux__) would expand to defined(1) on GCC/Clang.
+ */
+#define CB_DEFINED(X) ((X + 0) >= 1)
 
 /** Platforms */
-#define CB_PLATFORM_PRIVATE_DEFINITION_WIN32() CB_DEFINED(_WIN32) || CB_DEFINED(__INTELLISENSE__)
-#define CB_PLATFORM_PRIVATE_DEFINITION_WIN64() CB_DEFINED(_WIN64) || CB_DEFINED(__INTELLISENSE__)
-#define CB_PLATFORM_PRIVATE_DEFINITION_WINDOWS() CB_PLATFORM_PRIVATE_DEFINITION_WIN32() || CB_PLATFORM_PRIVATE_DEFINITION_WIN64() || defined(__INTELLISENSE__)
+#define CB_PLATFORM_PRIVATE_DEFINITION_WIN32() (CB_DEFINED(_WIN32) || CB_DEFINED(__INTELLISENSE__))
+#define CB_PLATFORM_PRIVATE_DEFINITION_WIN64() (CB_DEFINED(_WIN64) || CB_DEFINED(__INTELLISENSE__))
+#define CB_PLATFORM_PRIVATE_DEFINITION_WINDOWS() (CB_PLATFORM_PRIVATE_DEFINITION_WIN32() || CB_PLATFORM_PRIVATE_DEFINITION_WIN64())
 #define CB_PLATFORM_PRIVATE_DEFINITION_ANDROID() CB_DEFINED(__ANDROID__)
-#define CB_PLATFORM_PRIVATE_DEFINITION_LINUX() CB_DEFINED(__linux__) && !CB_PLATFORM_PRIVATE_DEFINITION_ANDROID()
-#define CB_PLATFORM_PRIVATE_DEFINITION_OSX() CB_DEFINED(__APPLE__) || CB_DEFINED(__MACH__)
+#define CB_PLATFORM_PRIVATE_DEFINITION_LINUX() (CB_DEFINED(__linux__) && !CB_PLATFORM_PRIVATE_DEFINITION_ANDROID())
+#define CB_PLATFORM_PRIVATE_DEFINITION_OSX() (CB_DEFINED(__APPLE__) || CB_DEFINED(__MACH__))
 #define CB_PLATFORM_PRIVATE_DEFINITION_FREEBSD() CB_DEFINED(__FREEBSD__)
 
 /** Return 1 if compiling for this platform */
 #define CB_PLATFORM(X) CB_PLATFORM_PRIVATE_DEFINITION_##X()
 
 /** Compilers */
-#define CB_COMPILER_PRIVATE_DEFINITION_MSVC() CB_DEFINED(_MSC_VER) || CB_DEFINED(__INTELLISENSE__)
-#define CB_COMPILER_PRIVATE_DEFINITION_GCC() CB_DEFINED(__GNUC__) && !CB_DEFINED(__llvm__) && !CB_DEFINED(__INTEL_COMPILER)
-#define CB_COMPILER_PRIVATE_DEFINITION_CLANG() CB_DEFINED(__clang__) && !CB_DEFINED(__INTELLISENSE__)
-#define CB_COMPILER_PRIVATE_DEFINITION_CLANG_CL() CB_COMPILER_PRIVATE_DEFINITION_CLANG() && CB_PLATFORM(WINDOWS)
+#define CB_COMPILER_PRIVATE_DEFINITION_MSVC() (CB_DEFINED(_MSC_VER) || CB_DEFINED(__INTELLISENSE__))
+#define CB_COMPILER_PRIVATE_DEFINITION_GCC() (CB_DEFINED(__GNUC__) && !CB_DEFINED(__llvm__) && !CB_DEFINED(__INTEL_COMPILER))
+#define CB_COMPILER_PRIVATE_DEFINITION_CLANG() (CB_DEFINED(__clang__) && !CB_DEFINED(__INTELLISENSE__))
+#define CB_COMPILER_PRIVATE_DEFINITION_CLANG_CL() (CB_COMPILER_PRIVATE_DEFINITION_CLANG() && CB_PLATFORM(WINDOWS))
 
 /** Return 1 if compiling with the specified compiler */
 #define CB_COMPILER(X) CB_COMPILER_PRIVATE_DEFINITION_##X()
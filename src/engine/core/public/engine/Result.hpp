@@ -36,24 +36,24 @@ public:
 	Result(ErrorType&& in_error, detail::ErrorTag in_tag = error_tag) : value(std::move(in_error)), error_handled(false) { (void)(in_tag); }
 	~Result()
 	{
-		CB_ASSERTF(value.index() == 0 || value.index() == 1 && error_handled, "Unhandled cb::Result error !");
+		CB_ASSERTF(value.index() == 0 || (value.index() == 1 && error_handled), "Unhandled cb::Result error !");
 	}
 	
 	/** Default move ctor */
 	Result(Result<T, E>&&)
-		requires !std::is_same_v<T, detail::MakeResultValue> && !std::is_same_v<E, detail::MakeResultError> = default;
+		requires (!std::is_same_v<T, detail::MakeResultValue> && !std::is_same_v<E, detail::MakeResultError>) = default;
 
 	/** Special construct for make_result to make code less cluttered */
 	Result(Result<ValueType, detail::MakeResultError>&& in_other) noexcept
-		requires !std::is_same_v<T, detail::MakeResultValue> : value(std::move(in_other.get_value())), error_handled(false) {}
+		requires (!std::is_same_v<T, detail::MakeResultValue>) : value(std::move(in_other.get_value())), error_handled(false) {}
 	
 	Result(Result<detail::MakeResultValue, E>&& in_other) noexcept
-		requires !std::is_same_v<E, detail::MakeResultError> : value(std::move(in_other.get_error())), error_handled(false) {}
+		requires (!std::is_same_v<E, detail::MakeResultError>) : value(std::move(in_other.get_error())), error_handled(false) {}
 
 	/** unique_ptr support */
 	template<typename U>
 	Result(Result<std::unique_ptr<U>, detail::MakeResultError>&& in_other) noexcept
-		requires !std::is_same_v<T, detail::MakeResultValue> : value(std::move(in_other.get_value())), error_handled(false) {}
+		requires (!std::is_same_v<T, detail::MakeResultValue>) : value(std::move(in_other.get_value())), error_handled(false) {}
 	
 	Result& operator=(const Result&) = default;
 	Result& operator=(Result&&) noexcept = default;
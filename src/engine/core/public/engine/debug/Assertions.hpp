@@ -12,24 +12,24 @@
 #define CB_DEBUGBREAK()
 #endif /** CB_COMPILER(MSVC) */
 
-/** Assertions */
+/** Assertions, the message and its arguments are forwarded together so calls without arguments are portable */
 
 /** ASSERT/ASSETF */
 #if CB_BUILD(DEBUG)
 #define CB_ASSERT(condition) if(!(condition)) { logger::fatal("Assertion failed: {} (File: {}, Line: {})", #condition, __FILE__, __LINE__); CB_DEBUGBREAK(); }
-#define CB_ASSERTF(condition, msg, ...) if(!(condition)) { logger::fatal("Assertion failed: {} (File: {}, Line: {})", fmt::format(msg, __VA_ARGS__), __FILE__, __LINE__); CB_DEBUGBREAK(); }
+#define CB_ASSERTF(condition, ...) if(!(condition)) { logger::fatal("Assertion failed: {} (File: {}, Line: {})", fmt::format(__VA_ARGS__), __FILE__, __LINE__); CB_DEBUGBREAK(); }
 #else 
 #define CB_ASSERT(condition) if(!(condition)) { logger::fatal("Assertion failed: {}", #condition); }
-#define CB_ASSERTF(condition, msg, ...) if(!(condition)) { logger::fatal("Assertion failed: {} ({})", fmt::format(msg, __VA_ARGS__), #condition); }
+#define CB_ASSERTF(condition, ...) if(!(condition)) { logger::fatal("Assertion failed: {} ({})", fmt::format(__VA_ARGS__), #condition); }
 #endif
 
 /** CHECK/CHECKF */
 #if CB_BUILD(DEBUG)
 #define CB_CHECK(condition) if(!(condition)) { logger::error("Check failed: {} (File: {}, Line: {})", #condition, __FILE__, __LINE__); CB_DEBUGBREAK(); }
-#define CB_CHECKF(condition, msg, ...) if(!(condition)) { logger::error("{} (File: {}, Line: {})", fmt::format(msg, __VA_ARGS__), __FILE__, __LINE__); CB_DEBUGBREAK(); }
+#define CB_CHECKF(condition, ...) if(!(condition)) { logger::error("{} (File: {}, Line: {})", fmt::format(__VA_ARGS__), __FILE__, __LINE__); CB_DEBUGBREAK(); }
 #define CB_UNREACHABLE() CB_CHECKF(true, "Reached unreacheable code!"); std::abort();
 #else
 #define CB_CHECK(condition)
-#define CB_CHECKF(condition, msg, ...)
+#define CB_CHECKF(condition, ...)
 #define CB_UNREACHABLE() std::abort();
 #endif
\ No newline at end of file
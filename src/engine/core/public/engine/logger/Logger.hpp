@@ -4,6 +4,8 @@
 #include <chrono>
 #include <thread>
 #include <string_view>
+#include <sstream>
+#include <iomanip>
 #include "engine/debug/Assertions.hpp"
 #include <fmt/format.h>
 #include "engine/UnusedParameters.hpp"
@@ -57,7 +59,7 @@ inline std::string format_message(const std::string& in_pattern, const Message&
 	std::stringstream ss;
 	ss << std::put_time(localtime, "%H:%M:%S");
 
-	return fmt::format(in_pattern, fmt::arg("time", ss.str()),
+	return fmt::format(fmt::runtime(in_pattern), fmt::arg("time", ss.str()),
 		fmt::arg("severity", severity_to_string(in_message.severity)),
 		fmt::arg("category", in_message.category.name),
 		fmt::arg("message", in_message.message));
@@ -73,7 +75,7 @@ template<typename... Args>
 void logf(SeverityFlagBits in_severity, const Category& in_category,
 	const std::string_view& in_format, Args&&... in_args)
 {
-	log(in_severity, in_category, fmt::format(in_format, std::forward<Args>(in_args)...));
+	log(in_severity, in_category, fmt::format(fmt::runtime(in_format), std::forward<Args>(in_args)...));
 }
 
 template<typename... Args>
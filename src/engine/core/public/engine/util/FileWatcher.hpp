@@ -0,0 +1,78 @@
+#pragma once
+
+#include "engine/Core.hpp"
+#include "engine/Result.hpp"
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <robin_hood.h>
+
+namespace cb
+{
+
+enum class FileWatcherError
+{
+	CannotWatchDirectory,
+};
+
+/**
+ * Reports files written in a directory (not recursive)
+ * Uses inotify on Linux and change notifications on Windows, other platforms compare modification times on each poll
+ */
+class FileWatcher
+{
+public:
+	FileWatcher() = default;
+	~FileWatcher();
+
+	FileWatcher(const FileWatcher&) = delete;
+	FileWatcher& operator=(const FileWatcher&) = delete;
+
+	FileWatcher(FileWatcher&& in_other) noexcept;
+	FileWatcher& operator=(FileWatcher&& in_other) noexcept;
+
+	[[nodiscard]] static cb::Result<FileWatcher, FileWatcherError> create(const std::string_view& in_directory);
+
+	/**
+	 * Never blocks
+	 * \return Paths (directory/file) of the files written since the last call, without duplicates
+	 */
+	[[nodiscard]] std::vector<std::string> poll();
+
+	[[nodiscard]] const std::string& get_directory() const { return directory; }
+private:
+	void close();
+
+#if !CB_PLATFORM(LINUX)
+	/** Modification time of every file of the directory */
+	[[nodiscard]] robin_hood::unordered_map<std::string, std::filesystem::file_time_type> scan() const;
+#endif
+private:
+	std::string directory;
+#if CB_PLATFORM(LINUX)
+	int inotify_fd = -1;
+#else
+	/** Windows change notification handle */
+	void* notification = nullptr;
+	robin_hood::unordered_map<std::string, std::filesystem::file_time_type> write_times;
+#endif
+};
+
+}
+
+namespace std
+{
+
+inline std::string to_string(const cb::FileWatcherError& in_error)
+{
+	switch(in_error)
+	{
+	case cb::FileWatcherError::CannotWatchDirectory:
+		return "Cannot watch directory";
+	}
+
+	return "";
+}
+
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "engine/Core.hpp"
+#include <chrono>
+
+namespace cb
+{
+
+/**
+ * Paces a loop to a target frame rate
+ * Most of the remaining frame time is slept with the OS high-resolution timer, the last fraction is spun
+ * since sleeps can overshoot by up to a scheduler quantum
+ */
+class FrameLimiter
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	/** 0 disables the limit */
+	explicit FrameLimiter(const float in_target_fps = 0.f);
+	~FrameLimiter();
+
+	FrameLimiter(const FrameLimiter&) = delete;
+	FrameLimiter& operator=(const FrameLimiter&) = delete;
+
+	/** 0 disables the limit */
+	void set_target_fps(const float in_target_fps);
+
+	/**
+	 * Block until the target frame time elapsed since the previous call
+	 * Late frames don't wait and restart the pacing, so a hitch isn't followed by a burst of short frames
+	 */
+	void wait();
+
+	[[nodiscard]] float get_target_fps() const { return target_fps; }
+private:
+	void sleep(const Clock::duration& in_duration);
+private:
+	float target_fps;
+	Clock::duration target_frame_time;
+	Clock::time_point next_frame;
+
+#if CB_PLATFORM(WINDOWS)
+	/** High-resolution waitable timer, null before Windows 10 1803 where std::this_thread::sleep_for is used */
+	void* timer;
+#endif
+};
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "engine/Core.hpp"
+#include "engine/Result.hpp"
+#include <span>
+#include <string_view>
+
+namespace cb
+{
+
+enum class MappedFileError
+{
+	CannotOpenFile,
+	CannotMapFile,
+};
+
+/**
+ * Read-only memory mapping of a whole file
+ * The mapped memory stays valid (and at the same address) until the MappedFile is destroyed, even if it is moved
+ */
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	MappedFile(MappedFile&& in_other) noexcept;
+	MappedFile& operator=(MappedFile&& in_other) noexcept;
+
+	[[nodiscard]] static cb::Result<MappedFile, MappedFileError> open(const std::string_view& in_path);
+
+	[[nodiscard]] std::span<const uint8_t> get_data() const { return { data, size }; }
+	[[nodiscard]] size_t get_size() const { return size; }
+private:
+	MappedFile(const uint8_t* in_data, const size_t in_size) : data(in_data), size(in_size) {}
+
+	void unmap();
+private:
+	const uint8_t* data = nullptr;
+	size_t size = 0;
+};
+
+}
+
+namespace std
+{
+
+inline std::string to_string(const cb::MappedFileError& in_error)
+{
+	switch(in_error)
+	{
+	case cb::MappedFileError::CannotOpenFile:
+		return "Cannot open file";
+	case cb::MappedFileError::CannotMapFile:
+		return "Cannot map file";
+	}
+
+	return "";
+}
+
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "engine/Core.hpp"
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace cb
+{
+
+/**
+ * A 64-bit key and the index of the element it sorts
+ */
+struct RadixSortEntry
+{
+	uint64_t key;
+	uint32_t value;
+};
+
+/**
+ * Stable LSD radix sort on 64-bit keys, 8 bits per pass
+ * Passes where every key has the same digit are skipped, so short keys cost less
+ * Inputs larger than in_min_entries_per_thread * 2 are split between up to in_max_threads threads
+ * \param in_scratch Must be as large as in_entries
+ */
+void radix_sort(const std::span<RadixSortEntry>& in_entries,
+	const std::span<RadixSortEntry>& in_scratch,
+	const uint32_t in_max_threads = 1,
+	const size_t in_min_entries_per_thread = 16384);
+
+/**
+ * Same sort as radix_sort, with worker threads created once and reused by every sort
+ * Inputs smaller than in_min_entries_per_thread * 2 are sorted inline on the calling thread
+ */
+class RadixSorter
+{
+public:
+	explicit RadixSorter(const uint32_t in_max_threads = 1, const size_t in_min_entries_per_thread = 16384);
+	~RadixSorter();
+
+	RadixSorter(const RadixSorter&) = delete;
+	void operator=(const RadixSorter&) = delete;
+
+	/** \param in_scratch Must be as large as in_entries */
+	void sort(const std::span<RadixSortEntry>& in_entries, const std::span<RadixSortEntry>& in_scratch);
+
+	[[nodiscard]] uint32_t get_max_threads() const { return static_cast<uint32_t>(workers.size()) + 1; }
+private:
+	/** Run in_task(i) for i in [0, in_count), 0 on the calling thread */
+	void parallel_for(const uint32_t in_count, const std::function<void(const uint32_t)>& in_task);
+	void run_worker(const uint32_t in_index);
+private:
+	size_t min_entries_per_thread;
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable start_condition;
+	std::condition_variable done_condition;
+	const std::function<void(const uint32_t)>* task;
+	uint32_t task_count;
+	uint32_t pending_workers;
+	uint64_t generation;
+	bool stop;
+};
+
+}
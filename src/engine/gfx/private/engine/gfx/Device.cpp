@@ -1,5 +1,10 @@
 #include "engine/gfx/Device.hpp"
 #include "engine/gfx/BackendDevice.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <optional>
 
 namespace cb::gfx
 {
@@ -8,9 +13,33 @@ using namespace detail;
 
 Device* current_device = nullptr;
 
+/** Bindless */
+uint32_t BindlessIndexAllocator::allocate()
+{
+	std::scoped_lock lock(mutex);
+
+	if(!free_indices.empty())
+	{
+		const uint32_t index = free_indices.back();
+		free_indices.pop_back();
+		return index;
+	}
+
+	return next_index < capacity ? next_index++ : invalid_bindless_index;
+}
+
+void BindlessIndexAllocator::free(const uint32_t in_index)
+{
+	std::scoped_lock lock(mutex);
+	free_indices.emplace_back(in_index);
+}
+
 /** Resources dtor */
 Buffer::~Buffer()
 {
+	if(bindless_index != invalid_bindless_index)
+		device.bindless_storage_buffers.free(bindless_index);
+
 	device.get_backend_device()->destroy_buffer(resource);	
 }
 
@@ -22,6 +51,9 @@ Texture::~Texture()
 
 TextureView::~TextureView()
 {
+	if(bindless_index != invalid_bindless_index)
+		device.bindless_texture_views.free(bindless_index);
+
 	/** texture maybe a dangling ref, don't access it ! */
 	if(!is_view_from_swapchain)
 		device.get_backend_device()->destroy_texture_view(resource);
@@ -105,11 +137,238 @@ Shader::~Shader()
 
 Sampler::~Sampler()
 {
+	if(bindless_index != invalid_bindless_index)
+		device.bindless_samplers.free(bindless_index);
+
 	device.get_backend_device()->destroy_sampler(resource);
 }
 
 /** Command List */
 
+void CommandList::begin()
+{
+	pipeline_layout = PipelineLayoutHandle();
+	render_pass = null_backend_resource;
+	subpass = 0;
+	rendering_formats = PipelineRenderingFormats();
+	dynamic_rendering = false;
+	multisampling = PipelineMultisamplingStateCreateInfo();
+	end_rendering_barriers.clear();
+	render_pass_state = PipelineRenderPassState();
+	material_state = PipelineMaterialState();
+	pipeline_state_dirty = false;
+	descriptors = {};
+	dirty_sets_mask = 0;
+	dirty_bindings_masks.fill(0);
+	for(auto& hashes : binding_hashes)
+		hashes.fill(std::hash<Descriptor>()(Descriptor()));
+	bound_sets_mask = 0;
+	populated_sets_mask = 0;
+	bound_pipeline = null_backend_resource;
+	bound_sets.fill(null_backend_resource);
+	bound_vertex_buffers.fill(null_backend_resource);
+	bound_vertex_buffer_offsets.fill(0);
+	bound_index_buffer = null_backend_resource;
+	bound_index_buffer_offset = 0;
+	bound_index_type = IndexType::Uint16;
+	bound_viewport.reset();
+	bound_scissor.reset();
+	statistics = {};
+}
+
+void CommandList::set_pipeline_layout(const PipelineLayoutHandle& in_handle)
+{
+	if(pipeline_layout == in_handle)
+		return;
+
+	pipeline_layout = in_handle;
+	pipeline_state_dirty = true;
+
+	/** Sets allocated for the previous layout must be allocated again, with the descriptors already written */
+	bound_sets_mask = 0;
+	bound_sets.fill(null_backend_resource);
+
+	if(!in_handle)
+		return;
+
+	auto layout = Device::cast_handle<PipelineLayout>(in_handle);
+	dirty_sets_mask |= populated_sets_mask & layout->get_sets_mask();
+
+	if(layout->is_bindless())
+		dirty_sets_mask |= 1 << bindless_descriptor_set;
+}
+
+void CommandList::set_render_pass(const BackendDeviceResource& in_handle)
+{
+	dynamic_rendering = false;
+	if(render_pass == in_handle && subpass == 0)
+		return;
+
+	render_pass = in_handle;
+	subpass = 0;
+	rendering_formats = PipelineRenderingFormats();
+	pipeline_state_dirty = true;
+}
+
+void CommandList::set_rendering_formats(const PipelineRenderingFormats& in_formats)
+{
+	dynamic_rendering = true;
+	if(render_pass == null_backend_resource && rendering_formats == in_formats)
+		return;
+
+	render_pass = null_backend_resource;
+	subpass = 0;
+	rendering_formats = in_formats;
+	pipeline_state_dirty = true;
+}
+
+void CommandList::set_sample_count(const SampleCountFlagBits in_sample_count)
+{
+	if(multisampling.samples == in_sample_count)
+		return;
+
+	multisampling.samples = in_sample_count;
+	pipeline_state_dirty = true;
+}
+
+void CommandList::next_subpass()
+{
+	CB_CHECKF(!dynamic_rendering && render_pass != null_backend_resource, "Dynamic rendering passes have a single subpass");
+	subpass++;
+	pipeline_state_dirty = true;
+}
+
+void CommandList::set_render_pass_state(const PipelineRenderPassState& in_state)
+{
+	if(render_pass_state == in_state)
+		return;
+
+	render_pass_state = in_state;
+	pipeline_state_dirty = true;
+}
+
+void CommandList::set_material_state(const PipelineMaterialState& in_state)
+{
+	if(material_state == in_state)
+		return;
+
+	material_state = in_state;
+	pipeline_state_dirty = true;
+}
+
+void CommandList::set_descriptor(size_t in_set, size_t in_binding, const Descriptor& in_descriptor)
+{
+	CB_CHECKF(!pipeline_layout || !Device::cast_handle<PipelineLayout>(pipeline_layout)->is_bindless() ||
+		in_set != bindless_descriptor_set, "The bindless set can't be written");
+
+	if(bound_sets_mask & (1 << in_set) && descriptors[in_set][in_binding] == in_descriptor)
+	{
+		statistics.filtered.descriptors++;
+		return;
+	}
+
+	descriptors[in_set][in_binding] = in_descriptor;
+	dirty_sets_mask |= 1 << in_set;
+	populated_sets_mask |= 1 << in_set;
+	dirty_bindings_masks[in_set] |= 1 << in_binding;
+	statistics.issued.descriptors++;
+}
+
+void CommandList::bind_vertex_buffers(const uint32_t in_first_binding,
+	const std::span<const BackendDeviceResource>& in_buffers,
+	const std::span<const uint64_t>& in_offsets)
+{
+	CB_CHECK(in_buffers.size() == in_offsets.size() && in_first_binding + in_buffers.size() <= max_vertex_input_bindings)
+
+	/** Only forward the range between the first and last binding that changed */
+	size_t first = in_buffers.size();
+	size_t last = 0;
+	for(size_t i = 0; i < in_buffers.size(); ++i)
+	{
+		const size_t binding = in_first_binding + i;
+		if(bound_vertex_buffers[binding] != in_buffers[i] || bound_vertex_buffer_offsets[binding] != in_offsets[i])
+		{
+			bound_vertex_buffers[binding] = in_buffers[i];
+			bound_vertex_buffer_offsets[binding] = in_offsets[i];
+			first = std::min(first, i);
+			last = i;
+		}
+	}
+
+	if(first == in_buffers.size())
+	{
+		statistics.filtered.vertex_buffers++;
+		return;
+	}
+
+	/** The shadow arrays now hold the new bindings */
+	const size_t first_binding = in_first_binding + first;
+	const size_t count = last - first + 1;
+	device.get_backend_device()->cmd_bind_vertex_buffers(resource,
+		static_cast<uint32_t>(first_binding),
+		{ bound_vertex_buffers.data() + first_binding, count },
+		{ bound_vertex_buffer_offsets.data() + first_binding, count });
+	statistics.issued.vertex_buffers++;
+}
+
+void CommandList::bind_index_buffer(const BackendDeviceResource in_buffer, 
+	const uint64_t in_offset,
+	const IndexType in_index_type)
+{
+	if(bound_index_buffer == in_buffer && bound_index_buffer_offset == in_offset && bound_index_type == in_index_type)
+	{
+		statistics.filtered.index_buffers++;
+		return;
+	}
+
+	bound_index_buffer = in_buffer;
+	bound_index_buffer_offset = in_offset;
+	bound_index_type = in_index_type;
+	device.get_backend_device()->cmd_bind_index_buffer(resource, in_buffer, in_offset, in_index_type);
+	statistics.issued.index_buffers++;
+}
+
+void CommandList::set_viewport(const Viewport& in_viewport)
+{
+	if(bound_viewport == in_viewport)
+	{
+		statistics.filtered.viewports++;
+		return;
+	}
+
+	bound_viewport = in_viewport;
+	std::array viewports = { in_viewport };
+	device.get_backend_device()->cmd_set_viewports(resource, 0, viewports);
+	statistics.issued.viewports++;
+}
+
+void CommandList::set_scissor(const Rect2D& in_scissor)
+{
+	if(bound_scissor == in_scissor)
+	{
+		statistics.filtered.scissors++;
+		return;
+	}
+
+	bound_scissor = in_scissor;
+	std::array scissors = { in_scissor };
+	device.get_backend_device()->cmd_set_scissors(resource, 0, scissors);
+	statistics.issued.scissors++;
+}
+
+void CommandList::push_constants(const ShaderStageFlags in_stages, 
+	const uint32_t in_offset, 
+	const std::span<const uint8_t>& in_data)
+{
+	CB_CHECKF(pipeline_layout, "No pipeline layout was bound!");
+
+	device.get_backend_device()->cmd_push_constants(resource,
+		Device::cast_handle<PipelineLayout>(pipeline_layout)->get_resource(),
+		in_stages,
+		in_offset,
+		in_data);
+}
+
 void CommandList::prepare_draw()
 {
 	if(pipeline_state_dirty)
@@ -122,24 +381,32 @@ void CommandList::update_pipeline_state()
 {
 	CB_CHECKF(pipeline_layout, "No pipeline layout was bound!");
 	
-	GfxPipelineCreateInfo create_info(material_state.stages,
+	GfxPipelineCreateInfo create_info({},
 		material_state.vertex_input,
 		material_state.input_assembly,
 		material_state.rasterizer,
-		render_pass_state.multisampling,
+		multisampling,
 		render_pass_state.depth_stencil,
 		render_pass_state.color_blend,
 		Device::cast_handle<PipelineLayout>(pipeline_layout)->get_resource(),
 		render_pass,
-		0);
-	auto pipeline = device.get_or_create_pipeline(create_info);
-	
+		subpass,
+		rendering_formats);
+	auto pipeline = device.get_or_create_pipeline(detail::GfxPipelineKey { material_state.stages, create_info });
+	pipeline_state_dirty = false;	
+
+	if(pipeline == bound_pipeline)
+	{
+		statistics.filtered.pipelines++;
+		return;
+	}
+
 	device.get_backend_device()->cmd_bind_pipeline(
 		resource,
 		PipelineBindPoint::Gfx,
 		pipeline);
-	
-	pipeline_state_dirty = false;	
+	bound_pipeline = pipeline;
+	statistics.issued.pipelines++;
 }
 
 void CommandList::update_descriptors()
@@ -149,38 +416,102 @@ void CommandList::update_descriptors()
 
 	auto layout = Device::cast_handle<PipelineLayout>(pipeline_layout);
 
-	std::vector<BackendDeviceResource> sets;
-	sets.reserve(max_descriptor_sets);
-	for(uint32_t i = 0; i < max_descriptor_sets; ++i)
+	uint32_t changed_sets_mask = 0;
+	for(uint32_t set = 0; set < max_descriptor_sets; ++set)
 	{
-		if(dirty_sets_mask & (1 << i))
+		if(!(dirty_sets_mask & (1 << set)))
+			continue;
+
+		BackendDeviceResource descriptor_set;
+		if(set == bindless_descriptor_set && layout->is_bindless())
+		{
+			descriptor_set = device.get_backend_device()->get_bindless_descriptor_set();
+		}
+		else
 		{
+			for(uint32_t bindings = dirty_bindings_masks[set]; bindings != 0; bindings &= bindings - 1)
+			{
+				const uint32_t binding = std::countr_zero(bindings);
+				binding_hashes[set][binding] = std::hash<Descriptor>()(descriptors[set][binding]);
+			}
+			dirty_bindings_masks[set] = 0;
+
+			uint64_t hash = 0;
+			for(const auto& binding_hash : binding_hashes[set])
+				hash_combine(hash, binding_hash);
+
 			auto result = device.get_backend_device()->allocate_descriptor_set(layout->get_resource(),
-				i,
-				descriptors[i]);
-			sets.emplace_back(result.get_value());
+				set,
+				descriptors[set],
+				hash);
+			descriptor_set = result.get_value();
 		}
+
+		/** Allocators return the same set for the same descriptors, it may already be bound */
+		if(std::exchange(bound_sets[set], descriptor_set) != descriptor_set)
+			changed_sets_mask |= 1 << set;
+		else
+			statistics.filtered.descriptor_sets++;
+		bound_sets_mask |= 1 << set;
 	}
 
-	device.get_backend_device()->cmd_bind_descriptor_sets(resource,
-		layout->get_resource(),
-		sets);
+	dirty_sets_mask = 0;
+
+	/** Bind each contiguous range of changed sets at its own first set */
+	while(changed_sets_mask != 0)
+	{
+		const uint32_t first_set = std::countr_zero(changed_sets_mask);
+		const uint32_t count = std::countr_one(changed_sets_mask >> first_set);
+		device.get_backend_device()->cmd_bind_descriptor_sets(resource,
+			layout->get_resource(),
+			first_set,
+			{ bound_sets.data() + first_set, count });
+		statistics.issued.descriptor_sets += count;
+		changed_sets_mask &= ~(((1u << count) - 1) << first_set);
+	}
 }
 
 /** Device */
 
 Device::Device(Backend& in_backend, 
-	std::unique_ptr<BackendDevice>&& in_backend_device) : backend(in_backend),
+	std::unique_ptr<BackendDevice>&& in_backend_device,
+	const uint32_t in_frames_in_flight) : backend(in_backend),
 	backend_device(std::move(in_backend_device)),
-	current_frame(0)
+	current_frame(0),
+	latency_mode(LatencyMode::Throughput),
+	dynamic_rendering_enabled(backend_device->supports_dynamic_rendering()),
+	bindless_enabled(backend_device->is_bindless_enabled()),
+	bindless_texture_views(max_bindless_texture_views),
+	bindless_samplers(max_bindless_samplers),
+	bindless_storage_buffers(max_bindless_storage_buffers)
 {
 	current_device = this;
 
-	frames.resize(Device::max_frames_in_flight);
+	const uint32_t frames_in_flight = std::clamp(in_frames_in_flight, min_frames_in_flight, max_frames_in_flight);
+	if(frames_in_flight != in_frames_in_flight)
+	{
+		logger::warn(log_gfx_device, "{} frames in flight requested, using {}", 
+			in_frames_in_flight,
+			frames_in_flight);
+	}
+
+	frames.resize(frames_in_flight);
 }
 
 Device::~Device()
 {
+	/** Pending requests never complete, their staging buffers are freed with the frames */
+	for(auto& frame : frames)
+	{
+		for(const auto& readback : frame.readbacks)
+			frame.expired_buffers.emplace_back(readback.buffer);
+		frame.readbacks.clear();
+	}
+
+	for(const auto& buffer : readback_buffers)
+		destroy_buffer(buffer.handle);
+	readback_buffers.clear();
+
 	for(auto& frame : frames)
 	{
 		if(!frame.wait_fences.empty())
@@ -214,7 +545,7 @@ Device::~Device()
 }
 
 Device::Frame::Frame() : gfx_command_pool(QueueType::Gfx),
-	compute_command_pool(QueueType::Compute)
+	compute_command_pool(QueueType::Compute), gfx_submitted(false)
 {
 	auto fence = get_device()->create_fence(FenceCreateInfo());
 	gfx_fence = fence.get_value();
@@ -248,11 +579,58 @@ void Device::Frame::free_resources()
 
 	for(auto& sampler : expired_samplers)
 		get_device()->samplers.free(cast_handle<Sampler>(sampler));
+
+	for(auto& pipeline : expired_backend_pipelines)
+		get_device()->get_backend_device()->destroy_pipeline(pipeline);
+
+	for(auto& shader : expired_backend_shaders)
+		get_device()->get_backend_device()->destroy_shader(shader);
 }
 
 void Device::wait_idle()
 {
 	backend_device->wait_idle();
+
+	/** Frames not submitted yet may have recorded readbacks to lists the GPU never saw */
+	for(auto& frame : frames)
+	{
+		if(frame.gfx_submitted)
+			complete_readbacks(frame);
+	}
+}
+
+void Device::complete_readbacks(Frame& in_frame)
+{
+	std::vector<PendingReadback> readbacks;
+	{
+		std::lock_guard lock(readback_mutex);
+		readbacks.swap(in_frame.readbacks);
+	}
+
+	for(auto& readback : readbacks)
+	{
+		auto map = map_buffer(readback.buffer);
+		if(map)
+		{
+			readback.state->data.resize(readback.size);
+			memcpy(readback.state->data.data(), map.get_value(), readback.size);
+			unmap_buffer(readback.buffer);
+		}
+		else
+		{
+			logger::error(log_gfx_device, "Failed to map readback buffer: {}", map.get_error());
+		}
+
+		{
+			std::lock_guard lock(readback_mutex);
+			readback_buffers.push_back({ readback.buffer, readback.size });
+		}
+
+		/** A failed request is still completed, with no data, so that pollers don't wait forever */
+		readback.state->ready.store(true, std::memory_order_release);
+		if(readback.state->callback)
+			readback.state->callback(readback.state->data);
+	}
 }
 
 void Device::new_frame()
@@ -263,7 +641,7 @@ void Device::new_frame()
 
 	if(!first_frame)
 	{
-		current_frame = (current_frame + 1) % max_frames_in_flight;
+		current_frame = (current_frame + 1) % frames.size();
 
 		/** Wait for fences before doing anything */
 		if(!get_current_frame().wait_fences.empty())
@@ -272,9 +650,24 @@ void Device::new_frame()
 			reset_fences(get_current_frame().wait_fences);
 		}
 
+		complete_readbacks(get_current_frame());
+
 		/** Free all resources marked to be destroyed */
 		get_current_frame().free_resources();
 		get_current_frame().reset();
+
+		/** Fences of other frames are only waited here, they are reset when their frame comes around */
+		if(latency_mode == LatencyMode::LowLatency)
+		{
+			for(auto& frame : frames)
+			{
+				if(!frame.wait_fences.empty())
+				{
+					wait_for_fences(frame.wait_fences);
+					complete_readbacks(frame);
+				}
+			}
+		}
 	}
 	else
 	{
@@ -284,6 +677,10 @@ void Device::new_frame()
 
 void Device::end_frame()
 {
+	command_list_statistics = {};
+	for(const auto& list : get_current_frame().gfx_lists)
+		command_list_statistics += cast_handle<CommandList>(list)->get_statistics();
+
 	/** Submit to queues */
 	submit_queue(QueueType::Gfx);
 }
@@ -374,6 +771,13 @@ cb::Result<BufferHandle, Result> Device::create_buffer(BufferInfo in_create_info
 
 	auto buffer = buffers.allocate(*this, result.get_value(), in_create_info.debug_name);
 	auto handle = cast_resource_ptr<BufferHandle>(buffer);
+
+	if(bindless_enabled && in_create_info.info.usage_flags & BufferUsageFlagBits::StorageBuffer)
+	{
+		buffer->set_bindless_index(bindless_storage_buffers.allocate());
+		if(buffer->get_bindless_index() != invalid_bindless_index)
+			backend_device->update_bindless_storage_buffer(buffer->get_bindless_index(), result.get_value());
+	}
 	
 	if(!in_create_info.initial_data.empty())
 	{
@@ -414,7 +818,97 @@ cb::Result<BufferHandle, Result> Device::create_buffer(BufferInfo in_create_info
 
 cb::Result<TextureHandle, Result> Device::create_texture(TextureInfo in_create_info)
 {
-	in_create_info.info.usage_flags |= TextureUsageFlagBits::TransferSrc | TextureUsageFlagBits::TransferDst;
+	/** Transient attachments can't be used with any other usage than attachments */
+	if(in_create_info.info.usage_flags & TextureUsageFlagBits::TransientAttachment)
+	{
+		CB_CHECKF(in_create_info.initial_data.empty(), "Transient attachments can't have initial data");
+	}
+	else
+	{
+		CB_CHECKF(in_create_info.info.mem_usage != MemoryUsage::GpuLazy, 
+			"Lazily allocated memory is only valid for transient attachments");
+		in_create_info.info.usage_flags |= TextureUsageFlagBits::TransferSrc | TextureUsageFlagBits::TransferDst;
+	}
+
+	/** 
+	 * Upload every level fully contained in the initial data, at the given offsets or tightly packed
+	 * Block-compressed rows are padded to whole blocks, so the row pitch is explicitly given in texels
+	 */
+	std::vector<BufferTextureCopyRegion> regions;
+	if(!in_create_info.initial_data.empty())
+	{
+		const TextureCreateInfo& info = in_create_info.info;
+		const TextureAspectFlags aspect_flags = format_to_aspect_flags(info.format);
+		CB_CHECKF(aspect_flags == TextureAspectFlags(TextureAspectFlagBits::Color),
+			"Only color texture formats support uploading initial data !");
+
+		const std::span<const TextureMipData>& mips = in_create_info.initial_data_mips;
+		const uint64_t data_size = in_create_info.initial_data.size();
+		if(!mips.empty() && mips.size() > info.mip_levels)
+		{
+			logger::error(log_gfx_device, "Texture \"{}\" has initial data for {} mip levels but only {} levels",
+				in_create_info.debug_name,
+				mips.size(),
+				info.mip_levels);
+			return make_error(Result::ErrorInvalidParameter);
+		}
+
+		const uint32_t block_extent = get_format_block_extent(info.format);
+		const uint32_t level_count = mips.empty() ? info.mip_levels : static_cast<uint32_t>(mips.size());
+		uint64_t offset = 0;
+		for(uint32_t level = 0; level < level_count; ++level)
+		{
+			const Extent3D extent(get_mip_dimension(info.width, level),
+				get_mip_dimension(info.height, level),
+				get_mip_dimension(info.depth, level));
+			const uint64_t level_size = get_mip_level_size(info.format, 
+				info.width, 
+				info.height, 
+				info.depth, 
+				level) * info.array_layers;
+
+			if(!mips.empty())
+			{
+				/** Written so that offsets and sizes coming from files can't overflow */
+				const TextureMipData& mip = mips[level];
+				if(mip.offset > data_size || mip.size > data_size - mip.offset || mip.size < level_size)
+				{
+					logger::error(log_gfx_device, "Mip {} of texture \"{}\" (offset {}, size {}) doesn't fit in its {} bytes of initial data",
+						level,
+						in_create_info.debug_name,
+						mip.offset,
+						mip.size,
+						data_size);
+					return make_error(Result::ErrorInvalidParameter);
+				}
+
+				offset = mip.offset;
+			}
+			else if(level_size > data_size - offset)
+			{
+				if(level == 0)
+				{
+					logger::error(log_gfx_device, "Initial data of texture \"{}\" ({} bytes) is too small to contain mip 0 ({} bytes)",
+						in_create_info.debug_name,
+						data_size,
+						level_size);
+					return make_error(Result::ErrorInvalidParameter);
+				}
+
+				/** Partial mip chain, the remaining levels are left undefined */
+				break;
+			}
+
+			regions.emplace_back(offset,
+				TextureSubresourceLayers(aspect_flags, level, 0, info.array_layers),
+				Offset3D(),
+				extent,
+				(extent.width + block_extent - 1) / block_extent * block_extent,
+				(extent.height + block_extent - 1) / block_extent * block_extent);
+			offset += level_size;
+		}
+	}
+
 	auto result = backend_device->create_texture(in_create_info.info);
 	if(!result)
 		return result.get_error();
@@ -426,29 +920,34 @@ cb::Result<TextureHandle, Result> Device::create_texture(TextureInfo in_create_i
 		in_create_info.debug_name);
 	auto handle = cast_resource_ptr<TextureHandle>(texture);
 
-	if(!in_create_info.initial_data.empty())
+	if(!regions.empty())
 	{
-		CB_CHECKF(format_to_aspect_flags(in_create_info.info.format) == TextureAspectFlags(TextureAspectFlagBits::Color),
-			"Only color texture formats support uploading initial data !");
+		const TextureCreateInfo& info = texture->get_create_info();
+		const TextureAspectFlags aspect_flags = format_to_aspect_flags(info.format);
+
+		auto level_range = [&](const uint32_t in_base_level, const uint32_t in_level_count)
+		{
+			return TextureSubresourceRange(aspect_flags, in_base_level, in_level_count, 0, info.array_layers);
+		};
 
 		/** Create a staging buffer containing our initial data */
 		UniqueBuffer staging(create_buffer(BufferInfo::make_staging(in_create_info.initial_data.size(),
 			in_create_info.initial_data).set_debug_name("Copy Staging Buffer (create_texture)")).get_value());
 
+		const uint32_t uploaded_levels = static_cast<uint32_t>(regions.size());
+		bool generate_mips = in_create_info.generate_mip_chain && uploaded_levels < info.mip_levels;
+		if(generate_mips && !backend_device->supports_linear_blit(info.format))
+		{
+			logger::warn(log_gfx_device, "Format {} doesn't support linear blits, mip levels {}-{} of texture \"{}\" will be undefined",
+				to_string(info.format),
+				uploaded_levels,
+				info.mip_levels - 1,
+				in_create_info.debug_name);
+			generate_mips = false;
+		}
+
 		/** Transition our fresh texture to TransferDst */
 		auto list = allocate_cmd_list(QueueType::Gfx);
-		std::array regions =
-		{
-			BufferTextureCopyRegion(0, 
-				TextureSubresourceLayers(format_to_aspect_flags(texture->get_create_info().format),
-				0,
-				0,
-				1),
-				Offset3D(),
-				Extent3D(texture->get_create_info().width, 
-				texture->get_create_info().height,
-				texture->get_create_info().depth))
-		};
 		cmd_texture_barrier(list,
 			handle,
 			PipelineStageFlags(PipelineStageFlagBits::TopOfPipe),
@@ -462,14 +961,88 @@ cb::Result<TextureHandle, Result> Device::create_texture(TextureInfo in_create_i
 			handle,
 			TextureLayout::TransferDst,
 			regions);
-		cmd_texture_barrier(list,
-			handle,
-			PipelineStageFlags(PipelineStageFlagBits::Transfer),
-			TextureLayout::TransferDst,
-			AccessFlags(AccessFlagBits::TransferWrite),
-			PipelineStageFlags(PipelineStageFlagBits::FragmentShader),
-			TextureLayout::ShaderReadOnly,
-			AccessFlags(AccessFlagBits::ShaderRead));
+
+		if(generate_mips)
+		{
+			/** 
+			 * Downsample each level from the previous one, the source level is transitioned to TransferSrc
+			 * right before being read so levels [first_src_level, mip_levels - 1) end up in TransferSrc
+			 */
+			const uint32_t first_src_level = uploaded_levels - 1;
+			for(uint32_t level = uploaded_levels; level < info.mip_levels; ++level)
+			{
+				cmd_texture_barrier(list,
+					handle,
+					level_range(level - 1, 1),
+					PipelineStageFlags(PipelineStageFlagBits::Transfer),
+					TextureLayout::TransferDst,
+					AccessFlags(AccessFlagBits::TransferWrite),
+					PipelineStageFlags(PipelineStageFlagBits::Transfer),
+					TextureLayout::TransferSrc,
+					AccessFlags(AccessFlagBits::TransferRead));
+
+				std::array blits = 
+				{
+					TextureBlitRegion(TextureSubresourceLayers(aspect_flags, level - 1, 0, info.array_layers),
+						{ Offset3D(), Offset3D(get_mip_dimension(info.width, level - 1),
+							get_mip_dimension(info.height, level - 1),
+							get_mip_dimension(info.depth, level - 1)) },
+						TextureSubresourceLayers(aspect_flags, level, 0, info.array_layers),
+						{ Offset3D(), Offset3D(get_mip_dimension(info.width, level),
+							get_mip_dimension(info.height, level),
+							get_mip_dimension(info.depth, level)) })
+				};
+				cmd_blit_texture(list,
+					handle,
+					TextureLayout::TransferSrc,
+					handle,
+					TextureLayout::TransferDst,
+					blits);
+			}
+
+			cmd_texture_barrier(list,
+				handle,
+				level_range(first_src_level, info.mip_levels - 1 - first_src_level),
+				PipelineStageFlags(PipelineStageFlagBits::Transfer),
+				TextureLayout::TransferSrc,
+				AccessFlags(AccessFlagBits::TransferRead),
+				PipelineStageFlags(PipelineStageFlagBits::FragmentShader),
+				TextureLayout::ShaderReadOnly,
+				AccessFlags(AccessFlagBits::ShaderRead));
+
+			if(first_src_level > 0)
+				cmd_texture_barrier(list,
+					handle,
+					level_range(0, first_src_level),
+					PipelineStageFlags(PipelineStageFlagBits::Transfer),
+					TextureLayout::TransferDst,
+					AccessFlags(AccessFlagBits::TransferWrite),
+					PipelineStageFlags(PipelineStageFlagBits::FragmentShader),
+					TextureLayout::ShaderReadOnly,
+					AccessFlags(AccessFlagBits::ShaderRead));
+
+			cmd_texture_barrier(list,
+				handle,
+				level_range(info.mip_levels - 1, 1),
+				PipelineStageFlags(PipelineStageFlagBits::Transfer),
+				TextureLayout::TransferDst,
+				AccessFlags(AccessFlagBits::TransferWrite),
+				PipelineStageFlags(PipelineStageFlagBits::FragmentShader),
+				TextureLayout::ShaderReadOnly,
+				AccessFlags(AccessFlagBits::ShaderRead));
+		}
+		else
+		{
+			cmd_texture_barrier(list,
+				handle,
+				PipelineStageFlags(PipelineStageFlagBits::Transfer),
+				TextureLayout::TransferDst,
+				AccessFlags(AccessFlagBits::TransferWrite),
+				PipelineStageFlags(PipelineStageFlagBits::FragmentShader),
+				TextureLayout::ShaderReadOnly,
+				AccessFlags(AccessFlagBits::ShaderRead));
+		}
+
 		submit(list);
 	}
 
@@ -481,6 +1054,13 @@ cb::Result<TextureViewHandle, Result> Device::create_texture_view(TextureViewInf
 	CB_CHECK(in_create_info.texture);
 
 	auto texture = cast_handle<Texture>(in_create_info.texture);
+	if(in_create_info.bindless && !(texture->get_create_info().usage_flags & TextureUsageFlagBits::Sampled))
+	{
+		logger::error(log_gfx_device, "Texture view \"{}\" is bindless but its texture isn't sampled",
+			in_create_info.debug_name);
+		return make_error(Result::ErrorInvalidParameter);
+	}
+
 	TextureViewCreateInfo create_info(
 		texture->get_resource(),
 		in_create_info.type,
@@ -495,6 +1075,17 @@ cb::Result<TextureViewHandle, Result> Device::create_texture_view(TextureViewInf
 		create_info,
 		result.get_value(), 
 		in_create_info.debug_name);
+
+	if(bindless_enabled && in_create_info.bindless)
+	{
+		/** Depth is sampled in the read-only depth layout, it can stay bound as a read-only attachment meanwhile */
+		const TextureLayout layout = in_create_info.subresource_range.aspect_flags & TextureAspectFlagBits::Depth ?
+			TextureLayout::DepthReadOnly : TextureLayout::ShaderReadOnly;
+		texture_view->set_bindless_index(bindless_texture_views.allocate());
+		if(texture_view->get_bindless_index() != invalid_bindless_index)
+			backend_device->update_bindless_texture_view(texture_view->get_bindless_index(), result.get_value(), layout);
+	}
+
 	return make_result(cast_resource_ptr<TextureViewHandle>(texture_view));
 }
 
@@ -508,6 +1099,32 @@ cb::Result<ShaderHandle, Result> Device::create_shader(const ShaderInfo& in_crea
 	return make_result(cast_resource_ptr<ShaderHandle>(shader));
 }
 
+cb::Result<size_t, Result> Device::reload_shader(const ShaderHandle& in_shader, const ShaderInfo& in_create_info)
+{
+	auto result = backend_device->create_shader(in_create_info.create_info);
+	if(!result)
+		return result.get_error();
+
+	get_current_frame().expired_backend_shaders.emplace_back(
+		cast_handle<Shader>(in_shader)->exchange_resource(result.get_value()));
+
+	size_t invalidated_pipelines = 0;
+	for(auto it = gfx_pipelines.begin(); it != gfx_pipelines.end();)
+	{
+		if(std::ranges::none_of(it->first.stages, [&](const auto& stage) { return stage.shader == in_shader; }))
+		{
+			++it;
+			continue;
+		}
+
+		get_current_frame().expired_backend_pipelines.emplace_back(it->second);
+		it = gfx_pipelines.erase(it);
+		invalidated_pipelines++;
+	}
+
+	return make_result(invalidated_pipelines);
+}
+
 cb::Result<SwapchainHandle, Result> Device::create_swapchain(const SwapChainInfo& in_create_info)
 {
 	auto result = backend_device->create_swap_chain(in_create_info.create_info);
@@ -538,13 +1155,35 @@ cb::Result<SemaphoreHandle, Result> Device::create_semaphore(const SemaphoreInfo
 	return make_result(cast_resource_ptr<SemaphoreHandle>(semaphore));
 }
 
+namespace
+{
+
+uint8_t get_pipeline_layout_sets_mask(const PipelineLayoutCreateInfo& in_create_info)
+{
+	uint8_t mask = static_cast<uint8_t>((1 << in_create_info.set_layouts.size()) - 1);
+	if(in_create_info.bindless)
+		mask |= 1 << bindless_descriptor_set;
+	return mask;
+}
+
+}
+
 cb::Result<PipelineLayoutHandle, Result> Device::create_pipeline_layout(const PipelineLayoutInfo& in_create_info)
 {
+	CB_CHECKF(!in_create_info.create_info.bindless || 
+		(bindless_enabled && in_create_info.create_info.set_layouts.size() <= bindless_descriptor_set),
+		"Bindless pipeline layouts require bindless to be enabled and leave the bindless set free");
+
 	auto result = backend_device->create_pipeline_layout(in_create_info.create_info);
 	if(!result)
 		return result.get_error();
 
-	auto layout = pipeline_layouts.allocate(*this, result.get_value(), in_create_info.debug_name);
+	auto layout = pipeline_layouts.allocate(*this, 
+		result.get_value(), 
+		in_create_info.create_info.bindless, 
+		get_pipeline_layout_sets_mask(in_create_info.create_info),
+		BindingTable(in_create_info.binding_table),
+		in_create_info.debug_name);
 	return make_result(cast_resource_ptr<PipelineLayoutHandle>(layout));
 }
 
@@ -555,6 +1194,14 @@ cb::Result<SamplerHandle, Result> Device::create_sampler(const SamplerInfo& in_c
 		return result.get_error();
 
 	auto sampler = samplers.allocate(*this, result.get_value(), in_create_info.debug_name);
+
+	if(bindless_enabled)
+	{
+		sampler->set_bindless_index(bindless_samplers.allocate());
+		if(sampler->get_bindless_index() != invalid_bindless_index)
+			backend_device->update_bindless_sampler(sampler->get_bindless_index(), result.get_value());
+	}
+
 	return make_result(cast_resource_ptr<SamplerHandle>(sampler));
 }
 
@@ -613,6 +1260,11 @@ void Device::unmap_buffer(const BufferHandle& in_handle)
 	backend_device->unmap_buffer(cast_handle<Buffer>(in_handle)->get_resource());	
 }
 
+void Device::flush_buffer(const BufferHandle& in_handle, const uint64_t in_offset, const uint64_t in_size)
+{
+	backend_device->flush_buffer(cast_handle<Buffer>(in_handle)->get_resource(), in_offset, in_size);
+}
+
 CommandListHandle Device::allocate_cmd_list(const QueueType& in_type)
 {
 	CommandListHandle list;
@@ -628,6 +1280,7 @@ CommandListHandle Device::allocate_cmd_list(const QueueType& in_type)
 	}
 
 	CB_CHECK(list);
+	cast_handle<CommandList>(list)->begin();
 	backend_device->begin_cmd_list(cast_handle<CommandList>(list)->get_resource());
 	return list;
 }
@@ -654,15 +1307,114 @@ void Device::reset_fences(const std::span<FenceHandle>& in_fences)
 
 /** Commands */
 
-void Device::cmd_begin_render_pass(const CommandListHandle& in_cmd_list,
-	const RenderPassInfo& in_info)
+namespace
 {
-	CB_CHECK(in_info.render_area.width > 0 && in_info.render_area.height > 0);
 
-	std::vector<AttachmentDescription> attachment_descriptions;
-	std::vector<BackendDeviceResource> attachments;
-	attachments.reserve(in_info.color_attachments.size() + 1);
-	attachment_descriptions.reserve(in_info.color_attachments.size() + 1);
+/**
+ * Layout an attachment is in when a pass begins
+ * Loaded attachments are expected in the final layout a previous pass left them in, others are discarded
+ */
+TextureLayout get_attachment_initial_layout(TextureView& in_view, const AttachmentOps& in_ops)
+{
+	if(!in_ops.is_loaded())
+		return TextureLayout::Undefined;
+
+	if(in_view.get_texture().is_texture_from_swapchain())
+		return TextureLayout::Present;
+
+	return format_to_aspect_flags(in_view.get_create_info().format) & TextureAspectFlagBits::Color
+		? TextureLayout::ColorAttachment : TextureLayout::DepthStencilAttachment;
+}
+
+void check_attachment_ops(TextureView& in_view, const AttachmentOps& in_ops)
+{
+	(void)(in_view);
+	(void)(in_ops);
+	CB_CHECKF(!(in_view.get_texture().get_create_info().usage_flags & TextureUsageFlagBits::TransientAttachment) ||
+		(!in_ops.is_loaded() && !in_ops.is_stored()),
+		"Transient attachments have no memory outside of a pass, they can't be loaded or stored");
+}
+
+/**
+ * Depth-stencil input attachments are read in a depth read-only layout so depth testing can stay enabled
+ */
+TextureLayout get_input_attachment_layout(const Format in_format)
+{
+	return format_to_aspect_flags(in_format) & TextureAspectFlagBits::Color 
+		? TextureLayout::ShaderReadOnly : TextureLayout::DepthReadOnly;
+}
+
+/**
+ * Find a named binding in the pipeline layout bound to a command list
+ */
+const BindingSlot* resolve_binding(const CommandList& in_list, const BindingName& in_name, const DescriptorType in_type)
+{
+	CB_CHECKF(in_list.get_pipeline_layout(), "No pipeline layout was bound!");
+
+	const BindingSlot* slot = Device::cast_handle<PipelineLayout>(in_list.get_pipeline_layout())->find_binding(in_name);
+	if(!slot)
+	{
+		logger::error(log_gfx_device, "Binding \"{}\" not found in the bound pipeline layout, not bound", in_name.name);
+		return nullptr;
+	}
+
+	if(slot->type != in_type)
+	{
+		logger::error(log_gfx_device, "Binding \"{}\" is bound with a different descriptor type than the shader expects, "
+			"not bound", in_name.name);
+		return nullptr;
+	}
+
+	return slot;
+}
+
+/**
+ * All attachments of a pass share the same sample count, pipelines used inside the pass are created with it
+ */
+SampleCountFlagBits get_pass_sample_count(const RenderPassInfo& in_info)
+{
+	std::optional<SampleCountFlagBits> sample_count;
+	const auto add_attachment = [&](const TextureViewHandle& in_view)
+	{
+		const SampleCountFlagBits count = Device::cast_handle<TextureView>(in_view)->get_texture().get_create_info().sample_count;
+		CB_CHECKF(!sample_count || *sample_count == count, "Attachments of a pass must have the same sample count");
+		sample_count = count;
+	};
+
+	for(const auto& attachment : in_info.color_attachments)
+		add_attachment(attachment);
+
+	if(in_info.depth_stencil_attachment)
+		add_attachment(in_info.depth_stencil_attachment);
+
+	return sample_count.value_or(SampleCountFlagBits::Count1);
+}
+
+}
+
+void Device::cmd_begin_render_pass(const CommandListHandle& in_cmd_list,
+	const RenderPassInfo& in_info)
+{
+	CB_CHECK(in_info.render_area.width > 0 && in_info.render_area.height > 0);
+	CB_CHECK(in_info.color_attachment_ops.size() == in_info.color_attachments.size());
+	CB_CHECK(in_info.resolve_attachments.empty() || in_info.resolve_attachments.size() == in_info.color_attachments.size());
+
+	auto list = cast_handle<CommandList>(in_cmd_list);
+	list->set_sample_count(get_pass_sample_count(in_info));
+
+	/** Input attachments aren't expressed without render passes yet */
+	if(dynamic_rendering_enabled && 
+		in_info.subpasses.size() == 1 &&
+		in_info.subpasses[0].input_attachments.empty())
+	{
+		begin_rendering(*list, in_info);
+		return;
+	}
+
+	std::vector<AttachmentDescription> attachment_descriptions;
+	std::vector<BackendDeviceResource> attachments;
+	attachments.reserve(in_info.color_attachments.size() + in_info.resolve_attachments.size() + 1);
+	attachment_descriptions.reserve(in_info.color_attachments.size() + in_info.resolve_attachments.size() + 1);
 
 	Framebuffer framebuffer;
 	framebuffer.width = in_info.render_area.width;
@@ -672,25 +1424,18 @@ void Device::cmd_begin_render_pass(const CommandListHandle& in_cmd_list,
 	for(size_t i = 0; i < in_info.color_attachments.size(); ++i)
 	{
 		auto view = cast_handle<TextureView>(in_info.color_attachments[i]);
+		const AttachmentOps& ops = in_info.color_attachment_ops[i];
+		check_attachment_ops(*view, ops);
 		
 		AttachmentDescription desc(view->get_create_info().format,
 			view->get_texture().get_create_info().sample_count,
+			ops.load_op,
+			ops.store_op,
 			AttachmentLoadOp::DontCare,
 			AttachmentStoreOp::DontCare,
-			AttachmentLoadOp::DontCare,
-			AttachmentStoreOp::DontCare,
-			TextureLayout::Undefined,
+			get_attachment_initial_layout(*view, ops),
 			TextureLayout::ColorAttachment);
 
-		if(in_info.clear_attachment_flags & (1 << i))
-			desc.load_op = AttachmentLoadOp::Clear;
-		
-		if(in_info.load_attachment_flags & (1 << i))
-			desc.load_op = AttachmentLoadOp::Load;
-
-		if(in_info.store_attachment_flags & (1 << i))
-			desc.store_op = AttachmentStoreOp::Store;
-
 		if(view->get_texture().is_texture_from_swapchain())
 			desc.final_layout = TextureLayout::Present;
 
@@ -698,54 +1443,97 @@ void Device::cmd_begin_render_pass(const CommandListHandle& in_cmd_list,
 		attachment_descriptions.push_back(desc);
 	}
 
+	const uint32_t depth_stencil_index = static_cast<uint32_t>(attachment_descriptions.size());
 	if(in_info.depth_stencil_attachment)
 	{
 		auto view = cast_handle<TextureView>(in_info.depth_stencil_attachment);
+		const AttachmentOps& ops = in_info.depth_stencil_attachment_ops;
+		check_attachment_ops(*view, ops);
+
 		attachments.emplace_back(view->get_resource());
 		attachment_descriptions.emplace_back(view->get_create_info().format,
 			view->get_texture().get_create_info().sample_count,
-			AttachmentLoadOp::Clear,
+			ops.load_op,
+			ops.store_op,
+			ops.stencil_load_op,
+			ops.stencil_store_op,
+			get_attachment_initial_layout(*view, ops),
+			TextureLayout::DepthStencilAttachment);
+	}
+
+	/** Resolve attachments come last, their previous content is always discarded */
+	std::vector<uint32_t> resolve_indices(in_info.resolve_attachments.size(), AttachmentReference::unused_attachment);
+	for(size_t i = 0; i < in_info.resolve_attachments.size(); ++i)
+	{
+		if(!in_info.resolve_attachments[i])
+			continue;
+
+		auto view = cast_handle<TextureView>(in_info.resolve_attachments[i]);
+		CB_CHECKF(view->get_texture().get_create_info().sample_count == SampleCountFlagBits::Count1,
+			"Resolve attachments must be single-sampled");
+
+		resolve_indices[i] = static_cast<uint32_t>(attachment_descriptions.size());
+		attachments.push_back(view->get_resource());
+		attachment_descriptions.emplace_back(view->get_create_info().format,
+			SampleCountFlagBits::Count1,
+			AttachmentLoadOp::DontCare,
 			AttachmentStoreOp::Store,
 			AttachmentLoadOp::DontCare,
 			AttachmentStoreOp::DontCare,
 			TextureLayout::Undefined,
-			TextureLayout::DepthStencilAttachment);
+			view->get_texture().is_texture_from_swapchain() ? TextureLayout::Present : TextureLayout::ColorAttachment);
+	}
+
+	/** A color attachment is resolved by the last subpass writing it */
+	std::vector<size_t> resolving_subpasses(resolve_indices.size());
+	for(size_t i = 0; i < in_info.subpasses.size(); ++i)
+	{
+		for(const auto& index : in_info.subpasses[i].color_attachments)
+			if(index < resolving_subpasses.size())
+				resolving_subpasses[index] = i;
 	}
 
 	std::vector<SubpassDescription> subpasses;
 	subpasses.reserve(in_info.subpasses.size());
-	for(const auto& subpass : in_info.subpasses)
+	for(size_t subpass_index = 0; subpass_index < in_info.subpasses.size(); ++subpass_index)
 	{
-		auto process_attachments = [&](const std::span<uint32_t>& in_indices, 
-			const TextureLayout in_layout) -> std::vector<AttachmentReference>
-		{
-			std::vector<AttachmentReference> refs;
-			refs.reserve(in_indices.size());
-
-			for(const auto& index : in_indices)
-			{
-				refs.emplace_back(AttachmentReference(index,
-					in_layout));
-			}
-
-			return refs;
-		};
+		const auto& subpass = in_info.subpasses[subpass_index];
 
-		std::vector<AttachmentReference> input_attachments = process_attachments(subpass.input_attachments, 
-			TextureLayout::ShaderReadOnly);
+		std::vector<AttachmentReference> input_attachments;
+		input_attachments.reserve(subpass.input_attachments.size());
+		for(const auto& index : subpass.input_attachments)
+		{
+			CB_CHECKF(index < depth_stencil_index || 
+				(index == depth_stencil_index && in_info.depth_stencil_attachment), "Invalid input attachment index");
+			CB_CHECKF(index != depth_stencil_index || subpass.mode == RenderPassInfo::DepthStencilMode::ReadOnly,
+				"The depth-stencil attachment must be read-only in subpasses reading it as an input attachment");
+			input_attachments.emplace_back(index, 
+				index == depth_stencil_index ? TextureLayout::DepthReadOnly : TextureLayout::ShaderReadOnly);
+		}
 
-		std::vector<AttachmentReference> color_attachments = process_attachments(subpass.color_attachments,
-			TextureLayout::ColorAttachment);
+		std::vector<AttachmentReference> color_attachments;
+		color_attachments.reserve(subpass.color_attachments.size());
+		for(const auto& index : subpass.color_attachments)
+			color_attachments.emplace_back(index, TextureLayout::ColorAttachment);
 
-		std::vector<AttachmentReference> resolve_attachments = process_attachments(subpass.resolve_attachments,
-			TextureLayout::ColorAttachment);
+		std::vector<AttachmentReference> resolve_attachments;
+		for(size_t i = 0; i < subpass.color_attachments.size(); ++i)
+		{
+			const uint32_t index = subpass.color_attachments[i];
+			if(index >= resolve_indices.size() || 
+				resolve_indices[index] == AttachmentReference::unused_attachment ||
+				resolving_subpasses[index] != subpass_index)
+				continue;
+
+			/** Color attachments that aren't resolved still need an unused entry */
+			resolve_attachments.resize(subpass.color_attachments.size());
+			resolve_attachments[i] = AttachmentReference(resolve_indices[index], TextureLayout::ColorAttachment);
+		}
 
 		AttachmentReference depth_stencil_attachment;
-
-		/** Depth/stencil attachment always at the end ! */
 		if(in_info.depth_stencil_attachment)
 		{
-			depth_stencil_attachment = AttachmentReference(static_cast<uint32_t>(attachment_descriptions.size()) - 1,
+			depth_stencil_attachment = AttachmentReference(depth_stencil_index,
 				subpass.mode == RenderPassInfo::DepthStencilMode::ReadWrite 
 					? TextureLayout::DepthStencilAttachment : TextureLayout::DepthReadOnly);
 		}
@@ -756,10 +1544,126 @@ void Device::cmd_begin_render_pass(const CommandListHandle& in_cmd_list,
 			depth_stencil_attachment,
 			{}));
 	}
-	
-	auto render_pass = get_or_create_render_pass(RenderPassCreateInfo(attachment_descriptions, subpasses));
-	auto list = cast_handle<CommandList>(in_cmd_list);
 
+	/**
+	 * Without dependencies subpasses may overlap: each subpass waits for the previous ones writing an attachment
+	 * it reads as an input attachment, writes again or depth tests against
+	 */
+	std::vector<SubpassDependency> dependencies;
+	for(uint32_t dst = 1; dst < in_info.subpasses.size(); ++dst)
+	{
+		const auto& dst_subpass = in_info.subpasses[dst];
+		const auto reads = [&](const uint32_t in_index)
+		{
+			return std::ranges::find(dst_subpass.input_attachments, in_index) != dst_subpass.input_attachments.end();
+		};
+
+		for(uint32_t src = 0; src < dst; ++src)
+		{
+			const auto& src_subpass = in_info.subpasses[src];
+			SubpassDependency dependency(src, dst);
+			const auto add = [&](const PipelineStageFlags& in_src_stages, const AccessFlags& in_src_access,
+				const PipelineStageFlags& in_dst_stages, const AccessFlags& in_dst_access)
+			{
+				dependency.src_stage_mask |= in_src_stages;
+				dependency.src_access_mask |= in_src_access;
+				dependency.dst_stage_mask |= in_dst_stages;
+				dependency.dst_access_mask |= in_dst_access;
+			};
+
+			for(const auto& index : src_subpass.color_attachments)
+			{
+				if(reads(index))
+					add(PipelineStageFlags(PipelineStageFlagBits::ColorAttachmentOutput),
+						AccessFlags(AccessFlagBits::ColorAttachmentWrite),
+						PipelineStageFlags(PipelineStageFlagBits::FragmentShader),
+						AccessFlags(AccessFlagBits::InputAttachmentRead));
+
+				if(std::ranges::find(dst_subpass.color_attachments, index) != dst_subpass.color_attachments.end())
+					add(PipelineStageFlags(PipelineStageFlagBits::ColorAttachmentOutput),
+						AccessFlags(AccessFlagBits::ColorAttachmentWrite),
+						PipelineStageFlags(PipelineStageFlagBits::ColorAttachmentOutput),
+						AccessFlags(AccessFlagBits::ColorAttachmentRead | AccessFlagBits::ColorAttachmentWrite));
+			}
+
+			if(in_info.depth_stencil_attachment && src_subpass.mode == RenderPassInfo::DepthStencilMode::ReadWrite)
+			{
+				if(reads(depth_stencil_index))
+					add(PipelineStageFlags(PipelineStageFlagBits::LateFragmentTests),
+						AccessFlags(AccessFlagBits::DepthStencilAttachmentWrite),
+						PipelineStageFlags(PipelineStageFlagBits::FragmentShader),
+						AccessFlags(AccessFlagBits::InputAttachmentRead));
+
+				add(PipelineStageFlags(PipelineStageFlagBits::LateFragmentTests),
+					AccessFlags(AccessFlagBits::DepthStencilAttachmentWrite),
+					PipelineStageFlags(PipelineStageFlagBits::EarlyFragmentTests | PipelineStageFlagBits::LateFragmentTests),
+					dst_subpass.mode == RenderPassInfo::DepthStencilMode::ReadWrite
+						? AccessFlags(AccessFlagBits::DepthStencilAttachmentRead | AccessFlagBits::DepthStencilAttachmentWrite)
+						: AccessFlags(AccessFlagBits::DepthStencilAttachmentRead));
+			}
+
+			if(dependency.src_stage_mask != PipelineStageFlags())
+				dependencies.push_back(dependency);
+		}
+	}
+
+	/** Loads/clears and writes of the first subpass wait for the attachment writes recorded before the pass */
+	{
+		SubpassDependency dependency(SubpassDependency::external_subpass, 0);
+		if(!in_info.color_attachments.empty())
+		{
+			dependency.src_stage_mask |= PipelineStageFlags(PipelineStageFlagBits::ColorAttachmentOutput);
+			dependency.src_access_mask |= AccessFlags(AccessFlagBits::ColorAttachmentWrite);
+			dependency.dst_stage_mask |= PipelineStageFlags(PipelineStageFlagBits::ColorAttachmentOutput);
+			dependency.dst_access_mask |= AccessFlags(AccessFlagBits::ColorAttachmentRead | AccessFlagBits::ColorAttachmentWrite);
+		}
+
+		if(in_info.depth_stencil_attachment)
+		{
+			dependency.src_stage_mask |= PipelineStageFlags(PipelineStageFlagBits::LateFragmentTests);
+			dependency.src_access_mask |= AccessFlags(AccessFlagBits::DepthStencilAttachmentWrite);
+			dependency.dst_stage_mask |= PipelineStageFlags(PipelineStageFlagBits::EarlyFragmentTests | PipelineStageFlagBits::LateFragmentTests);
+			dependency.dst_access_mask |= AccessFlags(AccessFlagBits::DepthStencilAttachmentRead | AccessFlagBits::DepthStencilAttachmentWrite);
+		}
+
+		if(dependency.src_stage_mask != PipelineStageFlags())
+			dependencies.push_back(dependency);
+	}
+
+	/** Attachments left in a shader-read layout are sampled by fragment shaders once the last subpass wrote them */
+	if(!in_info.subpasses.empty())
+	{
+		SubpassDependency dependency(static_cast<uint32_t>(in_info.subpasses.size() - 1), 
+			SubpassDependency::external_subpass);
+		for(uint32_t i = 0; i < attachment_descriptions.size(); ++i)
+		{
+			const TextureLayout final_layout = attachment_descriptions[i].final_layout;
+			if(final_layout != TextureLayout::ShaderReadOnly && final_layout != TextureLayout::DepthReadOnly)
+				continue;
+
+			if(in_info.depth_stencil_attachment && i == depth_stencil_index)
+			{
+				dependency.src_stage_mask |= PipelineStageFlags(PipelineStageFlagBits::LateFragmentTests);
+				dependency.src_access_mask |= AccessFlags(AccessFlagBits::DepthStencilAttachmentWrite);
+			}
+			else
+			{
+				dependency.src_stage_mask |= PipelineStageFlags(PipelineStageFlagBits::ColorAttachmentOutput);
+				dependency.src_access_mask |= AccessFlags(AccessFlagBits::ColorAttachmentWrite);
+			}
+		}
+
+		if(dependency.src_stage_mask != PipelineStageFlags())
+		{
+			dependency.dst_stage_mask = PipelineStageFlags(PipelineStageFlagBits::FragmentShader);
+			dependency.dst_access_mask = AccessFlags(AccessFlagBits::ShaderRead);
+			dependencies.push_back(dependency);
+		}
+	}
+	
+	auto render_pass = get_or_create_render_pass(RenderPassCreateInfo(attachment_descriptions, 
+		subpasses, 
+		dependencies));
 	list->set_render_pass(render_pass);
 
 	framebuffer.attachments = attachments;
@@ -771,11 +1675,132 @@ void Device::cmd_begin_render_pass(const CommandListHandle& in_cmd_list,
 		in_info.render_area,
 		in_info.clear_values);
 
-	std::array viewports = { Viewport(0, 0, 
-		static_cast<float>(framebuffer.width), static_cast<float>(framebuffer.height), 0.f, 1.f )};
-	std::array scissors = { Rect2D(0, 0, framebuffer.width, framebuffer.height )};
-	backend_device->cmd_set_viewports(list->get_resource(), 0, viewports);
-	backend_device->cmd_set_scissors(list->get_resource(), 0, scissors);
+	list->set_viewport(Viewport(0, 0, 
+		static_cast<float>(framebuffer.width), static_cast<float>(framebuffer.height), 0.f, 1.f ));
+	list->set_scissor(Rect2D(0, 0, framebuffer.width, framebuffer.height ));
+}
+
+/**
+ * Render passes transition attachments through their initial/final layouts, dynamic rendering needs explicit barriers:
+ * attachments are transitioned the same way before the pass, and swapchain textures to Present after it
+ */
+void Device::begin_rendering(CommandList& in_list, const RenderPassInfo& in_info)
+{
+	const RenderPassInfo::Subpass& subpass = in_info.subpasses[0];
+	CB_CHECK(subpass.color_attachments.size() <= max_attachments_per_framebuffer)
+
+	PipelineRenderingFormats formats;
+	std::array<RenderingAttachmentInfo, max_attachments_per_framebuffer> color_attachments;
+	auto& begin_barriers = in_list.get_begin_rendering_barriers();
+	auto& end_barriers = in_list.get_end_rendering_barriers();
+	begin_barriers.clear();
+	end_barriers.clear();
+
+	for(size_t i = 0; i < subpass.color_attachments.size(); ++i)
+	{
+		const uint32_t index = subpass.color_attachments[i];
+		auto view = cast_handle<TextureView>(in_info.color_attachments[index]);
+		const AttachmentOps& ops = in_info.color_attachment_ops[index];
+		const bool swapchain = view->get_texture().is_texture_from_swapchain();
+		check_attachment_ops(*view, ops);
+
+		RenderingAttachmentInfo& attachment = color_attachments[i];
+		attachment.texture_view = view->get_resource();
+		attachment.layout = TextureLayout::ColorAttachment;
+		attachment.load_op = ops.load_op;
+		attachment.store_op = ops.store_op;
+		if(ops.load_op == AttachmentLoadOp::Clear)
+			attachment.clear_value = in_info.clear_values[index];
+
+		begin_barriers.emplace_back(view->get_texture().get_resource(),
+			AccessFlags(AccessFlagBits::ColorAttachmentWrite),
+			AccessFlags(AccessFlagBits::ColorAttachmentRead | AccessFlagBits::ColorAttachmentWrite),
+			get_attachment_initial_layout(*view, ops),
+			TextureLayout::ColorAttachment,
+			view->get_create_info().subresource_range);
+
+		if(swapchain)
+			end_barriers.emplace_back(view->get_texture().get_resource(),
+				AccessFlags(AccessFlagBits::ColorAttachmentWrite),
+				AccessFlags(),
+				TextureLayout::ColorAttachment,
+				TextureLayout::Present,
+				view->get_create_info().subresource_range);
+
+		if(!in_info.resolve_attachments.empty() && in_info.resolve_attachments[index])
+		{
+			auto resolve_view = cast_handle<TextureView>(in_info.resolve_attachments[index]);
+			CB_CHECKF(resolve_view->get_texture().get_create_info().sample_count == SampleCountFlagBits::Count1,
+				"Resolve attachments must be single-sampled");
+
+			attachment.resolve_texture_view = resolve_view->get_resource();
+			attachment.resolve_layout = TextureLayout::ColorAttachment;
+
+			begin_barriers.emplace_back(resolve_view->get_texture().get_resource(),
+				AccessFlags(AccessFlagBits::ColorAttachmentWrite),
+				AccessFlags(AccessFlagBits::ColorAttachmentWrite),
+				TextureLayout::Undefined,
+				TextureLayout::ColorAttachment,
+				resolve_view->get_create_info().subresource_range);
+
+			if(resolve_view->get_texture().is_texture_from_swapchain())
+				end_barriers.emplace_back(resolve_view->get_texture().get_resource(),
+					AccessFlags(AccessFlagBits::ColorAttachmentWrite),
+					AccessFlags(),
+					TextureLayout::ColorAttachment,
+					TextureLayout::Present,
+					resolve_view->get_create_info().subresource_range);
+		}
+
+		formats.color_formats[i] = view->get_create_info().format;
+	}
+	formats.color_format_count = static_cast<uint32_t>(subpass.color_attachments.size());
+
+	RenderingInfo info;
+	info.render_area = in_info.render_area;
+	info.color_attachments = { color_attachments.data(), subpass.color_attachments.size() };
+
+	if(in_info.depth_stencil_attachment)
+	{
+		auto view = cast_handle<TextureView>(in_info.depth_stencil_attachment);
+		const AttachmentOps& ops = in_info.depth_stencil_attachment_ops;
+		const TextureLayout layout = subpass.mode == RenderPassInfo::DepthStencilMode::ReadWrite 
+			? TextureLayout::DepthStencilAttachment : TextureLayout::DepthReadOnly;
+		check_attachment_ops(*view, ops);
+
+		info.depth_attachment = RenderingAttachmentInfo(view->get_resource(), layout, ops.load_op, ops.store_op);
+		if(ops.load_op == AttachmentLoadOp::Clear || ops.stencil_load_op == AttachmentLoadOp::Clear)
+			info.depth_attachment.clear_value = in_info.clear_values[in_info.color_attachments.size()];
+
+		if(format_to_aspect_flags(view->get_create_info().format) & TextureAspectFlagBits::Stencil)
+		{
+			info.stencil_attachment = info.depth_attachment;
+			info.stencil_attachment.load_op = ops.stencil_load_op;
+			info.stencil_attachment.store_op = ops.stencil_store_op;
+		}
+
+		begin_barriers.emplace_back(view->get_texture().get_resource(),
+			AccessFlags(AccessFlagBits::DepthStencilAttachmentWrite),
+			AccessFlags(AccessFlagBits::DepthStencilAttachmentRead | AccessFlagBits::DepthStencilAttachmentWrite),
+			get_attachment_initial_layout(*view, ops),
+			info.depth_attachment.layout,
+			view->get_create_info().subresource_range);
+
+		formats.depth_stencil_format = view->get_create_info().format;
+	}
+
+	backend_device->cmd_pipeline_barrier(in_list.get_resource(),
+		PipelineStageFlags(PipelineStageFlagBits::ColorAttachmentOutput | PipelineStageFlagBits::LateFragmentTests),
+		PipelineStageFlags(PipelineStageFlagBits::ColorAttachmentOutput) | 
+			(PipelineStageFlagBits::EarlyFragmentTests | PipelineStageFlagBits::LateFragmentTests),
+		begin_barriers);
+
+	in_list.set_rendering_formats(formats);
+	backend_device->cmd_begin_rendering(in_list.get_resource(), info);
+
+	in_list.set_viewport(Viewport(0, 0, 
+		static_cast<float>(in_info.render_area.width), static_cast<float>(in_info.render_area.height), 0.f, 1.f ));
+	in_list.set_scissor(Rect2D(0, 0, in_info.render_area.width, in_info.render_area.height ));
 }
 
 void Device::cmd_draw(const CommandListHandle& in_cmd_list,
@@ -829,8 +1854,7 @@ void Device::cmd_set_material_state(const CommandListHandle& in_cmd_list,
 void Device::cmd_set_scissor(const CommandListHandle& in_cmd_list, const Rect2D& in_scissor)
 {
 	auto list = cast_handle<CommandList>(in_cmd_list);
-	std::array scissors = { in_scissor };
-	backend_device->cmd_set_scissors(list->get_resource(), 0, scissors);
+	list->set_scissor(in_scissor);
 }
 
 void Device::cmd_bind_pipeline_layout(const CommandListHandle& in_cmd_list, 
@@ -862,6 +1886,48 @@ void Device::cmd_bind_texture_view(const CommandListHandle& in_cmd_list,
 		in_handle ? cast_handle<TextureView>(in_handle)->get_resource() : null_backend_resource) : Descriptor());
 }
 
+void Device::cmd_bind_input_attachment(const CommandListHandle& in_cmd_list, 
+	const uint32_t in_set, 
+	const uint32_t in_binding, 
+	const TextureViewHandle& in_handle)
+{
+	CB_CHECK(in_handle);
+
+	auto list = cast_handle<CommandList>(in_cmd_list);
+	auto view = cast_handle<TextureView>(in_handle);
+	list->set_descriptor(in_set, in_binding, Descriptor::make_input_attachment_info(in_binding,
+		view->get_resource(),
+		get_input_attachment_layout(view->get_create_info().format)));
+}
+
+void Device::cmd_bind_ubo(const CommandListHandle& in_cmd_list, const BindingName& in_name, const BufferHandle& in_handle)
+{
+	if(const BindingSlot* slot = resolve_binding(*cast_handle<CommandList>(in_cmd_list), in_name, DescriptorType::UniformBuffer))
+		cmd_bind_ubo(in_cmd_list, slot->set, slot->binding, in_handle);
+}
+
+void Device::cmd_bind_texture_view(const CommandListHandle& in_cmd_list, 
+	const BindingName& in_name, 
+	const TextureViewHandle& in_handle)
+{
+	if(const BindingSlot* slot = resolve_binding(*cast_handle<CommandList>(in_cmd_list), in_name, DescriptorType::SampledTexture))
+		cmd_bind_texture_view(in_cmd_list, slot->set, slot->binding, in_handle);
+}
+
+void Device::cmd_bind_input_attachment(const CommandListHandle& in_cmd_list, 
+	const BindingName& in_name, 
+	const TextureViewHandle& in_handle)
+{
+	if(const BindingSlot* slot = resolve_binding(*cast_handle<CommandList>(in_cmd_list), in_name, DescriptorType::InputAttachment))
+		cmd_bind_input_attachment(in_cmd_list, slot->set, slot->binding, in_handle);
+}
+
+void Device::cmd_bind_sampler(const CommandListHandle& in_cmd_list, const BindingName& in_name, const SamplerHandle& in_handle)
+{
+	if(const BindingSlot* slot = resolve_binding(*cast_handle<CommandList>(in_cmd_list), in_name, DescriptorType::Sampler))
+		cmd_bind_sampler(in_cmd_list, slot->set, slot->binding, in_handle);
+}
+
 void Device::cmd_bind_sampler(const CommandListHandle& in_cmd_list, 
 	const uint32_t in_set, 
 	const uint32_t in_binding, 
@@ -874,28 +1940,74 @@ void Device::cmd_bind_sampler(const CommandListHandle& in_cmd_list,
 		in_handle ? cast_handle<Sampler>(in_handle)->get_resource() : null_backend_resource) : Descriptor());
 }
 
+void Device::cmd_push_constants(const CommandListHandle& in_cmd_list, 
+	const ShaderStageFlags in_stages, 
+	const uint32_t in_offset,
+	const std::span<const uint8_t>& in_data)
+{
+	cast_handle<CommandList>(in_cmd_list)->push_constants(in_stages, in_offset, in_data);
+}
+
+void Device::cmd_next_subpass(const CommandListHandle& in_cmd_list)
+{
+	auto list = cast_handle<CommandList>(in_cmd_list);
+	list->next_subpass();
+	backend_device->cmd_next_subpass(list->get_resource());
+}
+
 void Device::cmd_end_render_pass(const CommandListHandle& in_cmd_list)
 {
-	backend_device->cmd_end_render_pass(cast_handle<CommandList>(in_cmd_list)->get_resource());
+	auto list = cast_handle<CommandList>(in_cmd_list);
+	if(!list->is_dynamic_rendering())
+	{
+		backend_device->cmd_end_render_pass(list->get_resource());
+		return;
+	}
+
+	backend_device->cmd_end_rendering(list->get_resource());
+
+	auto& barriers = list->get_end_rendering_barriers();
+	if(!barriers.empty())
+	{
+		backend_device->cmd_pipeline_barrier(list->get_resource(),
+			PipelineStageFlags(PipelineStageFlagBits::ColorAttachmentOutput),
+			PipelineStageFlags(PipelineStageFlagBits::BottomOfPipe),
+			barriers);
+		barriers.clear();
+	}
 }
 
 void Device::cmd_bind_vertex_buffer(const CommandListHandle& in_cmd_list, const BufferHandle& in_buffer, const uint64_t in_offset)
 {
 	std::array vertex_buffers = { cast_handle<Buffer>(in_buffer)->get_resource() };
 	std::array offsets = { in_offset };
-	backend_device->cmd_bind_vertex_buffers(cast_handle<CommandList>(in_cmd_list)->get_resource(),
-		0,
+	cast_handle<CommandList>(in_cmd_list)->bind_vertex_buffers(0,
 		vertex_buffers,
 		offsets);	
 }
 
+void Device::cmd_bind_vertex_buffers(const CommandListHandle& in_cmd_list, 
+	const uint32_t in_first_binding,
+	const std::span<const BufferHandle>& in_buffers,
+	const std::span<const uint64_t>& in_offsets)
+{
+	CB_CHECK(in_buffers.size() == in_offsets.size() && in_buffers.size() <= max_vertex_input_bindings)
+
+	std::array<BackendDeviceResource, max_vertex_input_bindings> vertex_buffers;
+	for(size_t i = 0; i < in_buffers.size(); ++i)
+		vertex_buffers[i] = cast_handle<Buffer>(in_buffers[i])->get_resource();
+
+	cast_handle<CommandList>(in_cmd_list)->bind_vertex_buffers(in_first_binding,
+		{ vertex_buffers.data(), in_buffers.size() },
+		in_offsets);	
+}
+
 void Device::cmd_bind_index_buffer(const CommandListHandle& in_cmd_list, 
 	const BufferHandle& in_buffer, 
 	const uint64_t in_offset, 
 	const IndexType in_index_type)
 {
-	backend_device->cmd_bind_index_buffer(cast_handle<CommandList>(in_cmd_list)->get_resource(),
-		cast_handle<Buffer>(in_buffer)->get_resource(),
+	cast_handle<CommandList>(in_cmd_list)->bind_index_buffer(cast_handle<Buffer>(in_buffer)->get_resource(),
 		in_offset,
 		in_index_type);
 }
@@ -940,6 +2052,122 @@ void Device::cmd_copy_buffer_to_texture(const CommandListHandle& in_cmd_list,
 		in_regions);
 }
 
+void Device::cmd_copy_texture_to_buffer(const CommandListHandle& in_cmd_list, 
+	const TextureHandle& in_src_texture,
+	const TextureLayout in_src_layout,
+	const BufferHandle& in_dst_buffer, 
+	const std::span<BufferTextureCopyRegion>& in_regions)
+{
+	CB_CHECK(!in_regions.empty());
+	CB_CHECK(in_src_texture);
+	CB_CHECK(in_dst_buffer);
+
+	auto list = cast_handle<CommandList>(in_cmd_list);
+	auto src = cast_handle<Texture>(in_src_texture);
+	auto dst = cast_handle<Buffer>(in_dst_buffer);
+
+	backend_device->cmd_copy_texture_to_buffer(list->get_resource(),
+		src->get_resource(),
+		in_src_layout,
+		dst->get_resource(),
+		in_regions);
+}
+
+ReadbackRequest Device::cmd_readback_texture(const CommandListHandle& in_cmd_list,
+	const TextureHandle& in_texture,
+	const TextureLayout in_src_layout,
+	const TextureAspectFlagBits in_aspect,
+	ReadbackCallback in_callback,
+	const Rect2D& in_area)
+{
+	CB_CHECK(in_texture);
+
+	const TextureCreateInfo& info = get_texture_create_info(in_texture);
+	const Rect2D area = in_area.width > 0 && in_area.height > 0 ? in_area : Rect2D(0, 0, info.width, info.height);
+	CB_CHECK(area.x >= 0 && area.y >= 0 && 
+		static_cast<uint32_t>(area.x) + area.width <= info.width && 
+		static_cast<uint32_t>(area.y) + area.height <= info.height);
+
+	const uint32_t texel_size = get_format_aspect_texel_size(info.format, in_aspect);
+	if(texel_size == 0)
+	{
+		logger::error(log_gfx_device, "Can't read back {} textures, the aspect is missing or its texel size is unknown", 
+			to_string(info.format));
+		return {};
+	}
+
+	const uint64_t size = static_cast<uint64_t>(area.width) * area.height * texel_size;
+	BufferHandle buffer = acquire_readback_buffer(size);
+	if(!buffer)
+		return {};
+
+	std::array regions = { BufferTextureCopyRegion(0,
+		TextureSubresourceLayers(TextureAspectFlags(in_aspect), 0, 0, 1),
+		Offset3D(area.x, area.y),
+		Extent3D(area.width, area.height, 1)) };
+	cmd_copy_texture_to_buffer(in_cmd_list, in_texture, in_src_layout, buffer, regions);
+
+	return add_readback(buffer, size, std::move(in_callback));
+}
+
+ReadbackRequest Device::cmd_readback_buffer(const CommandListHandle& in_cmd_list,
+	const BufferHandle& in_buffer,
+	const uint64_t in_offset,
+	const uint64_t in_size,
+	ReadbackCallback in_callback)
+{
+	CB_CHECK(in_buffer);
+	CB_CHECK(in_size > 0);
+
+	BufferHandle buffer = acquire_readback_buffer(in_size);
+	if(!buffer)
+		return {};
+
+	std::array regions = { BufferCopyRegion(in_offset, 0, in_size) };
+	cmd_copy_buffer(in_cmd_list, in_buffer, buffer, regions);
+	backend_device->cmd_host_read_barrier(cast_handle<CommandList>(in_cmd_list)->get_resource());
+
+	return add_readback(buffer, in_size, std::move(in_callback));
+}
+
+BufferHandle Device::acquire_readback_buffer(const uint64_t in_size)
+{
+	{
+		std::lock_guard lock(readback_mutex);
+		if(auto it = std::ranges::find_if(readback_buffers, [&](const ReadbackBuffer& in_buffer) { return in_buffer.size == in_size; });
+			it != readback_buffers.end())
+		{
+			BufferHandle buffer = it->handle;
+			readback_buffers.erase(it);
+			return buffer;
+		}
+	}
+
+	auto result = create_buffer(BufferInfo(BufferCreateInfo(in_size,
+		MemoryUsage::GpuToCpu,
+		BufferUsageFlags(BufferUsageFlagBits::TransferDst))).set_debug_name("Readback Buffer"));
+	if(!result)
+	{
+		logger::error(log_gfx_device, "Failed to create readback buffer: {}", result.get_error());
+		return {};
+	}
+
+	return result.get_value();
+}
+
+ReadbackRequest Device::add_readback(const BufferHandle& in_buffer, const uint64_t in_size, ReadbackCallback in_callback)
+{
+	auto state = std::make_shared<detail::ReadbackState>();
+	state->callback = std::move(in_callback);
+
+	{
+		std::lock_guard lock(readback_mutex);
+		get_current_frame().readbacks.push_back({ in_buffer, in_size, state });
+	}
+
+	return ReadbackRequest(std::move(state));
+}
+
 void Device::cmd_texture_barrier(const CommandListHandle& in_cmd_list,
 	const TextureHandle& in_texture,
 	const PipelineStageFlags in_src_flags, 
@@ -951,6 +2179,32 @@ void Device::cmd_texture_barrier(const CommandListHandle& in_cmd_list,
 {
 	CB_CHECK(in_texture);
 
+	auto texture = cast_handle<Texture>(in_texture);
+	cmd_texture_barrier(in_cmd_list,
+		in_texture,
+		TextureSubresourceRange(format_to_aspect_flags(texture->get_create_info().format), 
+			0, texture->get_create_info().mip_levels,
+			0, texture->get_create_info().array_layers),
+		in_src_flags,
+		in_src_layout,
+		in_src_access_flags,
+		in_dst_flags,
+		in_dst_layout,
+		in_dst_access_flags);
+}
+
+void Device::cmd_texture_barrier(const CommandListHandle& in_cmd_list,
+	const TextureHandle& in_texture,
+	const TextureSubresourceRange& in_subresource_range,
+	const PipelineStageFlags in_src_flags, 
+	const TextureLayout in_src_layout, 
+	const AccessFlags in_src_access_flags, 
+	const PipelineStageFlags in_dst_flags, 
+	const TextureLayout in_dst_layout, 
+	const AccessFlags in_dst_access_flags)
+{
+	CB_CHECK(in_texture);
+
 	auto texture = cast_handle<Texture>(in_texture);
 
 	std::array barriers = 
@@ -960,9 +2214,7 @@ void Device::cmd_texture_barrier(const CommandListHandle& in_cmd_list,
 			in_dst_access_flags,
 			in_src_layout,
 			in_dst_layout,
-			TextureSubresourceRange(format_to_aspect_flags(texture->get_create_info().format), 
-				0, texture->get_create_info().mip_levels,
-				0, texture->get_create_info().array_layers))
+			in_subresource_range)
 	};
 
 	backend_device->cmd_pipeline_barrier(cast_handle<CommandList>(in_cmd_list)->get_resource(),
@@ -971,6 +2223,27 @@ void Device::cmd_texture_barrier(const CommandListHandle& in_cmd_list,
 		barriers);
 }
 
+void Device::cmd_blit_texture(const CommandListHandle& in_cmd_list,
+	const TextureHandle& in_src_texture,
+	const TextureLayout in_src_layout,
+	const TextureHandle& in_dst_texture,
+	const TextureLayout in_dst_layout,
+	const std::span<TextureBlitRegion>& in_regions,
+	const Filter in_filter)
+{
+	CB_CHECK(!in_regions.empty());
+	CB_CHECK(in_src_texture);
+	CB_CHECK(in_dst_texture);
+
+	backend_device->cmd_blit_texture(cast_handle<CommandList>(in_cmd_list)->get_resource(),
+		cast_handle<Texture>(in_src_texture)->get_resource(),
+		in_src_layout,
+		cast_handle<Texture>(in_dst_texture)->get_resource(),
+		in_dst_layout,
+		in_regions,
+		in_filter);
+}
+
 Result Device::acquire_swapchain_texture(const SwapchainHandle& in_swapchain,
 	const SemaphoreHandle& in_signal_semaphore)
 {
@@ -1006,6 +2279,16 @@ BackendDeviceResource Device::get_swapchain_backend_handle(const SwapchainHandle
 	return cast_handle<Swapchain>(in_swapchain)->get_resource();
 }
 
+Format Device::get_swapchain_format(const SwapchainHandle& in_swapchain) const
+{
+	return backend_device->get_swapchain_format(cast_handle<Swapchain>(in_swapchain)->get_resource());
+}
+
+PresentMode Device::get_swapchain_present_mode(const SwapchainHandle& in_swapchain) const
+{
+	return backend_device->get_swapchain_present_mode(cast_handle<Swapchain>(in_swapchain)->get_resource());
+}
+
 BackendDeviceResource Device::get_or_create_render_pass(const RenderPassCreateInfo& in_create_info)
 {
 	auto it = render_passes.find(in_create_info);
@@ -1018,15 +2301,32 @@ BackendDeviceResource Device::get_or_create_render_pass(const RenderPassCreateIn
 	return rp.get_value();
 }
 
-BackendDeviceResource Device::get_or_create_pipeline(const GfxPipelineCreateInfo& in_create_info)
+BackendDeviceResource Device::get_or_create_pipeline(const detail::GfxPipelineKey& in_key)
 {
-	auto it = gfx_pipelines.find(in_create_info);
+	auto it = gfx_pipelines.find(in_key);
 	if(it != gfx_pipelines.end())
 		return it->second;
 
-	auto pipeline = backend_device->create_gfx_pipeline(in_create_info);
+	/** Resolve shader handles to their current backend module */
+	std::vector<PipelineShaderStage> stages;
+	stages.reserve(in_key.stages.size());
+	for(const auto& stage : in_key.stages)
+	{
+		stages.emplace_back(stage.shader_stage,
+			cast_handle<Shader>(stage.shader)->get_resource(),
+			stage.entry_point,
+			stage.get_specialization_constants());
+	}
+
+	std::vector<PipelineColorBlendAttachmentState> color_blend_attachments = in_key.color_blend_attachments;
+
+	GfxPipelineCreateInfo create_info = in_key.create_info;
+	create_info.shader_stages = stages;
+	create_info.color_blend_state.attachments = color_blend_attachments;
+
+	auto pipeline = backend_device->create_gfx_pipeline(create_info);
 	CB_ASSERT(pipeline.has_value());
-	gfx_pipelines.insert({ in_create_info, pipeline.get_value() });
+	gfx_pipelines.insert({ in_key, pipeline.get_value() });
 	return pipeline.get_value();
 }
 
@@ -2,6 +2,11 @@
 #include <GLFW/glfw3.h>
 #if CB_PLATFORM(WINDOWS)
 #define GLFW_EXPOSE_NATIVE_WIN32
+#elif CB_PLATFORM(LINUX)
+#define GLFW_EXPOSE_NATIVE_X11
+#if __has_include(<wayland-client.h>)
+#define GLFW_EXPOSE_NATIVE_WAYLAND
+#endif
 #endif
 #include <GLFW/glfw3native.h>
 
@@ -21,6 +26,9 @@ Window::Window(const uint32_t in_width,
 	const uint32_t in_height,
 	WindowFlags in_flags) : window(nullptr), width(in_width), height(in_height), flags(std::move(in_flags))
 {
+	if(flags & WindowFlagBits::Headless)
+		return;
+
 	glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
 	window = glfwCreateWindow(width, 
 		height, 
@@ -51,12 +59,25 @@ Window::~Window()
 	window = nullptr;
 }
 
-void* Window::get_native_handle() const
+gfx::NativeWindowHandle Window::get_native_handle() const
 {
+	if(!window)
+		return gfx::NativeWindowHandle(gfx::WindowSystem::Headless);
+
 #if CB_PLATFORM(WINDOWS)
-	return glfwGetWin32Window(window);
+	return gfx::NativeWindowHandle(gfx::WindowSystem::Win32, nullptr, glfwGetWin32Window(window));
+#elif CB_PLATFORM(LINUX)
+#if defined(GLFW_EXPOSE_NATIVE_WAYLAND) && defined(GLFW_PLATFORM_WAYLAND)
+	/** GLFW 3.4 selects X11 or Wayland at runtime */
+	if(glfwGetPlatform() == GLFW_PLATFORM_WAYLAND)
+		return gfx::NativeWindowHandle(gfx::WindowSystem::Wayland, glfwGetWaylandDisplay(), glfwGetWaylandWindow(window));
+#endif
+	return gfx::NativeWindowHandle(gfx::WindowSystem::Xlib, 
+		glfwGetX11Display(), 
+		reinterpret_cast<void*>(static_cast<uintptr_t>(glfwGetX11Window(window))));
 #else
 	CB_ASSERTF(false, "Unsupported platform");
+	return gfx::NativeWindowHandle();
 #endif
 }
 
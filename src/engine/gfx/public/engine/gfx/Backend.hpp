@@ -13,7 +13,16 @@ class BackendDevice;
 enum class BackendFlagBits
 {
 	/** Enable debugging utilities like Vulkan's Validation Layers or D3D Debug Layer */
-	DebugLayers = 1 << 0	
+	DebugLayers = 1 << 0,
+
+	/** Enable the bindless resource model if the GPU supports it (descriptor indexing) */
+	Bindless = 1 << 1,
+
+	/** No windowing system, swapchains are created for WindowSystem::Headless windows only */
+	Headless = 1 << 2,
+
+	/** No presentation at all, devices only render to textures and swapchains can't be created */
+	Offscreen = 1 << 3,
 };
 CB_ENABLE_FLAG_ENUMS(BackendFlagBits, BackendFlags);
 	
@@ -69,9 +69,27 @@ public:
 	virtual void destroy_fence(const BackendDeviceResource& in_fence) = 0;
 	virtual void destroy_pipeline_layout(const BackendDeviceResource& in_pipeline_layout) = 0;
 
+	/** Format support */
+
+	/**
+	 * Check if textures of this format can be used as both source and destination of a linear-filtered blit
+	 */
+	[[nodiscard]] virtual bool supports_linear_blit(const Format in_format) = 0;
+
+	/**
+	 * Check if the format can be used by a vertex input attribute
+	 */
+	[[nodiscard]] virtual bool supports_vertex_format(const Format in_format) = 0;
+
+	/**
+	 * Sample counts usable by both color and depth-stencil attachments
+	 */
+	[[nodiscard]] virtual SampleCountFlags get_supported_attachment_sample_counts() = 0;
+
 	/** Buffer */
 	[[nodiscard]] virtual cb::Result<void*, Result> map_buffer(const BackendDeviceResource& in_buffer) = 0;
 	virtual void unmap_buffer(const BackendDeviceResource& in_buffer) = 0;
+	virtual void flush_buffer(const BackendDeviceResource& in_buffer, const uint64_t in_offset, const uint64_t in_size) = 0;
 
 	/** Command pool */
 	[[nodiscard]] virtual cb::Result<std::vector<BackendDeviceResource>, Result> allocate_command_lists(const BackendDeviceResource& in_pool, 
@@ -89,10 +107,37 @@ public:
 	[[nodiscard]] virtual const std::vector<BackendDeviceResource>& get_swapchain_backbuffer_views(const BackendDeviceResource& in_swapchain) = 0;
 	[[nodiscard]] virtual Format get_swapchain_format(const BackendDeviceResource& in_swapchain) = 0;
 
+	/** The mode actually used, may differ from the requested one if it is not supported */
+	[[nodiscard]] virtual PresentMode get_swapchain_present_mode(const BackendDeviceResource& in_swapchain) = 0;
+
 	/** Pipeline layout */
+	/** in_hash identifies the content of in_descriptors, a set allocated with the same hash is returned without being written */
 	[[nodiscard]] virtual cb::Result<BackendDeviceResource, Result> allocate_descriptor_set(const BackendDeviceResource& in_pipeline_layout,
 		const uint32_t in_set,
-		const std::span<Descriptor, max_bindings>& in_descriptors) = 0;
+		const std::span<Descriptor, max_bindings>& in_descriptors,
+		const uint64_t in_hash) = 0;
+
+	/** Bindless */
+	[[nodiscard]] virtual bool is_bindless_enabled() = 0;
+	[[nodiscard]] virtual BackendDeviceResource get_bindless_descriptor_set() = 0;
+
+	/**
+	 * Write a resource in the global bindless set, the index must not be used by in-flight command lists
+	 * Texture views are sampled in in_layout, the layout their texture is in when shaders read it
+	 */
+	virtual void update_bindless_texture_view(const uint32_t in_index, const BackendDeviceResource& in_texture_view,
+		const TextureLayout in_layout) = 0;
+	virtual void update_bindless_sampler(const uint32_t in_index, const BackendDeviceResource& in_sampler) = 0;
+	virtual void update_bindless_storage_buffer(const uint32_t in_index, const BackendDeviceResource& in_buffer) = 0;
+
+	/** Dynamic rendering, single-subpass passes begun without render pass or framebuffer objects */
+	[[nodiscard]] virtual bool supports_dynamic_rendering() = 0;
+
+	/**
+	 * Pipelines are linked from separately compiled parts (vertex input, pre-rasterization, fragment shader and
+	 * fragment output) that are shared between pipelines, then an optimized version is compiled in the background
+	 */
+	[[nodiscard]] virtual bool supports_graphics_pipeline_library() = 0;
 
 	/** Commands */
 	virtual void begin_cmd_list(const BackendDeviceResource& in_list) = 0;
@@ -115,11 +160,20 @@ public:
 		const uint32_t in_first_index,
 		const int32_t in_vertex_offset,
 		const uint32_t in_first_instance) = 0;
+	virtual void cmd_next_subpass(const BackendDeviceResource& in_list) = 0;
 	virtual void cmd_end_render_pass(const BackendDeviceResource& in_list) = 0;
+	virtual void cmd_begin_rendering(const BackendDeviceResource& in_list, const RenderingInfo& in_info) = 0;
+	virtual void cmd_end_rendering(const BackendDeviceResource& in_list) = 0;
 
 	virtual void cmd_bind_descriptor_sets(const BackendDeviceResource in_list,
 		const BackendDeviceResource in_pipeline_layout,
+		const uint32_t in_first_set,
 		const std::span<BackendDeviceResource> in_descriptor_sets) = 0;
+	virtual void cmd_push_constants(const BackendDeviceResource& in_list,
+		const BackendDeviceResource& in_pipeline_layout,
+		const ShaderStageFlags in_stages,
+		const uint32_t in_offset,
+		const std::span<const uint8_t>& in_data) = 0;
 	virtual void cmd_bind_vertex_buffers(const BackendDeviceResource& in_list,
 		const uint32_t in_first_binding,
 		const std::span<BackendDeviceResource> in_buffers,
@@ -152,6 +206,24 @@ public:
 		const TextureLayout in_dst_layout,
 		const std::span<BufferTextureCopyRegion>& in_copy_regions) = 0;
 
+	/** The copied data is made visible to the host once the command list completed */
+	virtual void cmd_copy_texture_to_buffer(const BackendDeviceResource in_list,
+		const BackendDeviceResource in_src_texture,
+		const TextureLayout in_src_layout,
+		const BackendDeviceResource in_dst_buffer,
+		const std::span<BufferTextureCopyRegion>& in_copy_regions) = 0;
+
+	/** Make the transfer writes recorded before it visible to the host once the command list completed */
+	virtual void cmd_host_read_barrier(const BackendDeviceResource in_list) = 0;
+
+	virtual void cmd_blit_texture(const BackendDeviceResource in_list,
+		const BackendDeviceResource in_src_texture,
+		const TextureLayout in_src_layout,
+		const BackendDeviceResource in_dst_texture,
+		const TextureLayout in_dst_layout,
+		const std::span<TextureBlitRegion>& in_regions,
+		const Filter in_filter) = 0;
+
 	virtual void end_cmd_list(const BackendDeviceResource& in_list) = 0;
 
 	/** Fence */
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Texture.hpp"
+#include <array>
 
 namespace cb::gfx
 {
@@ -62,13 +63,43 @@ struct BufferTextureCopyRegion
 	Offset3D texture_offset;
 	Extent3D texture_extent;
 
+	/**
+	 * Row pitch and image height of the buffer data, in texels. 0 means tightly packed according to texture_extent
+	 * For block-compressed formats, these must be multiples of the block extent
+	 */
+	uint32_t buffer_row_length;
+	uint32_t buffer_image_height;
+
 	BufferTextureCopyRegion(const uint64_t in_buffer_offset,
 		const TextureSubresourceLayers in_layers,
 		const Offset3D in_offset,
-		const Extent3D in_extent) : buffer_offset(in_buffer_offset),
+		const Extent3D in_extent,
+		const uint32_t in_buffer_row_length = 0,
+		const uint32_t in_buffer_image_height = 0) : buffer_offset(in_buffer_offset),
 		texture_subresource(in_layers),
 		texture_offset(in_offset),
-		texture_extent(in_extent) {}
+		texture_extent(in_extent),
+		buffer_row_length(in_buffer_row_length),
+		buffer_image_height(in_buffer_image_height) {}
+};
+
+/**
+ * Region of a texture blit, offsets define the two corners of the source and destination regions
+ */
+struct TextureBlitRegion
+{
+	TextureSubresourceLayers src_subresource;
+	std::array<Offset3D, 2> src_offsets;
+	TextureSubresourceLayers dst_subresource;
+	std::array<Offset3D, 2> dst_offsets;
+
+	TextureBlitRegion(const TextureSubresourceLayers& in_src_subresource,
+		const std::array<Offset3D, 2>& in_src_offsets,
+		const TextureSubresourceLayers& in_dst_subresource,
+		const std::array<Offset3D, 2>& in_dst_offsets) : src_subresource(in_src_subresource),
+		src_offsets(in_src_offsets),
+		dst_subresource(in_dst_subresource),
+		dst_offsets(in_dst_offsets) {}
 };
 
 enum class IndexType
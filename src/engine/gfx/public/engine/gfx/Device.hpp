@@ -16,8 +16,11 @@
 #include "Sampler.hpp"
 #include "Sync.hpp"
 #include "Rect.hpp"
+#include "Readback.hpp"
 #include "BackendDevice.hpp"
 #include <thread>
+#include <optional>
+#include <mutex>
 #include <robin_hood.h>
 
 namespace cb::gfx
@@ -31,12 +34,18 @@ class Device;
 
 /**
  * Pipeline state associated to a render pass
+ * The sample count isn't part of it, it is inferred from the attachments of the current pass
  */
 struct PipelineRenderPassState
 {
 	PipelineColorBlendStateCreateInfo color_blend;	
 	PipelineDepthStencilStateCreateInfo depth_stencil;	
-	PipelineMultisamplingStateCreateInfo multisampling;	
+
+	bool operator==(const PipelineRenderPassState& in_other) const
+	{
+		return color_blend == in_other.color_blend &&
+			depth_stencil == in_other.depth_stencil;
+	}
 };
 
 /**
@@ -44,10 +53,126 @@ struct PipelineRenderPassState
  */
 struct PipelineMaterialState
 {
-	std::span<PipelineShaderStage> stages;
+	std::span<MaterialShaderStage> stages;
 	PipelineVertexInputStateCreateInfo vertex_input;
 	PipelineInputAssemblyStateCreateInfo input_assembly;
 	PipelineRasterizationStateCreateInfo rasterizer;
+
+	bool operator==(const PipelineMaterialState& in_other) const
+	{
+		return std::ranges::equal(stages, in_other.stages) &&
+			vertex_input == in_other.vertex_input &&
+			input_assembly == in_other.input_assembly &&
+			rasterizer == in_other.rasterizer;
+	}
+};
+
+namespace detail
+{
+
+/**
+ * Key of the device pipeline cache, owns the stages and blend attachments so it doesn't depend on the lifetime
+ * of the material or render pass state that created it, the spans of create_info are left empty
+ * Stages reference shaders by handle so the key stays the same when a shader is reloaded
+ */
+struct GfxPipelineKey
+{
+	std::vector<MaterialShaderStage> stages;
+	std::vector<PipelineColorBlendAttachmentState> color_blend_attachments;
+	GfxPipelineCreateInfo create_info;
+
+	GfxPipelineKey(const std::span<const MaterialShaderStage>& in_stages, const GfxPipelineCreateInfo& in_create_info)
+		: stages(in_stages.begin(), in_stages.end()),
+		color_blend_attachments(in_create_info.color_blend_state.attachments.begin(), in_create_info.color_blend_state.attachments.end()),
+		create_info(in_create_info)
+	{
+		create_info.shader_stages = {};
+		create_info.color_blend_state.attachments = {};
+	}
+
+	bool operator==(const GfxPipelineKey& in_other) const
+	{
+		return stages == in_other.stages &&
+			color_blend_attachments == in_other.color_blend_attachments &&
+			create_info == in_other.create_info;
+	}
+};
+
+}
+
+}
+
+namespace std
+{
+
+template<> struct hash<cb::gfx::detail::GfxPipelineKey>
+{
+	uint64_t operator()(const cb::gfx::detail::GfxPipelineKey& in_key) const noexcept
+	{
+		uint64_t hash = 0;
+
+		for(const auto& stage : in_key.stages)
+			cb::hash_combine(hash, stage);
+
+		for(const auto& attachment : in_key.color_blend_attachments)
+			cb::hash_combine(hash, attachment);
+
+		cb::hash_combine(hash, in_key.create_info);
+
+		return hash;
+	}
+};
+
+}
+
+namespace cb::gfx
+{
+
+/**
+ * Per-state counters of a command list
+ */
+struct CommandListStateCounters
+{
+	uint32_t pipelines = 0;
+	uint32_t descriptors = 0;
+	uint32_t descriptor_sets = 0;
+	uint32_t vertex_buffers = 0;
+	uint32_t index_buffers = 0;
+	uint32_t viewports = 0;
+	uint32_t scissors = 0;
+
+	CommandListStateCounters& operator+=(const CommandListStateCounters& in_other)
+	{
+		pipelines += in_other.pipelines;
+		descriptors += in_other.descriptors;
+		descriptor_sets += in_other.descriptor_sets;
+		vertex_buffers += in_other.vertex_buffers;
+		index_buffers += in_other.index_buffers;
+		viewports += in_other.viewports;
+		scissors += in_other.scissors;
+		return *this;
+	}
+
+	[[nodiscard]] uint32_t get_total() const
+	{
+		return pipelines + descriptors + descriptor_sets + vertex_buffers + index_buffers + viewports + scissors;
+	}
+};
+
+/**
+ * State changes forwarded to the backend, and redundant ones that were dropped because the state was already bound
+ */
+struct CommandListStatistics
+{
+	CommandListStateCounters issued;
+	CommandListStateCounters filtered;
+
+	CommandListStatistics& operator+=(const CommandListStatistics& in_other)
+	{
+		issued += in_other.issued;
+		filtered += in_other.filtered;
+		return *this;
+	}
 };
 
 namespace detail
@@ -56,6 +181,24 @@ namespace detail
 template<typename T, typename Handle>
 struct IsHandleCompatibleWith : std::false_type {};
 
+/**
+ * Hands out stable indices into one of the bindless descriptor arrays, freed indices are reused
+ */
+class BindlessIndexAllocator
+{
+public:
+	explicit BindlessIndexAllocator(const uint32_t in_capacity) : capacity(in_capacity), next_index(0) {}
+
+	/** \return invalid_bindless_index if the array is full */
+	[[nodiscard]] uint32_t allocate();
+	void free(const uint32_t in_index);
+private:
+	std::mutex mutex;
+	uint32_t capacity;
+	uint32_t next_index;
+	std::vector<uint32_t> free_indices;
+};
+
 template<DeviceResourceType Type>
 class BackendResourceWrapper
 {
@@ -102,8 +245,14 @@ class Buffer : public BackendResourceWrapper<DeviceResourceType::Buffer>
 public:
 	Buffer(Device& in_device,
 		const BackendDeviceResource& in_buffer,
-		const std::string_view& in_debug_name) : BackendResourceWrapper(in_device, in_buffer, in_debug_name) {}
+		const std::string_view& in_debug_name) : BackendResourceWrapper(in_device, in_buffer, in_debug_name),
+		bindless_index(invalid_bindless_index) {}
 	~Buffer();
+
+	void set_bindless_index(const uint32_t in_index) { bindless_index = in_index; }
+	[[nodiscard]] uint32_t get_bindless_index() const { return bindless_index; }
+private:
+	uint32_t bindless_index;
 };
 
 class Texture : public BackendResourceWrapper<DeviceResourceType::Texture>
@@ -132,15 +281,20 @@ public:
 		const TextureViewCreateInfo& in_create_info,
 		const BackendDeviceResource& in_texture_view,
 		const std::string_view& in_debug_name) : BackendResourceWrapper(in_device, in_texture_view, in_debug_name), texture(in_texture),
-		create_info(in_create_info), is_view_from_swapchain(in_texture.is_texture_from_swapchain()) {}
+		create_info(in_create_info), is_view_from_swapchain(in_texture.is_texture_from_swapchain()),
+		bindless_index(invalid_bindless_index) {}
 	~TextureView();
 
 	[[nodiscard]] Texture& get_texture() { return texture; }
 	[[nodiscard]] const TextureViewCreateInfo& get_create_info() { return create_info; }
+
+	void set_bindless_index(const uint32_t in_index) { bindless_index = in_index; }
+	[[nodiscard]] uint32_t get_bindless_index() const { return bindless_index; }
 private:
 	Texture& texture;
 	TextureViewCreateInfo create_info;
 	bool is_view_from_swapchain;
+	uint32_t bindless_index;
 };
 
 class Shader : public BackendResourceWrapper<DeviceResourceType::Shader>
@@ -150,11 +304,17 @@ public:
 		const BackendDeviceResource& in_shader,
 		const std::string_view& in_debug_name) : BackendResourceWrapper(in_device, in_shader, in_debug_name) {}
 	~Shader();
+
+	/** Swap the backend shader module, used by shader reloading. Returns the previous one */
+	[[nodiscard]] BackendDeviceResource exchange_resource(const BackendDeviceResource& in_shader)
+	{
+		return std::exchange(resource, in_shader);
+	}
 };
 
 class Swapchain : public BackendResourceWrapper<DeviceResourceType::Swapchain>
 {
-	friend class Device;
+	friend class gfx::Device;
 
 public:
 	Swapchain(Device& in_device,
@@ -190,10 +350,33 @@ class PipelineLayout : public BackendResourceWrapper<DeviceResourceType::Pipelin
 public:
 	PipelineLayout(Device& in_device,
 		const BackendDeviceResource& in_pipeline_layout,
-		const std::string_view& in_debug_name) : BackendResourceWrapper(in_device, in_pipeline_layout, in_debug_name) {}
+		const bool in_bindless,
+		const uint8_t in_sets_mask,
+		BindingTable&& in_binding_table,
+		const std::string_view& in_debug_name) : BackendResourceWrapper(in_device, in_pipeline_layout, in_debug_name),
+		bindless(in_bindless), sets_mask(in_sets_mask), binding_table(std::move(in_binding_table)) {}
 	~PipelineLayout();
+
+	[[nodiscard]] bool is_bindless() const { return bindless; }
+
+	/** Bitmask of the descriptor sets declared by the layout, including the bindless set */
+	[[nodiscard]] uint8_t get_sets_mask() const { return sets_mask; }
+
+	[[nodiscard]] const BindingSlot* find_binding(const BindingName& in_name) const
+	{
+		auto it = binding_table.find(in_name.hash);
+		return it != binding_table.end() ? &it->second : nullptr;
+	}
+private:
+	bool bindless;
+	uint8_t sets_mask;
+	BindingTable binding_table;
 };
 
+/**
+ * Shadows all state bound to the backend command list so redundant binds are never forwarded
+ * Shadowed state is only valid between begin() and the end of the list
+ */
 class CommandList : public BackendResourceWrapper<DeviceResourceType::CommandList>
 {
 public:
@@ -201,20 +384,44 @@ public:
 		const BackendDeviceResource& in_list,
 		const QueueType& in_type,
 		const std::string_view& in_debug_name) : BackendResourceWrapper(in_device, in_list, in_debug_name),
-		type(in_type), pipeline_state_dirty(false), dirty_sets_mask(0) {}
+		type(in_type) { begin(); }
+
+	/** Reset all shadowed state, called when the list is (re)allocated as command buffers start with nothing bound */
+	void begin();
 
 	void prepare_draw();
-	void set_render_pass(const BackendDeviceResource& in_handle) { render_pass = in_handle; }
-	void set_pipeline_layout(const PipelineLayoutHandle& in_handle) { pipeline_layout = in_handle; pipeline_state_dirty = true; }
-	void set_render_pass_state(const PipelineRenderPassState& in_state) { render_pass_state = in_state; pipeline_state_dirty = true; }
-	void set_material_state(const PipelineMaterialState& in_state) { material_state = in_state; pipeline_state_dirty = true; }
-	void set_descriptor(size_t in_set, size_t in_binding, const Descriptor& in_descriptor)
-	{
-		descriptors[in_set][in_binding] = in_descriptor;
-		dirty_sets_mask = 1 << in_set;
-	}
+	void set_render_pass(const BackendDeviceResource& in_handle);
+
+	/** Begin a dynamic rendering pass, pipelines are then created against these formats instead of a render pass */
+	void set_rendering_formats(const PipelineRenderingFormats& in_formats);
+
+	/** Sample count of the attachments of the current pass, pipelines are created with it */
+	void set_sample_count(const SampleCountFlagBits in_sample_count);
+	void next_subpass();
+	void set_pipeline_layout(const PipelineLayoutHandle& in_handle);
+	[[nodiscard]] const PipelineLayoutHandle& get_pipeline_layout() const { return pipeline_layout; }
+	void set_render_pass_state(const PipelineRenderPassState& in_state);
+	void set_material_state(const PipelineMaterialState& in_state);
+	void set_descriptor(size_t in_set, size_t in_binding, const Descriptor& in_descriptor);
+
+	/** Binds below forward to the backend only what differs from the bound state */
+	void bind_vertex_buffers(const uint32_t in_first_binding,
+		const std::span<const BackendDeviceResource>& in_buffers,
+		const std::span<const uint64_t>& in_offsets);
+	void bind_index_buffer(const BackendDeviceResource in_buffer, 
+		const uint64_t in_offset,
+		const IndexType in_index_type);
+	void set_viewport(const Viewport& in_viewport);
+	void set_scissor(const Rect2D& in_scissor);
+	void push_constants(const ShaderStageFlags in_stages, const uint32_t in_offset, const std::span<const uint8_t>& in_data);
 
 	[[nodiscard]] QueueType get_queue_type() const { return type; }
+	[[nodiscard]] const CommandListStatistics& get_statistics() const { return statistics; }
+	[[nodiscard]] bool is_dynamic_rendering() const { return dynamic_rendering; }
+
+	/** Scratch barriers recorded when the current dynamic rendering pass begins, and the ones to record when it ends */
+	[[nodiscard]] std::vector<TextureMemoryBarrier>& get_begin_rendering_barriers() { return begin_rendering_barriers; }
+	[[nodiscard]] std::vector<TextureMemoryBarrier>& get_end_rendering_barriers() { return end_rendering_barriers; }
 private:
 	void update_pipeline_state();
 	void update_descriptors();
@@ -222,6 +429,12 @@ private:
 	QueueType type;
 	PipelineLayoutHandle pipeline_layout;
 	BackendDeviceResource render_pass;
+	uint32_t subpass;
+	PipelineRenderingFormats rendering_formats;
+	bool dynamic_rendering;
+	PipelineMultisamplingStateCreateInfo multisampling;
+	std::vector<TextureMemoryBarrier> begin_rendering_barriers;
+	std::vector<TextureMemoryBarrier> end_rendering_barriers;
 	PipelineRenderPassState render_pass_state;
 	PipelineMaterialState material_state;
 	bool pipeline_state_dirty;
@@ -229,6 +442,29 @@ private:
 
 	/** Bitmask used to keep track of which descriptor sets to update */
 	uint8_t dirty_sets_mask;
+
+	/** Per-set bitmask of the bindings written since the set was last allocated, only their hashes are recomputed */
+	static_assert(max_bindings <= 16);
+	std::array<uint16_t, max_descriptor_sets> dirty_bindings_masks;
+	std::array<std::array<uint64_t, max_bindings>, max_descriptor_sets> binding_hashes;
+
+	/** Bitmask of the sets bound with the current pipeline layout, only their descriptors can be filtered */
+	uint8_t bound_sets_mask;
+
+	/** Bitmask of the sets with descriptors written since the list began, rebound when the layout changes */
+	uint8_t populated_sets_mask;
+
+	/** Currently bound backend state */
+	BackendDeviceResource bound_pipeline;
+	std::array<BackendDeviceResource, max_descriptor_sets> bound_sets;
+	std::array<BackendDeviceResource, max_vertex_input_bindings> bound_vertex_buffers;
+	std::array<uint64_t, max_vertex_input_bindings> bound_vertex_buffer_offsets;
+	BackendDeviceResource bound_index_buffer;
+	uint64_t bound_index_buffer_offset;
+	IndexType bound_index_type;
+	std::optional<Viewport> bound_viewport;
+	std::optional<Rect2D> bound_scissor;
+	CommandListStatistics statistics;
 };
 
 class Fence : public BackendResourceWrapper<DeviceResourceType::Fence>
@@ -254,8 +490,14 @@ class Sampler : public BackendResourceWrapper<DeviceResourceType::Sampler>
 public:
 	Sampler(Device& in_device,
 		const BackendDeviceResource& in_sampler,
-		const std::string_view& in_debug_name) : BackendResourceWrapper(in_device, in_sampler, in_debug_name) {}
+		const std::string_view& in_debug_name) : BackendResourceWrapper(in_device, in_sampler, in_debug_name),
+		bindless_index(invalid_bindless_index) {}
 	~Sampler();
+
+	void set_bindless_index(const uint32_t in_index) { bindless_index = in_index; }
+	[[nodiscard]] uint32_t get_bindless_index() const { return bindless_index; }
+private:
+	uint32_t bindless_index;
 };
 
 template<> struct IsHandleCompatibleWith<Buffer, BufferHandle> : std::true_type {};
@@ -332,13 +574,13 @@ struct DeviceResourceInfo
 struct BufferInfo : public DeviceResourceInfo<BufferInfo>
 {
 	BufferCreateInfo info;
-	std::span<uint8_t> initial_data;
+	std::span<const uint8_t> initial_data;
 
 	explicit BufferInfo(const BufferCreateInfo& in_info,
-		const std::span<uint8_t>& in_initial_data = {}) : info(in_info),
+		const std::span<const uint8_t>& in_initial_data = {}) : info(in_info),
 		initial_data(in_initial_data) {}
 	
-	static BufferInfo make_staging(const size_t in_size, const std::span<uint8_t> in_initial_data = {})
+	static BufferInfo make_staging(const size_t in_size, const std::span<const uint8_t> in_initial_data = {})
 	{
 		return BufferInfo(BufferCreateInfo(in_size, 
 			MemoryUsage::CpuOnly, 
@@ -372,18 +614,37 @@ struct TextureInfo : public DeviceResourceInfo<TextureInfo>
 {
 	TextureCreateInfo info;
 
-	/** Mip0 initial data */
-	std::span<uint8_t> initial_data;
+	/** 
+	 * Initial data, mip levels tightly packed one after another starting from mip 0 
+	 * Levels not covered by the data are generated if generate_mip_chain is set, undefined otherwise
+	 */
+	std::span<const uint8_t> initial_data;
+
+	/** 
+	 * Optional location of each mip level in initial_data, used instead of tightly packed levels
+	 * Every range must lie within initial_data and hold at least the size of its level
+	 */
+	std::span<const TextureMipData> initial_data_mips;
+
+	/** Generate missing mip levels on the GPU by successive blits from the last uploaded level */
+	bool generate_mip_chain;
 
 	explicit TextureInfo(const TextureCreateInfo& in_info,
-		const std::span<uint8_t>& in_initial_data = {}) : info(in_info),
-		initial_data(in_initial_data) {}
+		const std::span<const uint8_t>& in_initial_data = {},
+		const bool in_generate_mip_chain = false) : info(in_info),
+		initial_data(in_initial_data), generate_mip_chain(in_generate_mip_chain) {}
+
+	TextureInfo& set_initial_data_mips(const std::span<const TextureMipData>& in_mips)
+	{
+		initial_data_mips = in_mips;
+		return *this;
+	}
 
 	static TextureInfo make_immutable_2d(const uint32_t in_width, 
 		const uint32_t in_height,
 		const Format in_format, const uint32_t in_mip_levels = 1, 
 		const TextureUsageFlags in_usage_flags = TextureUsageFlags(TextureUsageFlagBits::Sampled),
-		const std::span<uint8_t>& in_initial_data = {})
+		const std::span<const uint8_t>& in_initial_data = {})
 	{
 		return TextureInfo(TextureCreateInfo(TextureType::Tex2D,
 			MemoryUsage::GpuOnly,
@@ -397,6 +658,27 @@ struct TextureInfo : public DeviceResourceInfo<TextureInfo>
 			in_usage_flags), in_initial_data);
 	}
 
+	/**
+	 * Immutable 2D texture with a full mip chain generated on the GPU from mip 0
+	 */
+	static TextureInfo make_immutable_2d_mipmapped(const uint32_t in_width, 
+		const uint32_t in_height,
+		const Format in_format,
+		const TextureUsageFlags in_usage_flags = TextureUsageFlags(TextureUsageFlagBits::Sampled),
+		const std::span<const uint8_t>& in_initial_data = {})
+	{
+		return TextureInfo(TextureCreateInfo(TextureType::Tex2D,
+			MemoryUsage::GpuOnly,
+			in_format,
+			in_width,
+			in_height,
+			1,
+			get_mip_chain_length(in_width, in_height),
+			1,
+			SampleCountFlagBits::Count1,
+			in_usage_flags), in_initial_data, true);
+	}
+
 	static TextureInfo make_depth_stencil_attachment(const uint32_t in_width, 
 		const uint32_t in_height,
 		const Format in_format,
@@ -413,6 +695,28 @@ struct TextureInfo : public DeviceResourceInfo<TextureInfo>
 			SampleCountFlagBits::Count1,
 			in_usage_flags));
 	}
+
+	/**
+	 * Attachment only used inside render passes (e.g. a depth buffer not read afterwards),
+	 * backed by lazily allocated memory where available
+	 */
+	static TextureInfo make_transient_attachment(const uint32_t in_width, 
+		const uint32_t in_height,
+		const Format in_format,
+		const TextureUsageFlags in_usage_flags,
+		const SampleCountFlagBits in_sample_count = SampleCountFlagBits::Count1)
+	{
+		return TextureInfo(TextureCreateInfo(TextureType::Tex2D,
+			MemoryUsage::GpuLazy,
+			in_format,
+			in_width,
+			in_height,
+			1,
+			1,
+			1,
+			in_sample_count,
+			in_usage_flags | TextureUsageFlags(TextureUsageFlagBits::TransientAttachment)));
+	}
 };
 
 struct TextureViewInfo : public DeviceResourceInfo<TextureViewInfo>
@@ -422,13 +726,23 @@ struct TextureViewInfo : public DeviceResourceInfo<TextureViewInfo>
 	Format format;
 	TextureSubresourceRange subresource_range;
 
+	/** Register the view in the global bindless set when bindless is enabled, the texture must be sampled */
+	bool bindless;
+
 	TextureViewInfo(const TextureViewType in_type,
 		const TextureHandle& in_handle,
 		const Format in_format,
 		const TextureSubresourceRange& in_subresource_range) : type(in_type),
 		texture(in_handle),
 		format(in_format),
-		subresource_range(in_subresource_range) {}
+		subresource_range(in_subresource_range),
+		bindless(false) {}
+
+	TextureViewInfo& set_bindless(const bool in_bindless)
+	{
+		bindless = in_bindless;
+		return *this;
+	}
 
 	static TextureViewInfo make_2d(const TextureHandle& in_handle,
 		const Format in_format,
@@ -498,7 +812,16 @@ struct PipelineLayoutInfo : public DeviceResourceInfo<PipelineLayoutInfo>
 {
 	PipelineLayoutCreateInfo create_info;
 
+	/** Optional, lets descriptors be bound by name (e.g. built from shader reflection) */
+	BindingTable binding_table;
+
 	PipelineLayoutInfo(const PipelineLayoutCreateInfo& in_create_info) : create_info(in_create_info) {}
+
+	PipelineLayoutInfo& set_binding_table(BindingTable in_binding_table)
+	{
+		binding_table = std::move(in_binding_table);
+		return *this;
+	}
 };
 
 struct SamplerInfo : public DeviceResourceInfo<SamplerInfo>
@@ -519,30 +842,41 @@ struct RenderPassInfo
 		ReadWrite
 	};
 	
+	/**
+	 * Attachments are indexed like clear_values: color attachments first, then the depth-stencil attachment
+	 * Dependencies between subpasses are deduced from the attachments they use
+	 */
 	struct Subpass
 	{
 		std::span<uint32_t> color_attachments;
+
+		/** Attachments written by previous subpasses, bound with Device::cmd_bind_input_attachment */
 		std::span<uint32_t> input_attachments;
-		std::span<uint32_t> resolve_attachments;
 		/** Depth stencil mode for the depth-stencil attachment (determine layout) */
 		DepthStencilMode mode;
 
 		Subpass(const std::span<uint32_t>& in_color_attachments,
 			const std::span<uint32_t>& in_input_attachments,
-			const std::span<uint32_t>& in_resolve_attachments,
 			const DepthStencilMode in_mode = DepthStencilMode::ReadWrite) : color_attachments(in_color_attachments),
-		input_attachments(in_input_attachments), resolve_attachments(in_resolve_attachments), mode(in_mode) {}
+		input_attachments(in_input_attachments), mode(in_mode) {}
 	};
 	
 	/** Attachments to use */
 	std::span<TextureViewHandle> color_attachments;
 	TextureViewHandle depth_stencil_attachment;
 
-	/** Clear/load/store flags. To add attachment 2/3 to load e.g: (1 << 2) | (1 << 3) */
-	uint32_t clear_attachment_flags;
-	uint32_t load_attachment_flags;
-	uint32_t store_attachment_flags;
+	/**
+	 * Single-sampled textures multisampled color attachments are resolved to, indexed like color_attachments
+	 * Resolves happen at the end of the last subpass writing the color attachment, null handles aren't resolved
+	 * Can be empty if nothing is resolved
+	 */
+	std::span<TextureViewHandle> resolve_attachments;
+
+	/** Load/store operations of each color attachment, indexed like color_attachments */
+	std::span<const AttachmentOps> color_attachment_ops;
+	AttachmentOps depth_stencil_attachment_ops;
 
+	/** Indexed like attachments: color attachments first, then the depth-stencil attachment */
 	std::span<ClearValue> clear_values;
 
 
@@ -551,6 +885,18 @@ struct RenderPassInfo
 	Rect2D render_area;
 };
 
+/**
+ * How far the CPU may run ahead of the GPU
+ */
+enum class LatencyMode
+{
+	/** Up to frames in flight frames are queued, the CPU and GPU overlap */
+	Throughput,
+
+	/** A frame starts once the GPU finished the previous ones, input is sampled closer to display */
+	LowLatency,
+};
+
 /**
  * A GPU device, used to communicate with it
  * The engine currently only supports one active GPU (as using multiple GPU is hard to manage)
@@ -559,7 +905,23 @@ class Device final
 {
 	friend class detail::Swapchain;
 	friend class detail::CommandList;
+	friend class detail::Buffer;
+	friend class detail::TextureView;
+	friend class detail::Sampler;
 	
+	struct PendingReadback
+	{
+		BufferHandle buffer;
+		uint64_t size;
+		std::shared_ptr<detail::ReadbackState> state;
+	};
+
+	struct ReadbackBuffer
+	{
+		BufferHandle handle;
+		uint64_t size;
+	};
+
 	struct Frame
 	{
 		detail::ThreadedCommandPool gfx_command_pool;
@@ -580,11 +942,18 @@ class Device final
 		std::vector<SemaphoreHandle> expired_semaphores;
 		std::vector<SamplerHandle> expired_samplers;
 
+		/** Backend objects replaced by a shader reload, they may still be used by in-flight command lists */
+		std::vector<BackendDeviceResource> expired_backend_shaders;
+		std::vector<BackendDeviceResource> expired_backend_pipelines;
+
 		std::vector<CommandListHandle> gfx_lists;
 		std::vector<SemaphoreHandle> gfx_wait_semaphores;
 		std::vector<SemaphoreHandle> gfx_signal_semaphores;
 		bool gfx_submitted;
 
+		/** Readbacks recorded during this frame, completed once its fences are signaled */
+		std::vector<PendingReadback> readbacks;
+
 		Frame();
 
 		void free_resources();
@@ -597,6 +966,8 @@ class Device final
 			expired_shaders.clear();
 			expired_pipeline_layouts.clear();
 			expired_pipelines.clear();
+			expired_backend_shaders.clear();
+			expired_backend_pipelines.clear();
 
 			gfx_command_pool.reset();
 
@@ -616,9 +987,15 @@ class Device final
 		}
 	};
 public:
-	static constexpr size_t max_frames_in_flight = 2;
-
-	Device(Backend& in_backend, std::unique_ptr<BackendDevice>&& in_backend_device);
+	/** Bounds of the frames in flight count chosen at creation, per-frame resources are rings of that size */
+	static constexpr uint32_t min_frames_in_flight = 1;
+	static constexpr uint32_t max_frames_in_flight = 4;
+	static constexpr uint32_t default_frames_in_flight = 2;
+
+	/** in_frames_in_flight is clamped to [min_frames_in_flight, max_frames_in_flight] */
+	Device(Backend& in_backend, 
+		std::unique_ptr<BackendDevice>&& in_backend_device,
+		const uint32_t in_frames_in_flight = default_frames_in_flight);
 	~Device();
 	
 	Device(const Device&) = delete;	 
@@ -642,6 +1019,13 @@ public:
 	[[nodiscard]] cb::Result<PipelineLayoutHandle, Result> create_pipeline_layout(const PipelineLayoutInfo& in_create_info);
 	[[nodiscard]] cb::Result<SamplerHandle, Result> create_sampler(const SamplerInfo& in_create_info);
 
+	/**
+	 * Replace the bytecode of a shader, the handle and the pipeline shader stages referencing it stay valid
+	 * Only the cached pipelines using this shader are dropped, they are recreated the next time they are bound
+	 * \return Number of cached pipelines invalidated
+	 */
+	[[nodiscard]] cb::Result<size_t, Result> reload_shader(const ShaderHandle& in_shader, const ShaderInfo& in_create_info);
+
 	void destroy_buffer(const BufferHandle& in_buffer);
 	void destroy_texture(const TextureHandle& in_texture);
 	void destroy_texture_view(const TextureViewHandle& in_texture_view);
@@ -653,8 +1037,16 @@ public:
 	void destroy_semaphore(const SemaphoreHandle& in_semaphore);
 
 	cb::Result<void*, Result> map_buffer(const BufferHandle& in_handle);
+
+	/** Unmapping flushes the whole buffer */
 	void unmap_buffer(const BufferHandle& in_handle);
 
+	/** 
+	 * Make host writes to a range of a buffer that stays mapped visible to the GPU, 
+	 * required before the GPU reads memory that isn't host-coherent 
+	 */
+	void flush_buffer(const BufferHandle& in_handle, const uint64_t in_offset, const uint64_t in_size);
+
 	[[nodiscard]] CommandListHandle allocate_cmd_list(const QueueType& in_type);
 
 	void wait_for_fences(const std::span<FenceHandle>& in_fences, 
@@ -676,10 +1068,16 @@ public:
 		const uint32_t in_first_index, 
 		const int32_t in_vertex_offset, 
 		const uint32_t in_first_instance);
+	/** Move to the next subpass of the current pass, render pass state and descriptors stay bound */
+	void cmd_next_subpass(const CommandListHandle& in_cmd_list);
 	void cmd_end_render_pass(const CommandListHandle& in_cmd_list);
 	void cmd_bind_vertex_buffer(const CommandListHandle& in_cmd_list,
 		const BufferHandle& in_buffer,
 		const uint64_t in_offset);
+	void cmd_bind_vertex_buffers(const CommandListHandle& in_cmd_list,
+		const uint32_t in_first_binding,
+		const std::span<const BufferHandle>& in_buffers,
+		const std::span<const uint64_t>& in_offsets);
 	void cmd_bind_index_buffer(const CommandListHandle& in_cmd_list,
 		const BufferHandle& in_buffer,
 		const uint64_t in_offset,
@@ -693,6 +1091,42 @@ public:
 		const TextureHandle& in_dst_texture,
 		const TextureLayout in_dst_layout,
 		const std::span<BufferTextureCopyRegion>& in_regions);
+
+	/** 
+	 * Copy texture regions to a buffer, typically a GpuToCpu buffer read back once the frame completed
+	 * The texture must be in in_src_layout (TransferSrc)
+	 */
+	void cmd_copy_texture_to_buffer(const CommandListHandle& in_cmd_list,
+		const TextureHandle& in_src_texture,
+		const TextureLayout in_src_layout,
+		const BufferHandle& in_dst_buffer,
+		const std::span<BufferTextureCopyRegion>& in_regions);
+
+	/**
+	 * Copy in_area of in_aspect of the first mip and layer of in_texture (whole texture when empty) to the CPU 
+	 * without stalling. Depth and stencil are read back separately, see get_format_aspect_texel_size.
+	 * The texture must be in in_src_layout (TransferSrc). The returned request is ready, and in_callback called,
+	 * once the frame recording the copy retired: in the new_frame that reuses its slot or in wait_idle.
+	 * Typical uses are GPU picking (1x1 area), screenshots, auto-exposure and test captures.
+	 * Returns an invalid request if the format has no such aspect, its texel size is unknown (e.g. compressed formats)
+	 * or the staging buffer can't be created
+	 */
+	[[nodiscard]] ReadbackRequest cmd_readback_texture(const CommandListHandle& in_cmd_list,
+		const TextureHandle& in_texture,
+		const TextureLayout in_src_layout,
+		const TextureAspectFlagBits in_aspect,
+		ReadbackCallback in_callback = {},
+		const Rect2D& in_area = {});
+
+	/**
+	 * Copy in_size bytes of in_buffer from in_offset to the CPU without stalling, completed like cmd_readback_texture
+	 * in_buffer needs the TransferSrc usage and its previous writes must be made visible to transfers by the caller
+	 */
+	[[nodiscard]] ReadbackRequest cmd_readback_buffer(const CommandListHandle& in_cmd_list,
+		const BufferHandle& in_buffer,
+		const uint64_t in_offset,
+		const uint64_t in_size,
+		ReadbackCallback in_callback = {});
 	void cmd_texture_barrier(const CommandListHandle& in_cmd_list,
 		const TextureHandle& in_texture,
 		const PipelineStageFlags in_src_flags,
@@ -701,6 +1135,22 @@ public:
 		const PipelineStageFlags in_dst_flags,
 		const TextureLayout in_dst_layout,
 		const AccessFlags in_dst_access_flags);
+	void cmd_texture_barrier(const CommandListHandle& in_cmd_list,
+		const TextureHandle& in_texture,
+		const TextureSubresourceRange& in_subresource_range,
+		const PipelineStageFlags in_src_flags,
+		const TextureLayout in_src_layout,
+		const AccessFlags in_src_access_flags,
+		const PipelineStageFlags in_dst_flags,
+		const TextureLayout in_dst_layout,
+		const AccessFlags in_dst_access_flags);
+	void cmd_blit_texture(const CommandListHandle& in_cmd_list,
+		const TextureHandle& in_src_texture,
+		const TextureLayout in_src_layout,
+		const TextureHandle& in_dst_texture,
+		const TextureLayout in_dst_layout,
+		const std::span<TextureBlitRegion>& in_regions,
+		const Filter in_filter = Filter::Linear);
 
 	/** Pipeline management */
 	void cmd_bind_pipeline_layout(const CommandListHandle& in_cmd_list, const PipelineLayoutHandle& in_handle);
@@ -716,6 +1166,36 @@ public:
 	void cmd_bind_texture_view(const CommandListHandle& in_cmd_list, const uint32_t in_set, const uint32_t in_binding, 
 		const TextureViewHandle& in_handle);
 
+	/** The view must be an input attachment of the current subpass */
+	void cmd_bind_input_attachment(const CommandListHandle& in_cmd_list, const uint32_t in_set, const uint32_t in_binding, 
+		const TextureViewHandle& in_handle);
+
+	/** 
+	 * Bind by shader resource name, resolved through the binding table of the bound pipeline layout
+	 * (see PipelineLayoutInfo::set_binding_table)
+	 */
+	void cmd_bind_ubo(const CommandListHandle& in_cmd_list, const BindingName& in_name, const BufferHandle& in_handle);
+	void cmd_bind_sampler(const CommandListHandle& in_cmd_list, const BindingName& in_name, const SamplerHandle& in_handle);
+	void cmd_bind_texture_view(const CommandListHandle& in_cmd_list, const BindingName& in_name, 
+		const TextureViewHandle& in_handle);
+	void cmd_bind_input_attachment(const CommandListHandle& in_cmd_list, const BindingName& in_name, 
+		const TextureViewHandle& in_handle);
+
+	/** 
+	 * Push constants to the bound pipeline layout
+	 * With bindless, materials push the indices of their resources instead of binding descriptors
+	 */
+	void cmd_push_constants(const CommandListHandle& in_cmd_list, const ShaderStageFlags in_stages, const uint32_t in_offset,
+		const std::span<const uint8_t>& in_data);
+
+	template<typename T>
+		requires std::is_trivially_copyable_v<T>
+	void cmd_push_constants(const CommandListHandle& in_cmd_list, const ShaderStageFlags in_stages, const T& in_data,
+		const uint32_t in_offset = 0)
+	{
+		cmd_push_constants(in_cmd_list, in_stages, in_offset, { reinterpret_cast<const uint8_t*>(&in_data), sizeof(T) });
+	}
+
 	/** Swapchain */
 	Result acquire_swapchain_texture(const SwapchainHandle& in_swapchain,
 		const SemaphoreHandle& in_signal_semaphore = SemaphoreHandle());
@@ -723,6 +1203,8 @@ public:
 		const std::span<SemaphoreHandle>& in_wait_semaphores = {});
 	TextureViewHandle get_swapchain_backbuffer_view(const SwapchainHandle& in_swapchain) const;
 	BackendDeviceResource get_swapchain_backend_handle(const SwapchainHandle& in_swapchain) const;
+	[[nodiscard]] Format get_swapchain_format(const SwapchainHandle& in_swapchain) const;
+	[[nodiscard]] PresentMode get_swapchain_present_mode(const SwapchainHandle& in_swapchain) const;
 
 	template<typename T>
 	[[nodiscard]] static T* cast_handle(const auto& in_handle)
@@ -738,26 +1220,97 @@ public:
 		return Handle(reinterpret_cast<uint64_t>(in_resource));
 	}
 
-	static BackendDeviceResource get_backend_shader(const ShaderHandle& in_handle)
+	[[nodiscard]] static const TextureCreateInfo& get_texture_create_info(const TextureHandle& in_handle)
 	{
-		return cast_handle<detail::Shader>(in_handle)->get_resource();
+		return cast_handle<detail::Texture>(in_handle)->get_create_info();
 	}
 
 	[[nodiscard]] BackendDevice* get_backend_device() const { return backend_device.get(); }
+
+	/** Index of the frame being recorded, in [0, get_frames_in_flight()), used to ring per-frame resources */
+	[[nodiscard]] size_t get_current_frame_index() const { return current_frame; }
+	[[nodiscard]] uint32_t get_frames_in_flight() const { return static_cast<uint32_t>(frames.size()); }
+
+	/** Applied from the next new_frame */
+	void set_latency_mode(const LatencyMode in_mode) { latency_mode = in_mode; }
+	[[nodiscard]] LatencyMode get_latency_mode() const { return latency_mode; }
+
+	/** 
+	 * Bindless, enabled if the backend was created with BackendFlagBits::Bindless and the GPU supports it
+	 * Texture views created with set_bindless(true), samplers and storage buffers then get a stable index in the
+	 * global bindless set, invalid_bindless_index otherwise (or when the array is full)
+	 */
+	[[nodiscard]] bool is_bindless_enabled() const { return bindless_enabled; }
+	[[nodiscard]] static uint32_t get_bindless_index(const TextureViewHandle& in_handle)
+	{
+		return cast_handle<detail::TextureView>(in_handle)->get_bindless_index();
+	}
+	[[nodiscard]] static uint32_t get_bindless_index(const SamplerHandle& in_handle)
+	{
+		return cast_handle<detail::Sampler>(in_handle)->get_bindless_index();
+	}
+	[[nodiscard]] static uint32_t get_bindless_index(const BufferHandle& in_handle)
+	{
+		return cast_handle<detail::Buffer>(in_handle)->get_bindless_index();
+	}
+
+	/**
+	 * Dynamic rendering, when enabled cmd_begin_render_pass begins single-subpass passes without creating render passes
+	 * or framebuffers. Passes with several subpasses (e.g. to keep attachments on-chip on tile-based GPUs)
+	 * or input attachments still use render passes
+	 */
+	[[nodiscard]] bool is_dynamic_rendering_supported() const { return backend_device->supports_dynamic_rendering(); }
+	[[nodiscard]] bool is_dynamic_rendering_enabled() const { return dynamic_rendering_enabled; }
+	void set_dynamic_rendering_enabled(const bool in_enable)
+	{
+		dynamic_rendering_enabled = in_enable && is_dynamic_rendering_supported();
+	}
+
+	/** Pipelines are first linked from shared precompiled parts, then replaced by an optimized build */
+	[[nodiscard]] bool is_graphics_pipeline_library_supported() const
+	{
+		return backend_device->supports_graphics_pipeline_library();
+	}
+
+	/** State changes issued and filtered by all command lists submitted during the last frame */
+	[[nodiscard]] const CommandListStatistics& get_command_list_statistics() const { return command_list_statistics; }
 private:
 	void submit_queue(const QueueType& in_type);
+	void begin_rendering(detail::CommandList& in_list, const RenderPassInfo& in_info);
 	BackendDeviceResource get_or_create_render_pass(const RenderPassCreateInfo& in_create_info);
-	BackendDeviceResource get_or_create_pipeline(const GfxPipelineCreateInfo& in_create_info);
+	BackendDeviceResource get_or_create_pipeline(const detail::GfxPipelineKey& in_key);
 	
 	[[nodiscard]] Frame& get_current_frame() { return frames[current_frame]; }
+
+	/** A completed readback buffer of in_size bytes, or a new one. Null if it can't be created */
+	[[nodiscard]] BufferHandle acquire_readback_buffer(const uint64_t in_size);
+
+	/** Track a copy recorded to in_buffer, completed with the current frame */
+	[[nodiscard]] ReadbackRequest add_readback(const BufferHandle& in_buffer, const uint64_t in_size, 
+		ReadbackCallback in_callback);
+
+	/** Must only be called once the fences of in_frame are signaled */
+	void complete_readbacks(Frame& in_frame);
 private:
 	Backend& backend;
 	std::unique_ptr<BackendDevice> backend_device;
 	size_t current_frame;
 	std::vector<Frame> frames;
+	LatencyMode latency_mode;
+	CommandListStatistics command_list_statistics;
+
+	bool dynamic_rendering_enabled;
+	bool bindless_enabled;
+	detail::BindlessIndexAllocator bindless_texture_views;
+	detail::BindlessIndexAllocator bindless_samplers;
+	detail::BindlessIndexAllocator bindless_storage_buffers;
 
 	robin_hood::unordered_map<RenderPassCreateInfo, BackendDeviceResource> render_passes;
-	robin_hood::unordered_map<GfxPipelineCreateInfo, BackendDeviceResource> gfx_pipelines;
+	robin_hood::unordered_map<detail::GfxPipelineKey, BackendDeviceResource> gfx_pipelines;
+
+	/** Guards frame readbacks and the staging buffers of completed readbacks, reused for requests of the same size */
+	std::mutex readback_mutex;
+	std::vector<ReadbackBuffer> readback_buffers;
 	
 	/** Resources pools */
 	ThreadSafeSimplePool<detail::Buffer> buffers;
@@ -882,4 +1435,4 @@ CB_GFX_DECLARE_SMART_DEVICE_RESOURCE(Swapchain, swapchain, SwapchainHandle);
 CB_GFX_DECLARE_SMART_DEVICE_RESOURCE(Semaphore, semaphore, SemaphoreHandle);
 CB_GFX_DECLARE_SMART_DEVICE_RESOURCE(Sampler, sampler, SamplerHandle);
 
-}
\ No newline at end of file
+}
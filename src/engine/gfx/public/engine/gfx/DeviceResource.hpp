@@ -1,7 +1,9 @@
 #pragma once
 
 #include "engine/Core.hpp"
+#include <functional>
 #include <limits>
+#include <utility>
 
 namespace cb::gfx
 {
@@ -39,7 +41,7 @@ namespace detail
 template<DeviceResourceType Type>
 struct DeviceResource
 {
-	static constexpr uint64_t null = ~0Ui64;
+	static constexpr uint64_t null = ~0ull;
 
 	constexpr explicit DeviceResource(const uint64_t in_handle = null) noexcept : handle(in_handle) {}
 
@@ -87,6 +89,14 @@ using SamplerHandle = detail::DeviceResource<DeviceResourceType::Sampler>;
 namespace std
 {
 
+template<cb::gfx::DeviceResourceType Type> struct hash<cb::gfx::detail::DeviceResource<Type>>
+{
+	uint64_t operator()(const cb::gfx::detail::DeviceResource<Type>& in_handle) const noexcept
+	{
+		return std::hash<uint64_t>()(in_handle.get_handle());
+	}
+};
+
 inline std::string to_string(const cb::gfx::DeviceResourceType& in_type)
 {
 	switch(in_type)
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <cstdint>
 
 namespace cb::gfx
 {
@@ -75,8 +76,123 @@ enum class Format
     /** BC7 */
     Bc7UnormBlock,
     Bc7SrgbBlock,
+
+    /** 
+     * Compact vertex attribute formats
+     * Appended last as formats are serialized in cooked assets 
+     */
+
+    /** RGBA 16-bit (signed normalized) */
+    R16G16B16A16Snorm,
+
+    /** RG 16-bit (signed float) */
+    R16G16Sfloat,
+
+    /** RG 16-bit (signed normalized) */
+    R16G16Snorm,
+
+    /** ABGR 2-10-10-10-bit packed in 32-bit (signed normalized) */
+    A2B10G10R10SnormPack32,
 };
 
+/**
+ * Get the size in bytes of a single texel of the specified format
+ * \return Texel size, 0 for block-compressed or undefined formats
+ */
+inline uint32_t get_format_texel_size(const Format& in_format)
+{
+    switch(in_format)
+    {
+        case Format::R8Unorm:
+            return 1;
+        case Format::R8G8B8Unorm:
+            return 3;
+        case Format::R8G8B8A8Unorm:
+        case Format::R8G8B8A8Srgb:
+        case Format::B8G8R8A8Unorm:
+        case Format::R32Uint:
+        case Format::D32Sfloat:
+        case Format::D24UnormS8Uint:
+        case Format::R16G16Sfloat:
+        case Format::R16G16Snorm:
+        case Format::A2B10G10R10SnormPack32:
+            return 4;
+        case Format::D32SfloatS8Uint:
+            return 5;
+        case Format::R16G16B16A16Sfloat:
+        case Format::R16G16B16A16Snorm:
+        case Format::R32G32Sfloat:
+        case Format::R64Uint:
+            return 8;
+        case Format::R32G32B32Sfloat:
+            return 12;
+        case Format::R32G32B32A32Sfloat:
+        case Format::R32G32B32A32Uint:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * Is the format a block-compressed format (BCn)
+ */
+inline bool is_block_compressed_format(const Format& in_format)
+{
+    switch(in_format)
+    {
+        case Format::Bc1RgbUnormBlock:
+        case Format::Bc1RgbaUnormBlock:
+        case Format::Bc1RgbSrgbBlock:
+        case Format::Bc1RgbaSrgbBlock:
+        case Format::Bc3UnormBlock:
+        case Format::Bc3SrgbBlock:
+        case Format::Bc5UnormBlock:
+        case Format::Bc5SnormBlock:
+        case Format::Bc6HUfloatBlock:
+        case Format::Bc6HSfloatBlock:
+        case Format::Bc7UnormBlock:
+        case Format::Bc7SrgbBlock:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * Width/height in texels of a single block of the format, 1 for uncompressed formats
+ */
+inline uint32_t get_format_block_extent(const Format& in_format)
+{
+    return is_block_compressed_format(in_format) ? 4 : 1;
+}
+
+/**
+ * Size in bytes of a single block of the format, the texel size for uncompressed formats
+ */
+inline uint32_t get_format_block_size(const Format& in_format)
+{
+    switch(in_format)
+    {
+        case Format::Bc1RgbUnormBlock:
+        case Format::Bc1RgbaUnormBlock:
+        case Format::Bc1RgbSrgbBlock:
+        case Format::Bc1RgbaSrgbBlock:
+            return 8;
+        case Format::Bc3UnormBlock:
+        case Format::Bc3SrgbBlock:
+        case Format::Bc5UnormBlock:
+        case Format::Bc5SnormBlock:
+        case Format::Bc6HUfloatBlock:
+        case Format::Bc6HSfloatBlock:
+        case Format::Bc7UnormBlock:
+        case Format::Bc7SrgbBlock:
+            return 16;
+        default:
+            return get_format_texel_size(in_format);
+    }
+}
+
 inline std::string to_string(const Format& in_format)
 {
     switch(in_format)
@@ -136,6 +252,14 @@ inline std::string to_string(const Format& in_format)
             return "Bc6HUfloatBlock";
         case Format::Bc6HSfloatBlock:
             return "Bc6HSfloatBlock";
+        case Format::R16G16B16A16Snorm:
+            return "R16G16B16A16Snorm";
+        case Format::R16G16Sfloat:
+            return "R16G16Sfloat";
+        case Format::R16G16Snorm:
+            return "R16G16Snorm";
+        case Format::A2B10G10R10SnormPack32:
+            return "A2B10G10R10SnormPack32";
     }
 }
 }
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include "Format.hpp"
 #include "Texture.hpp"
 #include <span>
+#include <array>
+#include <algorithm>
 
 namespace cb::gfx
 {
@@ -14,6 +16,8 @@ enum class VertexInputRate
 	Instance
 };
 
+static constexpr uint32_t max_vertex_input_bindings = 16;
+
 	/**
  * Description of a vertex buffer input binding
  */
@@ -382,6 +386,29 @@ struct PipelineInputAssemblyStateCreateInfo
 	}
 };
 
+/**
+ * Attachment formats of a pass begun with dynamic rendering, they replace the render pass at pipeline creation
+ */
+struct PipelineRenderingFormats
+{
+	std::array<Format, max_attachments_per_framebuffer> color_formats;
+	uint32_t color_format_count;
+	Format depth_stencil_format;
+
+	PipelineRenderingFormats() : color_format_count(0), depth_stencil_format(Format::Undefined)
+	{
+		color_formats.fill(Format::Undefined);
+	}
+
+	[[nodiscard]] std::span<const Format> get_color_formats() const { return { color_formats.data(), color_format_count }; }
+
+	bool operator==(const PipelineRenderingFormats& in_other) const
+	{
+		return std::ranges::equal(get_color_formats(), in_other.get_color_formats()) &&
+			depth_stencil_format == in_other.depth_stencil_format;
+	}
+};
+
 struct GfxPipelineCreateInfo
 {
 	std::span<PipelineShaderStage> shader_stages;
@@ -397,6 +424,9 @@ struct GfxPipelineCreateInfo
 	/** Subpass where this pipeline will be used */
 	uint32_t subpass;
 
+	/** Used instead of render_pass/subpass when render_pass is null */
+	PipelineRenderingFormats rendering_formats;
+
 	GfxPipelineCreateInfo(const std::span<PipelineShaderStage>& in_shader_stages = {},
 		const PipelineVertexInputStateCreateInfo& in_vertex_input_state = PipelineVertexInputStateCreateInfo(),
 		const PipelineInputAssemblyStateCreateInfo& in_input_assembly_state = PipelineInputAssemblyStateCreateInfo(),
@@ -406,15 +436,18 @@ struct GfxPipelineCreateInfo
 		const PipelineColorBlendStateCreateInfo& in_color_blend_state = PipelineColorBlendStateCreateInfo(),
 		const BackendDeviceResource& in_pipeline_layout = BackendDeviceResource(),
 		const BackendDeviceResource& in_render_pass = BackendDeviceResource(),
-		const uint32_t& in_subpass = 0) :
+		const uint32_t& in_subpass = 0,
+		const PipelineRenderingFormats& in_rendering_formats = PipelineRenderingFormats()) :
 		shader_stages(in_shader_stages), vertex_input_state(in_vertex_input_state),
 		input_assembly_state(in_input_assembly_state), rasterization_state(in_rasterization_state),
 		multisampling_state(in_multisampling_state), depth_stencil_state(in_depth_stencil_state),
-		color_blend_state(in_color_blend_state), pipeline_layout(in_pipeline_layout), render_pass(in_render_pass), subpass(in_subpass) {}
+		color_blend_state(in_color_blend_state), pipeline_layout(in_pipeline_layout), render_pass(in_render_pass), subpass(in_subpass),
+		rendering_formats(in_rendering_formats) {}
 
 	bool operator==(const GfxPipelineCreateInfo& in_create_info) const
 	{
-		return shader_stages.data() == in_create_info.shader_stages.data() &&
+		/** Compared by value, stages sharing a module may differ only by their specialization constants */
+		return std::ranges::equal(shader_stages, in_create_info.shader_stages) &&
 			vertex_input_state == in_create_info.vertex_input_state &&
 			input_assembly_state == in_create_info.input_assembly_state &&
 			rasterization_state == in_create_info.rasterization_state &&
@@ -423,7 +456,8 @@ struct GfxPipelineCreateInfo
 			color_blend_state == in_create_info.color_blend_state &&
 			pipeline_layout == in_create_info.pipeline_layout &&
 			render_pass == in_create_info.render_pass &&
-			subpass == in_create_info.subpass;
+			subpass == in_create_info.subpass &&
+			rendering_formats == in_create_info.rendering_formats;
 	}
 };
 	
@@ -510,6 +544,7 @@ template<> struct hash<cb::gfx::PipelineRasterizationStateCreateInfo>
 		cb::hash_combine(hash, in_state.enable_depth_clamp);
 		cb::hash_combine(hash, in_state.polygon_mode);
 		cb::hash_combine(hash, in_state.cull_mode);
+		cb::hash_combine(hash, in_state.front_face);
 		cb::hash_combine(hash, in_state.enable_depth_bias);
 		cb::hash_combine(hash, in_state.depth_bias_constant_factor);
 		cb::hash_combine(hash, in_state.depth_bias_slope_factor);
@@ -554,6 +589,55 @@ template<> struct hash<cb::gfx::PipelineDepthStencilStateCreateInfo>
 	}
 };
 
+template<> struct hash<cb::gfx::PipelineColorBlendAttachmentState>
+{
+	uint64_t operator()(const cb::gfx::PipelineColorBlendAttachmentState& in_state) const noexcept
+	{
+		uint64_t hash = 0;
+
+		cb::hash_combine(hash, in_state.enable_blend);
+		cb::hash_combine(hash, in_state.src_color_blend_factor);
+		cb::hash_combine(hash, in_state.dst_color_blend_factor);
+		cb::hash_combine(hash, in_state.color_blend_op);
+		cb::hash_combine(hash, in_state.src_alpha_blend_factor);
+		cb::hash_combine(hash, in_state.dst_alpha_blend_factor);
+		cb::hash_combine(hash, in_state.alpha_blend_op);
+		cb::hash_combine(hash, in_state.color_write_flags);
+			
+		return hash;
+	}
+};
+
+template<> struct hash<cb::gfx::PipelineColorBlendStateCreateInfo>
+{
+	uint64_t operator()(const cb::gfx::PipelineColorBlendStateCreateInfo& in_state) const noexcept
+	{
+		uint64_t hash = 0;
+
+		cb::hash_combine(hash, in_state.enable_logic_op);
+		cb::hash_combine(hash, in_state.logic_op);
+		for(const auto& attachment : in_state.attachments)
+			cb::hash_combine(hash, attachment);
+			
+		return hash;
+	}
+};
+
+template<> struct hash<cb::gfx::PipelineRenderingFormats>
+{
+	uint64_t operator()(const cb::gfx::PipelineRenderingFormats& in_formats) const noexcept
+	{
+		uint64_t hash = 0;
+
+		for(const auto& format : in_formats.get_color_formats())
+			cb::hash_combine(hash, format);
+
+		cb::hash_combine(hash, in_formats.depth_stencil_format);
+			
+		return hash;
+	}
+};
+
 template<> struct hash<cb::gfx::GfxPipelineCreateInfo>
 {
 	uint64_t operator()(const cb::gfx::GfxPipelineCreateInfo& in_create_info) const noexcept
@@ -568,9 +652,11 @@ template<> struct hash<cb::gfx::GfxPipelineCreateInfo>
 		cb::hash_combine(hash, in_create_info.multisampling_state);
 		cb::hash_combine(hash, in_create_info.rasterization_state);
 		cb::hash_combine(hash, in_create_info.depth_stencil_state);
+		cb::hash_combine(hash, in_create_info.color_blend_state);
 		cb::hash_combine(hash, in_create_info.pipeline_layout);
 		cb::hash_combine(hash, in_create_info.render_pass);
 		cb::hash_combine(hash, in_create_info.subpass);
+		cb::hash_combine(hash, in_create_info.rendering_formats);
 
 		return hash;
 	}
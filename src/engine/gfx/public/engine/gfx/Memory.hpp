@@ -8,7 +8,13 @@ enum class MemoryUsage
 	CpuOnly,
 	GpuOnly,
 	CpuToGpu,
-	GpuToCpu
+	GpuToCpu,
+
+	/** 
+	 * Memory only committed if the GPU needs it (tile-based GPUs keep transient attachments on-chip)
+	 * Only valid for transient attachments, backends fall back to GpuOnly if no such memory exists
+	 */
+	GpuLazy
 };
 	
 }
\ No newline at end of file
@@ -4,6 +4,10 @@
 #include "engine/gfx/DeviceResource.hpp"
 #include "engine/Hash.hpp"
 #include "Texture.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <span>
 
 namespace cb::gfx
 {
@@ -42,27 +46,106 @@ enum class ShaderStageFlagBits
 CB_ENABLE_FLAG_ENUMS(ShaderStageFlagBits, ShaderStageFlags);
 	
 /**
- * A single shader stage of a pipeline
+ * Value of a specialization constant, declared in HLSL as:
+ *	[[vk::constant_id(0)]] const bool use_normal_map = false;
+ * Applied by the driver when the pipeline is created, so one SPIR-V module can be specialized into several pipelines
  */
-struct PipelineShaderStage
+struct SpecializationConstant
+{
+	uint32_t id;
+
+	/** 32-bit bool, int, uint or float */
+	uint32_t value;
+
+	SpecializationConstant(const uint32_t in_id = 0, const uint32_t in_value = 0) : id(in_id), value(in_value) {}
+
+	static SpecializationConstant make_bool(const uint32_t in_id, const bool in_value)
+	{
+		return SpecializationConstant(in_id, in_value ? 1 : 0);
+	}
+
+	static SpecializationConstant make_int(const uint32_t in_id, const int32_t in_value)
+	{
+		return SpecializationConstant(in_id, std::bit_cast<uint32_t>(in_value));
+	}
+
+	static SpecializationConstant make_float(const uint32_t in_id, const float in_value)
+	{
+		return SpecializationConstant(in_id, std::bit_cast<uint32_t>(in_value));
+	}
+
+	bool operator==(const SpecializationConstant& in_other) const
+	{
+		return id == in_other.id && value == in_other.value;
+	}
+};
+
+static constexpr uint32_t max_specialization_constants = 8;
+
+/**
+ * A single shader stage of a pipeline, TShader is what references the shader:
+ * - PipelineShaderStage: a backend shader module, what backends create pipelines from
+ * - MaterialShaderStage: a ShaderHandle, resolved to its current module when the device creates the pipeline,
+ *   so reloading the shader doesn't invalidate the stages using it
+ */
+template<typename TShader>
+struct BasicPipelineShaderStage
 {
 	ShaderStageFlagBits shader_stage;
-	BackendDeviceResource shader;
+	TShader shader;
 	const char* entry_point;
 
-	PipelineShaderStage(const ShaderStageFlagBits& in_shader_stage,
-		const BackendDeviceResource& in_shader,
-		const char* in_entry_point) : shader_stage(in_shader_stage),
-		shader(in_shader), entry_point(in_entry_point) {}
+	/** Stored inline so stages stay plain values, each combination creates its own pipeline */
+	std::array<SpecializationConstant, max_specialization_constants> specialization_constants;
+	uint32_t specialization_constant_count;
+
+	BasicPipelineShaderStage(const ShaderStageFlagBits& in_shader_stage,
+		const TShader& in_shader,
+		const char* in_entry_point,
+		const std::span<const SpecializationConstant>& in_specialization_constants = {}) : shader_stage(in_shader_stage),
+		shader(in_shader), entry_point(in_entry_point), specialization_constant_count(0)
+	{
+		for(const auto& constant : in_specialization_constants)
+			set_specialization_constant(constant);
+	}
+
+	/** Add a constant, or replace the value of the constant with the same id */
+	BasicPipelineShaderStage& set_specialization_constant(const SpecializationConstant& in_constant)
+	{
+		auto it = std::ranges::find(specialization_constants.begin(), 
+			specialization_constants.begin() + specialization_constant_count,
+			in_constant.id,
+			&SpecializationConstant::id);
+		if(it != specialization_constants.begin() + specialization_constant_count)
+		{
+			it->value = in_constant.value;
+			return *this;
+		}
+
+		CB_CHECKF(specialization_constant_count < max_specialization_constants, "Too many specialization constants");
+		if(specialization_constant_count < max_specialization_constants)
+			specialization_constants[specialization_constant_count++] = in_constant;
+
+		return *this;
+	}
 
-	bool operator==(const PipelineShaderStage& in_other) const
+	[[nodiscard]] std::span<const SpecializationConstant> get_specialization_constants() const
+	{
+		return { specialization_constants.data(), specialization_constant_count };
+	}
+
+	bool operator==(const BasicPipelineShaderStage& in_other) const
 	{
 		return shader_stage == in_other.shader_stage &&
 			shader == in_other.shader &&
-			entry_point == in_other.entry_point;
+			entry_point == in_other.entry_point &&
+			std::ranges::equal(get_specialization_constants(), in_other.get_specialization_constants());
 	}
 };
 
+using PipelineShaderStage = BasicPipelineShaderStage<BackendDeviceResource>;
+using MaterialShaderStage = BasicPipelineShaderStage<ShaderHandle>;
+
 enum class PipelineBindPoint
 {
 	Gfx,
@@ -85,6 +168,16 @@ struct Viewport
 		const float in_min_depth = 0.f,
 		const float in_max_depth = 1.f) : x(in_x), y(in_y),
 		width(in_width), height(in_height), min_depth(in_min_depth), max_depth(in_max_depth) {}
+
+	bool operator==(const Viewport& in_other) const
+	{
+		return x == in_other.x &&
+			y == in_other.y &&
+			width == in_other.width &&
+			height == in_other.height &&
+			min_depth == in_other.min_depth &&
+			max_depth == in_other.max_depth;
+	}
 };
 
 /** Barrier related structures */
@@ -102,8 +195,8 @@ enum class AccessFlagBits
 	ColorAttachmentWrite = 1 << 9,
 	DepthStencilAttachmentRead = 1 << 10,
 	DepthStencilAttachmentWrite = 1 << 11,
-	InputAttachmentRead = 1 << 11,
-	UniformRead = 1 << 12,
+	InputAttachmentRead = 1 << 12,
+	UniformRead = 1 << 13,
 };
 CB_ENABLE_FLAG_ENUMS(AccessFlagBits, AccessFlags);
 
@@ -132,9 +225,9 @@ struct TextureMemoryBarrier
 namespace std
 {
 
-template<> struct hash<cb::gfx::PipelineShaderStage>
+template<typename TShader> struct hash<cb::gfx::BasicPipelineShaderStage<TShader>>
 {
-	uint64_t operator()(const cb::gfx::PipelineShaderStage& in_stage) const noexcept
+	uint64_t operator()(const cb::gfx::BasicPipelineShaderStage<TShader>& in_stage) const noexcept
 	{
 		uint64_t hash = 0;
 
@@ -142,6 +235,12 @@ template<> struct hash<cb::gfx::PipelineShaderStage>
 		cb::hash_combine(hash, in_stage.shader);
 		cb::hash_combine(hash, in_stage.entry_point);
 
+		for(const auto& constant : in_stage.get_specialization_constants())
+		{
+			cb::hash_combine(hash, constant.id);
+			cb::hash_combine(hash, constant.value);
+		}
+
 		return hash;
 	}
 };	
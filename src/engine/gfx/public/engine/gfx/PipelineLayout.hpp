@@ -2,6 +2,10 @@
 
 #include <span>
 #include <variant>
+#include <limits>
+#include <string_view>
+#include <robin_hood.h>
+#include "engine/Hash.hpp"
 #include "Pipeline.hpp"
 #include "Texture.hpp"
 
@@ -61,6 +65,13 @@ struct DescriptorBufferInfo
 		const uint64_t in_range) : handle(in_handle),
 		offset(in_offset),
 		range(in_range) {}
+
+	bool operator==(const DescriptorBufferInfo& in_other) const
+	{
+		return handle == in_other.handle &&
+			offset == in_other.offset &&
+			range == in_other.range;
+	}
 };
 
 struct DescriptorTextureInfo
@@ -71,6 +82,12 @@ struct DescriptorTextureInfo
 	DescriptorTextureInfo(const BackendDeviceResource in_texture_view,
 		const TextureLayout in_layout) : texture_view(in_texture_view),
 		layout(in_layout) {}
+
+	bool operator==(const DescriptorTextureInfo& in_other) const
+	{
+		return texture_view == in_other.texture_view &&
+			layout == in_other.layout;
+	}
 };
 
 struct DescriptorSamplerInfo
@@ -78,6 +95,11 @@ struct DescriptorSamplerInfo
 	BackendDeviceResource sampler;
 
 	DescriptorSamplerInfo(const BackendDeviceResource in_sampler) : sampler(in_sampler) {}
+
+	bool operator==(const DescriptorSamplerInfo& in_other) const
+	{
+		return sampler == in_other.sampler;
+	}
 };
 
 struct Descriptor
@@ -120,6 +142,18 @@ struct Descriptor
 		return descriptor;
 	}
 
+	/** Attachment written by a previous subpass, read at the current pixel */
+	static Descriptor make_input_attachment_info(const uint32_t in_binding,
+		const BackendDeviceResource in_view,
+		const TextureLayout in_layout = TextureLayout::ShaderReadOnly)
+	{
+		Descriptor descriptor;
+		descriptor.type = DescriptorType::InputAttachment;
+		descriptor.binding = in_binding;
+		descriptor.info = DescriptorTextureInfo(in_view, in_layout);
+		return descriptor;
+	}
+
 	static Descriptor make_sampler_info(const uint32_t in_binding,
 		const BackendDeviceResource in_sampler)
 	{
@@ -129,21 +163,82 @@ struct Descriptor
 		descriptor.info = DescriptorSamplerInfo(in_sampler);
 		return descriptor;
 	}
+
+	bool operator==(const Descriptor& in_other) const
+	{
+		return type == in_other.type &&
+			binding == in_other.binding &&
+			info == in_other.info;
+	}
+};
+
+/**
+ * Hashed name of a shader resource, hash it once (e.g. in a constexpr variable) and bind by name in O(1)
+ */
+struct BindingName
+{
+	uint64_t hash;
+
+	/** For error messages, only valid as long as the string it was built from */
+	std::string_view name;
+
+	constexpr BindingName(const std::string_view& in_name) : hash(fnv1a_64(in_name)), name(in_name) {}
+	constexpr BindingName(const char* in_name) : hash(fnv1a_64(in_name)), name(in_name) {}
+
+	bool operator==(const BindingName& in_other) const { return hash == in_other.hash; }
+};
+
+/**
+ * Where a named resource is bound in a pipeline layout
+ */
+struct BindingSlot
+{
+	uint32_t set;
+	uint32_t binding;
+	DescriptorType type;
+
+	BindingSlot(const uint32_t in_set = 0,
+		const uint32_t in_binding = 0,
+		const DescriptorType in_type = DescriptorType::UniformBuffer) : set(in_set), binding(in_binding), type(in_type) {}
 };
 
+/** Binding name hash to slot */
+using BindingTable = robin_hood::unordered_flat_map<uint64_t, BindingSlot>;
+
 struct PipelineLayoutCreateInfo
 {
 	std::span<DescriptorSetLayoutCreateInfo> set_layouts;
 	std::span<PushConstantRange> push_constant_ranges;
 
+	/** Append the global bindless set at bindless_descriptor_set, set_layouts must not reach it */
+	bool bindless;
+
 	PipelineLayoutCreateInfo(const std::span<DescriptorSetLayoutCreateInfo>& in_set_layouts,
-		const std::span<PushConstantRange>& in_push_constant_ranges = {}) : set_layouts(in_set_layouts),
-	push_constant_ranges(in_push_constant_ranges) {}
+		const std::span<PushConstantRange>& in_push_constant_ranges = {},
+		const bool in_bindless = false) : set_layouts(in_set_layouts),
+	push_constant_ranges(in_push_constant_ranges), bindless(in_bindless) {}
 };
 
 static constexpr int max_descriptor_sets = 4;
 static constexpr int max_bindings = 16;
 
+/**
+ * Bindless resource model
+ * A single global update-after-bind set holds every sampled texture view, sampler and storage buffer,
+ * shaders index the arrays with the 32-bit indices handed out by the Device (usually pushed as constants):
+ *	[[vk::binding(0, 3)]] Texture2D textures[];
+ *	[[vk::binding(1, 3)]] SamplerState samplers[];
+ *	[[vk::binding(2, 3)]] ByteAddressBuffer buffers[];
+ */
+static constexpr uint32_t bindless_descriptor_set = max_descriptor_sets - 1;
+static constexpr uint32_t bindless_texture_views_binding = 0;
+static constexpr uint32_t bindless_samplers_binding = 1;
+static constexpr uint32_t bindless_storage_buffers_binding = 2;
+static constexpr uint32_t max_bindless_texture_views = 1 << 16;
+static constexpr uint32_t max_bindless_samplers = 1 << 10;
+static constexpr uint32_t max_bindless_storage_buffers = 1 << 16;
+static constexpr uint32_t invalid_bindless_index = std::numeric_limits<uint32_t>::max();
+
 }
 
 namespace std
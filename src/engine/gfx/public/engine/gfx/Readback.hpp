@@ -0,0 +1,57 @@
+#pragma once
+
+#include "engine/Core.hpp"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace cb::gfx
+{
+
+class Device;
+
+/** Called with the read back data once the GPU copy completed, from the thread calling Device::new_frame/wait_idle */
+using ReadbackCallback = std::function<void(std::span<const uint8_t>)>;
+
+namespace detail
+{
+
+struct ReadbackState
+{
+	std::atomic<bool> ready = false;
+	std::vector<uint8_t> data;
+	ReadbackCallback callback;
+};
+
+}
+
+/**
+ * Handle to data copied from the GPU, completed once the frame that recorded the copy retired
+ * Polling never blocks, copies of a request share the same data
+ */
+class ReadbackRequest
+{
+	friend class Device;
+
+public:
+	ReadbackRequest() = default;
+
+	[[nodiscard]] bool is_valid() const { return state != nullptr; }
+	[[nodiscard]] bool is_ready() const { return state && state->ready.load(std::memory_order_acquire); }
+
+	/** Empty until the request is ready */
+	[[nodiscard]] std::span<const uint8_t> get_data() const
+	{
+		return is_ready() ? std::span<const uint8_t>(state->data) : std::span<const uint8_t>();
+	}
+
+	explicit operator bool() const { return is_valid(); }
+private:
+	explicit ReadbackRequest(std::shared_ptr<detail::ReadbackState> in_state) : state(std::move(in_state)) {}
+private:
+	std::shared_ptr<detail::ReadbackState> state;
+};
+
+}
@@ -14,6 +14,14 @@ struct Rect2D
 		const int32_t in_y = 0,
 		const uint32_t in_width = 0,
 		const uint32_t in_height = 0) : x(in_x), y(in_y), width(in_width), height(in_height) {}
+
+	bool operator==(const Rect2D& in_other) const
+	{
+		return x == in_other.x &&
+			y == in_other.y &&
+			width == in_other.width &&
+			height == in_other.height;
+	}
 };
 
 }
\ No newline at end of file
@@ -2,6 +2,9 @@
 
 #include "engine/Hash.hpp"
 #include "Texture.hpp"
+#include "Pipeline.hpp"
+#include "Rect.hpp"
+#include <span>
 #include <array>
 #include <variant>
 #include <algorithm>
@@ -23,6 +26,36 @@ enum class AttachmentStoreOp
 	DontCare
 };
 
+/** 
+ * Load/store operations of an attachment for a whole pass
+ * Attachments not read after the pass should use AttachmentStoreOp::DontCare to save bandwidth
+ */
+struct AttachmentOps
+{
+	AttachmentLoadOp load_op;
+	AttachmentStoreOp store_op;
+
+	/** Only used by depth-stencil formats with a stencil aspect */
+	AttachmentLoadOp stencil_load_op;
+	AttachmentStoreOp stencil_store_op;
+
+	AttachmentOps(const AttachmentLoadOp in_load_op = AttachmentLoadOp::DontCare,
+		const AttachmentStoreOp in_store_op = AttachmentStoreOp::DontCare,
+		const AttachmentLoadOp in_stencil_load_op = AttachmentLoadOp::DontCare,
+		const AttachmentStoreOp in_stencil_store_op = AttachmentStoreOp::DontCare) : load_op(in_load_op),
+		store_op(in_store_op), stencil_load_op(in_stencil_load_op), stencil_store_op(in_stencil_store_op) {}
+
+	[[nodiscard]] bool is_loaded() const
+	{
+		return load_op == AttachmentLoadOp::Load || stencil_load_op == AttachmentLoadOp::Load;
+	}
+
+	[[nodiscard]] bool is_stored() const
+	{
+		return store_op == AttachmentStoreOp::Store || stencil_store_op == AttachmentStoreOp::Store;
+	}
+};
+
 /** Description of an attachment */
 struct AttachmentDescription
 {
@@ -65,7 +98,7 @@ struct AttachmentDescription
  */
 struct AttachmentReference
 {
-	static constexpr uint32_t unused_attachment = ~0Ui32;
+	static constexpr uint32_t unused_attachment = ~0u;
 
 	/** Index of the attachment (mirror RenderPassCreateInfo::attachments) */
 	uint32_t attachment;
@@ -112,19 +145,59 @@ struct SubpassDescription
 	}
 };
 
+/**
+ * Execution and memory dependency between two subpasses
+ * Dependencies are always by region: a subpass only reads what previous subpasses wrote at the same pixel,
+ * which lets tile-based GPUs keep attachments on chip between subpasses
+ */
+struct SubpassDependency
+{
+	/** Commands recorded before or after the render pass */
+	static constexpr uint32_t external_subpass = ~0u;
+
+	uint32_t src_subpass;
+	uint32_t dst_subpass;
+	PipelineStageFlags src_stage_mask;
+	PipelineStageFlags dst_stage_mask;
+	AccessFlags src_access_mask;
+	AccessFlags dst_access_mask;
+
+	SubpassDependency(const uint32_t in_src_subpass,
+		const uint32_t in_dst_subpass,
+		const PipelineStageFlags& in_src_stage_mask = PipelineStageFlags(),
+		const PipelineStageFlags& in_dst_stage_mask = PipelineStageFlags(),
+		const AccessFlags& in_src_access_mask = AccessFlags(),
+		const AccessFlags& in_dst_access_mask = AccessFlags()) : src_subpass(in_src_subpass),
+		dst_subpass(in_dst_subpass), src_stage_mask(in_src_stage_mask), dst_stage_mask(in_dst_stage_mask),
+		src_access_mask(in_src_access_mask), dst_access_mask(in_dst_access_mask) {}
+
+	bool operator==(const SubpassDependency& in_dependency) const
+	{
+		return src_subpass == in_dependency.src_subpass &&
+			dst_subpass == in_dependency.dst_subpass &&
+			src_stage_mask == in_dependency.src_stage_mask &&
+			dst_stage_mask == in_dependency.dst_stage_mask &&
+			src_access_mask == in_dependency.src_access_mask &&
+			dst_access_mask == in_dependency.dst_access_mask;
+	}
+};
+
 struct RenderPassCreateInfo
 {
 	std::vector<AttachmentDescription> attachments;
 	std::vector<SubpassDescription> subpasses;
+	std::vector<SubpassDependency> dependencies;
 
 	RenderPassCreateInfo(const std::vector<AttachmentDescription>& in_attachments,
-		const std::vector<SubpassDescription>& in_subpasses) : attachments(in_attachments),
-		subpasses(in_subpasses) {}
+		const std::vector<SubpassDescription>& in_subpasses,
+		const std::vector<SubpassDependency>& in_dependencies = {}) : attachments(in_attachments),
+		subpasses(in_subpasses), dependencies(in_dependencies) {}
 
 	bool operator==(const RenderPassCreateInfo& in_info) const
 	{
 		return attachments == in_info.attachments &&
-			subpasses == in_info.subpasses;
+			subpasses == in_info.subpasses &&
+			dependencies == in_info.dependencies;
 	}
 };
 
@@ -180,6 +253,44 @@ struct Framebuffer
 			height == other.height;
 	}
 };
+
+/**
+ * Attachment of a dynamic rendering pass
+ * The texture must already be in layout when the pass begins, the backend performs no transition
+ */
+struct RenderingAttachmentInfo
+{
+	BackendDeviceResource texture_view;
+	TextureLayout layout;
+	AttachmentLoadOp load_op;
+	AttachmentStoreOp store_op;
+	ClearValue clear_value;
+
+	/** Single-sampled view the attachment samples are averaged to at the end of the pass, unused if null */
+	BackendDeviceResource resolve_texture_view;
+	TextureLayout resolve_layout;
+
+	RenderingAttachmentInfo(const BackendDeviceResource& in_texture_view = null_backend_resource,
+		const TextureLayout in_layout = TextureLayout::Undefined,
+		const AttachmentLoadOp in_load_op = AttachmentLoadOp::DontCare,
+		const AttachmentStoreOp in_store_op = AttachmentStoreOp::DontCare,
+		const ClearValue& in_clear_value = ClearValue(ClearColorValue({ 0.f, 0.f, 0.f, 0.f }))) :
+		texture_view(in_texture_view), layout(in_layout), load_op(in_load_op), store_op(in_store_op),
+		clear_value(in_clear_value), resolve_texture_view(null_backend_resource), resolve_layout(TextureLayout::Undefined) {}
+};
+
+/**
+ * A single-subpass pass begun without render pass or framebuffer objects
+ */
+struct RenderingInfo
+{
+	Rect2D render_area;
+	std::span<const RenderingAttachmentInfo> color_attachments;
+
+	/** Unused if their texture view is null, both point to the same view for combined depth-stencil formats */
+	RenderingAttachmentInfo depth_attachment;
+	RenderingAttachmentInfo stencil_attachment;
+};
 	
 }
 
@@ -231,13 +342,28 @@ template<> struct hash<cb::gfx::SubpassDescription>
 
 		cb::hash_combine(hash, in_subpass.depth_stencil_attachment);
 
-		for(const auto& attachment : in_subpass.resolve_attachments)
+		for(const auto& attachment : in_subpass.preserve_attachments)
 			cb::hash_combine(hash, attachment);
 
 		return hash;
 	}
 };
 
+template<> struct hash<cb::gfx::SubpassDependency>
+{
+	uint64_t operator()(const cb::gfx::SubpassDependency& in_dependency) const noexcept
+	{
+		uint64_t hash = 0;
+		cb::hash_combine(hash, in_dependency.src_subpass);
+		cb::hash_combine(hash, in_dependency.dst_subpass);
+		cb::hash_combine(hash, in_dependency.src_stage_mask);
+		cb::hash_combine(hash, in_dependency.dst_stage_mask);
+		cb::hash_combine(hash, in_dependency.src_access_mask);
+		cb::hash_combine(hash, in_dependency.dst_access_mask);
+		return hash;
+	}
+};
+
 template<> struct hash<cb::gfx::RenderPassCreateInfo>
 {
 	uint64_t operator()(const cb::gfx::RenderPassCreateInfo& in_create_info) const noexcept
@@ -248,6 +374,9 @@ template<> struct hash<cb::gfx::RenderPassCreateInfo>
 
 		for(const auto& subpass : in_create_info.subpasses)
 			cb::hash_combine(hash, subpass);
+
+		for(const auto& dependency : in_create_info.dependencies)
+			cb::hash_combine(hash, dependency);
 		
 		return hash;
 	}
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <string_view>
+#include <fmt/format.h>
+
 namespace cb::gfx
 {
 
@@ -18,4 +21,38 @@ enum class Result
 	ErrorInitializationFailed = -5,
 };
 
-}
\ No newline at end of file
+inline std::string_view to_string(Result in_result)
+{
+	switch(in_result)
+	{
+	case Result::Success:
+		return "Success";
+	case Result::Timeout:
+		return "Timeout";
+	case Result::ErrorUnknown:
+		return "ErrorUnknown";
+	case Result::ErrorOutOfDeviceMemory:
+		return "ErrorOutOfDeviceMemory";
+	case Result::ErrorOutOfHostMemory:
+		return "ErrorOutOfHostMemory";
+	case Result::ErrorInvalidParameter:
+		return "ErrorInvalidParameter";
+	case Result::ErrorInitializationFailed:
+		return "ErrorInitializationFailed";
+	}
+
+	return "Invalid";
+}
+
+}
+
+/** Scoped enums aren't formattable by fmt, log results by name */
+template<>
+struct fmt::formatter<cb::gfx::Result> : fmt::formatter<std::string_view>
+{
+	template<typename FormatContext>
+	auto format(cb::gfx::Result in_result, FormatContext& in_context) const
+	{
+		return fmt::formatter<std::string_view>::format(cb::gfx::to_string(in_result), in_context);
+	}
+};
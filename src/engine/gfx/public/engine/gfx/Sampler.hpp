@@ -17,6 +17,9 @@ enum class SamplerAddressMode
 	ClampToBorder
 };
 
+/** Max LOD value that doesn't clamp any mip level */
+static constexpr float lod_clamp_none = 1000.f;
+
 struct SamplerCreateInfo
 {
 	Filter min_filter;
@@ -44,7 +47,7 @@ struct SamplerCreateInfo
 		const bool in_enable_aniostropy = false,
 		const float in_max_anisotropy = 0.f,
 		const float in_min_lod = 0.f,
-		const float in_max_lod = 0.f) :
+		const float in_max_lod = lod_clamp_none) :
 		min_filter(in_min_filter), mag_filter(in_mag_filter),
 		mip_map_mode(in_mip_map_mode), address_mode_u(in_address_mode_u),
 		address_mode_v(in_address_mode_v), address_mode_w(in_address_mode_w),
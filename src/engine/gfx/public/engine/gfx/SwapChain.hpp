@@ -1,22 +1,92 @@
 #pragma once
 
 #include "engine/Core.hpp"
+#include <string>
 
 namespace cb::gfx
 {
 
+/**
+ * How presented images are queued to the display
+ * Unsupported modes fall back to the closest supported one, Fifo is always supported
+ */
+enum class PresentMode
+{
+	/** V-Sync, presents wait for the next vertical blank */
+	Fifo,
+
+	/** V-Sync, but a late image is presented right away and may tear. Falls back to Fifo */
+	FifoRelaxed,
+
+	/** No tearing, a new image replaces the one waiting for the vertical blank. Falls back to Fifo */
+	Mailbox,
+
+	/** No V-Sync, images are presented right away and may tear. Falls back to Mailbox then Fifo */
+	Immediate,
+};
+
+enum class WindowSystem
+{
+	Win32,
+	Xlib,
+	Xcb,
+	Wayland,
+
+	/** No window, images are presented nowhere. Requires a backend created with BackendFlagBits::Headless */
+	Headless,
+};
+
+/**
+ * OS handles of the window a swapchain presents to
+ * Win32: window is the HWND. Xlib: Display* and Window. Xcb: xcb_connection_t* and xcb_window_t.
+ * Wayland: wl_display* and wl_surface*. X11 window ids are stored in the pointer value
+ */
+struct NativeWindowHandle
+{
+	WindowSystem system;
+	void* display;
+	void* window;
+
+	NativeWindowHandle(const WindowSystem in_system = WindowSystem::Headless,
+		void* in_display = nullptr,
+		void* in_window = nullptr) : system(in_system), display(in_display), window(in_window) {}
+};
+
 struct SwapChainCreateInfo
 {
-	void* os_handle;
+	NativeWindowHandle window;
 	uint32_t width;
 	uint32_t height;
 	BackendDeviceResource old_swapchain;
+	PresentMode present_mode;
 
-	SwapChainCreateInfo(void* in_window_handle = nullptr,
+	SwapChainCreateInfo(const NativeWindowHandle& in_window = {},
 		const uint32_t& in_width = 0,
 		const uint32_t& in_height = 0,
-		const BackendDeviceResource in_old_swapchain = {}) : os_handle(in_window_handle),
-		width(in_width), height(in_height), old_swapchain(in_old_swapchain) {}
+		const BackendDeviceResource in_old_swapchain = {},
+		const PresentMode in_present_mode = PresentMode::Fifo) : window(in_window),
+		width(in_width), height(in_height), old_swapchain(in_old_swapchain), present_mode(in_present_mode) {}
 };
 	
-}
\ No newline at end of file
+}
+
+namespace std
+{
+
+inline std::string to_string(const cb::gfx::PresentMode& in_present_mode)
+{
+	switch(in_present_mode)
+	{
+	default:
+	case cb::gfx::PresentMode::Fifo:
+		return "Fifo";
+	case cb::gfx::PresentMode::FifoRelaxed:
+		return "FifoRelaxed";
+	case cb::gfx::PresentMode::Mailbox:
+		return "Mailbox";
+	case cb::gfx::PresentMode::Immediate:
+		return "Immediate";
+	}
+}
+
+}
@@ -5,6 +5,7 @@
 #include "Memory.hpp"
 #include "Format.hpp"
 #include "DeviceResource.hpp"
+#include <algorithm>
 
 namespace cb::gfx
 {
@@ -50,6 +51,12 @@ enum class TextureUsageFlagBits
 	Sampled = 1 << 2,
 	TransferSrc = 1 << 3,
 	TransferDst = 1 << 4,
+
+	/** Attachment whose contents never leave a render pass, must not be loaded or stored */
+	TransientAttachment = 1 << 5,
+
+	/** Attachment read by a later subpass of the same render pass */
+	InputAttachment = 1 << 6,
 };
 CB_ENABLE_FLAG_ENUMS(TextureUsageFlagBits, TextureUsageFlags);
 	
@@ -108,6 +115,15 @@ struct TextureSubresourceLayers
 		base_array_layer(in_base_array_layer),
 		layer_count(in_layer_count) {}
 };
+
+/**
+ * Location of a mip level (every array layer) in texture initial data
+ */
+struct TextureMipData
+{
+	uint64_t offset;
+	uint64_t size;
+};
 	
 struct TextureCreateInfo
 {
@@ -167,5 +183,66 @@ inline TextureAspectFlags format_to_aspect_flags(Format in_format)
 		return TextureAspectFlags(TextureAspectFlagBits::Color);
 	}
 }
+
+/**
+ * Size of a texel of a single aspect of in_format once copied to a buffer, 0 if the format has no such aspect
+ * Depth and stencil are copied separately: depth is 4 bytes (D24 is padded), stencil is 1 byte
+ */
+inline uint32_t get_format_aspect_texel_size(const Format in_format, const TextureAspectFlagBits in_aspect)
+{
+	if(!(format_to_aspect_flags(in_format) & in_aspect))
+		return 0;
+
+	switch(in_aspect)
+	{
+	case TextureAspectFlagBits::Depth:
+		return 4;
+	case TextureAspectFlagBits::Stencil:
+		return 1;
+	default:
+		return get_format_texel_size(in_format);
+	}
+}
+
+/**
+ * Number of mip levels of a full mip chain (down to 1x1x1)
+ */
+inline uint32_t get_mip_chain_length(const uint32_t in_width, 
+	const uint32_t in_height = 1, 
+	const uint32_t in_depth = 1)
+{
+	uint32_t size = std::max({ in_width, in_height, in_depth });
+	uint32_t levels = 1;
+	while(size > 1)
+	{
+		size >>= 1;
+		levels++;
+	}
+
+	return levels;
+}
+
+/**
+ * Size of a dimension at the specified mip level
+ */
+inline uint32_t get_mip_dimension(const uint32_t in_size, const uint32_t in_mip_level)
+{
+	return std::max<uint32_t>(in_size >> in_mip_level, 1);
+}
+
+/**
+ * Size in bytes of a tightly packed mip level (rows rounded up to whole blocks for block-compressed formats)
+ */
+inline uint64_t get_mip_level_size(const Format in_format,
+	const uint32_t in_width,
+	const uint32_t in_height,
+	const uint32_t in_depth,
+	const uint32_t in_mip_level)
+{
+	const uint32_t block_extent = get_format_block_extent(in_format);
+	const uint64_t blocks_x = (get_mip_dimension(in_width, in_mip_level) + block_extent - 1) / block_extent;
+	const uint64_t blocks_y = (get_mip_dimension(in_height, in_mip_level) + block_extent - 1) / block_extent;
+	return blocks_x * blocks_y * get_mip_dimension(in_depth, in_mip_level) * get_format_block_size(in_format);
+}
 	
 }
\ No newline at end of file
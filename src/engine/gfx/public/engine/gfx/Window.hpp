@@ -3,6 +3,7 @@
 #include "engine/Core.hpp"
 #include "engine/Flags.hpp"
 #include "engine/MulticastDelegate.hpp"
+#include "engine/gfx/SwapChain.hpp"
 
 struct GLFWwindow;
 
@@ -12,7 +13,10 @@ namespace cb
 enum class WindowFlagBits
 {
 	/** Center the window on the primary monitor */
-	Centered = 1 << 0	
+	Centered = 1 << 0,
+
+	/** No OS window is created, get_handle() is null and the native handle is WindowSystem::Headless */
+	Headless = 1 << 1,
 };
 CB_ENABLE_FLAG_ENUMS(WindowFlagBits, WindowFlags);
 	
@@ -36,7 +40,7 @@ public:
 	Window& operator=(Window&&) noexcept = default;
 
 	[[nodiscard]] GLFWwindow* get_handle() const { return window; }
-	[[nodiscard]] void* get_native_handle() const;
+	[[nodiscard]] gfx::NativeWindowHandle get_native_handle() const;
 	[[nodiscard]] auto& get_window_resized() { return window_resized_delegate; }
 	[[nodiscard]] uint32_t get_width() const { return width; }
 	[[nodiscard]] uint32_t get_height() const { return height; }
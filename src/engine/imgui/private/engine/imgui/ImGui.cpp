@@ -1,11 +1,4 @@
 #include "engine/imgui/ImGui.hpp"
-#include <Unknwn.h>
-#include <dxcapi.h>
-#include <fstream>
-#if CB_PLATFORM(WINDOWS)
-#define WIN32_LEAN_AND_MEAN
-#include <Windows.h>
-#endif
 #include <glm/glm.hpp>
 
 namespace cb::ui
@@ -31,7 +24,7 @@ TextureViewHandle font_texture_view;
 ShaderHandle vertex_shader;
 ShaderHandle fragment_shader;
 PipelineLayoutHandle pipeline_layout;
-std::vector<PipelineShaderStage> shader_stages;
+std::vector<MaterialShaderStage> shader_stages;
 PipelineRenderPassState render_pass_state;
 PipelineMaterialState material_state;
 std::array color_blend_states = { PipelineColorBlendAttachmentState(
@@ -44,74 +37,13 @@ std::array color_blend_states = { PipelineColorBlendAttachmentState(
 	BlendOp::Add) };
 ImDrawData* draw_data = nullptr;
 
-/** Shader compiling eco+ */
-std::vector<uint8_t> compile_shader(bool in_vs, std::vector<uint8_t> in_source)
-{
-	cb::logger::info("Compiling shader");
-
-	std::vector<LPCWSTR> args =
-	{
-		L"-E main", L" ",
-		L"-Qstrip_debug", L" ",
-		L"-Qstrip_reflect", L" ",
-		L"-spirv", L" ",
-		L"-WX", L" ",
-		L"-Zpr", L" ",
-	};
-
-	if(in_vs)
-		args.emplace_back(L"-T vs_6_0");
-	else
-		args.emplace_back(L"-T ps_6_0");
-
-	IDxcCompiler3* compiler = nullptr;
-	DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(&compiler));
-
-	IDxcUtils* utils = nullptr;
-	DxcCreateInstance(CLSID_DxcUtils, IID_PPV_ARGS(&utils));
+/** Resource names of imgui_vs.hlsl/imgui_fs.hlsl */
+constexpr BindingName global_data_binding = "GlobalData";
+constexpr BindingName texture_sampler_binding = "texture_sampler";
+constexpr BindingName texture_binding = "texture";
 
-	IDxcBlobEncoding* blob = nullptr;
-	DxcBuffer buffer { in_source.data(), in_source.size(), DXC_CP_UTF8 };
-	IDxcResult* result = nullptr;
-	HRESULT hr = compiler->Compile(&buffer, args.data(), args.size(), nullptr, IID_PPV_ARGS(&result));
-	
-	std::vector<uint8_t> ret;
-
-	IDxcBlobUtf8* errors;
-	result->GetOutput(DXC_OUT_ERRORS, IID_PPV_ARGS(&errors), nullptr);
-	if(errors && errors->GetStringLength() > 0)
-		cb::logger::fatal("Shader compiling error: {}", errors->GetStringPointer());
-
-	IDxcBlob* bytecode;
-	result->GetOutput(DXC_OUT_OBJECT, IID_PPV_ARGS(&bytecode), nullptr);
-	if(bytecode)
-		ret = { (uint8_t*) bytecode->GetBufferPointer(),
-		(uint8_t*) bytecode->GetBufferPointer() + bytecode->GetBufferSize() };
-
-	result->Release();
-	utils->Release();
-
-	if(blob)
-		blob->Release();
-	compiler->Release();
-
-	return ret;
-}
-std::vector<uint8_t> read_text_file(const std::string& in_name)
-{
-	std::ifstream file(in_name, std::ios::ate | std::ios::binary);
-
-	const size_t file_size = file.tellg();
-	
-	std::vector<uint8_t> buffer(file_size);
-	file.seekg(0);
-	file.read((char*) buffer.data(), file_size);
-	file.close();
-
-	return buffer;
-}
-
-void initialize_imgui()
+void initialize_imgui(shadercompiler::ShaderCompiler& in_shader_compiler,
+	shadercompiler::PipelineLayoutCache& in_layout_cache)
 {
 	ImGuiIO& io = ImGui::GetIO();
 	io.Fonts->AddFontDefault();
@@ -159,8 +91,16 @@ void initialize_imgui()
 
 	/** Create shaders */
 	{
-		auto vert_data = compile_shader(true, read_text_file("assets/shaders/imgui_vs.hlsl"));
-		auto frag_data = compile_shader(false, read_text_file("assets/shaders/imgui_fs.hlsl"));
+		std::array infos = {
+			shadercompiler::ShaderCompileInfo("assets/shaders/imgui_vs.hlsl", ShaderStageFlagBits::Vertex),
+			shadercompiler::ShaderCompileInfo("assets/shaders/imgui_fs.hlsl", ShaderStageFlagBits::Fragment),
+		};
+		auto results = in_shader_compiler.compile(infos, static_cast<uint32_t>(infos.size()));
+		for(size_t i = 0; i < results.size(); ++i)
+			CB_ASSERTF(results[i].has_value(), "Failed to compile {}: {}", infos[i].path, results[i].get_error());
+
+		auto& vert_data = results[0].get_value();
+		auto& frag_data = results[1].get_value();
 
 		// TODO: Change
 		auto vert_result = get_device()->create_shader(ShaderInfo::make({ (uint32_t*) vert_data.data(), 
@@ -171,28 +111,18 @@ void initialize_imgui()
 		vertex_shader = vert_result.get_value();
 		fragment_shader = frag_result.get_value();
 
-		shader_stages.emplace_back(ShaderStageFlagBits::Vertex, Device::get_backend_shader(vertex_shader), "main");
-		shader_stages.emplace_back(ShaderStageFlagBits::Fragment, Device::get_backend_shader(fragment_shader), "main");
-	}
+		shader_stages.emplace_back(ShaderStageFlagBits::Vertex, vertex_shader, "main");
+		shader_stages.emplace_back(ShaderStageFlagBits::Fragment, fragment_shader, "main");
 
-	/** Create pipeline layout */
-	{
-		std::array bindings = {
-			DescriptorSetLayoutBinding(0, 
-				DescriptorType::UniformBuffer, 
-				1, 
-				ShaderStageFlags(ShaderStageFlagBits::Vertex)),
-			DescriptorSetLayoutBinding(1, 
-				DescriptorType::Sampler, 
-				1, 
-				ShaderStageFlags(ShaderStageFlagBits::Fragment)),
-			DescriptorSetLayoutBinding(2, 
-				DescriptorType::SampledTexture, 
-				1, 
-				ShaderStageFlags(ShaderStageFlagBits::Fragment)),
-		};
-		std::array set_layouts = { DescriptorSetLayoutCreateInfo(bindings) };
-		auto result = get_device()->create_pipeline_layout(PipelineLayoutInfo({ set_layouts, {} }));
+		/** Create pipeline layout from the resources the shaders use */
+		auto vert_reflection = shadercompiler::ShaderReflection::reflect(vert_data);
+		auto frag_reflection = shadercompiler::ShaderReflection::reflect(frag_data);
+		CB_ASSERTF(vert_reflection.has_value(), "Failed to reflect ImGui vertex shader: {}", vert_reflection.get_error());
+		CB_ASSERTF(frag_reflection.has_value(), "Failed to reflect ImGui fragment shader: {}", frag_reflection.get_error());
+
+		std::array<const shadercompiler::ShaderReflection*, 2> reflections = { &vert_reflection.get_value(),
+			&frag_reflection.get_value() };
+		auto result = in_layout_cache.get_or_create(reflections);
 		CB_ASSERTF(result.has_value(), "Failed to create ImGui pipeline layout: {}", result.get_error());
 		pipeline_layout = result.get_value();
 	}
@@ -288,8 +218,8 @@ void draw_imgui(gfx::CommandListHandle list)
 		get_device()->cmd_set_render_pass_state(list, render_pass_state);
 		get_device()->cmd_set_material_state(list, material_state);
 
-		get_device()->cmd_bind_ubo(list, 0, 0, global_data_ubo);
-		get_device()->cmd_bind_sampler(list, 0, 1, sampler);
+		get_device()->cmd_bind_ubo(list, global_data_binding, global_data_ubo);
+		get_device()->cmd_bind_sampler(list, texture_sampler_binding, sampler);
 
 		get_device()->cmd_bind_vertex_buffer(list, vertex_buffer.get(), 0);
 		get_device()->cmd_bind_index_buffer(list, index_buffer.get(), 0, IndexType::Uint16);
@@ -321,7 +251,7 @@ void draw_imgui(gfx::CommandListHandle list)
 				// TODO: Implement texture
 				CB_CHECK(!cmd.TextureId);
 				if(!cmd.TextureId)
-					get_device()->cmd_bind_texture_view(list, 0, 2, font_texture_view);
+					get_device()->cmd_bind_texture_view(list, texture_binding, font_texture_view);
 
 				get_device()->cmd_draw_indexed(list,
 					cmd.ElemCount,
@@ -339,8 +269,6 @@ void draw_imgui(gfx::CommandListHandle list)
 
 void destroy_imgui()
 {
-	get_device()->destroy_pipeline_layout(pipeline_layout);
-
 	get_device()->destroy_shader(vertex_shader);
 	get_device()->destroy_shader(fragment_shader);
 
@@ -3,6 +3,8 @@
 #include "engine/Core.hpp"
 #include <imgui.h>
 #include "engine/gfx/Device.hpp"
+#include "engine/shadercompiler/ShaderCompiler.hpp"
+#include "engine/shadercompiler/PipelineLayoutCache.hpp"
 
 namespace cb::ui
 {
@@ -10,8 +12,10 @@ namespace cb::ui
 
 /**
  * Initialize ImGui renderer (create default font atlas and setup pipeline & shaders)
+ * The pipeline layout is owned by in_layout_cache, which must outlive the renderer
  */
-void initialize_imgui();
+void initialize_imgui(shadercompiler::ShaderCompiler& in_shader_compiler,
+	shadercompiler::PipelineLayoutCache& in_layout_cache);
 void draw_imgui(gfx::CommandListHandle in_handle);
 void destroy_imgui();
 
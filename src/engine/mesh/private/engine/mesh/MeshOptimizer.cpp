@@ -0,0 +1,385 @@
+#include "engine/mesh/MeshOptimizer.hpp"
+#include "engine/Hash.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <string_view>
+
+namespace cb::mesh
+{
+
+namespace detail
+{
+
+static constexpr uint32_t invalid_index = ~0u;
+
+uint64_t hash_vertex(const uint8_t* in_vertex, const size_t in_stride)
+{
+	return fnv1a_64(std::string_view(reinterpret_cast<const char*>(in_vertex), in_stride));
+}
+
+/**
+ * Forsyth's scoring, see https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html
+ */
+static constexpr size_t forsyth_cache_size = 32;
+static constexpr float forsyth_cache_decay_power = 1.5f;
+static constexpr float forsyth_last_triangle_score = 0.75f;
+static constexpr float forsyth_valence_boost_scale = 2.f;
+static constexpr float forsyth_valence_boost_power = 0.5f;
+static constexpr size_t forsyth_max_valence = 64;
+
+struct ForsythScoreTables
+{
+	std::array<float, forsyth_cache_size> cache;
+	std::array<float, forsyth_max_valence> valence;
+
+	ForsythScoreTables()
+	{
+		for(size_t i = 0; i < forsyth_cache_size; ++i)
+		{
+			if(i < 3)
+			{
+				/** The last triangle vertices get a fixed score, whatever the order they were used in */
+				cache[i] = forsyth_last_triangle_score;
+			}
+			else
+			{
+				const float scaler = 1.f / (forsyth_cache_size - 3);
+				cache[i] = std::pow(1.f - (i - 3) * scaler, forsyth_cache_decay_power);
+			}
+		}
+
+		valence[0] = 0.f;
+		for(size_t i = 1; i < forsyth_max_valence; ++i)
+			valence[i] = forsyth_valence_boost_scale * std::pow(static_cast<float>(i), -forsyth_valence_boost_power);
+	}
+
+	float get_vertex_score(const int32_t in_cache_position, const uint32_t in_live_triangles) const
+	{
+		/** No triangle left to emit, the vertex doesn't matter anymore */
+		if(in_live_triangles == 0)
+			return -1.f;
+
+		float score = in_cache_position >= 0 ? cache[in_cache_position] : 0.f;
+		score += valence[std::min<size_t>(in_live_triangles, forsyth_max_valence - 1)];
+		return score;
+	}
+};
+
+}
+
+size_t generate_vertex_remap(const std::span<uint32_t>& out_remap,
+	const std::span<const uint32_t>& in_indices,
+	const std::span<const uint8_t>& in_vertices,
+	const size_t in_stride)
+{
+	const size_t vertex_count = in_vertices.size() / in_stride;
+	CB_CHECK(out_remap.size() >= vertex_count);
+
+	std::fill(out_remap.begin(), out_remap.end(), detail::invalid_index);
+
+	/** Open addressing table storing the first source vertex of each unique vertex */
+	size_t table_size = 16;
+	while(table_size < vertex_count * 2)
+		table_size *= 2;
+	const size_t table_mask = table_size - 1;
+	std::vector<uint32_t> table(table_size, detail::invalid_index);
+
+	size_t unique_count = 0;
+	const size_t index_count = in_indices.empty() ? vertex_count : in_indices.size();
+	for(size_t i = 0; i < index_count; ++i)
+	{
+		const uint32_t index = in_indices.empty() ? static_cast<uint32_t>(i) : in_indices[i];
+		CB_CHECK(index < vertex_count);
+		if(out_remap[index] != detail::invalid_index)
+			continue;
+
+		const uint8_t* vertex = in_vertices.data() + index * in_stride;
+
+		/** Quadratic probing, visits every slot since the table size is a power of two */
+		size_t slot = detail::hash_vertex(vertex, in_stride) & table_mask;
+		for(size_t probe = 1; ; ++probe)
+		{
+			const uint32_t entry = table[slot];
+			if(entry == detail::invalid_index)
+			{
+				table[slot] = index;
+				out_remap[index] = static_cast<uint32_t>(unique_count++);
+				break;
+			}
+
+			if(memcmp(in_vertices.data() + entry * in_stride, vertex, in_stride) == 0)
+			{
+				out_remap[index] = out_remap[entry];
+				break;
+			}
+
+			slot = (slot + probe) & table_mask;
+		}
+	}
+
+	return unique_count;
+}
+
+void remap_vertex_buffer(const std::span<uint8_t>& out_vertices,
+	const std::span<const uint8_t>& in_vertices,
+	const size_t in_stride,
+	const std::span<const uint32_t>& in_remap)
+{
+	const size_t vertex_count = in_vertices.size() / in_stride;
+	for(size_t i = 0; i < vertex_count; ++i)
+	{
+		if(in_remap[i] == detail::invalid_index)
+			continue;
+
+		CB_CHECK((in_remap[i] + 1) * in_stride <= out_vertices.size());
+		memcpy(out_vertices.data() + in_remap[i] * in_stride, in_vertices.data() + i * in_stride, in_stride);
+	}
+}
+
+void remap_index_buffer(const std::span<uint32_t>& out_indices,
+	const std::span<const uint32_t>& in_indices,
+	const std::span<const uint32_t>& in_remap)
+{
+	if(in_indices.empty())
+	{
+		for(size_t i = 0; i < in_remap.size(); ++i)
+			out_indices[i] = in_remap[i];
+	}
+	else
+	{
+		for(size_t i = 0; i < in_indices.size(); ++i)
+			out_indices[i] = in_remap[in_indices[i]];
+	}
+}
+
+void optimize_vertex_cache(const std::span<uint32_t>& out_indices,
+	const std::span<const uint32_t>& in_indices,
+	const size_t in_vertex_count)
+{
+	static const detail::ForsythScoreTables score_tables;
+
+	const size_t triangle_count = in_indices.size() / 3;
+	CB_CHECK(out_indices.size() >= triangle_count * 3);
+
+	/** Vertex -> triangles adjacency, the first live_triangles entries of each vertex are the non-emitted ones */
+	std::vector<uint32_t> live_triangles(in_vertex_count, 0);
+	for(const uint32_t index : in_indices)
+		live_triangles[index]++;
+
+	std::vector<uint32_t> adjacency_offsets(in_vertex_count + 1, 0);
+	for(size_t i = 0; i < in_vertex_count; ++i)
+		adjacency_offsets[i + 1] = adjacency_offsets[i] + live_triangles[i];
+
+	std::vector<uint32_t> adjacency(in_indices.size());
+	{
+		std::vector<uint32_t> fill_count(in_vertex_count, 0);
+		for(size_t i = 0; i < in_indices.size(); ++i)
+		{
+			const uint32_t vertex = in_indices[i];
+			adjacency[adjacency_offsets[vertex] + fill_count[vertex]++] = static_cast<uint32_t>(i / 3);
+		}
+	}
+
+	std::vector<float> vertex_scores(in_vertex_count);
+	for(size_t i = 0; i < in_vertex_count; ++i)
+		vertex_scores[i] = score_tables.get_vertex_score(-1, live_triangles[i]);
+
+	std::vector<float> triangle_scores(triangle_count);
+	std::vector<bool> emitted(triangle_count, false);
+	uint32_t best_triangle = detail::invalid_index;
+	float best_score = -1.f;
+	for(size_t i = 0; i < triangle_count; ++i)
+	{
+		triangle_scores[i] = vertex_scores[in_indices[i * 3 + 0]] +
+			vertex_scores[in_indices[i * 3 + 1]] +
+			vertex_scores[in_indices[i * 3 + 2]];
+		if(triangle_scores[i] > best_score)
+		{
+			best_score = triangle_scores[i];
+			best_triangle = static_cast<uint32_t>(i);
+		}
+	}
+
+	/** Three more slots to hold the vertices pushed out by the last triangle */
+	std::array<uint32_t, detail::forsyth_cache_size + 3> cache;
+	std::array<uint32_t, detail::forsyth_cache_size + 3> new_cache;
+	size_t cache_count = 0;
+	size_t input_cursor = 0;
+
+	for(size_t output_triangle = 0; output_triangle < triangle_count; ++output_triangle)
+	{
+		/** Nothing in the cache is connected to a live triangle, restart from the next non-emitted triangle */
+		if(best_triangle == detail::invalid_index)
+		{
+			while(emitted[input_cursor])
+				input_cursor++;
+			best_triangle = static_cast<uint32_t>(input_cursor);
+		}
+
+		const uint32_t* triangle = &in_indices[best_triangle * 3];
+		memcpy(&out_indices[output_triangle * 3], triangle, sizeof(uint32_t) * 3);
+		emitted[best_triangle] = true;
+
+		size_t new_cache_count = 0;
+		for(size_t i = 0; i < 3; ++i)
+		{
+			const uint32_t vertex = triangle[i];
+
+			uint32_t* triangles = &adjacency[adjacency_offsets[vertex]];
+			uint32_t& live_count = live_triangles[vertex];
+			for(uint32_t j = 0; j < live_count; ++j)
+			{
+				if(triangles[j] == best_triangle)
+				{
+					triangles[j] = triangles[live_count - 1];
+					live_count--;
+					break;
+				}
+			}
+
+			new_cache[new_cache_count++] = vertex;
+		}
+
+		for(size_t i = 0; i < cache_count; ++i)
+		{
+			const uint32_t vertex = cache[i];
+			if(vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+				new_cache[new_cache_count++] = vertex;
+		}
+
+		/** Update scores of every vertex in the cache (including the ones being evicted) and of their triangles */
+		for(size_t i = 0; i < new_cache_count; ++i)
+		{
+			const uint32_t vertex = new_cache[i];
+			const int32_t cache_position = i < detail::forsyth_cache_size ? static_cast<int32_t>(i) : -1;
+
+			const float score = score_tables.get_vertex_score(cache_position, live_triangles[vertex]);
+			const float score_delta = score - vertex_scores[vertex];
+			vertex_scores[vertex] = score;
+
+			const uint32_t* triangles = &adjacency[adjacency_offsets[vertex]];
+			for(uint32_t j = 0; j < live_triangles[vertex]; ++j)
+				triangle_scores[triangles[j]] += score_delta;
+		}
+
+		/** Next triangle is the best one connected to the cache, scores are final only once every vertex is updated */
+		best_triangle = detail::invalid_index;
+		best_score = -1.f;
+		for(size_t i = 0; i < new_cache_count; ++i)
+		{
+			const uint32_t vertex = new_cache[i];
+			const uint32_t* triangles = &adjacency[adjacency_offsets[vertex]];
+			for(uint32_t j = 0; j < live_triangles[vertex]; ++j)
+			{
+				if(triangle_scores[triangles[j]] > best_score)
+				{
+					best_score = triangle_scores[triangles[j]];
+					best_triangle = triangles[j];
+				}
+			}
+		}
+
+		cache_count = std::min(new_cache_count, detail::forsyth_cache_size);
+		std::copy_n(new_cache.begin(), cache_count, cache.begin());
+	}
+}
+
+size_t optimize_vertex_fetch_remap(const std::span<uint32_t>& out_remap,
+	const std::span<const uint32_t>& in_indices)
+{
+	std::fill(out_remap.begin(), out_remap.end(), detail::invalid_index);
+
+	size_t vertex_count = 0;
+	for(const uint32_t index : in_indices)
+	{
+		if(out_remap[index] == detail::invalid_index)
+			out_remap[index] = static_cast<uint32_t>(vertex_count++);
+	}
+
+	return vertex_count;
+}
+
+std::vector<uint8_t> encode_indices(const std::span<const uint32_t>& in_indices,
+	const gfx::IndexType in_index_type)
+{
+	std::vector<uint8_t> data;
+	if(in_index_type == gfx::IndexType::Uint16)
+	{
+		data.resize(in_indices.size() * sizeof(uint16_t));
+		uint16_t* indices = reinterpret_cast<uint16_t*>(data.data());
+		for(size_t i = 0; i < in_indices.size(); ++i)
+		{
+			CB_CHECK(in_indices[i] <= std::numeric_limits<uint16_t>::max());
+			indices[i] = static_cast<uint16_t>(in_indices[i]);
+		}
+	}
+	else
+	{
+		data.resize(in_indices.size() * sizeof(uint32_t));
+		memcpy(data.data(), in_indices.data(), data.size());
+	}
+
+	return data;
+}
+
+VertexCacheStatistics analyze_vertex_cache(const std::span<const uint32_t>& in_indices,
+	const size_t in_vertex_count,
+	const size_t in_cache_size)
+{
+	VertexCacheStatistics statistics;
+	if(in_indices.empty())
+		return statistics;
+
+	/** A vertex is in the FIFO if it was inserted less than in_cache_size insertions ago */
+	std::vector<size_t> insertion_times(in_vertex_count, 0);
+	size_t time = in_cache_size + 1;
+	size_t unique_count = 0;
+	for(const uint32_t index : in_indices)
+	{
+		if(insertion_times[index] == 0)
+			unique_count++;
+
+		if(time - insertion_times[index] > in_cache_size)
+		{
+			insertion_times[index] = time++;
+			statistics.vertices_transformed++;
+		}
+	}
+
+	statistics.acmr = static_cast<float>(statistics.vertices_transformed) / static_cast<float>(in_indices.size() / 3);
+	statistics.atvr = static_cast<float>(statistics.vertices_transformed) / static_cast<float>(unique_count);
+	return statistics;
+}
+
+OptimizedMesh optimize_mesh(const std::span<const uint8_t>& in_vertices,
+	const size_t in_stride,
+	const std::span<const uint32_t>& in_indices)
+{
+	const size_t source_vertex_count = in_vertices.size() / in_stride;
+
+	std::vector<uint32_t> remap(source_vertex_count);
+	const size_t unique_count = generate_vertex_remap(remap, in_indices, in_vertices, in_stride);
+
+	std::vector<uint32_t> indices(in_indices.empty() ? source_vertex_count : in_indices.size());
+	remap_index_buffer(indices, in_indices, remap);
+
+	std::vector<uint8_t> vertices(unique_count * in_stride);
+	remap_vertex_buffer(vertices, in_vertices, in_stride, remap);
+
+	OptimizedMesh mesh;
+	mesh.indices.resize(indices.size());
+	optimize_vertex_cache(mesh.indices, indices, unique_count);
+
+	remap.resize(unique_count);
+	mesh.vertex_count = optimize_vertex_fetch_remap(remap, mesh.indices);
+	remap_index_buffer(mesh.indices, mesh.indices, remap);
+
+	mesh.vertices.resize(mesh.vertex_count * in_stride);
+	remap_vertex_buffer(mesh.vertices, vertices, in_stride, remap);
+
+	return mesh;
+}
+
+}
@@ -0,0 +1,118 @@
+#include "engine/mesh/VertexQuantization.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace cb::mesh
+{
+
+namespace detail
+{
+
+int32_t quantize_snorm(const float in_value, const uint32_t in_bits)
+{
+	const float max_value = static_cast<float>((1 << (in_bits - 1)) - 1);
+	return static_cast<int32_t>(std::lround(std::clamp(in_value, -1.f, 1.f) * max_value));
+}
+
+float sign_not_zero(const float in_value)
+{
+	return in_value >= 0.f ? 1.f : -1.f;
+}
+
+}
+
+PositionQuantization compute_position_quantization(const std::array<float, 3>& in_bounds_min,
+	const std::array<float, 3>& in_bounds_max)
+{
+	PositionQuantization quantization;
+	quantization.scale = 0.f;
+	for(size_t i = 0; i < 3; ++i)
+	{
+		quantization.offset[i] = (in_bounds_min[i] + in_bounds_max[i]) * 0.5f;
+		quantization.scale = std::max(quantization.scale, (in_bounds_max[i] - in_bounds_min[i]) * 0.5f);
+	}
+
+	/** Degenerated mesh (single point) */
+	if(quantization.scale <= 0.f)
+		quantization.scale = 1.f;
+
+	return quantization;
+}
+
+int16_t quantize_snorm16(const float in_value)
+{
+	return static_cast<int16_t>(detail::quantize_snorm(in_value, 16));
+}
+
+uint16_t quantize_half(const float in_value)
+{
+	uint32_t bits;
+	memcpy(&bits, &in_value, sizeof(bits));
+
+	const uint32_t sign = (bits >> 16) & 0x8000;
+	const uint32_t float_exponent = (bits >> 23) & 0xff;
+	const int32_t exponent = static_cast<int32_t>(float_exponent) - 127 + 15;
+	uint32_t mantissa = bits & 0x7fffff;
+
+	/** Inf/NaN */
+	if(float_exponent == 0xff)
+		return static_cast<uint16_t>(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+
+	/** Overflow */
+	if(exponent >= 31)
+		return static_cast<uint16_t>(sign | 0x7c00);
+
+	/** Subnormal or zero */
+	if(exponent <= 0)
+	{
+		if(exponent < -10)
+			return static_cast<uint16_t>(sign);
+
+		mantissa |= 0x800000;
+		const uint32_t shift = static_cast<uint32_t>(14 - exponent);
+		uint32_t half = mantissa >> shift;
+		const uint32_t remainder = mantissa & ((1u << shift) - 1);
+		const uint32_t halfway = 1u << (shift - 1);
+		if(remainder > halfway || (remainder == halfway && (half & 1)))
+			half++;
+		return static_cast<uint16_t>(sign | half);
+	}
+
+	/** Rounding can carry into the exponent, which gives the correct result (up to infinity) */
+	uint32_t half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+	const uint32_t remainder = mantissa & 0x1fff;
+	if(remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+		half++;
+
+	return static_cast<uint16_t>(sign | half);
+}
+
+uint32_t pack_snorm_10_10_10_2(const float in_x, 
+	const float in_y, 
+	const float in_z, 
+	const float in_w)
+{
+	const uint32_t x = static_cast<uint32_t>(detail::quantize_snorm(in_x, 10)) & 0x3ff;
+	const uint32_t y = static_cast<uint32_t>(detail::quantize_snorm(in_y, 10)) & 0x3ff;
+	const uint32_t z = static_cast<uint32_t>(detail::quantize_snorm(in_z, 10)) & 0x3ff;
+	const uint32_t w = static_cast<uint32_t>(detail::quantize_snorm(in_w, 2)) & 0x3;
+	return x | (y << 10) | (z << 20) | (w << 30);
+}
+
+std::array<float, 2> encode_octahedral(const float in_x, const float in_y, const float in_z)
+{
+	const float length = std::abs(in_x) + std::abs(in_y) + std::abs(in_z);
+	if(length <= 0.f)
+		return { 0.f, 0.f };
+
+	const float x = in_x / length;
+	const float y = in_y / length;
+	if(in_z >= 0.f)
+		return { x, y };
+
+	/** Fold the lower hemisphere over the diagonals */
+	return { (1.f - std::abs(y)) * detail::sign_not_zero(x), (1.f - std::abs(x)) * detail::sign_not_zero(y) };
+}
+
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "engine/Core.hpp"
+#include "engine/gfx/Command.hpp"
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace cb::mesh
+{
+
+/**
+ * Mesh processing used by cb-meshcook and for meshes built at runtime
+ * Vertices are handled as opaque blobs of in_stride bytes, indices are triangle lists
+ * The usual pipeline is: weld (generate_vertex_remap + remap_*), optimize_vertex_cache, optimize_vertex_fetch,
+ * then encode_indices with select_index_type
+ */
+
+/**
+ * Find identical vertices (bitwise) using a hash table
+ * \param in_indices Source index buffer, can be empty if the vertices are not indexed (one vertex per corner)
+ * \param out_remap Receives for each source vertex its index in the welded vertex buffer, unreferenced vertices are 
+ *	set to ~0u. Must be vertex_count large
+ * \return Number of unique vertices
+ */
+[[nodiscard]] size_t generate_vertex_remap(const std::span<uint32_t>& out_remap,
+	const std::span<const uint32_t>& in_indices,
+	const std::span<const uint8_t>& in_vertices,
+	const size_t in_stride);
+
+/**
+ * Build a vertex buffer from a remap table generated by generate_vertex_remap or optimize_vertex_fetch_remap
+ * \param out_vertices Must be unique_vertex_count * in_stride bytes large
+ */
+void remap_vertex_buffer(const std::span<uint8_t>& out_vertices,
+	const std::span<const uint8_t>& in_vertices,
+	const size_t in_stride,
+	const std::span<const uint32_t>& in_remap);
+
+/**
+ * Build an index buffer from a remap table
+ * \param in_indices Source index buffer, can be empty if the vertices are not indexed
+ * \param out_indices Must be in_indices.size() large (or in_remap.size() if not indexed), can alias in_indices
+ */
+void remap_index_buffer(const std::span<uint32_t>& out_indices,
+	const std::span<const uint32_t>& in_indices,
+	const std::span<const uint32_t>& in_remap);
+
+/**
+ * Reorder triangles to maximize post-transform cache hits (Tom Forsyth's linear-speed vertex cache optimisation)
+ * \param out_indices Must be in_indices.size() large, can't alias in_indices
+ */
+void optimize_vertex_cache(const std::span<uint32_t>& out_indices,
+	const std::span<const uint32_t>& in_indices,
+	const size_t in_vertex_count);
+
+/**
+ * Generate a remap table that orders vertices by first use in the index buffer to improve fetch locality
+ * Unreferenced vertices are dropped
+ * \return Number of referenced vertices
+ */
+[[nodiscard]] size_t optimize_vertex_fetch_remap(const std::span<uint32_t>& out_remap,
+	const std::span<const uint32_t>& in_indices);
+
+/**
+ * Use 16-bit indices whenever every vertex can be addressed
+ */
+[[nodiscard]] inline gfx::IndexType select_index_type(const size_t in_vertex_count)
+{
+	return in_vertex_count <= std::numeric_limits<uint16_t>::max() + 1ull ? gfx::IndexType::Uint16 : gfx::IndexType::Uint32;
+}
+
+/**
+ * Encode indices as a raw index buffer of the specified type
+ */
+[[nodiscard]] std::vector<uint8_t> encode_indices(const std::span<const uint32_t>& in_indices, 
+	const gfx::IndexType in_index_type);
+
+struct VertexCacheStatistics
+{
+	/** Vertex shader invocations */
+	size_t vertices_transformed = 0;
+
+	/** Average cache miss ratio: transformed vertices per triangle, 0.5 is optimal, 3 is the worst */
+	float acmr = 0.f;
+
+	/** Average transformed vertex ratio: transformed vertices per unique vertex, 1 is optimal */
+	float atvr = 0.f;
+};
+
+/**
+ * Simulate a FIFO post-transform cache
+ */
+[[nodiscard]] VertexCacheStatistics analyze_vertex_cache(const std::span<const uint32_t>& in_indices,
+	const size_t in_vertex_count,
+	const size_t in_cache_size = 16);
+
+/**
+ * Result of optimize_mesh
+ */
+struct OptimizedMesh
+{
+	std::vector<uint8_t> vertices;
+	std::vector<uint32_t> indices;
+	size_t vertex_count = 0;
+};
+
+/**
+ * Run the full pipeline on a mesh: weld, reorder triangles for the vertex cache then vertices for fetch locality
+ * \param in_indices Source index buffer, can be empty if the vertices are not indexed
+ */
+[[nodiscard]] OptimizedMesh optimize_mesh(const std::span<const uint8_t>& in_vertices,
+	const size_t in_stride,
+	const std::span<const uint32_t>& in_indices = {});
+
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "engine/Core.hpp"
+#include <array>
+
+namespace cb::mesh
+{
+
+/**
+ * Vertex attribute quantization helpers, outputs match the GPU decoding of the corresponding gfx::Format
+ */
+
+/**
+ * Positions are stored as snorm relative to the mesh bounds: position = offset + quantized * scale
+ * The scale is uniform so the dequantization can be folded in the world matrix without skewing normals
+ */
+struct PositionQuantization
+{
+	std::array<float, 3> offset;
+	float scale;
+};
+
+[[nodiscard]] PositionQuantization compute_position_quantization(const std::array<float, 3>& in_bounds_min,
+	const std::array<float, 3>& in_bounds_max);
+
+/** Float in [-1, 1] to 16-bit snorm (Format::R16G16B16A16Snorm, Format::R16G16Snorm) */
+[[nodiscard]] int16_t quantize_snorm16(const float in_value);
+
+/** Float to IEEE 754 half, rounded to nearest even (Format::R16G16Sfloat) */
+[[nodiscard]] uint16_t quantize_half(const float in_value);
+
+/** Pack floats in [-1, 1] (Format::A2B10G10R10SnormPack32), in_w only has -1, 0 and 1 as exact values */
+[[nodiscard]] uint32_t pack_snorm_10_10_10_2(const float in_x, 
+	const float in_y, 
+	const float in_z, 
+	const float in_w = 0.f);
+
+/**
+ * Octahedral encoding of a unit vector, both components in [-1, 1] (store as Format::R16G16Snorm)
+ * Decoding must be done in the shader
+ */
+[[nodiscard]] std::array<float, 2> encode_octahedral(const float in_x, const float in_y, const float in_z);
+
+}
@@ -0,0 +1,316 @@
+#include "engine/renderer/FrameCapture.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+namespace cb::renderer
+{
+
+namespace
+{
+
+/**
+ * Minimal OpenEXR writer: uncompressed scanlines of half or float RGBA
+ * in_data holds interleaved RGBA texels, EXR stores each line channel by channel in alphabetical order (ABGR)
+ */
+bool write_exr(const std::string& in_path,
+	const uint32_t in_width,
+	const uint32_t in_height,
+	const bool in_half,
+	const std::span<const uint8_t>& in_data)
+{
+	std::vector<uint8_t> header;
+	const auto write = [&](const void* in_value, const size_t in_size)
+	{
+		header.insert(header.end(), static_cast<const uint8_t*>(in_value), static_cast<const uint8_t*>(in_value) + in_size);
+	};
+	const auto write_u32 = [&](const uint32_t in_value) { write(&in_value, sizeof(in_value)); };
+	const auto write_f32 = [&](const float in_value) { write(&in_value, sizeof(in_value)); };
+	const auto write_string = [&](const std::string_view& in_value)
+	{
+		write(in_value.data(), in_value.size());
+		header.push_back(0);
+	};
+	const auto write_attribute = [&](const std::string_view& in_name, const std::string_view& in_type, const uint32_t in_size)
+	{
+		write_string(in_name);
+		write_string(in_type);
+		write_u32(in_size);
+	};
+	const auto write_box = [&](const std::string_view& in_name)
+	{
+		write_attribute(in_name, "box2i", 16);
+		write_u32(0);
+		write_u32(0);
+		write_u32(in_width - 1);
+		write_u32(in_height - 1);
+	};
+
+	static constexpr uint32_t magic = 20000630;
+	static constexpr uint32_t version = 2;
+	static constexpr std::array channel_names = { "A", "B", "G", "R" };
+	static constexpr std::array channel_indices = { 3u, 2u, 1u, 0u };
+	static constexpr uint32_t pixel_type_half = 1;
+	static constexpr uint32_t pixel_type_float = 2;
+
+	write_u32(magic);
+	write_u32(version);
+
+	/** Name, pixel type, linear flag + reserved, x and y sampling */
+	static constexpr uint32_t channel_size = 2 + 4 * sizeof(uint32_t);
+	write_attribute("channels", "chlist", channel_size * static_cast<uint32_t>(channel_names.size()) + 1);
+	for(const auto& name : channel_names)
+	{
+		write_string(name);
+		write_u32(in_half ? pixel_type_half : pixel_type_float);
+		write_u32(0);
+		write_u32(1);
+		write_u32(1);
+	}
+	header.push_back(0);
+
+	write_attribute("compression", "compression", 1);
+	header.push_back(0);
+	write_box("dataWindow");
+	write_box("displayWindow");
+	write_attribute("lineOrder", "lineOrder", 1);
+	header.push_back(0);
+	write_attribute("pixelAspectRatio", "float", 4);
+	write_f32(1.f);
+	write_attribute("screenWindowCenter", "v2f", 8);
+	write_f32(0.f);
+	write_f32(0.f);
+	write_attribute("screenWindowWidth", "float", 4);
+	write_f32(1.f);
+	header.push_back(0);
+
+	/** One line per chunk, the offset table follows the header */
+	const size_t component_size = in_half ? 2 : 4;
+	const size_t line_size = in_width * channel_names.size() * component_size;
+	const uint64_t first_line_offset = header.size() + in_height * sizeof(uint64_t);
+	for(uint32_t y = 0; y < in_height; ++y)
+	{
+		const uint64_t offset = first_line_offset + y * (2 * sizeof(uint32_t) + line_size);
+		write(&offset, sizeof(offset));
+	}
+
+	std::vector<uint8_t> line(line_size);
+	std::ofstream file(in_path, std::ios::binary);
+	file.write(reinterpret_cast<const char*>(header.data()), header.size());
+	for(uint32_t y = 0; y < in_height; ++y)
+	{
+		const uint8_t* src_line = in_data.data() + y * line_size;
+		uint8_t* dst = line.data();
+		for(const auto& channel : channel_indices)
+		{
+			for(uint32_t x = 0; x < in_width; ++x)
+			{
+				memcpy(dst, src_line + (x * channel_names.size() + channel) * component_size, component_size);
+				dst += component_size;
+			}
+		}
+
+		const std::array line_header = { y, static_cast<uint32_t>(line_size) };
+		file.write(reinterpret_cast<const char*>(line_header.data()), sizeof(line_header));
+		file.write(reinterpret_cast<const char*>(line.data()), line.size());
+	}
+
+	return file.good();
+}
+
+}
+
+FrameCapture::FrameCapture(gfx::Device& in_device, const std::string& in_directory) : device(in_device),
+	directory(in_directory), writing(false), stop(false), written_count(0)
+{
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+	if(error)
+		logger::warn(log_renderer, "Cannot create capture directory {}: {}", directory, error.message());
+
+	writer = std::thread([this]() { write_images(); });
+}
+
+FrameCapture::~FrameCapture()
+{
+	flush();
+
+	{
+		std::lock_guard lock(mutex);
+		stop = true;
+	}
+	condition.notify_all();
+	writer.join();
+}
+
+bool FrameCapture::is_format_supported(const gfx::Format in_format)
+{
+	using namespace gfx;
+
+	switch(in_format)
+	{
+	case Format::R8G8B8A8Unorm:
+	case Format::R8G8B8A8Srgb:
+	case Format::B8G8R8A8Unorm:
+	case Format::R16G16B16A16Sfloat:
+	case Format::R32G32B32A32Sfloat:
+		return true;
+	default:
+		return false;
+	}
+}
+
+void FrameCapture::capture(const gfx::CommandListHandle& in_cmd_list,
+	const gfx::TextureHandle& in_texture,
+	const std::string& in_name)
+{
+	using namespace gfx;
+
+	const TextureCreateInfo& info = Device::get_texture_create_info(in_texture);
+	if(!is_format_supported(info.format))
+	{
+		logger::error(log_renderer, "Cannot capture {}: unsupported format {}", in_name, to_string(info.format));
+		return;
+	}
+
+	device.cmd_texture_barrier(in_cmd_list,
+		in_texture,
+		PipelineStageFlags(PipelineStageFlagBits::ColorAttachmentOutput),
+		TextureLayout::ColorAttachment,
+		AccessFlags(AccessFlagBits::ColorAttachmentWrite),
+		PipelineStageFlags(PipelineStageFlagBits::Transfer),
+		TextureLayout::TransferSrc,
+		AccessFlags(AccessFlagBits::TransferRead));
+
+	ReadbackRequest request = device.cmd_readback_texture(in_cmd_list, in_texture, TextureLayout::TransferSrc,
+		TextureAspectFlagBits::Color);
+
+	device.cmd_texture_barrier(in_cmd_list,
+		in_texture,
+		PipelineStageFlags(PipelineStageFlagBits::Transfer),
+		TextureLayout::TransferSrc,
+		AccessFlags(AccessFlagBits::TransferRead),
+		PipelineStageFlags(PipelineStageFlagBits::ColorAttachmentOutput),
+		TextureLayout::ColorAttachment,
+		AccessFlags(AccessFlagBits::ColorAttachmentWrite));
+
+	if(!request)
+	{
+		logger::error(log_renderer, "Cannot capture {}: failed to create readback request", in_name);
+		return;
+	}
+
+	const bool exr = info.format == Format::R16G16B16A16Sfloat || info.format == Format::R32G32B32A32Sfloat;
+	pending_captures.push_back({ std::move(request),
+		info.format,
+		info.width,
+		info.height,
+		(std::filesystem::path(directory) / (in_name + (exr ? ".exr" : ".png"))).string() });
+}
+
+void FrameCapture::update()
+{
+	/** Requests complete in frame order */
+	auto it = pending_captures.begin();
+	for(; it != pending_captures.end() && it->request.is_ready(); ++it)
+		queue_image(std::move(*it));
+
+	pending_captures.erase(pending_captures.begin(), it);
+}
+
+void FrameCapture::flush()
+{
+	if(!pending_captures.empty())
+	{
+		device.wait_idle();
+		update();
+	}
+
+	std::unique_lock lock(mutex);
+	idle_condition.wait(lock, [&]() { return images.empty() && !writing; });
+}
+
+void FrameCapture::queue_image(PendingCapture&& in_capture)
+{
+	const std::span<const uint8_t> data = in_capture.request.get_data();
+	if(data.empty())
+	{
+		logger::error(log_renderer, "Failed to read back {}", in_capture.path);
+		return;
+	}
+
+	/** Copied so the request can be released right away, encoding is much slower than the copy */
+	Image image { std::move(in_capture.path), 
+		in_capture.format, 
+		in_capture.width, 
+		in_capture.height, 
+		std::vector<uint8_t>(data.begin(), data.end()) };
+
+	{
+		std::lock_guard lock(mutex);
+		images.emplace_back(std::move(image));
+	}
+	condition.notify_one();
+}
+
+void FrameCapture::write_images()
+{
+	using namespace gfx;
+
+	while(true)
+	{
+		Image image;
+		{
+			std::unique_lock lock(mutex);
+			condition.wait(lock, [&]() { return stop || !images.empty(); });
+			if(images.empty())
+				return;
+
+			image = std::move(images.front());
+			images.pop_front();
+			writing = true;
+		}
+
+		bool written = false;
+		switch(image.format)
+		{
+		case Format::B8G8R8A8Unorm:
+			for(size_t i = 0; i < image.data.size(); i += 4)
+				std::swap(image.data[i], image.data[i + 2]);
+			[[fallthrough]];
+		case Format::R8G8B8A8Unorm:
+		case Format::R8G8B8A8Srgb:
+			written = stbi_write_png(image.path.c_str(),
+				static_cast<int>(image.width),
+				static_cast<int>(image.height),
+				4,
+				image.data.data(),
+				static_cast<int>(image.width * 4)) != 0;
+			break;
+		case Format::R16G16B16A16Sfloat:
+		case Format::R32G32B32A32Sfloat:
+			written = write_exr(image.path, image.width, image.height, image.format == Format::R16G16B16A16Sfloat, image.data);
+			break;
+		default:
+			break;
+		}
+
+		if(written)
+			written_count++;
+		else
+			logger::error(log_renderer, "Failed to write {}", image.path);
+
+		{
+			std::lock_guard lock(mutex);
+			writing = false;
+		}
+		idle_condition.notify_all();
+	}
+}
+
+}
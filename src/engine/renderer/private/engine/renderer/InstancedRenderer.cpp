@@ -0,0 +1,161 @@
+#include "engine/renderer/InstancedRenderer.hpp"
+#include <algorithm>
+#include <cstddef>
+
+namespace cb::renderer
+{
+
+InstancedRenderer::InstancedRenderer(gfx::Device& in_device) : device(&in_device), mapped_instances(nullptr),
+	max_instances(0), frame_base_instance(0), instance_count(0), flushed_instance_count(0) {}
+
+InstancedRenderer::~InstancedRenderer()
+{
+	if(instance_buffer)
+		device->unmap_buffer(instance_buffer.get());
+}
+
+cb::Result<InstancedRenderer, gfx::Result> InstancedRenderer::create(gfx::Device& in_device,
+	const uint32_t in_max_instances)
+{
+	InstancedRenderer renderer(in_device);
+	if(auto result = renderer.reserve(in_max_instances); !result)
+		return make_error(result.get_error());
+
+	return make_result(std::move(renderer));
+}
+
+cb::Result<bool, gfx::Result> InstancedRenderer::reserve(const uint32_t in_max_instances)
+{
+	using namespace gfx;
+
+	if(in_max_instances <= max_instances)
+		return make_result(true);
+
+	/** Grow geometrically so that raising the count step by step doesn't reallocate every frame */
+	const uint32_t new_max_instances = std::max(in_max_instances, max_instances * 2);
+
+	auto buffer = device->create_buffer(BufferInfo(BufferCreateInfo(
+		sizeof(InstanceData) * new_max_instances * device->get_frames_in_flight(),
+		MemoryUsage::CpuToGpu,
+		BufferUsageFlags(BufferUsageFlagBits::VertexBuffer))).set_debug_name("Instance Buffer"));
+	if(!buffer)
+		return make_error(buffer.get_error());
+
+	UniqueBuffer new_instance_buffer(buffer.get_value());
+
+	/** Mapped once for the lifetime of the buffer */
+	auto map = device->map_buffer(new_instance_buffer.get());
+	if(!map)
+		return make_error(map.get_error());
+
+	if(instance_buffer)
+		device->unmap_buffer(instance_buffer.get());
+
+	instance_buffer = std::move(new_instance_buffer);
+	mapped_instances = static_cast<InstanceData*>(map.get_value());
+	max_instances = new_max_instances;
+	return make_result(true);
+}
+
+BatchId InstancedRenderer::register_batch(const RenderMesh& in_mesh, RenderMaterial in_material)
+{
+	using namespace gfx;
+
+	Batch& batch = batches.emplace_back();
+	batch.mesh = in_mesh;
+	batch.material = std::move(in_material);
+	batch.material_state.stages = batch.material.stages;
+	batch.material_state.rasterizer = batch.material.rasterizer;
+	batch.material_state.vertex_input.input_binding_descriptions = {
+		VertexInputBindingDescription(0, in_mesh.vertex_stride, VertexInputRate::Vertex),
+		VertexInputBindingDescription(instance_binding, sizeof(InstanceData), VertexInputRate::Instance),
+	};
+	batch.material_state.vertex_input.input_attribute_descriptions = in_mesh.attributes;
+	for(uint32_t i = 0; i < 4; ++i)
+	{
+		batch.material_state.vertex_input.input_attribute_descriptions.emplace_back(instance_attribute_location + i,
+			instance_binding,
+			Format::R32G32B32A32Sfloat,
+			static_cast<uint32_t>(offsetof(InstanceData, world) + sizeof(glm::vec4) * i));
+	}
+
+	return static_cast<BatchId>(batches.size() - 1);
+}
+
+void InstancedRenderer::begin_frame()
+{
+	frame_base_instance = static_cast<uint32_t>(device->get_current_frame_index()) * max_instances;
+	instance_count = 0;
+	flushed_instance_count = 0;
+	draws.clear();
+	statistics = {};
+}
+
+std::span<InstanceData> InstancedRenderer::allocate_instances(const BatchId in_batch, const uint32_t in_count)
+{
+	CB_CHECK(in_batch < batches.size())
+
+	const uint32_t count = std::min(in_count, max_instances - instance_count);
+	statistics.dropped_instances += in_count - count;
+	if(count == 0)
+		return {};
+
+	const uint32_t first_instance = frame_base_instance + instance_count;
+	if(!draws.empty() && draws.back().batch == in_batch)
+		draws.back().instance_count += count;
+	else
+		draws.push_back({ in_batch, first_instance, count });
+
+	instance_count += count;
+	statistics.instances += count;
+	return { mapped_instances + first_instance, count };
+}
+
+void InstancedRenderer::flush(const gfx::CommandListHandle& in_cmd_list)
+{
+	using namespace gfx;
+
+	/** The instance buffer stays mapped and CpuToGpu memory isn't always host-coherent */
+	if(instance_count > flushed_instance_count)
+	{
+		device->flush_buffer(instance_buffer.get(), 
+			sizeof(InstanceData) * (frame_base_instance + flushed_instance_count),
+			sizeof(InstanceData) * (instance_count - flushed_instance_count));
+		flushed_instance_count = instance_count;
+	}
+
+	for(const auto& draw : draws)
+	{
+		const Batch& batch = batches[draw.batch];
+
+		device->cmd_set_material_state(in_cmd_list, batch.material_state);
+		device->cmd_bind_pipeline_layout(in_cmd_list, batch.material.pipeline_layout);
+		for(const auto& binding : batch.material.bindings)
+		{
+			if(const auto* buffer = std::get_if<BufferHandle>(&binding.resource))
+				device->cmd_bind_ubo(in_cmd_list, binding.set, binding.binding, *buffer);
+			else if(const auto* sampler = std::get_if<SamplerHandle>(&binding.resource))
+				device->cmd_bind_sampler(in_cmd_list, binding.set, binding.binding, *sampler);
+			else if(const auto* texture_view = std::get_if<TextureViewHandle>(&binding.resource))
+				device->cmd_bind_texture_view(in_cmd_list, binding.set, binding.binding, *texture_view);
+		}
+
+		const std::array vertex_buffers = { batch.mesh.vertex_buffer, instance_buffer.get() };
+		const std::array<uint64_t, 2> offsets = { 0, 0 };
+		device->cmd_bind_vertex_buffers(in_cmd_list, 0, vertex_buffers, offsets);
+		device->cmd_bind_index_buffer(in_cmd_list, batch.mesh.index_buffer, 0, batch.mesh.index_type);
+
+		/** Instance data is addressed through first_instance, the instance buffer is always bound at offset 0 */
+		device->cmd_draw_indexed(in_cmd_list,
+			batch.mesh.index_count,
+			draw.instance_count,
+			batch.mesh.first_index,
+			batch.mesh.vertex_offset,
+			draw.first_instance);
+		statistics.draw_calls++;
+	}
+
+	draws.clear();
+}
+
+}
@@ -0,0 +1,253 @@
+#include "engine/renderer/RenderQueue.hpp"
+#include "engine/Hash.hpp"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <limits>
+
+namespace cb::renderer
+{
+
+namespace
+{
+
+constexpr uint32_t depth_bits = 20;
+constexpr uint32_t mesh_bits = 14;
+constexpr uint32_t material_bits = 14;
+constexpr uint32_t pipeline_bits = 12;
+constexpr uint32_t pass_shift = 60;
+
+/**
+ * Positive IEEE floats keep their order when compared as integers, the top bits are a cheap logarithmic quantization
+ */
+uint64_t quantize_depth(const float in_depth)
+{
+	return std::bit_cast<uint32_t>(std::max(in_depth, 0.f)) >> (31 - depth_bits);
+}
+
+/** Detect state changes between consecutive packets */
+struct StateTracker
+{
+	uint32_t pipeline = std::numeric_limits<uint32_t>::max();
+	MaterialId material = std::numeric_limits<MaterialId>::max();
+	MeshId mesh = std::numeric_limits<MeshId>::max();
+	gfx::BufferHandle object_ubo;
+	bool object_ubo_bound = false;
+
+	bool set_pipeline(const uint32_t in_pipeline) { return std::exchange(pipeline, in_pipeline) != in_pipeline; }
+
+	/** Changing material may move the object UBO slot, it has to be bound again */
+	bool set_material(const MaterialId in_material)
+	{
+		if(std::exchange(material, in_material) == in_material)
+			return false;
+
+		object_ubo_bound = false;
+		return true;
+	}
+
+	bool set_mesh(const MeshId in_mesh) { return std::exchange(mesh, in_mesh) != in_mesh; }
+
+	bool set_object_ubo(const gfx::BufferHandle& in_object_ubo)
+	{
+		if(!in_object_ubo || (object_ubo_bound && object_ubo == in_object_ubo))
+			return false;
+
+		object_ubo = in_object_ubo;
+		object_ubo_bound = true;
+		return true;
+	}
+};
+
+}
+
+RenderQueue::RenderQueue(gfx::Device& in_device, const uint32_t in_sort_threads) : device(in_device),
+	sorter(in_sort_threads)
+{
+	pass_sort_modes.fill(PassSortMode::State);
+}
+
+MeshId RenderQueue::register_mesh(const RenderMesh& in_mesh)
+{
+	CB_CHECK(meshes.size() < max_meshes)
+
+	size_t hash = 0;
+	hash_combine(hash, in_mesh.vertex_stride);
+	for(const auto& attribute : in_mesh.attributes)
+		hash_combine(hash, attribute);
+
+	meshes.emplace_back(in_mesh);
+	mesh_pipeline_hashes.emplace_back(hash);
+	return static_cast<MeshId>(meshes.size() - 1);
+}
+
+MaterialId RenderQueue::register_material(RenderMaterial in_material)
+{
+	CB_CHECK(materials.size() < max_materials)
+
+	size_t hash = 0;
+	for(const auto& stage : in_material.stages)
+		hash_combine(hash, stage);
+	hash_combine(hash, in_material.rasterizer);
+	hash_combine(hash, in_material.pipeline_layout.get_handle());
+
+	materials.emplace_back(std::move(in_material));
+	material_pipeline_hashes.emplace_back(hash);
+	return static_cast<MaterialId>(materials.size() - 1);
+}
+
+void RenderQueue::set_pass_sort_mode(const uint32_t in_pass, const PassSortMode in_mode)
+{
+	CB_CHECK(in_pass < max_passes)
+	pass_sort_modes[in_pass] = in_mode;
+}
+
+uint32_t RenderQueue::get_or_create_pipeline(const MaterialId in_material, const MeshId in_mesh)
+{
+	using namespace gfx;
+
+	size_t hash = material_pipeline_hashes[in_material];
+	hash_combine(hash, mesh_pipeline_hashes[in_mesh]);
+
+	RenderMaterial& material = materials[in_material];
+	const RenderMesh& mesh = meshes[in_mesh];
+
+	/** Hashes may collide, only reuse a pipeline if the state really matches */
+	auto& bucket = pipeline_ids[hash];
+	for(const uint32_t id : bucket)
+	{
+		const Pipeline& pipeline = pipelines[id];
+		const RenderMaterial& pipeline_material = materials[pipeline.material];
+		const RenderMesh& pipeline_mesh = meshes[pipeline.mesh];
+		if(std::ranges::equal(pipeline_material.stages, material.stages) &&
+			pipeline_material.rasterizer == material.rasterizer &&
+			pipeline_material.pipeline_layout == material.pipeline_layout &&
+			pipeline_mesh.vertex_stride == mesh.vertex_stride &&
+			pipeline_mesh.attributes == mesh.attributes)
+			return id;
+	}
+
+	CB_CHECK(pipelines.size() < max_pipelines)
+
+	Pipeline& pipeline = pipelines.emplace_back();
+	pipeline.material = in_material;
+	pipeline.mesh = in_mesh;
+	pipeline.state.stages = material.stages;
+	pipeline.state.rasterizer = material.rasterizer;
+	pipeline.state.vertex_input.input_binding_descriptions = {
+		VertexInputBindingDescription(0, mesh.vertex_stride, VertexInputRate::Vertex) };
+	pipeline.state.vertex_input.input_attribute_descriptions = mesh.attributes;
+
+	const uint32_t id = static_cast<uint32_t>(pipelines.size() - 1);
+	bucket.push_back(id);
+	return id;
+}
+
+uint64_t RenderQueue::make_sort_key(const uint32_t in_pass,
+	const float in_depth,
+	const uint32_t in_pipeline,
+	const DrawPacket& in_packet) const
+{
+	const uint64_t state = (static_cast<uint64_t>(in_pipeline) << (material_bits + mesh_bits)) |
+		(static_cast<uint64_t>(in_packet.material) << mesh_bits) |
+		in_packet.mesh;
+	const uint64_t depth = quantize_depth(in_depth);
+
+	uint64_t key = static_cast<uint64_t>(in_pass) << pass_shift;
+	if(pass_sort_modes[in_pass] == PassSortMode::BackToFront)
+		key |= ((~depth & ((1ull << depth_bits) - 1)) << (pipeline_bits + material_bits + mesh_bits)) | state;
+	else
+		key |= (state << depth_bits) | depth;
+
+	return key;
+}
+
+void RenderQueue::submit(const uint32_t in_pass, const float in_depth, const DrawPacket& in_packet)
+{
+	CB_CHECK(in_pass < max_passes && in_packet.mesh < meshes.size() && in_packet.material < materials.size())
+
+	const uint32_t pipeline = get_or_create_pipeline(in_packet.material, in_packet.mesh);
+	sort_entries.push_back({ make_sort_key(in_pass, in_depth, pipeline, in_packet),
+		static_cast<uint32_t>(packets.size()) });
+	packets.push_back({ in_packet, pipeline });
+}
+
+void RenderQueue::flush(const gfx::CommandListHandle& in_cmd_list)
+{
+	using namespace gfx;
+
+	statistics = {};
+	statistics.packets = static_cast<uint32_t>(packets.size());
+
+	/** State changes the submission order would have caused, for comparison */
+	{
+		StateTracker tracker;
+		for(const auto& packet : packets)
+		{
+			statistics.unsorted.pipelines += tracker.set_pipeline(packet.pipeline);
+			statistics.unsorted.materials += tracker.set_material(packet.draw.material);
+			statistics.unsorted.object_ubos += tracker.set_object_ubo(packet.draw.object_ubo);
+			statistics.unsorted.meshes += tracker.set_mesh(packet.draw.mesh);
+		}
+	}
+
+	const auto sort_start_time = std::chrono::high_resolution_clock::now();
+	sort_scratch.resize(sort_entries.size());
+	sorter.sort(sort_entries, sort_scratch);
+	statistics.sort_time_ms = std::chrono::duration<float, std::milli>(
+		std::chrono::high_resolution_clock::now() - sort_start_time).count();
+
+	StateTracker tracker;
+	for(const auto& entry : sort_entries)
+	{
+		const Packet& packet = packets[entry.value];
+		const RenderMaterial& material = materials[packet.draw.material];
+		const RenderMesh& mesh = meshes[packet.draw.mesh];
+
+		if(tracker.set_pipeline(packet.pipeline))
+		{
+			device.cmd_set_material_state(in_cmd_list, pipelines[packet.pipeline].state);
+			device.cmd_bind_pipeline_layout(in_cmd_list, material.pipeline_layout);
+			statistics.sorted.pipelines++;
+		}
+
+		if(tracker.set_material(packet.draw.material))
+		{
+			for(const auto& binding : material.bindings)
+			{
+				if(const auto* buffer = std::get_if<BufferHandle>(&binding.resource))
+					device.cmd_bind_ubo(in_cmd_list, binding.set, binding.binding, *buffer);
+				else if(const auto* sampler = std::get_if<SamplerHandle>(&binding.resource))
+					device.cmd_bind_sampler(in_cmd_list, binding.set, binding.binding, *sampler);
+				else if(const auto* texture_view = std::get_if<TextureViewHandle>(&binding.resource))
+					device.cmd_bind_texture_view(in_cmd_list, binding.set, binding.binding, *texture_view);
+			}
+			statistics.sorted.materials++;
+		}
+
+		if(tracker.set_object_ubo(packet.draw.object_ubo))
+		{
+			device.cmd_bind_ubo(in_cmd_list, material.object_ubo_set, material.object_ubo_binding, packet.draw.object_ubo);
+			statistics.sorted.object_ubos++;
+		}
+
+		if(tracker.set_mesh(packet.draw.mesh))
+		{
+			device.cmd_bind_vertex_buffer(in_cmd_list, mesh.vertex_buffer, 0);
+			device.cmd_bind_index_buffer(in_cmd_list, mesh.index_buffer, 0, mesh.index_type);
+			statistics.sorted.meshes++;
+		}
+
+		device.cmd_draw_indexed(in_cmd_list,
+			mesh.index_count,
+			packet.draw.instance_count,
+			mesh.first_index,
+			mesh.vertex_offset,
+			packet.draw.first_instance);
+	}
+
+	packets.clear();
+	sort_entries.clear();
+}
+
+}
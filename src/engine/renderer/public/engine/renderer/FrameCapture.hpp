@@ -0,0 +1,85 @@
+#pragma once
+
+#include "engine/Core.hpp"
+#include "engine/gfx/Device.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cb::renderer
+{
+
+CB_DEFINE_LOG_CATEGORY(renderer);
+
+/**
+ * Writes rendered frames to disk without stalling the GPU
+ * A capture is a device readback request, completed once the frame that recorded it retired,
+ * the image is then encoded on a worker thread
+ * 8-bit RGBA/BGRA textures are written as PNG, 16-bit and 32-bit float RGBA textures as EXR
+ */
+class FrameCapture
+{
+	struct PendingCapture
+	{
+		gfx::ReadbackRequest request;
+		gfx::Format format;
+		uint32_t width;
+		uint32_t height;
+		std::string path;
+	};
+
+	struct Image
+	{
+		std::string path;
+		gfx::Format format;
+		uint32_t width;
+		uint32_t height;
+		std::vector<uint8_t> data;
+	};
+public:
+	/** Images are written to in_directory, created if needed */
+	FrameCapture(gfx::Device& in_device, const std::string& in_directory);
+	~FrameCapture();
+
+	FrameCapture(const FrameCapture&) = delete;
+	void operator=(const FrameCapture&) = delete;
+
+	[[nodiscard]] static bool is_format_supported(const gfx::Format in_format);
+
+	/**
+	 * Record the copy of in_texture, which must be in ColorAttachment layout (as render passes leave color attachments)
+	 * The texture is back in that layout after the copy. The image is written to <directory>/<in_name>.<png|exr>
+	 */
+	void capture(const gfx::CommandListHandle& in_cmd_list, const gfx::TextureHandle& in_texture, const std::string& in_name);
+
+	/** Hand the completed captures to the writer, to call once per frame after Device::new_frame */
+	void update();
+
+	/** Wait for the GPU and for every pending capture to be written */
+	void flush();
+
+	[[nodiscard]] uint32_t get_written_count() const { return written_count; }
+private:
+	void queue_image(PendingCapture&& in_capture);
+	void write_images();
+private:
+	gfx::Device& device;
+	std::string directory;
+	std::vector<PendingCapture> pending_captures;
+
+	/** Images waiting to be encoded, the writer thread owns them once queued */
+	std::thread writer;
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::condition_variable idle_condition;
+	std::deque<Image> images;
+	bool writing;
+	bool stop;
+	std::atomic<uint32_t> written_count;
+};
+
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "engine/Core.hpp"
+#include "engine/Result.hpp"
+#include "engine/gfx/Device.hpp"
+#include "engine/renderer/Renderable.hpp"
+#include <glm/glm.hpp>
+#include <vector>
+#include <span>
+
+namespace cb::renderer
+{
+
+/**
+ * Per-instance data, fetched from the instance buffer at VertexInputRate::Instance
+ * The world matrix is fed as 4 float4 columns starting at InstancedRenderer::instance_attribute_location
+ */
+struct InstanceData
+{
+	glm::mat4 world;
+};
+
+using BatchId = uint32_t;
+
+struct InstancedRendererStatistics
+{
+	uint32_t draw_calls = 0;
+	uint32_t instances = 0;
+
+	/** Instances that didn't fit in the instance buffer */
+	uint32_t dropped_instances = 0;
+};
+
+/**
+ * Draws many copies of the same mesh/material with one instanced draw per batch
+ * Instance data is written straight into a persistently mapped CpuToGpu buffer, split in one region
+ * per frame in flight so the CPU never writes data the GPU may still be reading. Written ranges are flushed
+ * before they are drawn.
+ * The buffer is only allocated for the instances actually requested and grows through reserve
+ * Consecutive pushes to the same batch are merged into a single draw, interleaving batches splits draws
+ */
+class InstancedRenderer
+{
+	struct Batch
+	{
+		RenderMesh mesh;
+		RenderMaterial material;
+
+		/** Vertex input with the instance binding appended, stages point to material.stages */
+		gfx::PipelineMaterialState material_state;
+	};
+
+	struct Draw
+	{
+		BatchId batch;
+		uint32_t first_instance;
+		uint32_t instance_count;
+	};
+
+public:
+	static constexpr uint32_t instance_binding = 1;
+	static constexpr uint32_t instance_attribute_location = 8;
+
+	InstancedRenderer(InstancedRenderer&& in_other) noexcept = default;
+	~InstancedRenderer();
+
+	InstancedRenderer(const InstancedRenderer&) = delete;
+	void operator=(const InstancedRenderer&) = delete;
+	void operator=(InstancedRenderer&&) = delete;
+
+	/**
+	 * Create a renderer able to draw up to in_max_instances instances per frame, 0 defers the allocation to reserve
+	 */
+	[[nodiscard]] static cb::Result<InstancedRenderer, gfx::Result> create(gfx::Device& in_device,
+		const uint32_t in_max_instances);
+
+	/**
+	 * Make room for at least in_max_instances instances per frame, must be called before begin_frame
+	 * The previous buffer is destroyed through the device, once the frames using it retired
+	 */
+	[[nodiscard]] cb::Result<bool, gfx::Result> reserve(const uint32_t in_max_instances);
+
+	/**
+	 * Register a mesh/material pair, done once and not per frame
+	 */
+	[[nodiscard]] BatchId register_batch(const RenderMesh& in_mesh, RenderMaterial in_material);
+
+	/**
+	 * Select the instance buffer region of the current device frame and clear pending draws
+	 * Must be called after Device::new_frame
+	 */
+	void begin_frame();
+
+	/**
+	 * Reserve instances for a batch, the returned span points into mapped memory and is write-only
+	 * May be smaller than requested if the instance buffer is full
+	 */
+	[[nodiscard]] std::span<InstanceData> allocate_instances(const BatchId in_batch, const uint32_t in_count);
+
+	void push_instance(const BatchId in_batch, const InstanceData& in_instance)
+	{
+		auto instances = allocate_instances(in_batch, 1);
+		if(!instances.empty())
+			instances[0] = in_instance;
+	}
+
+	/**
+	 * Record pending draws, a render pass and its render pass state must be set
+	 */
+	void flush(const gfx::CommandListHandle& in_cmd_list);
+
+	[[nodiscard]] const InstancedRendererStatistics& get_statistics() const { return statistics; }
+	[[nodiscard]] uint32_t get_max_instances() const { return max_instances; }
+private:
+	explicit InstancedRenderer(gfx::Device& in_device);
+private:
+	gfx::Device* device;
+	gfx::UniqueBuffer instance_buffer;
+	InstanceData* mapped_instances;
+	uint32_t max_instances;
+
+	/** First instance of the current frame region */
+	uint32_t frame_base_instance;
+	uint32_t instance_count;
+
+	/** Instances of the current frame already flushed to the GPU */
+	uint32_t flushed_instance_count;
+	std::vector<Batch> batches;
+	std::vector<Draw> draws;
+	InstancedRendererStatistics statistics;
+};
+
+}
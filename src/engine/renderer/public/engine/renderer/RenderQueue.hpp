@@ -0,0 +1,160 @@
+#pragma once
+
+#include "engine/Core.hpp"
+#include "engine/gfx/Device.hpp"
+#include "engine/renderer/Renderable.hpp"
+#include "engine/util/RadixSort.hpp"
+#include <robin_hood.h>
+#include <array>
+#include <vector>
+
+namespace cb::renderer
+{
+
+using MeshId = uint32_t;
+using MaterialId = uint32_t;
+
+/**
+ * A single draw submitted to a RenderQueue
+ */
+struct DrawPacket
+{
+	MeshId mesh;
+	MaterialId material;
+
+	/** Optional per-draw uniform buffer (e.g. object transform), bound at the material object UBO slot */
+	gfx::BufferHandle object_ubo;
+	uint32_t instance_count;
+	uint32_t first_instance;
+
+	DrawPacket(const MeshId in_mesh = 0,
+		const MaterialId in_material = 0,
+		const gfx::BufferHandle& in_object_ubo = {},
+		const uint32_t in_instance_count = 1,
+		const uint32_t in_first_instance = 0) : mesh(in_mesh), material(in_material), object_ubo(in_object_ubo),
+		instance_count(in_instance_count), first_instance(in_first_instance) {}
+};
+
+/**
+ * How packets of a pass are ordered
+ */
+enum class PassSortMode
+{
+	/** By pipeline, material and mesh, then front to back. For opaque geometry */
+	State,
+
+	/** Back to front first, then by state. For blended geometry */
+	BackToFront,
+};
+
+/**
+ * State changes issued when replaying, or that would have been issued in submission order
+ */
+struct RenderQueueStateChanges
+{
+	uint32_t pipelines = 0;
+	uint32_t materials = 0;
+	uint32_t object_ubos = 0;
+	uint32_t meshes = 0;
+};
+
+struct RenderQueueStatistics
+{
+	uint32_t packets = 0;
+	RenderQueueStateChanges sorted;
+	RenderQueueStateChanges unsorted;
+	float sort_time_ms = 0.f;
+
+	/** Negative when sorting issued more changes than the submission order would have */
+	[[nodiscard]] int64_t get_saved_state_changes() const
+	{
+		return static_cast<int64_t>(unsorted.pipelines + unsorted.materials + unsorted.object_ubos + unsorted.meshes) -
+			static_cast<int64_t>(sorted.pipelines + sorted.materials + sorted.object_ubos + sorted.meshes);
+	}
+};
+
+/**
+ * Collects draw packets, sorts them by a 64-bit key and replays them into a command list with the
+ * minimal amount of pipeline, descriptor and vertex/index buffer changes
+ *
+ * Key layout (MSB to LSB):
+ * State:       pass (4) | pipeline (12) | material (14) | mesh (14) | depth (20)
+ * BackToFront: pass (4) | inverted depth (20) | pipeline (12) | material (14) | mesh (14)
+ * The pipeline field is a compact id of the (material shaders/rasterizer, mesh vertex layout) pair,
+ * so different materials sharing a pipeline are adjacent
+ */
+class RenderQueue
+{
+	struct Pipeline
+	{
+		MaterialId material;
+		MeshId mesh;
+		gfx::PipelineMaterialState state;
+	};
+
+	struct Packet
+	{
+		DrawPacket draw;
+		uint32_t pipeline;
+	};
+
+public:
+	static constexpr uint32_t max_passes = 1 << 4;
+	static constexpr uint32_t max_pipelines = 1 << 12;
+	static constexpr uint32_t max_materials = 1 << 14;
+	static constexpr uint32_t max_meshes = 1 << 14;
+
+	/**
+	 * \param in_sort_threads Maximum number of threads used to sort large queues, created once with the queue
+	 */
+	explicit RenderQueue(gfx::Device& in_device, const uint32_t in_sort_threads = 1);
+
+	RenderQueue(const RenderQueue&) = delete;
+	void operator=(const RenderQueue&) = delete;
+
+	[[nodiscard]] MeshId register_mesh(const RenderMesh& in_mesh);
+	[[nodiscard]] MaterialId register_material(RenderMaterial in_material);
+
+	void set_pass_sort_mode(const uint32_t in_pass, const PassSortMode in_mode);
+
+	/**
+	 * Queue a draw
+	 * \param in_depth View-space distance, used to order packets inside a pass
+	 */
+	void submit(const uint32_t in_pass, const float in_depth, const DrawPacket& in_packet);
+
+	/**
+	 * Sort and record all queued packets, then clear the queue
+	 * A render pass and its render pass state must be set
+	 */
+	void flush(const gfx::CommandListHandle& in_cmd_list);
+
+	[[nodiscard]] const RenderQueueStatistics& get_statistics() const { return statistics; }
+private:
+	[[nodiscard]] uint32_t get_or_create_pipeline(const MaterialId in_material, const MeshId in_mesh);
+	[[nodiscard]] uint64_t make_sort_key(const uint32_t in_pass,
+		const float in_depth,
+		const uint32_t in_pipeline,
+		const DrawPacket& in_packet) const;
+private:
+	gfx::Device& device;
+	RadixSorter sorter;
+	std::vector<RenderMesh> meshes;
+	std::vector<RenderMaterial> materials;
+
+	/** Hashes of each material's pipeline state (shaders, rasterizer) and of each mesh vertex layout */
+	std::vector<uint64_t> material_pipeline_hashes;
+	std::vector<uint64_t> mesh_pipeline_hashes;
+	std::vector<Pipeline> pipelines;
+
+	/** Pipeline hash to pipeline ids, collisions are resolved by comparing the states */
+	robin_hood::unordered_map<uint64_t, std::vector<uint32_t>> pipeline_ids;
+
+	std::array<PassSortMode, max_passes> pass_sort_modes;
+	std::vector<Packet> packets;
+	std::vector<RadixSortEntry> sort_entries;
+	std::vector<RadixSortEntry> sort_scratch;
+	RenderQueueStatistics statistics;
+};
+
+}
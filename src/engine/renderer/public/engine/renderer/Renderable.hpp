@@ -0,0 +1,70 @@
+#pragma once
+
+#include "engine/Core.hpp"
+#include "engine/gfx/Device.hpp"
+#include <variant>
+#include <vector>
+
+namespace cb::renderer
+{
+
+/**
+ * Geometry drawn by the renderers, buffers are not owned
+ * Vertex attributes must use binding 0
+ */
+struct RenderMesh
+{
+	gfx::BufferHandle vertex_buffer;
+	gfx::BufferHandle index_buffer;
+	gfx::IndexType index_type;
+	uint32_t index_count;
+	uint32_t first_index;
+	int32_t vertex_offset;
+	uint32_t vertex_stride;
+	std::vector<gfx::VertexInputAttributeDescription> attributes;
+
+	RenderMesh(const gfx::BufferHandle& in_vertex_buffer = {},
+		const gfx::BufferHandle& in_index_buffer = {},
+		const gfx::IndexType in_index_type = gfx::IndexType::Uint32,
+		const uint32_t in_index_count = 0,
+		const uint32_t in_vertex_stride = 0,
+		const std::vector<gfx::VertexInputAttributeDescription>& in_attributes = {},
+		const uint32_t in_first_index = 0,
+		const int32_t in_vertex_offset = 0) : vertex_buffer(in_vertex_buffer), index_buffer(in_index_buffer),
+		index_type(in_index_type), index_count(in_index_count), first_index(in_first_index),
+		vertex_offset(in_vertex_offset), vertex_stride(in_vertex_stride), attributes(in_attributes) {}
+};
+
+/**
+ * A descriptor bound before drawing with a material
+ */
+struct MaterialBinding
+{
+	uint32_t set;
+	uint32_t binding;
+	std::variant<gfx::BufferHandle, gfx::SamplerHandle, gfx::TextureViewHandle> resource;
+
+	MaterialBinding(const uint32_t in_set,
+		const uint32_t in_binding,
+		const std::variant<gfx::BufferHandle, gfx::SamplerHandle, gfx::TextureViewHandle>& in_resource)
+		: set(in_set), binding(in_binding), resource(in_resource) {}
+};
+
+/**
+ * Shaders and resources of a draw
+ * Vertex input comes from the mesh, instanced materials must read InstanceData at 
+ * InstancedRenderer::instance_attribute_location
+ */
+struct RenderMaterial
+{
+	std::vector<gfx::MaterialShaderStage> stages;
+	gfx::PipelineRasterizationStateCreateInfo rasterizer;
+	gfx::PipelineLayoutHandle pipeline_layout;
+	std::vector<MaterialBinding> bindings;
+
+	/** Where RenderQueue binds the per-draw uniform buffer of a DrawPacket */
+	uint32_t object_ubo_set = 0;
+	uint32_t object_ubo_binding = 0;
+};
+
+}
@@ -0,0 +1,147 @@
+#include "engine/shadercompiler/PipelineLayoutCache.hpp"
+#include <algorithm>
+#include <array>
+#include <tuple>
+#include <fmt/format.h>
+
+namespace cb::shadercompiler
+{
+
+PipelineLayoutCache::PipelineLayoutCache(gfx::Device& in_device) : device(in_device) {}
+
+PipelineLayoutCache::~PipelineLayoutCache()
+{
+	for(const auto& [layout_hash, bucket] : layouts)
+		for(const auto& layout : bucket)
+			device.destroy_pipeline_layout(layout.handle);
+}
+
+cb::Result<gfx::PipelineLayoutHandle, std::string> PipelineLayoutCache::get_or_create(
+	const std::span<const ShaderReflection* const>& in_shaders)
+{
+	auto merged = merge(in_shaders);
+	if(!merged)
+		return make_error(merged.get_error());
+
+	Layout& layout = merged.get_value();
+	const uint64_t layout_hash = compute_hash(layout);
+
+	auto& bucket = layouts[layout_hash];
+	if(auto it = std::ranges::find(bucket, layout); it != bucket.end())
+		return make_result(it->handle);
+
+	/** Sets the shaders don't use stay empty so set indices match the shaders */
+	std::array<std::vector<gfx::DescriptorSetLayoutBinding>, gfx::max_descriptor_sets> set_bindings;
+	std::array<gfx::DescriptorSetLayoutCreateInfo, gfx::max_descriptor_sets> set_layouts;
+	uint32_t set_count = 0;
+	gfx::BindingTable binding_table;
+	for(const auto& [binding, stage] : layout.bindings)
+	{
+		set_bindings[binding.set].emplace_back(binding.binding, binding.type, binding.count, stage);
+		set_count = std::max(set_count, binding.set + 1);
+		binding_table.insert({ fnv1a_64(binding.name), gfx::BindingSlot(binding.set, binding.binding, binding.type) });
+	}
+
+	for(uint32_t i = 0; i < set_count; ++i)
+		set_layouts[i] = gfx::DescriptorSetLayoutCreateInfo(set_bindings[i]);
+
+	std::vector<gfx::PushConstantRange> push_constant_ranges;
+	if(layout.push_constant_size > 0)
+		push_constant_ranges.emplace_back(layout.push_constant_stage, 0, layout.push_constant_size);
+
+	auto result = device.create_pipeline_layout(gfx::PipelineLayoutInfo(gfx::PipelineLayoutCreateInfo(
+		std::span(set_layouts.data(), set_count),
+		push_constant_ranges,
+		layout.bindless)).set_binding_table(std::move(binding_table)));
+	if(!result)
+		return make_error(fmt::format("Failed to create pipeline layout: {}", result.get_error()));
+
+	layout.handle = result.get_value();
+	bucket.emplace_back(std::move(layout));
+	layout_count++;
+
+	return make_result(bucket.back().handle);
+}
+
+cb::Result<PipelineLayoutCache::Layout, std::string> PipelineLayoutCache::merge(
+	const std::span<const ShaderReflection* const>& in_shaders)
+{
+	Layout layout;
+
+	for(const ShaderReflection* shader : in_shaders)
+	{
+		for(const auto& binding : shader->bindings)
+		{
+			if(binding.set >= gfx::max_descriptor_sets || binding.binding >= gfx::max_bindings)
+				return make_error(fmt::format("{} is bound outside of the supported sets/bindings", binding.name));
+
+			auto it = std::ranges::find_if(layout.bindings, [&](const MergedBinding& in_other)
+			{
+				return in_other.binding.set == binding.set && in_other.binding.binding == binding.binding;
+			});
+
+			if(it == layout.bindings.end())
+			{
+				const bool name_taken = std::ranges::any_of(layout.bindings, [&](const MergedBinding& in_other)
+				{
+					return in_other.binding.name == binding.name;
+				});
+				if(name_taken)
+					return make_error(fmt::format("{} names several bindings", binding.name));
+
+				layout.bindings.push_back({ binding, gfx::ShaderStageFlags(shader->stage) });
+				continue;
+			}
+
+			if(it->binding.type != binding.type || it->binding.count != binding.count)
+			{
+				return make_error(fmt::format("{} (set {}, binding {}) is declared differently across stages",
+					binding.name,
+					binding.set,
+					binding.binding));
+			}
+
+			/** Stages may name the same slot differently, the first name is used for binding */
+			it->stage |= gfx::ShaderStageFlags(shader->stage);
+		}
+
+		if(shader->push_constant_size > 0)
+		{
+			layout.push_constant_stage |= gfx::ShaderStageFlags(shader->stage);
+			layout.push_constant_size = std::max(layout.push_constant_size, shader->push_constant_size);
+		}
+
+		layout.bindless |= shader->bindless;
+	}
+
+	if(layout.bindless && std::ranges::any_of(layout.bindings, [](const MergedBinding& in_binding)
+	{
+		return in_binding.binding.set >= gfx::bindless_descriptor_set;
+	}))
+		return make_error(std::string("Bindless shaders can't use the bindless set for regular bindings"));
+
+	std::ranges::sort(layout.bindings, [](const MergedBinding& in_a, const MergedBinding& in_b)
+	{
+		return std::tie(in_a.binding.set, in_a.binding.binding) < std::tie(in_b.binding.set, in_b.binding.binding);
+	});
+
+	return make_result(std::move(layout));
+}
+
+uint64_t PipelineLayoutCache::compute_hash(const Layout& in_layout)
+{
+	/** Stage flags are left to the equality check */
+	uint64_t hash = fnv1a_64("");
+	for(const auto& merged_binding : in_layout.bindings)
+	{
+		const ReflectedBinding& binding = merged_binding.binding;
+		hash = fnv1a_64(binding.name, hash);
+		const std::array values = { binding.set, binding.binding, static_cast<uint32_t>(binding.type), binding.count };
+		hash = fnv1a_64(std::string_view(reinterpret_cast<const char*>(values.data()), sizeof(values)), hash);
+	}
+
+	const std::array values = { in_layout.push_constant_size, static_cast<uint32_t>(in_layout.bindless) };
+	return fnv1a_64(std::string_view(reinterpret_cast<const char*>(values.data()), sizeof(values)), hash);
+}
+
+}
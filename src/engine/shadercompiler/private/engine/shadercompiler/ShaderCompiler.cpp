@@ -0,0 +1,560 @@
+#include "engine/shadercompiler/ShaderCompiler.hpp"
+#include "engine/Hash.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <robin_hood.h>
+#if CB_PLATFORM(WINDOWS)
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <Unknwn.h>
+#else
+#include <dlfcn.h>
+#endif
+#include <dxcapi.h>
+
+namespace cb::shadercompiler
+{
+
+namespace
+{
+
+/** Bump when the compile arguments or the cache layout change, invalidates every cached shader */
+constexpr uint32_t cache_format_version = 2;
+constexpr uint32_t spirv_magic = 0x07230203;
+
+/**
+ * Incremental fnv1a_64, stable across runs and platforms unlike std::hash
+ */
+class KeyHasher
+{
+public:
+	void add(const void* in_data, const size_t in_size)
+	{
+		hash = fnv1a_64({ static_cast<const char*>(in_data), in_size }, hash);
+	}
+
+	/** Size prefixed so consecutive fields can't be confused ("ab" + "c" vs "a" + "bc") */
+	void add(const std::string_view& in_string)
+	{
+		const uint64_t size = in_string.size();
+		add(&size, sizeof(size));
+		add(in_string.data(), in_string.size());
+	}
+
+	[[nodiscard]] uint64_t get() const { return hash; }
+private:
+	uint64_t hash = fnv1a_64({});
+};
+
+bool read_file(const std::filesystem::path& in_path, std::vector<uint8_t>& out_data)
+{
+	std::ifstream file(in_path, std::ios::ate | std::ios::binary);
+	if(!file.is_open())
+		return false;
+
+	const size_t file_size = file.tellg();
+	out_data.resize(file_size);
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(out_data.data()), file_size);
+	return file.good();
+}
+
+/**
+ * Write to a temporary file first then rename it, other processes never see a partially written entry
+ */
+void write_file_atomic(const std::string& in_path, const std::vector<uint8_t>& in_data)
+{
+	const std::string temp_path = fmt::format("{}.{}.tmp", in_path,
+		std::hash<std::thread::id>()(std::this_thread::get_id()));
+	{
+		std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+		if(!file.is_open())
+			return;
+
+		file.write(reinterpret_cast<const char*>(in_data.data()), in_data.size());
+		if(!file.good())
+			return;
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temp_path, in_path, error);
+	if(error)
+		std::filesystem::remove(temp_path, error);
+}
+
+bool is_valid_spirv(const std::vector<uint8_t>& in_bytecode)
+{
+	if(in_bytecode.size() < sizeof(uint32_t) || in_bytecode.size() % sizeof(uint32_t) != 0)
+		return false;
+
+	uint32_t magic;
+	memcpy(&magic, in_bytecode.data(), sizeof(magic));
+	return magic == spirv_magic;
+}
+
+std::string get_profile(const gfx::ShaderStageFlagBits in_stage, const gfx::ShaderModel in_shader_model)
+{
+	using namespace gfx;
+
+	std::string_view stage;
+	switch(in_stage)
+	{
+	case ShaderStageFlagBits::Vertex:
+		stage = "vs";
+		break;
+	case ShaderStageFlagBits::TessellationControl:
+		stage = "hs";
+		break;
+	case ShaderStageFlagBits::TessellationEvaluation:
+		stage = "ds";
+		break;
+	case ShaderStageFlagBits::Geometry:
+		stage = "gs";
+		break;
+	case ShaderStageFlagBits::Fragment:
+		stage = "ps";
+		break;
+	case ShaderStageFlagBits::Compute:
+		stage = "cs";
+		break;
+	}
+
+	return fmt::format("{}_{}", stage, in_shader_model == ShaderModel::SM6_5 ? "6_5" : "6_0");
+}
+
+/**
+ * Find the file an #include directive refers to, quoted includes are first searched next to the including file
+ */
+std::filesystem::path resolve_include(const std::filesystem::path& in_including_dir,
+	const std::string_view& in_name,
+	const bool in_quoted,
+	const std::vector<std::string>& in_include_dirs)
+{
+	std::error_code error;
+	if(in_quoted)
+	{
+		const auto path = (in_including_dir / in_name).lexically_normal();
+		if(std::filesystem::is_regular_file(path, error))
+			return path;
+	}
+
+	for(const auto& dir : in_include_dirs)
+	{
+		const auto path = (std::filesystem::path(dir) / in_name).lexically_normal();
+		if(std::filesystem::is_regular_file(path, error))
+			return path;
+	}
+
+	return {};
+}
+
+/**
+ * Hash every file included by in_source, recursively
+ * This is a plain text scan, includes inside disabled #if blocks are hashed too which can only cause extra misses
+ */
+void hash_includes(const std::filesystem::path& in_path,
+	const std::vector<uint8_t>& in_source,
+	const std::vector<std::string>& in_include_dirs,
+	robin_hood::unordered_set<std::string>& in_visited,
+	KeyHasher& in_hasher)
+{
+	const std::string_view source(reinterpret_cast<const char*>(in_source.data()), in_source.size());
+	const auto including_dir = in_path.parent_path();
+
+	for(size_t pos = source.find("#include"); pos != std::string_view::npos; pos = source.find("#include", pos))
+	{
+		pos += std::string_view("#include").size();
+		while(pos < source.size() && (source[pos] == ' ' || source[pos] == '\t'))
+			pos++;
+
+		if(pos >= source.size() || (source[pos] != '"' && source[pos] != '<'))
+			continue;
+
+		const bool quoted = source[pos] == '"';
+		const size_t end = source.find_first_of(quoted ? "\"\n" : ">\n", pos + 1);
+		if(end == std::string_view::npos || source[end] == '\n')
+			continue;
+
+		const std::string_view name = source.substr(pos + 1, end - pos - 1);
+		const auto include_path = resolve_include(including_dir, name, quoted, in_include_dirs);
+		in_hasher.add(name);
+
+		/** Unresolved includes only hash their name, DXC will report them */
+		std::vector<uint8_t> include_source;
+		if(include_path.empty() || !in_visited.insert(include_path.string()).second ||
+			!read_file(include_path, include_source))
+			continue;
+
+		in_hasher.add({ reinterpret_cast<const char*>(include_source.data()), include_source.size() });
+		hash_includes(include_path, include_source, in_include_dirs, in_visited, in_hasher);
+	}
+}
+
+template<typename T>
+class DxcPtr
+{
+public:
+	DxcPtr() = default;
+	~DxcPtr() { if(ptr) ptr->Release(); }
+
+	DxcPtr(const DxcPtr&) = delete;
+	void operator=(const DxcPtr&) = delete;
+
+	T* operator->() const { return ptr; }
+	T** operator&() { return &ptr; }
+	T* get() const { return ptr; }
+	explicit operator bool() const { return ptr != nullptr; }
+private:
+	T* ptr = nullptr;
+};
+
+struct DxcLibrary
+{
+	DxcCreateInstanceProc create_instance = nullptr;
+
+	/** Reported by the library itself, part of every cache key */
+	std::string version = "unavailable";
+};
+
+#if !CB_PLATFORM(WINDOWS)
+/**
+ * The DXC shipped next to the executable first, then the one found at configure time, then the loader search path
+ */
+void* load_dxc_library()
+{
+	std::vector<std::string> paths;
+	std::error_code error;
+	if(const auto executable = std::filesystem::read_symlink("/proc/self/exe", error); !error)
+		paths.emplace_back((executable.parent_path() / "libdxcompiler.so").string());
+#ifdef CB_DXC_LIBRARY_PATH
+	paths.emplace_back(CB_DXC_LIBRARY_PATH);
+#endif
+	paths.emplace_back("libdxcompiler.so");
+
+	for(const auto& path : paths)
+	{
+		if(void* library = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL))
+		{
+			logger::verbose(log_shadercompiler, "Loading DXC from {}", path);
+			return library;
+		}
+	}
+
+	return nullptr;
+}
+#endif
+
+/**
+ * major.minor.commits, commits is only known when the library implements IDxcVersionInfo2
+ */
+std::string query_dxc_version(const DxcCreateInstanceProc in_create_instance, 
+	void (*in_free)(void*))
+{
+	DxcPtr<IDxcCompiler3> compiler;
+	DxcPtr<IDxcVersionInfo> version_info;
+	UINT32 major = 0;
+	UINT32 minor = 0;
+	if(FAILED(in_create_instance(CLSID_DxcCompiler, IID_PPV_ARGS(&compiler))) ||
+		FAILED(compiler->QueryInterface(IID_PPV_ARGS(&version_info))) ||
+		FAILED(version_info->GetVersion(&major, &minor)))
+		return "unavailable";
+
+	UINT32 commit_count = 0;
+	char* commit_hash = nullptr;
+	DxcPtr<IDxcVersionInfo2> version_info2;
+	if(FAILED(compiler->QueryInterface(IID_PPV_ARGS(&version_info2))) ||
+		FAILED(version_info2->GetCommitInfo(&commit_count, &commit_hash)))
+		return fmt::format("{}.{}", major, minor);
+
+	std::string version = fmt::format("{}.{}.{}", major, minor, commit_count);
+	if(commit_hash && in_free)
+		in_free(commit_hash);
+	return version;
+}
+
+/**
+ * Loaded the first time a cache key is computed and never unloaded, only cache misses create compilers
+ */
+const DxcLibrary& get_dxc_library()
+{
+	static const DxcLibrary dxc = []()
+	{
+		const auto start_time = std::chrono::high_resolution_clock::now();
+
+		DxcLibrary library;
+#if CB_PLATFORM(WINDOWS)
+		HMODULE module = LoadLibraryA("dxcompiler.dll");
+		library.create_instance = module ? 
+			reinterpret_cast<DxcCreateInstanceProc>(GetProcAddress(module, "DxcCreateInstance")) : nullptr;
+		void (*free_memory)(void*) = CoTaskMemFree;
+#else
+		void* module = load_dxc_library();
+		library.create_instance = module ? 
+			reinterpret_cast<DxcCreateInstanceProc>(dlsym(module, "DxcCreateInstance")) : nullptr;
+
+		/** Strings returned by DXC are freed with its own CoTaskMemFree outside of Windows */
+		auto* free_memory = module ? reinterpret_cast<void (*)(void*)>(dlsym(module, "CoTaskMemFree")) : nullptr;
+#endif
+		if(!library.create_instance)
+		{
+			logger::error(log_shadercompiler, "Failed to load the DXC shared library");
+			return library;
+		}
+
+		library.version = query_dxc_version(library.create_instance, free_memory);
+		logger::info(log_shadercompiler, "Loaded DXC {} in {:.2f} ms", library.version,
+			std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start_time).count());
+		return library;
+	}();
+
+	return dxc;
+}
+
+/**
+ * DXC compilers are not thread-safe, each thread creates its own the first time it compiles something
+ */
+struct DxcContext
+{
+	DxcPtr<IDxcUtils> utils;
+	DxcPtr<IDxcCompiler3> compiler;
+	DxcPtr<IDxcIncludeHandler> include_handler;
+
+	static DxcContext* get()
+	{
+		thread_local DxcContext context;
+		if(!context.compiler)
+		{
+			auto create_instance = get_dxc_library().create_instance;
+			if(!create_instance ||
+				FAILED(create_instance(CLSID_DxcUtils, IID_PPV_ARGS(&context.utils))) ||
+				FAILED(context.utils->CreateDefaultIncludeHandler(&context.include_handler)) ||
+				FAILED(create_instance(CLSID_DxcCompiler, IID_PPV_ARGS(&context.compiler))))
+				return nullptr;
+		}
+
+		return &context;
+	}
+};
+
+std::wstring widen(const std::string_view& in_string)
+{
+	return { in_string.begin(), in_string.end() };
+}
+
+}
+
+ShaderCompiler::ShaderCompiler(const std::string& in_cache_dir, const std::vector<std::string>& in_include_dirs) :
+	cache_dir(in_cache_dir), include_dirs(in_include_dirs), cache_hits(0), cache_misses(0), compile_time_us(0)
+{
+	if(!cache_dir.empty())
+	{
+		std::error_code error;
+		std::filesystem::create_directories(cache_dir, error);
+		if(error)
+		{
+			logger::warn(log_shadercompiler, "Cannot create shader cache directory {}, disk cache disabled", cache_dir);
+			cache_dir.clear();
+		}
+	}
+}
+
+ShaderCompiler::~ShaderCompiler() = default;
+
+cb::Result<std::vector<uint8_t>, std::string> ShaderCompiler::compile(const ShaderCompileInfo& in_info)
+{
+	Output output;
+	compile_or_load(in_info, output);
+	if(!output.errors.empty())
+		return make_error(std::move(output.errors));
+
+	return make_result(std::move(output.bytecode));
+}
+
+std::vector<cb::Result<std::vector<uint8_t>, std::string>> ShaderCompiler::compile(
+	const std::span<const ShaderCompileInfo>& in_infos,
+	const uint32_t in_max_threads)
+{
+	if(in_infos.empty())
+		return {};
+
+	std::vector<Output> outputs(in_infos.size());
+	std::atomic_size_t next_shader = 0;
+	const auto compile_shaders = [&]()
+	{
+		for(size_t i = next_shader++; i < in_infos.size(); i = next_shader++)
+			compile_or_load(in_infos[i], outputs[i]);
+	};
+
+	const uint32_t thread_count = static_cast<uint32_t>(std::clamp<size_t>(in_max_threads, 1, in_infos.size()));
+	std::vector<std::thread> threads;
+	threads.reserve(thread_count - 1);
+	for(uint32_t i = 1; i < thread_count; ++i)
+		threads.emplace_back(compile_shaders);
+
+	compile_shaders();
+
+	for(auto& thread : threads)
+		thread.join();
+
+	std::vector<cb::Result<std::vector<uint8_t>, std::string>> results;
+	results.reserve(outputs.size());
+	for(auto& output : outputs)
+	{
+		if(output.errors.empty())
+			results.emplace_back(std::move(output.bytecode));
+		else
+			results.emplace_back(std::move(output.errors));
+	}
+
+	return results;
+}
+
+cb::Result<uint64_t, std::string> ShaderCompiler::get_key(const ShaderCompileInfo& in_info) const
+{
+	std::vector<uint8_t> source;
+	if(!read_file(in_info.path, source))
+		return make_error(fmt::format("Cannot open {}", in_info.path));
+
+	return make_result(compute_key(in_info, source));
+}
+
+ShaderCompilerStatistics ShaderCompiler::get_statistics() const
+{
+	ShaderCompilerStatistics statistics;
+	statistics.cache_hits = cache_hits;
+	statistics.cache_misses = cache_misses;
+	statistics.compile_time_ms = static_cast<float>(compile_time_us) / 1000.f;
+	return statistics;
+}
+
+void ShaderCompiler::compile_or_load(const ShaderCompileInfo& in_info, Output& out_output)
+{
+	std::vector<uint8_t> source;
+	if(!read_file(in_info.path, source))
+	{
+		out_output.errors = fmt::format("Cannot open {}", in_info.path);
+		return;
+	}
+
+	const uint64_t key = compute_key(in_info, source);
+	const std::string cache_path = get_cache_path(key);
+	if(!cache_dir.empty() && read_file(cache_path, out_output.bytecode) && is_valid_spirv(out_output.bytecode))
+	{
+		logger::verbose(log_shadercompiler, "Loaded {} from cache ({:016x})", in_info.path, key);
+		cache_hits++;
+		return;
+	}
+
+	cache_misses++;
+
+	DxcContext* dxc = DxcContext::get();
+	if(!dxc)
+	{
+		out_output.errors = fmt::format("Cannot compile {}: DXC is not available", in_info.path);
+		return;
+	}
+
+	const auto start_time = std::chrono::high_resolution_clock::now();
+
+	std::vector<std::wstring> args =
+	{
+		widen(in_info.path),
+		L"-E", widen(in_info.entry_point),
+		L"-T", widen(get_profile(in_info.stage, in_info.shader_model)),
+		L"-spirv",
+		L"-Qstrip_debug",
+		L"-WX",
+		L"-Zpr",
+	};
+
+	for(const auto& define : in_info.defines)
+	{
+		args.emplace_back(L"-D");
+		args.emplace_back(widen(define.name + "=" + define.value));
+	}
+
+	for(const auto& dir : include_dirs)
+	{
+		args.emplace_back(L"-I");
+		args.emplace_back(widen(dir));
+	}
+
+	std::vector<LPCWSTR> arg_ptrs;
+	arg_ptrs.reserve(args.size());
+	for(const auto& arg : args)
+		arg_ptrs.emplace_back(arg.c_str());
+
+	DxcBuffer buffer { source.data(), source.size(), DXC_CP_UTF8 };
+	DxcPtr<IDxcResult> result;
+	if(FAILED(dxc->compiler->Compile(&buffer,
+		arg_ptrs.data(),
+		static_cast<UINT32>(arg_ptrs.size()),
+		dxc->include_handler.get(),
+		IID_PPV_ARGS(&result))))
+	{
+		out_output.errors = fmt::format("Cannot compile {}: DXC failed", in_info.path);
+		return;
+	}
+
+	HRESULT status = E_FAIL;
+	result->GetStatus(&status);
+
+	DxcPtr<IDxcBlobUtf8> errors;
+	result->GetOutput(DXC_OUT_ERRORS, IID_PPV_ARGS(&errors), nullptr);
+
+	DxcPtr<IDxcBlob> bytecode;
+	result->GetOutput(DXC_OUT_OBJECT, IID_PPV_ARGS(&bytecode), nullptr);
+
+	const uint64_t elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::high_resolution_clock::now() - start_time).count();
+	compile_time_us += elapsed_us;
+
+	if(FAILED(status) || !bytecode || bytecode->GetBufferSize() == 0)
+	{
+		out_output.errors = errors && errors->GetStringLength() > 0 ?
+			std::string(errors->GetStringPointer(), errors->GetStringLength()) :
+			fmt::format("Cannot compile {}", in_info.path);
+		return;
+	}
+
+	const auto* data = static_cast<const uint8_t*>(bytecode->GetBufferPointer());
+	out_output.bytecode = { data, data + bytecode->GetBufferSize() };
+	logger::info(log_shadercompiler, "Compiled {} in {:.2f} ms", in_info.path, static_cast<float>(elapsed_us) / 1000.f);
+
+	if(!cache_dir.empty())
+		write_file_atomic(cache_path, out_output.bytecode);
+}
+
+uint64_t ShaderCompiler::compute_key(const ShaderCompileInfo& in_info, const std::vector<uint8_t>& in_source) const
+{
+	KeyHasher hasher;
+	hasher.add(&cache_format_version, sizeof(cache_format_version));
+	hasher.add(get_dxc_library().version);
+	hasher.add(in_info.entry_point);
+	hasher.add(get_profile(in_info.stage, in_info.shader_model));
+	for(const auto& define : in_info.defines)
+	{
+		hasher.add(define.name);
+		hasher.add(define.value);
+	}
+
+	for(const auto& dir : include_dirs)
+		hasher.add(dir);
+
+	hasher.add({ reinterpret_cast<const char*>(in_source.data()), in_source.size() });
+
+	robin_hood::unordered_set<std::string> visited;
+	hash_includes(in_info.path, in_source, include_dirs, visited, hasher);
+	return hasher.get();
+}
+
+std::string ShaderCompiler::get_cache_path(const uint64_t in_key) const
+{
+	return fmt::format("{}/{:016x}.spv", cache_dir, in_key);
+}
+
+}
@@ -0,0 +1,568 @@
+#include "engine/shadercompiler/ShaderReflection.hpp"
+#include <algorithm>
+#include <cstring>
+#include <tuple>
+#include <fmt/format.h>
+#include <robin_hood.h>
+
+namespace cb::shadercompiler
+{
+
+namespace
+{
+
+constexpr uint32_t spirv_magic = 0x07230203;
+constexpr size_t spirv_header_words = 5;
+
+enum class Op : uint16_t
+{
+	Name = 5,
+	EntryPoint = 15,
+	TypeInt = 21,
+	TypeFloat = 22,
+	TypeVector = 23,
+	TypeMatrix = 24,
+	TypeImage = 25,
+	TypeSampler = 26,
+	TypeSampledImage = 27,
+	TypeArray = 28,
+	TypeRuntimeArray = 29,
+	TypeStruct = 30,
+	TypePointer = 32,
+	Constant = 43,
+	Variable = 59,
+	Decorate = 71,
+	MemberDecorate = 72,
+};
+
+enum class Decoration : uint32_t
+{
+	Block = 2,
+	BufferBlock = 3,
+	ArrayStride = 6,
+	MatrixStride = 7,
+	BuiltIn = 11,
+	Location = 30,
+	Binding = 33,
+	DescriptorSet = 34,
+	Offset = 35,
+};
+
+enum class StorageClass : uint32_t
+{
+	UniformConstant = 0,
+	Input = 1,
+	Uniform = 2,
+	PushConstant = 9,
+	StorageBuffer = 12,
+};
+
+enum class ExecutionModel : uint32_t
+{
+	Vertex = 0,
+	TessellationControl = 1,
+	TessellationEvaluation = 2,
+	Geometry = 3,
+	Fragment = 4,
+	GLCompute = 5,
+};
+
+constexpr uint32_t image_dim_buffer = 5;
+constexpr uint32_t image_dim_subpass_data = 6;
+constexpr uint32_t image_sampled = 1;
+constexpr uint32_t image_storage = 2;
+
+constexpr uint32_t invalid_id = ~0u;
+
+struct Decorations
+{
+	uint32_t set = invalid_id;
+	uint32_t binding = invalid_id;
+	uint32_t location = invalid_id;
+	uint32_t array_stride = 0;
+	bool block = false;
+	bool buffer_block = false;
+	bool builtin = false;
+
+	/** Per struct member */
+	std::vector<uint32_t> member_offsets;
+	std::vector<uint32_t> member_matrix_strides;
+};
+
+struct Variable
+{
+	uint32_t id;
+	uint32_t pointer_type;
+	StorageClass storage_class;
+};
+
+/**
+ * Ids of a SPIR-V module, only the instructions needed to describe the interface of a shader are kept
+ */
+class Module
+{
+public:
+	cb::Result<ShaderReflection, std::string> parse(const std::span<const uint32_t>& in_words)
+	{
+		ShaderReflection reflection;
+
+		if(in_words.size() < spirv_header_words || in_words[0] != spirv_magic)
+			return make_error(std::string("Not a SPIR-V module"));
+
+		bool has_entry_point = false;
+		for(size_t i = spirv_header_words; i < in_words.size();)
+		{
+			const uint32_t word_count = in_words[i] >> 16;
+			const auto op = static_cast<Op>(in_words[i] & 0xFFFF);
+			if(word_count == 0 || i + word_count > in_words.size())
+				return make_error(std::string("Truncated SPIR-V instruction"));
+
+			const auto operands = in_words.subspan(i + 1, word_count - 1);
+			i += word_count;
+
+			switch(op)
+			{
+			case Op::Name:
+				names[operands[0]] = read_string(operands.subspan(1));
+				break;
+			case Op::EntryPoint:
+			{
+				if(has_entry_point)
+					return make_error(std::string("Modules with several entry points are not supported"));
+
+				auto stage = get_stage(static_cast<ExecutionModel>(operands[0]));
+				if(!stage)
+					return make_error(stage.get_error());
+
+				reflection.stage = stage.get_value();
+				has_entry_point = true;
+				break;
+			}
+			case Op::TypeInt:
+			case Op::TypeFloat:
+			case Op::TypeVector:
+			case Op::TypeMatrix:
+			case Op::TypeImage:
+			case Op::TypeSampler:
+			case Op::TypeSampledImage:
+			case Op::TypeArray:
+			case Op::TypeRuntimeArray:
+			case Op::TypeStruct:
+				types[operands[0]] = { op, std::vector<uint32_t>(operands.begin() + 1, operands.end()) };
+				break;
+			case Op::TypePointer:
+				/** Storage class, pointee */
+				types[operands[0]] = { op, { operands[1], operands[2] } };
+				break;
+			case Op::Constant:
+				/** Only 32-bit integer constants are needed, to size arrays */
+				constants[operands[1]] = operands.size() > 2 ? operands[2] : 0;
+				break;
+			case Op::Variable:
+				variables.push_back({ operands[1], operands[0], static_cast<StorageClass>(operands[2]) });
+				break;
+			case Op::Decorate:
+				decorate(decorations[operands[0]], static_cast<Decoration>(operands[1]), operands.subspan(2));
+				break;
+			case Op::MemberDecorate:
+				decorate_member(decorations[operands[0]], operands[1], static_cast<Decoration>(operands[2]),
+					operands.subspan(3));
+				break;
+			default:
+				break;
+			}
+		}
+
+		if(!has_entry_point)
+			return make_error(std::string("No entry point"));
+
+		for(const auto& variable : variables)
+		{
+			auto result = reflect_variable(variable, reflection);
+			if(!result)
+				return make_error(result.get_error());
+		}
+
+		std::ranges::sort(reflection.bindings, [](const ReflectedBinding& in_a, const ReflectedBinding& in_b)
+		{
+			return std::tie(in_a.set, in_a.binding) < std::tie(in_b.set, in_b.binding);
+		});
+
+		std::ranges::sort(reflection.vertex_inputs, {}, &ReflectedVertexInput::location);
+
+		return make_result(std::move(reflection));
+	}
+private:
+	struct Type
+	{
+		Op op;
+
+		/** Operands after the result id */
+		std::vector<uint32_t> operands;
+	};
+
+	cb::Result<bool, std::string> reflect_variable(const Variable& in_variable, ShaderReflection& out_reflection) const
+	{
+		const Type* pointer = get_type(in_variable.pointer_type);
+		if(!pointer || pointer->op != Op::TypePointer)
+			return make_error(std::string("Variable without a pointer type"));
+
+		const uint32_t type_id = pointer->operands[1];
+		const Decorations* variable_decorations = get_decorations(in_variable.id);
+
+		switch(in_variable.storage_class)
+		{
+		case StorageClass::PushConstant:
+			out_reflection.push_constant_size = std::max(out_reflection.push_constant_size, get_size(type_id));
+			return make_result(true);
+		case StorageClass::Input:
+			if(out_reflection.stage == gfx::ShaderStageFlagBits::Vertex &&
+				variable_decorations &&
+				!variable_decorations->builtin &&
+				variable_decorations->location != invalid_id)
+			{
+				out_reflection.vertex_inputs.emplace_back(get_name(in_variable.id),
+					variable_decorations->location,
+					get_vertex_format(type_id));
+			}
+			return make_result(true);
+		case StorageClass::UniformConstant:
+		case StorageClass::Uniform:
+		case StorageClass::StorageBuffer:
+			break;
+		default:
+			return make_result(true);
+		}
+
+		if(!variable_decorations ||
+			variable_decorations->set == invalid_id ||
+			variable_decorations->binding == invalid_id)
+			return make_error(fmt::format("{} has no descriptor set or binding", get_name(in_variable.id)));
+
+		/** Resources of the global bindless set are indexed, never bound by name */
+		if(variable_decorations->set == gfx::bindless_descriptor_set)
+		{
+			out_reflection.bindless = true;
+			return make_result(true);
+		}
+
+		uint32_t count = 1;
+		uint32_t element_type_id = type_id;
+		if(const Type* type = get_type(type_id); type && type->op == Op::TypeArray)
+		{
+			count = get_constant(type->operands[1]);
+			element_type_id = type->operands[0];
+		}
+		else if(type && type->op == Op::TypeRuntimeArray)
+		{
+			return make_error(fmt::format("{} is an unbounded array outside of the bindless set",
+				get_name(in_variable.id)));
+		}
+
+		auto descriptor_type = get_descriptor_type(in_variable.storage_class, element_type_id);
+		if(!descriptor_type)
+			return make_error(fmt::format("{}: {}", get_name(in_variable.id), descriptor_type.get_error()));
+
+		std::string name = get_name(in_variable.id);
+		if(name.empty())
+		{
+			/** Anonymous cbuffers are named after their type, "type.<name>" with DXC */
+			name = get_name(element_type_id);
+			if(name.starts_with("type."))
+				name.erase(0, 5);
+		}
+
+		out_reflection.bindings.emplace_back(name,
+			variable_decorations->set,
+			variable_decorations->binding,
+			descriptor_type.get_value(),
+			count);
+		return make_result(true);
+	}
+
+	cb::Result<gfx::DescriptorType, std::string> get_descriptor_type(const StorageClass in_storage_class,
+		const uint32_t in_type_id) const
+	{
+		const Type* type = get_type(in_type_id);
+		if(!type)
+			return make_error(std::string("Unknown type"));
+
+		if(in_storage_class == StorageClass::StorageBuffer)
+			return make_error(std::string("Storage buffers are only supported through the bindless set"));
+
+		if(in_storage_class == StorageClass::Uniform)
+		{
+			const Decorations* type_decorations = get_decorations(in_type_id);
+			if(type->op == Op::TypeStruct && type_decorations && type_decorations->block)
+				return make_result(gfx::DescriptorType::UniformBuffer);
+
+			return make_error(std::string("Storage buffers are only supported through the bindless set"));
+		}
+
+		switch(type->op)
+		{
+		case Op::TypeSampler:
+			return make_result(gfx::DescriptorType::Sampler);
+		case Op::TypeImage:
+		{
+			/** Sampled type, dim, depth, arrayed, multisampled, sampled, format */
+			const uint32_t dim = type->operands[1];
+			const uint32_t sampled = type->operands[5];
+			if(dim == image_dim_subpass_data)
+				return make_result(gfx::DescriptorType::InputAttachment);
+
+			if(dim == image_dim_buffer)
+				return make_error(std::string("Texel buffers are not supported"));
+
+			if(sampled == image_sampled)
+				return make_result(gfx::DescriptorType::SampledTexture);
+
+			if(sampled == image_storage)
+				return make_result(gfx::DescriptorType::StorageTexture);
+
+			return make_error(std::string("Images must be known to be sampled or storage at compile time"));
+		}
+		case Op::TypeSampledImage:
+			return make_error(std::string("Combined image samplers are not supported"));
+		default:
+			return make_error(std::string("Unsupported descriptor type"));
+		}
+	}
+
+	[[nodiscard]] uint32_t get_size(const uint32_t in_type_id, const uint32_t in_matrix_stride = 0) const
+	{
+		const Type* type = get_type(in_type_id);
+		if(!type)
+			return 0;
+
+		switch(type->op)
+		{
+		case Op::TypeInt:
+		case Op::TypeFloat:
+			return type->operands[0] / 8;
+		case Op::TypeVector:
+			return get_size(type->operands[0]) * type->operands[1];
+		case Op::TypeMatrix:
+			return in_matrix_stride != 0 ? in_matrix_stride * type->operands[1]
+				: get_size(type->operands[0]) * type->operands[1];
+		case Op::TypeArray:
+		{
+			const Decorations* array_decorations = get_decorations(in_type_id);
+			const uint32_t stride = array_decorations && array_decorations->array_stride != 0
+				? array_decorations->array_stride
+				: get_size(type->operands[0]);
+			return stride * get_constant(type->operands[1]);
+		}
+		case Op::TypeStruct:
+		{
+			const Decorations* struct_decorations = get_decorations(in_type_id);
+			uint32_t size = 0;
+			for(size_t i = 0; i < type->operands.size(); ++i)
+			{
+				const uint32_t offset = struct_decorations && i < struct_decorations->member_offsets.size()
+					? struct_decorations->member_offsets[i] : 0;
+				const uint32_t matrix_stride = struct_decorations && i < struct_decorations->member_matrix_strides.size()
+					? struct_decorations->member_matrix_strides[i] : 0;
+				size = std::max(size, offset + get_size(type->operands[i], matrix_stride));
+			}
+			return size;
+		}
+		default:
+			return 0;
+		}
+	}
+
+	[[nodiscard]] gfx::Format get_vertex_format(const uint32_t in_type_id) const
+	{
+		const Type* type = get_type(in_type_id);
+		if(!type)
+			return gfx::Format::Undefined;
+
+		const Type* component = type->op == Op::TypeVector ? get_type(type->operands[0]) : type;
+		const uint32_t component_count = type->op == Op::TypeVector ? type->operands[1] : 1;
+		if(!component || component->operands[0] != 32)
+			return gfx::Format::Undefined;
+
+		if(component->op == Op::TypeFloat)
+		{
+			switch(component_count)
+			{
+			case 2:
+				return gfx::Format::R32G32Sfloat;
+			case 3:
+				return gfx::Format::R32G32B32Sfloat;
+			case 4:
+				return gfx::Format::R32G32B32A32Sfloat;
+			default:
+				return gfx::Format::Undefined;
+			}
+		}
+
+		/** Unsigned integers */
+		if(component->op == Op::TypeInt && component->operands[1] == 0)
+		{
+			switch(component_count)
+			{
+			case 1:
+				return gfx::Format::R32Uint;
+			case 4:
+				return gfx::Format::R32G32B32A32Uint;
+			default:
+				return gfx::Format::Undefined;
+			}
+		}
+
+		return gfx::Format::Undefined;
+	}
+
+	static void decorate(Decorations& out_decorations, const Decoration in_decoration,
+		const std::span<const uint32_t>& in_operands)
+	{
+		const uint32_t value = in_operands.empty() ? 0 : in_operands[0];
+		switch(in_decoration)
+		{
+		case Decoration::Block:
+			out_decorations.block = true;
+			break;
+		case Decoration::BufferBlock:
+			out_decorations.buffer_block = true;
+			break;
+		case Decoration::ArrayStride:
+			out_decorations.array_stride = value;
+			break;
+		case Decoration::BuiltIn:
+			out_decorations.builtin = true;
+			break;
+		case Decoration::Location:
+			out_decorations.location = value;
+			break;
+		case Decoration::Binding:
+			out_decorations.binding = value;
+			break;
+		case Decoration::DescriptorSet:
+			out_decorations.set = value;
+			break;
+		default:
+			break;
+		}
+	}
+
+	static void decorate_member(Decorations& out_decorations, const uint32_t in_member,
+		const Decoration in_decoration,
+		const std::span<const uint32_t>& in_operands)
+	{
+		if(in_operands.empty())
+			return;
+
+		std::vector<uint32_t>* values = nullptr;
+		if(in_decoration == Decoration::Offset)
+			values = &out_decorations.member_offsets;
+		else if(in_decoration == Decoration::MatrixStride)
+			values = &out_decorations.member_matrix_strides;
+		else
+			return;
+
+		if(values->size() <= in_member)
+			values->resize(in_member + 1, 0);
+
+		(*values)[in_member] = in_operands[0];
+	}
+
+	static cb::Result<gfx::ShaderStageFlagBits, std::string> get_stage(const ExecutionModel in_model)
+	{
+		switch(in_model)
+		{
+		case ExecutionModel::Vertex:
+			return make_result(gfx::ShaderStageFlagBits::Vertex);
+		case ExecutionModel::TessellationControl:
+			return make_result(gfx::ShaderStageFlagBits::TessellationControl);
+		case ExecutionModel::TessellationEvaluation:
+			return make_result(gfx::ShaderStageFlagBits::TessellationEvaluation);
+		case ExecutionModel::Geometry:
+			return make_result(gfx::ShaderStageFlagBits::Geometry);
+		case ExecutionModel::Fragment:
+			return make_result(gfx::ShaderStageFlagBits::Fragment);
+		case ExecutionModel::GLCompute:
+			return make_result(gfx::ShaderStageFlagBits::Compute);
+		default:
+			return make_error(std::string("Unsupported execution model"));
+		}
+	}
+
+	/** Nul-terminated UTF-8 packed in words */
+	static std::string read_string(const std::span<const uint32_t>& in_words)
+	{
+		const char* chars = reinterpret_cast<const char*>(in_words.data());
+		return std::string(chars, strnlen(chars, in_words.size() * sizeof(uint32_t)));
+	}
+
+	[[nodiscard]] const Type* get_type(const uint32_t in_id) const
+	{
+		auto it = types.find(in_id);
+		return it != types.end() ? &it->second : nullptr;
+	}
+
+	[[nodiscard]] const Decorations* get_decorations(const uint32_t in_id) const
+	{
+		auto it = decorations.find(in_id);
+		return it != decorations.end() ? &it->second : nullptr;
+	}
+
+	[[nodiscard]] std::string get_name(const uint32_t in_id) const
+	{
+		auto it = names.find(in_id);
+		return it != names.end() ? it->second : std::string();
+	}
+
+	[[nodiscard]] uint32_t get_constant(const uint32_t in_id) const
+	{
+		auto it = constants.find(in_id);
+		return it != constants.end() ? it->second : 0;
+	}
+private:
+	robin_hood::unordered_map<uint32_t, std::string> names;
+	robin_hood::unordered_map<uint32_t, Type> types;
+	robin_hood::unordered_map<uint32_t, uint32_t> constants;
+	robin_hood::unordered_map<uint32_t, Decorations> decorations;
+	std::vector<Variable> variables;
+};
+
+}
+
+cb::Result<ShaderReflection, std::string> ShaderReflection::reflect(const std::span<const uint8_t>& in_bytecode)
+{
+	if(in_bytecode.size() % sizeof(uint32_t) != 0)
+		return make_error(std::string("SPIR-V size is not a multiple of 4"));
+
+	/** The bytecode may not be aligned on 4 bytes */
+	std::vector<uint32_t> words(in_bytecode.size() / sizeof(uint32_t));
+	std::memcpy(words.data(), in_bytecode.data(), in_bytecode.size());
+
+	Module spirv_module;
+	return spirv_module.parse(words);
+}
+
+cb::Result<std::vector<gfx::VertexInputAttributeDescription>, std::string> ShaderReflection::make_vertex_attributes(
+	const uint32_t in_binding,
+	const uint32_t in_end_location,
+	uint32_t& out_stride) const
+{
+	std::vector<gfx::VertexInputAttributeDescription> attributes;
+	out_stride = 0;
+	for(const auto& input : vertex_inputs)
+	{
+		if(input.location >= in_end_location)
+			break;
+
+		const uint32_t size = gfx::get_format_texel_size(input.format);
+		if(size == 0)
+			return make_error(fmt::format("Vertex input {} has no vertex format", input.name));
+
+		attributes.emplace_back(input.location, in_binding, input.format, out_stride);
+		out_stride += size;
+	}
+
+	return make_result(std::move(attributes));
+}
+
+}
@@ -0,0 +1,143 @@
+#include "engine/shadercompiler/ShaderReloader.hpp"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+
+namespace cb::shadercompiler
+{
+
+ShaderReloader::ShaderReloader(gfx::Device& in_device, ShaderCompiler& in_compiler, const uint32_t in_max_threads) :
+	device(in_device), compiler(in_compiler), max_threads(std::max(in_max_threads, 1u))
+{
+	for(const auto& dir : compiler.get_include_dirs())
+		watch_directory(dir);
+}
+
+void ShaderReloader::add_shader(const gfx::ShaderHandle& in_shader, const ShaderCompileInfo& in_info, 
+	const ShaderReflection& in_reflection)
+{
+	auto key = compiler.get_key(in_info);
+	if(!key)
+	{
+		logger::warn(log_shadercompiler, "Cannot watch {}: {}", in_info.path, key.get_error());
+		return;
+	}
+
+	shaders.push_back({ in_shader, in_info, in_reflection, key.get_value() });
+
+	const std::string directory = std::filesystem::path(in_info.path).parent_path().string();
+	watch_directory(directory.empty() ? "." : directory);
+}
+
+void ShaderReloader::remove_shader(const gfx::ShaderHandle& in_shader)
+{
+	std::erase_if(shaders, [&](const Shader& in_other) { return in_other.handle == in_shader; });
+}
+
+uint32_t ShaderReloader::update()
+{
+	/** Every watcher is polled so events don't accumulate */
+	bool changed = false;
+	for(auto& watcher : watchers)
+		changed |= !watcher.poll().empty();
+
+	if(!changed)
+		return 0;
+
+	const auto start_time = std::chrono::high_resolution_clock::now();
+
+	std::vector<size_t> dirty_shaders;
+	std::vector<ShaderCompileInfo> infos;
+	std::vector<uint64_t> keys;
+	for(size_t i = 0; i < shaders.size(); ++i)
+	{
+		/** The file may be in the middle of being saved, it will trigger another event */
+		auto key = compiler.get_key(shaders[i].info);
+		if(!key)
+		{
+			logger::warn(log_shadercompiler, "Cannot reload {}, skipped: {}", shaders[i].info.path, key.get_error());
+			continue;
+		}
+
+		if(key.get_value() == shaders[i].key)
+			continue;
+
+		dirty_shaders.emplace_back(i);
+		infos.emplace_back(shaders[i].info);
+		keys.emplace_back(key.get_value());
+	}
+
+	if(infos.empty())
+		return 0;
+
+	auto results = compiler.compile(infos, max_threads);
+
+	uint32_t reloaded_shaders = 0;
+	size_t invalidated_pipelines = 0;
+	for(size_t i = 0; i < results.size(); ++i)
+	{
+		Shader& shader = shaders[dirty_shaders[i]];
+		if(!results[i])
+		{
+			/** Keep the previous version, fixing the error triggers a new reload */
+			logger::error(log_shadercompiler, "Failed to reload {}: {}", shader.info.path, results[i].get_error());
+			continue;
+		}
+
+		auto& bytecode = results[i].get_value();
+		auto reflection = ShaderReflection::reflect(bytecode);
+		if(!reflection)
+		{
+			logger::error(log_shadercompiler, "Failed to reflect {}: {}", shader.info.path, reflection.get_error());
+			continue;
+		}
+
+		/** Layouts built from the previous version can't be rebuilt behind the materials using them */
+		if(!reflection.get_value().has_same_interface(shader.reflection))
+		{
+			logger::error(log_shadercompiler, 
+				"Cannot reload {}: its bindings, push constants or vertex inputs changed, restart to apply it",
+				shader.info.path);
+			continue;
+		}
+
+		auto reload = device.reload_shader(shader.handle, gfx::ShaderInfo::make({ (uint32_t*) bytecode.data(),
+			bytecode.size() }));
+		if(!reload)
+		{
+			logger::error(log_shadercompiler, "Failed to reload {}: {}", shader.info.path, reload.get_error());
+			continue;
+		}
+
+		shader.key = keys[i];
+		invalidated_pipelines += reload.get_value();
+		reloaded_shaders++;
+	}
+
+	logger::info(log_shadercompiler, "Reloaded {} shader(s) in {:.2f} ms, {} pipeline(s) invalidated",
+		reloaded_shaders,
+		std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start_time).count(),
+		invalidated_pipelines);
+	return reloaded_shaders;
+}
+
+void ShaderReloader::watch_directory(const std::string& in_directory)
+{
+	const auto path = std::filesystem::path(in_directory).lexically_normal();
+	if(std::ranges::any_of(watchers, [&](const FileWatcher& in_watcher)
+	{
+		return std::filesystem::path(in_watcher.get_directory()).lexically_normal() == path;
+	}))
+		return;
+
+	auto watcher = FileWatcher::create(in_directory);
+	if(!watcher)
+	{
+		logger::warn(log_shadercompiler, "Cannot watch {}: {}", in_directory, std::to_string(watcher.get_error()));
+		return;
+	}
+
+	watchers.emplace_back(std::move(watcher.get_value()));
+}
+
+}
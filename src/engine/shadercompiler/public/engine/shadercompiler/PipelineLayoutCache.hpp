@@ -0,0 +1,80 @@
+#pragma once
+
+#include "engine/Core.hpp"
+#include "engine/Result.hpp"
+#include "engine/gfx/Device.hpp"
+#include "engine/shadercompiler/ShaderReflection.hpp"
+#include <span>
+#include <string>
+#include <vector>
+
+namespace cb::shadercompiler
+{
+
+/**
+ * Builds pipeline layouts from the reflection of the shaders of a pipeline
+ * Bindings of every stage are merged and a binding table is attached so descriptors can be bound by name.
+ * Identical layouts are created once and shared, the cache owns them
+ */
+class PipelineLayoutCache
+{
+	struct MergedBinding
+	{
+		ReflectedBinding binding;
+		gfx::ShaderStageFlags stage;
+
+		bool operator==(const MergedBinding& in_other) const
+		{
+			return binding.name == in_other.binding.name &&
+				binding.set == in_other.binding.set &&
+				binding.binding == in_other.binding.binding &&
+				binding.type == in_other.binding.type &&
+				binding.count == in_other.binding.count &&
+				stage == in_other.stage;
+		}
+	};
+
+	struct Layout
+	{
+		std::vector<MergedBinding> bindings;
+		gfx::ShaderStageFlags push_constant_stage;
+		uint32_t push_constant_size = 0;
+		bool bindless = false;
+		gfx::PipelineLayoutHandle handle;
+
+		bool operator==(const Layout& in_other) const
+		{
+			return bindings == in_other.bindings &&
+				push_constant_stage == in_other.push_constant_stage &&
+				push_constant_size == in_other.push_constant_size &&
+				bindless == in_other.bindless;
+		}
+	};
+
+public:
+	explicit PipelineLayoutCache(gfx::Device& in_device);
+	~PipelineLayoutCache();
+
+	PipelineLayoutCache(const PipelineLayoutCache&) = delete;
+	void operator=(const PipelineLayoutCache&) = delete;
+
+	/**
+	 * Get the layout matching the union of the resources used by in_shaders, creating it if needed
+	 * Fails if two stages use the same slot with different types or array sizes
+	 */
+	[[nodiscard]] cb::Result<gfx::PipelineLayoutHandle, std::string> get_or_create(
+		const std::span<const ShaderReflection* const>& in_shaders);
+
+	[[nodiscard]] size_t get_layout_count() const { return layout_count; }
+private:
+	[[nodiscard]] static cb::Result<Layout, std::string> merge(const std::span<const ShaderReflection* const>& in_shaders);
+	[[nodiscard]] static uint64_t compute_hash(const Layout& in_layout);
+private:
+	gfx::Device& device;
+
+	/** Layout hash to layouts, collisions are resolved by comparing merged descriptions */
+	robin_hood::unordered_map<uint64_t, std::vector<Layout>> layouts;
+	size_t layout_count = 0;
+};
+
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "engine/Core.hpp"
+#include "engine/Result.hpp"
+#include "engine/logger/Logger.hpp"
+#include "engine/gfx/Pipeline.hpp"
+#include "engine/gfx/ShaderFormat.hpp"
+#include <atomic>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace cb::shadercompiler
+{
+
+CB_DEFINE_LOG_CATEGORY(shadercompiler);
+
+struct ShaderDefine
+{
+	std::string name;
+	std::string value;
+
+	ShaderDefine(const std::string& in_name = "", const std::string& in_value = "1") : name(in_name), value(in_value) {}
+};
+
+/**
+ * A HLSL file to compile to SPIR-V
+ */
+struct ShaderCompileInfo
+{
+	std::string path;
+	gfx::ShaderStageFlagBits stage;
+	std::string entry_point;
+	gfx::ShaderModel shader_model;
+	std::vector<ShaderDefine> defines;
+
+	ShaderCompileInfo(const std::string& in_path = "",
+		const gfx::ShaderStageFlagBits in_stage = gfx::ShaderStageFlagBits::Vertex,
+		const std::string& in_entry_point = "main",
+		const gfx::ShaderModel in_shader_model = gfx::ShaderModel::SM6_0,
+		const std::vector<ShaderDefine>& in_defines = {}) : path(in_path), stage(in_stage), entry_point(in_entry_point),
+		shader_model(in_shader_model), defines(in_defines) {}
+};
+
+struct ShaderCompilerStatistics
+{
+	uint32_t cache_hits = 0;
+	uint32_t cache_misses = 0;
+
+	/** Time spent inside DXC, summed over all threads */
+	float compile_time_ms = 0.f;
+};
+
+/**
+ * Compiles HLSL to SPIR-V with DXC, backed by a content-addressed on-disk cache
+ *
+ * Each output is stored as <cache dir>/<key>.spv where the key hashes the source, every file it includes
+ * (recursively), the entry point, target profile, defines, include directories and the DXC version,
+ * so any change to one of them misses the cache and stale entries are simply never read again
+ * The DXC shared library is loaded to query its version, a warm start never creates a compiler
+ */
+class ShaderCompiler
+{
+public:
+	/**
+	 * \param in_cache_dir Directory storing compiled SPIR-V, created if needed. Empty disables the disk cache
+	 * \param in_include_dirs Searched after the directory of the including file
+	 */
+	explicit ShaderCompiler(const std::string& in_cache_dir = "shadercache",
+		const std::vector<std::string>& in_include_dirs = {});
+	~ShaderCompiler();
+
+	ShaderCompiler(const ShaderCompiler&) = delete;
+	void operator=(const ShaderCompiler&) = delete;
+
+	/**
+	 * Compile a single shader, or load it from the cache
+	 * \return SPIR-V bytecode, or the DXC error messages
+	 */
+	[[nodiscard]] cb::Result<std::vector<uint8_t>, std::string> compile(const ShaderCompileInfo& in_info);
+
+	/**
+	 * Compile several shaders, cache misses are compiled in parallel on up to in_max_threads threads
+	 * \return One result per shader, in the same order as in_infos
+	 */
+	[[nodiscard]] std::vector<cb::Result<std::vector<uint8_t>, std::string>> compile(
+		const std::span<const ShaderCompileInfo>& in_infos,
+		const uint32_t in_max_threads);
+
+	/**
+	 * Cache key of a shader, computed without compiling it. Changes whenever the compiled output may change
+	 */
+	[[nodiscard]] cb::Result<uint64_t, std::string> get_key(const ShaderCompileInfo& in_info) const;
+
+	[[nodiscard]] ShaderCompilerStatistics get_statistics() const;
+	[[nodiscard]] const std::vector<std::string>& get_include_dirs() const { return include_dirs; }
+private:
+	struct Output
+	{
+		std::vector<uint8_t> bytecode;
+		std::string errors;
+	};
+
+	void compile_or_load(const ShaderCompileInfo& in_info, Output& out_output);
+	[[nodiscard]] uint64_t compute_key(const ShaderCompileInfo& in_info, const std::vector<uint8_t>& in_source) const;
+	[[nodiscard]] std::string get_cache_path(const uint64_t in_key) const;
+private:
+	std::string cache_dir;
+	std::vector<std::string> include_dirs;
+
+	std::atomic_uint32_t cache_hits;
+	std::atomic_uint32_t cache_misses;
+	std::atomic_uint64_t compile_time_us;
+};
+
+}
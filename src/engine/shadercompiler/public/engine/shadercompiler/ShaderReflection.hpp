@@ -0,0 +1,107 @@
+#pragma once
+
+#include "engine/Core.hpp"
+#include "engine/Result.hpp"
+#include "engine/gfx/Format.hpp"
+#include "engine/gfx/GfxPipeline.hpp"
+#include "engine/gfx/PipelineLayout.hpp"
+#include <span>
+#include <string>
+#include <vector>
+
+namespace cb::shadercompiler
+{
+
+/**
+ * A descriptor used by a shader
+ */
+struct ReflectedBinding
+{
+	std::string name;
+	uint32_t set;
+	uint32_t binding;
+	gfx::DescriptorType type;
+
+	/** Array size, 1 for non-arrays */
+	uint32_t count;
+
+	ReflectedBinding(const std::string& in_name = "",
+		const uint32_t in_set = 0,
+		const uint32_t in_binding = 0,
+		const gfx::DescriptorType in_type = gfx::DescriptorType::UniformBuffer,
+		const uint32_t in_count = 1) : name(in_name), set(in_set), binding(in_binding), type(in_type), count(in_count) {}
+
+	bool operator==(const ReflectedBinding& in_other) const
+	{
+		return name == in_other.name &&
+			set == in_other.set &&
+			binding == in_other.binding &&
+			type == in_other.type &&
+			count == in_other.count;
+	}
+};
+
+struct ReflectedVertexInput
+{
+	std::string name;
+	uint32_t location;
+
+	/** Undefined when the type has no matching gfx::Format */
+	gfx::Format format;
+
+	ReflectedVertexInput(const std::string& in_name = "",
+		const uint32_t in_location = 0,
+		const gfx::Format in_format = gfx::Format::Undefined) : name(in_name), location(in_location), format(in_format) {}
+
+	bool operator==(const ReflectedVertexInput& in_other) const
+	{
+		return name == in_other.name &&
+			location == in_other.location &&
+			format == in_other.format;
+	}
+};
+
+/**
+ * Resources used by a SPIR-V module, read from its decorations and debug names
+ * DXC names descriptors after the HLSL variable (or cbuffer), so bindings can be resolved by these names at runtime
+ */
+struct ShaderReflection
+{
+	gfx::ShaderStageFlagBits stage = gfx::ShaderStageFlagBits::Vertex;
+
+	/** Sorted by set then binding, bindless set excluded */
+	std::vector<ReflectedBinding> bindings;
+
+	/** Vertex shaders only, sorted by location */
+	std::vector<ReflectedVertexInput> vertex_inputs;
+
+	/** Size of the push constant block, 0 if none */
+	uint32_t push_constant_size = 0;
+
+	/** Whether the shader accesses the global bindless set */
+	bool bindless = false;
+
+	[[nodiscard]] static cb::Result<ShaderReflection, std::string> reflect(const std::span<const uint8_t>& in_bytecode);
+
+	/**
+	 * Attributes of the vertex inputs below in_end_location, tightly packed in location order in binding in_binding
+	 * Matches vertex buffers interleaving the inputs as the shader declares them
+	 * \param out_stride Size of one vertex
+	 */
+	[[nodiscard]] cb::Result<std::vector<gfx::VertexInputAttributeDescription>, std::string> make_vertex_attributes(
+		const uint32_t in_binding,
+		const uint32_t in_end_location,
+		uint32_t& out_stride) const;
+
+	/** Whether pipeline layouts and vertex inputs built from in_other also fit this shader */
+	[[nodiscard]] bool has_same_interface(const ShaderReflection& in_other) const
+	{
+		return stage == in_other.stage &&
+			bindings == in_other.bindings &&
+			vertex_inputs == in_other.vertex_inputs &&
+			push_constant_size == in_other.push_constant_size &&
+			bindless == in_other.bindless;
+	}
+};
+
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "engine/Core.hpp"
+#include "engine/gfx/Device.hpp"
+#include "engine/shadercompiler/ShaderCompiler.hpp"
+#include "engine/shadercompiler/ShaderReflection.hpp"
+#include "engine/util/FileWatcher.hpp"
+#include <vector>
+
+namespace cb::shadercompiler
+{
+
+/**
+ * Watches the sources of registered shaders and reloads the ones that changed
+ * When a watched directory changes, the cache key of each shader is recomputed and only shaders whose key changed
+ * (source, or one of its includes) are recompiled, then swapped behind their existing ShaderHandle
+ * Pipeline layouts and vertex inputs were built from the shaders' reflection, so a new version is reflected again
+ * and rejected if its interface (bindings, push constants, vertex inputs) changed, that requires a restart
+ */
+class ShaderReloader
+{
+	struct Shader
+	{
+		gfx::ShaderHandle handle;
+		ShaderCompileInfo info;
+		ShaderReflection reflection;
+		uint64_t key;
+	};
+
+public:
+	/**
+	 * \param in_max_threads Maximum number of threads used to recompile shaders that changed together
+	 */
+	ShaderReloader(gfx::Device& in_device, ShaderCompiler& in_compiler, const uint32_t in_max_threads = 1);
+
+	ShaderReloader(const ShaderReloader&) = delete;
+	void operator=(const ShaderReloader&) = delete;
+
+	/**
+	 * Reload in_shader when in_info's source or includes change
+	 * in_info must be what in_shader was compiled from, in_reflection its reflection
+	 */
+	void add_shader(const gfx::ShaderHandle& in_shader, const ShaderCompileInfo& in_info, 
+		const ShaderReflection& in_reflection);
+	void remove_shader(const gfx::ShaderHandle& in_shader);
+
+	/**
+	 * Poll the file watchers and reload changed shaders, call it outside of command list recording
+	 * \return Number of shaders reloaded
+	 */
+	uint32_t update();
+private:
+	void watch_directory(const std::string& in_directory);
+private:
+	gfx::Device& device;
+	ShaderCompiler& compiler;
+	uint32_t max_threads;
+	std::vector<Shader> shaders;
+	std::vector<FileWatcher> watchers;
+};
+
+}
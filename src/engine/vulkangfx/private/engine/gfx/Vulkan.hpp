@@ -14,6 +14,7 @@
 #include "engine/gfx/Result.hpp"
 #include "engine/gfx/Shader.hpp"
 #include "engine/gfx/Format.hpp"
+#include "engine/gfx/SwapChain.hpp"
 #include <atomic>
 #include "engine/logger/Logger.hpp"
 
@@ -110,6 +111,8 @@ inline VmaMemoryUsage convert_memory_usage(MemoryUsage in_mem_usage)
 		return VMA_MEMORY_USAGE_GPU_TO_CPU;
 	case MemoryUsage::GpuOnly:
 		return VMA_MEMORY_USAGE_GPU_ONLY;
+	case MemoryUsage::GpuLazy:
+		return VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED;
 	}
 }
 
@@ -148,6 +151,14 @@ inline VkFormat convert_format(const Format& in_format)
 		return VK_FORMAT_R32G32B32_SFLOAT;
 	case Format::R32G32B32A32Sfloat:
 		return VK_FORMAT_R32G32B32A32_SFLOAT;
+	case Format::R16G16B16A16Snorm:
+		return VK_FORMAT_R16G16B16A16_SNORM;
+	case Format::R16G16Sfloat:
+		return VK_FORMAT_R16G16_SFLOAT;
+	case Format::R16G16Snorm:
+		return VK_FORMAT_R16G16_SNORM;
+	case Format::A2B10G10R10SnormPack32:
+		return VK_FORMAT_A2B10G10R10_SNORM_PACK32;
 
 	/** Block */
 	case Format::Bc1RgbUnormBlock:
@@ -216,6 +227,14 @@ inline Format convert_vk_format(const VkFormat in_format)
 		return Format::R32G32B32Sfloat;
 	case VK_FORMAT_R32G32B32A32_SFLOAT:
 		return Format::R32G32B32A32Sfloat;
+	case VK_FORMAT_R16G16B16A16_SNORM:
+		return Format::R16G16B16A16Snorm;
+	case VK_FORMAT_R16G16_SFLOAT:
+		return Format::R16G16Sfloat;
+	case VK_FORMAT_R16G16_SNORM:
+		return Format::R16G16Snorm;
+	case VK_FORMAT_A2B10G10R10_SNORM_PACK32:
+		return Format::A2B10G10R10SnormPack32;
 
 	/** Block */
 	case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
@@ -249,6 +268,38 @@ inline Format convert_vk_format(const VkFormat in_format)
 	}
 }
 
+inline VkPresentModeKHR convert_present_mode(const PresentMode in_present_mode)
+{
+	switch(in_present_mode)
+	{
+	default:
+	case PresentMode::Fifo:
+		return VK_PRESENT_MODE_FIFO_KHR;
+	case PresentMode::FifoRelaxed:
+		return VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+	case PresentMode::Mailbox:
+		return VK_PRESENT_MODE_MAILBOX_KHR;
+	case PresentMode::Immediate:
+		return VK_PRESENT_MODE_IMMEDIATE_KHR;
+	}
+}
+
+inline PresentMode convert_vk_present_mode(const VkPresentModeKHR in_present_mode)
+{
+	switch(in_present_mode)
+	{
+	default:
+	case VK_PRESENT_MODE_FIFO_KHR:
+		return PresentMode::Fifo;
+	case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+		return PresentMode::FifoRelaxed;
+	case VK_PRESENT_MODE_MAILBOX_KHR:
+		return PresentMode::Mailbox;
+	case VK_PRESENT_MODE_IMMEDIATE_KHR:
+		return PresentMode::Immediate;
+	}
+}
+
 inline VkObjectType convert_object_type(DeviceResourceType in_type)
 {
 	switch(in_type)
@@ -1,12 +1,31 @@
 #include "engine/gfx/VulkanBackend.hpp"
 #include "engine/gfx/Device.hpp"
 #include "VulkanDevice.hpp"
+#include <algorithm>
 
 namespace cb::gfx
 {
 
+namespace
+{
+
+bool is_device_extension_supported(VkPhysicalDevice in_physical_device, const std::string_view& in_extension)
+{
+	uint32_t extension_count = 0;
+	vkEnumerateDeviceExtensionProperties(in_physical_device, nullptr, &extension_count, nullptr);
+	std::vector<VkExtensionProperties> extensions(extension_count);
+	vkEnumerateDeviceExtensionProperties(in_physical_device, nullptr, &extension_count, extensions.data());
+	return std::ranges::any_of(extensions, [&](const VkExtensionProperties& in_properties)
+	{
+		return std::string_view(in_properties.extensionName) == in_extension;
+	});
+}
+
+}
+
 VulkanBackend::VulkanBackend(const BackendFlags& in_flags)
-	: Backend(in_flags), debug_layers_enabled(false)
+	: Backend(in_flags), debug_layers_enabled(false), bindless_requested(in_flags & BackendFlagBits::Bindless),
+	offscreen(in_flags & BackendFlagBits::Offscreen)
 {
 	name = "Vulkan";
 	shader_language = ShaderLanguage::VK_SPIRV;
@@ -16,6 +35,29 @@ VulkanBackend::VulkanBackend(const BackendFlags& in_flags)
 	builder.set_app_name("CityBuilder");
 	builder.set_engine_name("ze_cb");
 	builder.require_api_version(1, 2, 0);
+
+	/** 
+	 * Window surface extensions (Win32, Xlib, XCB, Wayland) are enabled by vk-bootstrap when present,
+	 * headless instances only get the headless surface to run without any windowing system
+	 */
+	if(in_flags & BackendFlagBits::Headless)
+	{
+		auto system_info = vkb::SystemInfo::get_system_info();
+		if(!system_info || !system_info.value().is_extension_available(VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME))
+		{
+			error = "Headless rendering requires VK_EXT_headless_surface";
+			return;
+		}
+
+		builder.set_headless();
+		builder.enable_extension(VK_KHR_SURFACE_EXTENSION_NAME);
+		builder.enable_extension(VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME);
+	}
+	else if(offscreen)
+	{
+		/** No surface extension, this works with any ICD (e.g. software ones on GPU-less machines) */
+		builder.set_headless();
+	}
 	
 	/** Customize our instance based on the flags */
 	if(in_flags & BackendFlagBits::DebugLayers)
@@ -84,6 +126,68 @@ VulkanBackend::~VulkanBackend()
 	vkb::destroy_instance(instance);
 }
 	
+bool VulkanBackend::is_bindless_supported(VkPhysicalDevice in_physical_device) const
+{
+	VkPhysicalDeviceDescriptorIndexingFeatures descriptor_indexing = {};
+	descriptor_indexing.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+	VkPhysicalDeviceFeatures2 features = {};
+	features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	features.pNext = &descriptor_indexing;
+	vkGetPhysicalDeviceFeatures2(in_physical_device, &features);
+
+	VkPhysicalDeviceDescriptorIndexingProperties descriptor_indexing_properties = {};
+	descriptor_indexing_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+	VkPhysicalDeviceProperties2 properties = {};
+	properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	properties.pNext = &descriptor_indexing_properties;
+	vkGetPhysicalDeviceProperties2(in_physical_device, &properties);
+
+	return descriptor_indexing.shaderSampledImageArrayNonUniformIndexing &&
+		descriptor_indexing.shaderStorageBufferArrayNonUniformIndexing &&
+		descriptor_indexing.descriptorBindingSampledImageUpdateAfterBind &&
+		descriptor_indexing.descriptorBindingStorageBufferUpdateAfterBind &&
+		descriptor_indexing.descriptorBindingUpdateUnusedWhilePending &&
+		descriptor_indexing.descriptorBindingPartiallyBound &&
+		descriptor_indexing.runtimeDescriptorArray &&
+		descriptor_indexing_properties.maxPerStageDescriptorUpdateAfterBindSampledImages >= max_bindless_texture_views &&
+		descriptor_indexing_properties.maxPerStageDescriptorUpdateAfterBindSamplers >= max_bindless_samplers &&
+		descriptor_indexing_properties.maxPerStageDescriptorUpdateAfterBindStorageBuffers >= max_bindless_storage_buffers &&
+		descriptor_indexing_properties.maxDescriptorSetUpdateAfterBindSampledImages >= max_bindless_texture_views &&
+		descriptor_indexing_properties.maxDescriptorSetUpdateAfterBindSamplers >= max_bindless_samplers &&
+		descriptor_indexing_properties.maxDescriptorSetUpdateAfterBindStorageBuffers >= max_bindless_storage_buffers;
+}
+
+bool VulkanBackend::is_dynamic_rendering_supported(VkPhysicalDevice in_physical_device) const
+{
+	if(!is_device_extension_supported(in_physical_device, VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME))
+		return false;
+
+	VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamic_rendering = {};
+	dynamic_rendering.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+	VkPhysicalDeviceFeatures2 features = {};
+	features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	features.pNext = &dynamic_rendering;
+	vkGetPhysicalDeviceFeatures2(in_physical_device, &features);
+
+	return dynamic_rendering.dynamicRendering;
+}
+
+bool VulkanBackend::is_graphics_pipeline_library_supported(VkPhysicalDevice in_physical_device) const
+{
+	if(!is_device_extension_supported(in_physical_device, VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME) ||
+		!is_device_extension_supported(in_physical_device, VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME))
+		return false;
+
+	VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT graphics_pipeline_library = {};
+	graphics_pipeline_library.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+	VkPhysicalDeviceFeatures2 features = {};
+	features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	features.pNext = &graphics_pipeline_library;
+	vkGetPhysicalDeviceFeatures2(in_physical_device, &features);
+
+	return graphics_pipeline_library.graphicsPipelineLibrary;
+}
+
 cb::Result<std::unique_ptr<BackendDevice>, std::string> VulkanBackend::create_device(ShaderModel in_requested_shader_model)
 {
 	(void)(in_requested_shader_model);
@@ -95,11 +199,19 @@ cb::Result<std::unique_ptr<BackendDevice>, std::string> VulkanBackend::create_de
 		vkb::PhysicalDeviceSelector phys_device_selector(instance);
 		/** We don't have any surfaces yet */
 		phys_device_selector.defer_surface_initialization();
-		phys_device_selector.require_present();
+		if(!offscreen)
+			phys_device_selector.require_present();
 
 		VkPhysicalDeviceFeatures required_features = {};
 		required_features.fillModeNonSolid = VK_TRUE;
 		phys_device_selector.set_required_features(required_features);
+
+		/** Core in Vulkan 1.3, we target 1.2 so the extension is used. Enabled only if present */
+		phys_device_selector.add_desired_extension(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+
+		/** Pipelines are linked from precompiled parts when present */
+		phys_device_selector.add_desired_extension(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+		phys_device_selector.add_desired_extension(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
 		auto result = phys_device_selector.select();
 		if(!result)
 		{
@@ -112,13 +224,66 @@ cb::Result<std::unique_ptr<BackendDevice>, std::string> VulkanBackend::create_de
 	}
 
 	vkb::DeviceBuilder device_builder(physical_device);
+
+	/** Bindless relies on descriptor indexing, only the features we use are enabled */
+	VkPhysicalDeviceDescriptorIndexingFeatures descriptor_indexing = {};
+	descriptor_indexing.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+	const bool bindless = bindless_requested && is_bindless_supported(physical_device.physical_device);
+	if(bindless)
+	{
+		descriptor_indexing.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+		descriptor_indexing.shaderStorageBufferArrayNonUniformIndexing = VK_TRUE;
+		descriptor_indexing.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+		descriptor_indexing.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+		descriptor_indexing.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+		descriptor_indexing.descriptorBindingPartiallyBound = VK_TRUE;
+		descriptor_indexing.runtimeDescriptorArray = VK_TRUE;
+		device_builder.add_pNext(&descriptor_indexing);
+	}
+	else if(bindless_requested)
+	{
+		logger::warn(log_vulkan, "Bindless was requested but \"{}\" doesn't support the required descriptor indexing features",
+			physical_device.properties.deviceName);
+	}
+
+	VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamic_rendering = {};
+	dynamic_rendering.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+	const bool dynamic_rendering_supported = is_dynamic_rendering_supported(physical_device.physical_device);
+	if(dynamic_rendering_supported)
+	{
+		dynamic_rendering.dynamicRendering = VK_TRUE;
+		device_builder.add_pNext(&dynamic_rendering);
+	}
+	else
+	{
+		logger::info(log_vulkan, "\"{}\" doesn't support dynamic rendering, render passes will always be used",
+			physical_device.properties.deviceName);
+	}
+
+	VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT graphics_pipeline_library = {};
+	graphics_pipeline_library.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+	const bool graphics_pipeline_library_supported = 
+		is_graphics_pipeline_library_supported(physical_device.physical_device);
+	if(graphics_pipeline_library_supported)
+	{
+		graphics_pipeline_library.graphicsPipelineLibrary = VK_TRUE;
+		device_builder.add_pNext(&graphics_pipeline_library);
+	}
+	else
+	{
+		logger::info(log_vulkan, "\"{}\" doesn't support graphics pipeline libraries, pipelines will be fully compiled on first use",
+			physical_device.properties.deviceName);
+	}
+
 	auto device = device_builder.build();
 	if(!device)
 	{
 		return fmt::format("Failed to create logical device: {}", device.error().message());
 	}
 	
-	return make_result(std::make_unique<VulkanDevice>(*this, std::move(device.value())));	
+	return make_result(std::make_unique<VulkanDevice>(*this, std::move(device.value()), bindless,
+		dynamic_rendering_supported,
+		graphics_pipeline_library_supported));	
 }
 
 cb::Result<std::unique_ptr<Backend>, std::string> create_vulkan_backend(const BackendFlags& in_flags)
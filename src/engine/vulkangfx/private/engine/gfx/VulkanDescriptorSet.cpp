@@ -4,6 +4,7 @@
 #include "VulkanBuffer.hpp"
 #include "VulkanTexture.hpp"
 #include "VulkanTextureView.hpp"
+#include <bit>
 
 namespace cb::gfx
 {
@@ -11,12 +12,22 @@ namespace cb::gfx
 static constexpr uint32_t max_descriptor_sets_per_pool = 8;
 static constexpr uint32_t default_descriptor_count_per_type = 32;
 
+/** Update template data entry, one per binding */
+union DescriptorUpdateData
+{
+	VkDescriptorBufferInfo buffer;
+	VkDescriptorImageInfo image;
+};
+
 VulkanDescriptorSetAllocator::VulkanDescriptorSetAllocator(VulkanDevice& in_device,
 	VulkanPipelineLayout& in_pipeline_layout,
-	VkDescriptorSetLayout in_set_layout) : device(in_device),
-	pipeline_layout(in_pipeline_layout), set_layout(in_set_layout)
+	VkDescriptorSetLayout in_set_layout,
+	const std::span<const VkDescriptorSetLayoutBinding>& in_bindings) : device(in_device),
+	pipeline_layout(in_pipeline_layout), set_layout(in_set_layout), update_template(VK_NULL_HANDLE), layout_bindings_mask(0)
 {
-	for(size_t type = 0; type < VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT; ++type)
+	create_update_template(in_bindings);
+
+	for(size_t type = 0; type <= VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT; ++type)
 	{
 		if(in_pipeline_layout.get_descriptor_type_mask() & (1 << type))
 		{
@@ -27,6 +38,9 @@ VulkanDescriptorSetAllocator::VulkanDescriptorSetAllocator(VulkanDevice& in_devi
 
 VulkanDescriptorSetAllocator::~VulkanDescriptorSetAllocator()
 {
+	if(update_template != VK_NULL_HANDLE)
+		vkDestroyDescriptorUpdateTemplate(device.get_device(), update_template, nullptr);
+
 	for(const auto& pool : pools)
 		vkDestroyDescriptorPool(device.get_device(), pool, nullptr);
 }
@@ -49,13 +63,49 @@ void VulkanDescriptorSetAllocator::new_frame()
 		hashmap.erase(hash);
 }
 
-VkDescriptorSet VulkanDescriptorSetAllocator::allocate(const std::span<Descriptor, max_bindings>& in_descriptors)
+void VulkanDescriptorSetAllocator::create_update_template(const std::span<const VkDescriptorSetLayoutBinding>& in_bindings)
 {
-	uint64_t hash = 0;
-	for(const auto& descriptor : in_descriptors)
-		hash_combine(hash, descriptor);
+	std::vector<VkDescriptorUpdateTemplateEntry> entries;
+	entries.reserve(in_bindings.size());
+	for(const auto& binding : in_bindings)
+	{
+		CB_CHECK(binding.binding < max_bindings)
+
+		VkDescriptorUpdateTemplateEntry entry = {};
+		entry.dstBinding = binding.binding;
+		entry.dstArrayElement = 0;
+		entry.descriptorCount = 1;
+		entry.descriptorType = binding.descriptorType;
+		entry.offset = sizeof(DescriptorUpdateData) * binding.binding;
+		entry.stride = sizeof(DescriptorUpdateData);
+		entries.emplace_back(entry);
+
+		layout_bindings_mask |= 1 << binding.binding;
+	}
+
+	if(entries.empty())
+		return;
+
+	VkDescriptorUpdateTemplateCreateInfo create_info = {};
+	create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+	create_info.pNext = nullptr;
+	create_info.flags = 0;
+	create_info.descriptorUpdateEntryCount = static_cast<uint32_t>(entries.size());
+	create_info.pDescriptorUpdateEntries = entries.data();
+	create_info.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+	create_info.descriptorSetLayout = set_layout;
+
+	VkResult result = vkCreateDescriptorUpdateTemplate(device.get_device(),
+		&create_info,
+		nullptr,
+		&update_template);
+	CB_ASSERT(result == VK_SUCCESS);
+}
 
-	auto it = hashmap.find(hash);
+VkDescriptorSet VulkanDescriptorSetAllocator::allocate(const std::span<Descriptor, max_bindings>& in_descriptors, 
+	const uint64_t in_hash)
+{
+	auto it = hashmap.find(in_hash);
 	if(it != hashmap.end())
 	{
 		it->second.frame = 0;
@@ -68,28 +118,23 @@ VkDescriptorSet VulkanDescriptorSetAllocator::allocate(const std::span<Descripto
 	VkDescriptorSet set = free_sets.front();
 	free_sets.pop();
 
-	std::vector<VkWriteDescriptorSet> writes;
-	writes.reserve(in_descriptors.size());
-
-	std::vector<std::variant<std::monostate, VkDescriptorBufferInfo, VkDescriptorImageInfo>> infos;
-	infos.reserve(in_descriptors.size());
-
-	for(const auto& descriptor : in_descriptors)
+	std::array<DescriptorUpdateData, max_bindings> data;
+	uint32_t written_bindings_mask = 0;
+	for(size_t i = 0; i < in_descriptors.size(); ++i)
 	{
-		if(descriptor.info.index() == Descriptor::None)
-			continue;
-
-		auto& info = infos.emplace_back();
+		const Descriptor& descriptor = in_descriptors[i];
 
 		switch(descriptor.info.index())
 		{
 		default:
 			CB_UNREACHABLE();
 			break;
+		case Descriptor::None:
+			continue;
 		case Descriptor::BufferInfo:
 		{
 			DescriptorBufferInfo buffer = std::get<DescriptorBufferInfo>(descriptor.info);
-			info = VkDescriptorBufferInfo { get_resource<VulkanBuffer>(buffer.handle)->get_buffer(),
+			data[i].buffer = VkDescriptorBufferInfo { get_resource<VulkanBuffer>(buffer.handle)->get_buffer(),
 				buffer.offset,
 				buffer.range };
 			break;
@@ -97,7 +142,7 @@ VkDescriptorSet VulkanDescriptorSetAllocator::allocate(const std::span<Descripto
 		case Descriptor::TextureInfo:
 		{
 			DescriptorTextureInfo texture = std::get<DescriptorTextureInfo>(descriptor.info);
-			info = VkDescriptorImageInfo {
+			data[i].image = VkDescriptorImageInfo {
 				VK_NULL_HANDLE,
 				get_resource<VulkanTextureView>(texture.texture_view)->get_image_view(),
 				convert_texture_layout(texture.layout) };
@@ -106,7 +151,7 @@ VkDescriptorSet VulkanDescriptorSetAllocator::allocate(const std::span<Descripto
 		case Descriptor::SamplerInfo:
 		{
 			DescriptorSamplerInfo sampler = std::get<DescriptorSamplerInfo>(descriptor.info);
-			info = VkDescriptorImageInfo {
+			data[i].image = VkDescriptorImageInfo {
 				reinterpret_cast<VkSampler>(sampler.sampler),
 				VK_NULL_HANDLE,
 				VK_IMAGE_LAYOUT_UNDEFINED};
@@ -114,28 +159,47 @@ VkDescriptorSet VulkanDescriptorSetAllocator::allocate(const std::span<Descripto
 		}
 		}
 
-		writes.emplace_back(
-			VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-			nullptr,
-			set,
-			descriptor.binding,
+		written_bindings_mask |= 1 << i;
+	}
+
+	if(update_template != VK_NULL_HANDLE && (layout_bindings_mask & ~written_bindings_mask) == 0)
+	{
+		vkUpdateDescriptorSetWithTemplate(device.get_device(), set, update_template, data.data());
+	}
+	else
+	{
+		/** Some layout bindings are left unwritten, the template would read undefined data for them */
+		std::array<VkWriteDescriptorSet, max_bindings> writes;
+		uint32_t write_count = 0;
+		for(uint32_t bindings = written_bindings_mask; bindings != 0; bindings &= bindings - 1)
+		{
+			const uint32_t binding = std::countr_zero(bindings);
+			const Descriptor& descriptor = in_descriptors[binding];
+			const bool is_buffer = descriptor.info.index() == Descriptor::BufferInfo;
+
+			writes[write_count++] = VkWriteDescriptorSet {
+				VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+				nullptr,
+				set,
+				binding,
+				0,
+				1,
+				convert_descriptor_type(descriptor.type),
+				!is_buffer ? &data[binding].image : nullptr,
+				is_buffer ? &data[binding].buffer : nullptr,
+				nullptr };
+		}
+
+		vkUpdateDescriptorSets(device.get_device(),
+			write_count,
+			writes.data(),
 			0,
-			1,
-			convert_descriptor_type(descriptor.type),
-			descriptor.info.index() != Descriptor::BufferInfo ? &std::get<VkDescriptorImageInfo>(info) : nullptr,
-			descriptor.info.index() == Descriptor::BufferInfo ? &std::get<VkDescriptorBufferInfo>(info) : nullptr,
 			nullptr);
 	}
 
-	vkUpdateDescriptorSets(device.get_device(),
-		static_cast<uint32_t>(writes.size()),
-		writes.data(),
-		0,
-		nullptr);
-
 	logger::verbose(log_vulkan, "Updated descriptor set");
 
-	hashmap.insert({ hash, Node(set)} );
+	hashmap.insert({ in_hash, Node(set)} );
 
 	return set;
 }
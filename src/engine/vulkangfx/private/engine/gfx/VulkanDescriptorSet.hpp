@@ -15,6 +15,7 @@ class VulkanPipelineLayout;
  * Class managing descriptor set of a single pipeline set layout
  * This is managed by the device and created on-demand with a pipeline layout
  * Descriptor sets are allocated and stored in a hashmap, and after 10 frames they are marked as unused and can be recycled
+ * Sets are written through a descriptor update template covering every binding of the layout
  */
 class VulkanDescriptorSetAllocator
 {
@@ -32,17 +33,23 @@ class VulkanDescriptorSetAllocator
 public:
 	VulkanDescriptorSetAllocator(VulkanDevice& in_device,
 		VulkanPipelineLayout& in_pipeline_layout,
-		VkDescriptorSetLayout in_set_layout);
+		VkDescriptorSetLayout in_set_layout,
+		const std::span<const VkDescriptorSetLayoutBinding>& in_bindings);
 	~VulkanDescriptorSetAllocator();
 
 	void new_frame();
-	VkDescriptorSet allocate(const std::span<Descriptor, max_bindings>& in_descriptors);
+	VkDescriptorSet allocate(const std::span<Descriptor, max_bindings>& in_descriptors, const uint64_t in_hash);
 private:
 	void allocate_pool();
+	void create_update_template(const std::span<const VkDescriptorSetLayoutBinding>& in_bindings);
 private:
 	VulkanDevice& device;
 	VulkanPipelineLayout& pipeline_layout;
 	VkDescriptorSetLayout set_layout;
+	VkDescriptorUpdateTemplate update_template;
+
+	/** Bindings of the set layout, the template can only be used when all of them have a descriptor */
+	uint32_t layout_bindings_mask;
 	std::vector<VkDescriptorPool> pools;
 	std::queue<VkDescriptorSet> free_sets;
 	std::vector<VkDescriptorPoolSize> pool_sizes;
@@ -11,6 +11,8 @@
 #include "VulkanTextureView.hpp"
 #include "VulkanSync.hpp"
 #include "VulkanSampler.hpp"
+#include <algorithm>
+#include <optional>
 
 namespace cb::gfx
 {
@@ -70,12 +72,18 @@ VkFramebuffer VulkanDevice::FramebufferManager::get_or_create(VkRenderPass in_re
 	return framebuffer;
 }
 
-VulkanDevice::VulkanDevice(VulkanBackend& in_backend, vkb::Device&& in_device) :
+VulkanDevice::VulkanDevice(VulkanBackend& in_backend, 
+	vkb::Device&& in_device, 
+	const bool in_bindless, 
+	const bool in_dynamic_rendering,
+	const bool in_graphics_pipeline_library) :
 	backend(in_backend),
 	allocator(nullptr),
 	device_wrapper(DeviceWrapper(std::move(in_device))),
 	surface_manager(*this),
-	framebuffer_manager(*this)
+	framebuffer_manager(*this),
+	vkCmdBeginRenderingKHR(nullptr),
+	vkCmdEndRenderingKHR(nullptr)
 {
 	VmaAllocatorCreateInfo create_info = {};
 	create_info.instance = backend.get_instance();
@@ -84,13 +92,169 @@ VulkanDevice::VulkanDevice(VulkanBackend& in_backend, vkb::Device&& in_device) :
 
 	// TODO: Error check
 	vmaCreateAllocator(&create_info, &allocator);
+
+	if(in_bindless)
+		create_bindless_set();
+
+	if(in_dynamic_rendering)
+	{
+		vkCmdBeginRenderingKHR = reinterpret_cast<PFN_vkCmdBeginRenderingKHR>(vkGetDeviceProcAddr(get_device(),
+			"vkCmdBeginRenderingKHR"));
+		vkCmdEndRenderingKHR = reinterpret_cast<PFN_vkCmdEndRenderingKHR>(vkGetDeviceProcAddr(get_device(),
+			"vkCmdEndRenderingKHR"));
+	}
+
+	if(in_graphics_pipeline_library)
+	{
+		pipeline_libraries.enabled = true;
+		pipeline_libraries.worker = std::thread([this]() { compile_optimized_pipelines(); });
+	}
 }
 	
 VulkanDevice::~VulkanDevice()
 {
+	if(pipeline_libraries.worker.joinable())
+	{
+		{
+			std::scoped_lock lock(pipeline_libraries.mutex);
+			pipeline_libraries.stop = true;
+			pipeline_libraries.jobs.clear();
+		}
+		pipeline_libraries.condition.notify_one();
+		pipeline_libraries.worker.join();
+	}
+
+	if(bindless.pool != VK_NULL_HANDLE)
+		vkDestroyDescriptorPool(get_device(), bindless.pool, nullptr);
+	if(bindless.set_layout != VK_NULL_HANDLE)
+		vkDestroyDescriptorSetLayout(get_device(), bindless.set_layout, nullptr);
+
 	vmaDestroyAllocator(allocator);
 }
 
+void VulkanDevice::create_bindless_set()
+{
+	const std::array types = { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, VK_DESCRIPTOR_TYPE_SAMPLER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER };
+	const std::array counts = { max_bindless_texture_views, max_bindless_samplers, max_bindless_storage_buffers };
+	const std::array binding_indices = { bindless_texture_views_binding, bindless_samplers_binding, bindless_storage_buffers_binding };
+
+	std::array<VkDescriptorSetLayoutBinding, types.size()> bindings;
+	std::array<VkDescriptorBindingFlags, types.size()> binding_flags;
+	std::array<VkDescriptorPoolSize, types.size()> pool_sizes;
+	for(size_t i = 0; i < types.size(); ++i)
+	{
+		bindings[i] = {};
+		bindings[i].binding = binding_indices[i];
+		bindings[i].descriptorType = types[i];
+		bindings[i].descriptorCount = counts[i];
+		bindings[i].stageFlags = VK_SHADER_STAGE_ALL;
+		bindings[i].pImmutableSamplers = nullptr;
+
+		/** Unused slots are never written and slots can be filled while the set is bound */
+		binding_flags[i] = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | 
+			VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+			VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+
+		pool_sizes[i] = VkDescriptorPoolSize { types[i], counts[i] };
+	}
+
+	VkDescriptorSetLayoutBindingFlagsCreateInfo binding_flags_info = {};
+	binding_flags_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+	binding_flags_info.pNext = nullptr;
+	binding_flags_info.bindingCount = static_cast<uint32_t>(binding_flags.size());
+	binding_flags_info.pBindingFlags = binding_flags.data();
+
+	VkDescriptorSetLayoutCreateInfo layout_info = {};
+	layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layout_info.pNext = &binding_flags_info;
+	layout_info.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+	layout_info.bindingCount = static_cast<uint32_t>(bindings.size());
+	layout_info.pBindings = bindings.data();
+
+	VkResult result = vkCreateDescriptorSetLayout(get_device(), &layout_info, nullptr, &bindless.set_layout);
+	CB_ASSERT(result == VK_SUCCESS);
+
+	VkDescriptorPoolCreateInfo pool_info = {};
+	pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	pool_info.pNext = nullptr;
+	pool_info.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+	pool_info.maxSets = 1;
+	pool_info.poolSizeCount = static_cast<uint32_t>(pool_sizes.size());
+	pool_info.pPoolSizes = pool_sizes.data();
+
+	result = vkCreateDescriptorPool(get_device(), &pool_info, nullptr, &bindless.pool);
+	CB_ASSERT(result == VK_SUCCESS);
+
+	VkDescriptorSetAllocateInfo alloc_info = {};
+	alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	alloc_info.pNext = nullptr;
+	alloc_info.descriptorPool = bindless.pool;
+	alloc_info.descriptorSetCount = 1;
+	alloc_info.pSetLayouts = &bindless.set_layout;
+
+	result = vkAllocateDescriptorSets(get_device(), &alloc_info, &bindless.set);
+	CB_ASSERT(result == VK_SUCCESS);
+
+	logger::info(log_vulkan, "Bindless enabled ({} texture views, {} samplers, {} storage buffers)",
+		max_bindless_texture_views,
+		max_bindless_samplers,
+		max_bindless_storage_buffers);
+}
+
+void VulkanDevice::write_bindless_descriptor(VkWriteDescriptorSet& in_write)
+{
+	in_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	in_write.pNext = nullptr;
+	in_write.dstSet = bindless.set;
+	in_write.descriptorCount = 1;
+
+	std::scoped_lock lock(bindless.mutex);
+	vkUpdateDescriptorSets(get_device(), 1, &in_write, 0, nullptr);
+}
+
+void VulkanDevice::update_bindless_texture_view(const uint32_t in_index, const BackendDeviceResource& in_texture_view,
+	const TextureLayout in_layout)
+{
+	VkDescriptorImageInfo image_info = {};
+	image_info.imageView = get_resource<VulkanTextureView>(in_texture_view)->get_image_view();
+	image_info.imageLayout = convert_texture_layout(in_layout);
+
+	VkWriteDescriptorSet write = {};
+	write.dstBinding = bindless_texture_views_binding;
+	write.dstArrayElement = in_index;
+	write.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+	write.pImageInfo = &image_info;
+	write_bindless_descriptor(write);
+}
+
+void VulkanDevice::update_bindless_sampler(const uint32_t in_index, const BackendDeviceResource& in_sampler)
+{
+	VkDescriptorImageInfo image_info = {};
+	image_info.sampler = reinterpret_cast<VkSampler>(in_sampler);
+
+	VkWriteDescriptorSet write = {};
+	write.dstBinding = bindless_samplers_binding;
+	write.dstArrayElement = in_index;
+	write.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+	write.pImageInfo = &image_info;
+	write_bindless_descriptor(write);
+}
+
+void VulkanDevice::update_bindless_storage_buffer(const uint32_t in_index, const BackendDeviceResource& in_buffer)
+{
+	VkDescriptorBufferInfo buffer_info = {};
+	buffer_info.buffer = get_resource<VulkanBuffer>(in_buffer)->get_buffer();
+	buffer_info.offset = 0;
+	buffer_info.range = VK_WHOLE_SIZE;
+
+	VkWriteDescriptorSet write = {};
+	write.dstBinding = bindless_storage_buffers_binding;
+	write.dstArrayElement = in_index;
+	write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	write.pBufferInfo = &buffer_info;
+	write_bindless_descriptor(write);
+}
+
 void VulkanDevice::new_frame()
 {
 	framebuffer_manager.new_frame();
@@ -209,9 +373,10 @@ cb::Result<BackendDeviceResource, Result> VulkanDevice::create_buffer(const Buff
 	
 cb::Result<BackendDeviceResource, Result> VulkanDevice::create_swap_chain(const SwapChainCreateInfo& in_create_info)
 {
-	CB_CHECK(in_create_info.os_handle && in_create_info.width != 0 && in_create_info.height != 0);
+	CB_CHECK((in_create_info.window.window || in_create_info.window.system == WindowSystem::Headless) && 
+		in_create_info.width != 0 && in_create_info.height != 0);
 
-	auto surface = surface_manager.get_or_create(in_create_info.os_handle);
+	auto surface = surface_manager.get_or_create(in_create_info.window);
 	if(!surface)
 	{
 		return make_error(surface.get_error());
@@ -231,11 +396,20 @@ cb::Result<BackendDeviceResource, Result> VulkanDevice::create_swap_chain(const
 	VkSurfaceFormatKHR format = {};
 	format.colorSpace = VK_COLORSPACE_SRGB_NONLINEAR_KHR;
 	format.format = VK_FORMAT_B8G8R8A8_UNORM;
+
+	const VkPresentModeKHR present_mode = select_present_mode(surface.get_value(), in_create_info.present_mode);
+	if(present_mode != convert_present_mode(in_create_info.present_mode))
+	{
+		logger::info(log_vulkan, "Present mode {} is not supported, using {}", 
+			std::to_string(in_create_info.present_mode),
+			std::to_string(convert_vk_present_mode(present_mode)));
+	}
 	
 	auto result = 
 		swapchain_builder.set_old_swapchain(old_swapchain)
 		.set_desired_extent(in_create_info.width, in_create_info.height)
 		.set_desired_format(format)
+		.set_desired_present_mode(present_mode)
 		.build();
 	if(!result)
 	{
@@ -243,10 +417,31 @@ cb::Result<BackendDeviceResource, Result> VulkanDevice::create_swap_chain(const
 		return make_error(convert_result(result.vk_result()));
 	}
 
-	auto swapchain = new_resource<VulkanSwapChain>(*this, result.value());
+	auto swapchain = new_resource<VulkanSwapChain>(*this, result.value(), present_mode);
 	return static_cast<BackendDeviceResource>(swapchain);
 }
 
+VkPresentModeKHR VulkanDevice::select_present_mode(VkSurfaceKHR in_surface, const PresentMode in_present_mode) const
+{
+	uint32_t present_mode_count = 0;
+	vkGetPhysicalDeviceSurfacePresentModesKHR(get_physical_device(), in_surface, &present_mode_count, nullptr);
+	std::vector<VkPresentModeKHR> present_modes(present_mode_count);
+	vkGetPhysicalDeviceSurfacePresentModesKHR(get_physical_device(), in_surface, &present_mode_count, present_modes.data());
+
+	/** Tearing modes fall back to the non-tearing uncapped mode first, Fifo is guaranteed to be supported */
+	std::vector<VkPresentModeKHR> candidates = { convert_present_mode(in_present_mode) };
+	if(in_present_mode == PresentMode::Immediate)
+		candidates.push_back(VK_PRESENT_MODE_MAILBOX_KHR);
+
+	for(const auto& candidate : candidates)
+	{
+		if(std::ranges::find(present_modes, candidate) != present_modes.end())
+			return candidate;
+	}
+
+	return VK_PRESENT_MODE_FIFO_KHR;
+}
+
 cb::Result<BackendDeviceResource, Result> VulkanDevice::create_shader(const ShaderCreateInfo& in_create_info)
 {
 	CB_CHECK(!in_create_info.bytecode.empty());
@@ -278,8 +473,15 @@ cb::Result<BackendDeviceResource, Result> VulkanDevice::create_gfx_pipeline(cons
 
 	std::vector<VkPipelineShaderStageCreateInfo> shader_stages;
 	shader_stages.reserve(in_create_info.shader_stages.size());
-	for(const auto& stage : in_create_info.shader_stages)
+
+	/** Constant values are read directly from the stages, one 32-bit value per entry */
+	std::vector<std::array<VkSpecializationMapEntry, max_specialization_constants>> specialization_entries(
+		in_create_info.shader_stages.size());
+	std::vector<VkSpecializationInfo> specialization_infos(in_create_info.shader_stages.size());
+	for(size_t i = 0; i < in_create_info.shader_stages.size(); ++i)
 	{
+		const auto& stage = in_create_info.shader_stages[i];
+
 		VkPipelineShaderStageCreateInfo stage_create_info = {};
 		stage_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 		stage_create_info.pNext = nullptr;
@@ -288,6 +490,25 @@ cb::Result<BackendDeviceResource, Result> VulkanDevice::create_gfx_pipeline(cons
 		stage_create_info.pName = stage.entry_point;
 		stage_create_info.flags = 0;
 		stage_create_info.pSpecializationInfo = nullptr;
+
+		const auto constants = stage.get_specialization_constants();
+		if(!constants.empty())
+		{
+			for(uint32_t j = 0; j < constants.size(); ++j)
+			{
+				specialization_entries[i][j].constantID = constants[j].id;
+				specialization_entries[i][j].offset = static_cast<uint32_t>(j * sizeof(SpecializationConstant) + 
+					offsetof(SpecializationConstant, value));
+				specialization_entries[i][j].size = sizeof(uint32_t);
+			}
+
+			specialization_infos[i].mapEntryCount = static_cast<uint32_t>(constants.size());
+			specialization_infos[i].pMapEntries = specialization_entries[i].data();
+			specialization_infos[i].dataSize = constants.size_bytes();
+			specialization_infos[i].pData = constants.data();
+			stage_create_info.pSpecializationInfo = &specialization_infos[i];
+		}
+
 		shader_stages.push_back(stage_create_info);
 	}
 
@@ -423,10 +644,39 @@ cb::Result<BackendDeviceResource, Result> VulkanDevice::create_gfx_pipeline(cons
 	create_info.pColorBlendState = &color_blend_state;
 	create_info.pDynamicState = &dynamic_state_create_info;
 	create_info.layout = get_resource<VulkanPipelineLayout>(in_create_info.pipeline_layout)->get_pipeline_layout();
-	create_info.renderPass = get_resource<VulkanRenderPass>(in_create_info.render_pass)->get_render_pass();
 	create_info.subpass = in_create_info.subpass;
+
+	/** Without render pass, the pipeline is used with dynamic rendering and only needs the attachment formats */
+	std::array<VkFormat, max_attachments_per_framebuffer> color_formats;
+	VkPipelineRenderingCreateInfoKHR rendering_create_info = {};
+	if(in_create_info.render_pass != null_backend_resource)
+	{
+		create_info.renderPass = get_resource<VulkanRenderPass>(in_create_info.render_pass)->get_render_pass();
+	}
+	else
+	{
+		const auto& formats = in_create_info.rendering_formats;
+		for(uint32_t i = 0; i < formats.color_format_count; ++i)
+			color_formats[i] = convert_format(formats.color_formats[i]);
+
+		rendering_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+		rendering_create_info.pNext = nullptr;
+		rendering_create_info.viewMask = 0;
+		rendering_create_info.colorAttachmentCount = formats.color_format_count;
+		rendering_create_info.pColorAttachmentFormats = color_formats.data();
+		rendering_create_info.depthAttachmentFormat = convert_format(formats.depth_stencil_format);
+		rendering_create_info.stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
+		if(format_to_aspect_flags(formats.depth_stencil_format) & TextureAspectFlagBits::Stencil)
+			rendering_create_info.stencilAttachmentFormat = rendering_create_info.depthAttachmentFormat;
+
+		create_info.renderPass = VK_NULL_HANDLE;
+		create_info.pNext = &rendering_create_info;
+	}
 	create_info.basePipelineHandle = VK_NULL_HANDLE;
 	create_info.basePipelineIndex = -1;
+
+	if(pipeline_libraries.enabled)
+		return create_gfx_pipeline_from_libraries(in_create_info, create_info);
 	
 	VkPipeline pipeline;
 	VkResult result = vkCreateGraphicsPipelines(get_device(),
@@ -441,6 +691,301 @@ cb::Result<BackendDeviceResource, Result> VulkanDevice::create_gfx_pipeline(cons
 	auto ret = new_resource<VulkanPipeline>(*this, pipeline);
 	return make_result(ret.get());
 }
+
+cb::Result<BackendDeviceResource, Result> VulkanDevice::create_gfx_pipeline_from_libraries(
+	const GfxPipelineCreateInfo& in_create_info,
+	const VkGraphicsPipelineCreateInfo& in_full_create_info)
+{
+	VulkanPipelineLibraryKey vertex_input_key;
+	vertex_input_key.flags = VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT;
+	vertex_input_key.create_info.vertex_input_state = in_create_info.vertex_input_state;
+	vertex_input_key.create_info.input_assembly_state = in_create_info.input_assembly_state;
+
+	/** Every library except the vertex input one is compiled against the render pass or attachment formats */
+	const auto make_render_pass_key = [&](const VkGraphicsPipelineLibraryFlagsEXT in_flags)
+	{
+		VulkanPipelineLibraryKey key;
+		key.flags = in_flags;
+		key.create_info.render_pass = in_create_info.render_pass;
+		key.create_info.subpass = in_create_info.subpass;
+		key.create_info.rendering_formats = in_create_info.rendering_formats;
+		return key;
+	};
+
+	VulkanPipelineLibraryKey pre_rasterization_key = make_render_pass_key(
+		VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT);
+	pre_rasterization_key.create_info.rasterization_state = in_create_info.rasterization_state;
+	pre_rasterization_key.create_info.pipeline_layout = in_create_info.pipeline_layout;
+
+	VulkanPipelineLibraryKey fragment_key = make_render_pass_key(VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT);
+	fragment_key.create_info.depth_stencil_state = in_create_info.depth_stencil_state;
+	fragment_key.create_info.multisampling_state = in_create_info.multisampling_state;
+	fragment_key.create_info.pipeline_layout = in_create_info.pipeline_layout;
+
+	VulkanPipelineLibraryKey fragment_output_key = make_render_pass_key(
+		VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT);
+	fragment_output_key.create_info.color_blend_state = in_create_info.color_blend_state;
+	fragment_output_key.create_info.color_blend_state.attachments = {};
+	fragment_output_key.color_blend_attachments.assign(in_create_info.color_blend_state.attachments.begin(),
+		in_create_info.color_blend_state.attachments.end());
+	fragment_output_key.create_info.multisampling_state = in_create_info.multisampling_state;
+
+	std::vector<VkPipelineShaderStageCreateInfo> pre_rasterization_stages;
+	std::vector<VkPipelineShaderStageCreateInfo> fragment_stages;
+	std::vector<BackendDeviceResource> pre_rasterization_dependencies;
+	std::vector<BackendDeviceResource> fragment_dependencies;
+	for(size_t i = 0; i < in_create_info.shader_stages.size(); ++i)
+	{
+		const auto& stage = in_create_info.shader_stages[i];
+		if(stage.shader_stage == ShaderStageFlagBits::Fragment)
+		{
+			fragment_stages.push_back(in_full_create_info.pStages[i]);
+			fragment_dependencies.push_back(stage.shader);
+			fragment_key.stages.push_back(stage);
+		}
+		else
+		{
+			pre_rasterization_stages.push_back(in_full_create_info.pStages[i]);
+			pre_rasterization_dependencies.push_back(stage.shader);
+			pre_rasterization_key.stages.push_back(stage);
+		}
+	}
+
+	for(auto* dependencies : { &pre_rasterization_dependencies, &fragment_dependencies })
+	{
+		dependencies->push_back(in_create_info.pipeline_layout);
+		dependencies->push_back(in_create_info.render_pass);
+	}
+
+	VkGraphicsPipelineCreateInfo vertex_input_info = {};
+	vertex_input_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	vertex_input_info.pVertexInputState = in_full_create_info.pVertexInputState;
+	vertex_input_info.pInputAssemblyState = in_full_create_info.pInputAssemblyState;
+	vertex_input_info.basePipelineIndex = -1;
+
+	VkGraphicsPipelineCreateInfo pre_rasterization_info = {};
+	pre_rasterization_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	pre_rasterization_info.pNext = in_full_create_info.pNext;
+	pre_rasterization_info.stageCount = static_cast<uint32_t>(pre_rasterization_stages.size());
+	pre_rasterization_info.pStages = pre_rasterization_stages.data();
+	pre_rasterization_info.pTessellationState = in_full_create_info.pTessellationState;
+	pre_rasterization_info.pViewportState = in_full_create_info.pViewportState;
+	pre_rasterization_info.pRasterizationState = in_full_create_info.pRasterizationState;
+	pre_rasterization_info.pDynamicState = in_full_create_info.pDynamicState;
+	pre_rasterization_info.layout = in_full_create_info.layout;
+	pre_rasterization_info.renderPass = in_full_create_info.renderPass;
+	pre_rasterization_info.subpass = in_full_create_info.subpass;
+	pre_rasterization_info.basePipelineIndex = -1;
+
+	VkGraphicsPipelineCreateInfo fragment_info = {};
+	fragment_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	fragment_info.pNext = in_full_create_info.pNext;
+	fragment_info.stageCount = static_cast<uint32_t>(fragment_stages.size());
+	fragment_info.pStages = fragment_stages.data();
+	fragment_info.pMultisampleState = in_full_create_info.pMultisampleState;
+	fragment_info.pDepthStencilState = in_full_create_info.pDepthStencilState;
+	fragment_info.pDynamicState = in_full_create_info.pDynamicState;
+	fragment_info.layout = in_full_create_info.layout;
+	fragment_info.renderPass = in_full_create_info.renderPass;
+	fragment_info.subpass = in_full_create_info.subpass;
+	fragment_info.basePipelineIndex = -1;
+
+	VkGraphicsPipelineCreateInfo fragment_output_info = {};
+	fragment_output_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	fragment_output_info.pNext = in_full_create_info.pNext;
+	fragment_output_info.pMultisampleState = in_full_create_info.pMultisampleState;
+	fragment_output_info.pColorBlendState = in_full_create_info.pColorBlendState;
+	fragment_output_info.pDynamicState = in_full_create_info.pDynamicState;
+	fragment_output_info.renderPass = in_full_create_info.renderPass;
+	fragment_output_info.subpass = in_full_create_info.subpass;
+	fragment_output_info.basePipelineIndex = -1;
+
+	std::array<std::shared_ptr<VulkanPipelineLibrary>, 4> libraries;
+	std::array library_results = 
+	{
+		get_or_create_pipeline_library(std::move(vertex_input_key),
+			vertex_input_info,
+			{}),
+		get_or_create_pipeline_library(std::move(pre_rasterization_key),
+			pre_rasterization_info,
+			std::move(pre_rasterization_dependencies)),
+		get_or_create_pipeline_library(std::move(fragment_key),
+			fragment_info,
+			std::move(fragment_dependencies)),
+		get_or_create_pipeline_library(std::move(fragment_output_key),
+			fragment_output_info,
+			{ in_create_info.render_pass }),
+	};
+
+	std::optional<Result> error;
+	for(size_t i = 0; i < library_results.size(); ++i)
+	{
+		if(!library_results[i])
+		{
+			error = library_results[i].get_error();
+			continue;
+		}
+
+		libraries[i] = std::move(library_results[i].get_value());
+	}
+
+	if(error)
+		return make_error(error.value());
+
+	std::array<VkPipeline, 4> library_handles;
+	for(size_t i = 0; i < libraries.size(); ++i)
+		library_handles[i] = libraries[i]->get_library();
+
+	VkPipelineLibraryCreateInfoKHR library_info = {};
+	library_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+	library_info.pNext = nullptr;
+	library_info.libraryCount = static_cast<uint32_t>(library_handles.size());
+	library_info.pLibraries = library_handles.data();
+
+	/** Fast link, the libraries are already compiled */
+	VkGraphicsPipelineCreateInfo create_info = {};
+	create_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	create_info.pNext = &library_info;
+	create_info.flags = 0;
+	create_info.layout = in_full_create_info.layout;
+	create_info.basePipelineIndex = -1;
+
+	VkPipeline pipeline;
+	VkResult result = vkCreateGraphicsPipelines(get_device(),
+		VK_NULL_HANDLE,
+		1,
+		&create_info,
+		nullptr,
+		&pipeline);
+	if(result != VK_SUCCESS)
+		return make_error(convert_result(result));
+
+	/** 
+	 * The job holds the libraries and the layout, the pipeline and its layout may be destroyed 
+	 * while it is compiling
+	 */
+	auto optimized_pipeline = std::make_shared<VulkanPipeline::OptimizedPipeline>();
+	std::shared_ptr<VulkanSharedPipelineLayout> pipeline_layout = get_resource<VulkanPipelineLayout>(
+		in_create_info.pipeline_layout)->get_shared_pipeline_layout();
+	{
+		std::scoped_lock lock(pipeline_libraries.mutex);
+		pipeline_libraries.jobs.emplace_back([this, libraries, pipeline_layout, create_info, optimized_pipeline]() mutable
+		{
+			/** Skip pipelines destroyed before their turn, nothing would use the optimized pipeline */
+			{
+				std::scoped_lock lock(optimized_pipeline->mutex);
+				if(optimized_pipeline->abandoned)
+					return;
+			}
+
+			std::array<VkPipeline, 4> library_handles;
+			for(size_t i = 0; i < libraries.size(); ++i)
+				library_handles[i] = libraries[i]->get_library();
+
+			VkPipelineLibraryCreateInfoKHR library_info = {};
+			library_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+			library_info.pNext = nullptr;
+			library_info.libraryCount = static_cast<uint32_t>(library_handles.size());
+			library_info.pLibraries = library_handles.data();
+
+			create_info.pNext = &library_info;
+			create_info.flags = VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT;
+			create_info.layout = pipeline_layout->get_pipeline_layout();
+
+			VkPipeline optimized;
+			if(VkResult result = vkCreateGraphicsPipelines(get_device(),
+				VK_NULL_HANDLE,
+				1,
+				&create_info,
+				nullptr,
+				&optimized); result != VK_SUCCESS)
+			{
+				logger::warn(log_vulkan, "Failed to compile optimized pipeline, keeping the fast-linked one: {}", 
+					convert_result(result));
+				return;
+			}
+
+			std::scoped_lock lock(optimized_pipeline->mutex);
+			if(optimized_pipeline->abandoned)
+				vkDestroyPipeline(get_device(), optimized, nullptr);
+			else
+				optimized_pipeline->pipeline.store(optimized, std::memory_order_release);
+		});
+	}
+	pipeline_libraries.condition.notify_one();
+
+	auto ret = new_resource<VulkanPipeline>(*this, pipeline, std::move(optimized_pipeline));
+	return make_result(ret.get());
+}
+
+cb::Result<std::shared_ptr<VulkanPipelineLibrary>, Result> VulkanDevice::get_or_create_pipeline_library(
+	VulkanPipelineLibraryKey&& in_key,
+	VkGraphicsPipelineCreateInfo in_create_info,
+	std::vector<BackendDeviceResource>&& in_dependencies)
+{
+	if(auto it = pipeline_libraries.libraries.find(in_key); it != pipeline_libraries.libraries.end())
+		return make_result(it->second);
+
+	VkGraphicsPipelineLibraryCreateInfoEXT library_info = {};
+	library_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT;
+	library_info.pNext = in_create_info.pNext;
+	library_info.flags = in_key.flags;
+
+	/** Link-time optimization info is kept for the optimized pipeline compiled in the background */
+	in_create_info.pNext = &library_info;
+	in_create_info.flags = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | 
+		VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+
+	VkPipeline library;
+	VkResult result = vkCreateGraphicsPipelines(get_device(),
+		VK_NULL_HANDLE,
+		1,
+		&in_create_info,
+		nullptr,
+		&library);
+	if(result != VK_SUCCESS)
+		return make_error(convert_result(result));
+
+	auto ret = std::make_shared<VulkanPipelineLibrary>(*this, library, std::move(in_dependencies));
+	pipeline_libraries.libraries.insert({ std::move(in_key), ret });
+	return make_result(ret);
+}
+
+void VulkanDevice::evict_pipeline_libraries(const BackendDeviceResource& in_resource)
+{
+	/** Pipelines and pending optimized compilations keep their libraries alive */
+	for(auto it = pipeline_libraries.libraries.begin(); it != pipeline_libraries.libraries.end();)
+	{
+		if(std::ranges::find(it->second->get_dependencies(), in_resource) != it->second->get_dependencies().end())
+			it = pipeline_libraries.libraries.erase(it);
+		else
+			++it;
+	}
+}
+
+void VulkanDevice::compile_optimized_pipelines()
+{
+	while(true)
+	{
+		std::function<void()> job;
+
+		{
+			std::unique_lock lock(pipeline_libraries.mutex);
+			pipeline_libraries.condition.wait(lock, [&]()
+			{
+				return pipeline_libraries.stop || !pipeline_libraries.jobs.empty();
+			});
+
+			if(pipeline_libraries.stop)
+				return;
+
+			job = std::move(pipeline_libraries.jobs.front());
+			pipeline_libraries.jobs.pop_front();
+		}
+
+		job();
+	}
+}
 	
 cb::Result<BackendDeviceResource, Result> VulkanDevice::create_render_pass(const RenderPassCreateInfo& in_create_info)
 {
@@ -523,7 +1068,7 @@ cb::Result<BackendDeviceResource, Result> VulkanDevice::create_render_pass(const
 		desc.pInputAttachments = holder.input_attachments.data();
 		desc.colorAttachmentCount = static_cast<uint32_t>(holder.color_attachments.size());
 		desc.pColorAttachments = holder.color_attachments.data();
-		desc.pResolveAttachments = holder.resolve_attachments.data();
+		desc.pResolveAttachments = holder.resolve_attachments.empty() ? nullptr : holder.resolve_attachments.data();
 		desc.preserveAttachmentCount = static_cast<uint32_t>(subpass.preserve_attachments.size());
 		desc.pPreserveAttachments = subpass.preserve_attachments.data();
 		desc.pDepthStencilAttachment = &holder.depth_stencil_attachment;
@@ -533,8 +1078,25 @@ cb::Result<BackendDeviceResource, Result> VulkanDevice::create_render_pass(const
 	
 	create_info.subpassCount = static_cast<uint32_t>(subpasses.size());
 	create_info.pSubpasses = subpasses.data();
-	create_info.dependencyCount = 0;
-	create_info.pDependencies = nullptr;
+
+	static_assert(SubpassDependency::external_subpass == VK_SUBPASS_EXTERNAL);
+	std::vector<VkSubpassDependency> dependencies;
+	dependencies.reserve(in_create_info.dependencies.size());
+	for(const auto& dependency : in_create_info.dependencies)
+	{
+		VkSubpassDependency desc = {};
+		desc.srcSubpass = dependency.src_subpass;
+		desc.dstSubpass = dependency.dst_subpass;
+		desc.srcStageMask = convert_pipeline_stage_flags(dependency.src_stage_mask);
+		desc.dstStageMask = convert_pipeline_stage_flags(dependency.dst_stage_mask);
+		desc.srcAccessMask = convert_access_flags(dependency.src_access_mask);
+		desc.dstAccessMask = convert_access_flags(dependency.dst_access_mask);
+		desc.dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+		dependencies.push_back(desc);
+	}
+
+	create_info.dependencyCount = static_cast<uint32_t>(dependencies.size());
+	create_info.pDependencies = dependencies.data();
 
 	VkRenderPass render_pass;
 	VkResult result = vkCreateRenderPass(get_device(),
@@ -605,6 +1167,12 @@ cb::Result<BackendDeviceResource, Result> VulkanDevice::create_texture(const Tex
 	if(in_create_info.usage_flags & TextureUsageFlagBits::TransferDst)
 		create_info.usage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
 
+	if(in_create_info.usage_flags & TextureUsageFlagBits::TransientAttachment)
+		create_info.usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+
+	if(in_create_info.usage_flags & TextureUsageFlagBits::InputAttachment)
+		create_info.usage |= VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+
 	VmaAllocationCreateInfo alloc_create_info = {};
 	alloc_create_info.flags = 0;
 	alloc_create_info.usage = convert_memory_usage(in_create_info.mem_usage);	
@@ -617,6 +1185,19 @@ cb::Result<BackendDeviceResource, Result> VulkanDevice::create_texture(const Tex
 		&image,
 		&allocation,
 		nullptr);
+
+	/** Most desktop GPUs have no lazily allocated memory type, transient attachments then use regular memory */
+	if(result == VK_ERROR_FEATURE_NOT_PRESENT && in_create_info.mem_usage == MemoryUsage::GpuLazy)
+	{
+		alloc_create_info.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+		result = vmaCreateImage(allocator,
+			&create_info,
+			&alloc_create_info,
+			&image,
+			&allocation,
+			nullptr);
+	}
+
 	if(result != VK_SUCCESS)
 		return make_error(convert_result(result));
 
@@ -732,9 +1313,13 @@ cb::Result<BackendDeviceResource, Result> VulkanDevice::create_pipeline_layout(c
 
 	uint32_t descriptor_type_mask = 0;
 
+	/** Kept to build each set allocator update template */
+	std::vector<std::vector<VkDescriptorSetLayoutBinding>> set_bindings;
+	set_bindings.reserve(in_create_info.set_layouts.size());
+
 	for(const auto& set : in_create_info.set_layouts)
 	{
-		std::vector<VkDescriptorSetLayoutBinding> bindings;
+		auto& bindings = set_bindings.emplace_back();
 		bindings.reserve(set.bindings.size());
 		for(const auto& binding : set.bindings)
 		{
@@ -768,6 +1353,28 @@ cb::Result<BackendDeviceResource, Result> VulkanDevice::create_pipeline_layout(c
 		set_layouts.emplace_back(set_layout);		
 	}
 
+	/** Bindless layouts fill unused sets with empty layouts up to the global bindless set */
+	std::vector<VkDescriptorSetLayout> pipeline_set_layouts;
+	if(in_create_info.bindless)
+	{
+		VkDescriptorSetLayoutCreateInfo create_info = {};
+		create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		while(set_layouts.size() < bindless_descriptor_set)
+		{
+			VkDescriptorSetLayout set_layout;
+			vkCreateDescriptorSetLayout(get_device(),
+				&create_info,
+				nullptr,
+				&set_layout);
+
+			set_layouts.emplace_back(set_layout);
+			set_bindings.emplace_back();
+		}
+
+		pipeline_set_layouts = set_layouts;
+		pipeline_set_layouts.emplace_back(bindless.set_layout);
+	}
+
 	std::vector<VkPushConstantRange> push_constant_ranges;
 	for(const auto& push_constant : in_create_info.push_constant_ranges)
 	{
@@ -782,8 +1389,8 @@ cb::Result<BackendDeviceResource, Result> VulkanDevice::create_pipeline_layout(c
 	create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 	create_info.pNext = nullptr;
 	create_info.flags = 0;
-	create_info.setLayoutCount = static_cast<uint32_t>(set_layouts.size());
-	create_info.pSetLayouts = set_layouts.data();
+	create_info.setLayoutCount = static_cast<uint32_t>(in_create_info.bindless ? pipeline_set_layouts.size() : set_layouts.size());
+	create_info.pSetLayouts = in_create_info.bindless ? pipeline_set_layouts.data() : set_layouts.data();
 	create_info.pushConstantRangeCount = static_cast<uint32_t>(push_constant_ranges.size());
 	create_info.pPushConstantRanges = push_constant_ranges.data();
 
@@ -804,7 +1411,8 @@ cb::Result<BackendDeviceResource, Result> VulkanDevice::create_pipeline_layout(c
 	{
 		size_t allocator_idx = descriptor_set_allocators.emplace(*this,
 			*layout_object,
-			set_layout);
+			set_layout,
+			set_bindings[idx]);
 		layout_object->allocator_indices[idx] = allocator_idx;
 		idx++;
 	}
@@ -866,10 +1474,11 @@ void VulkanDevice::reset_command_pool(const BackendDeviceResource& in_pool)
 
 cb::Result<BackendDeviceResource, Result> VulkanDevice::allocate_descriptor_set(const BackendDeviceResource& in_pipeline_layout,
 	const uint32_t in_set,
-	const std::span<Descriptor, max_bindings>& in_descriptors)
+	const std::span<Descriptor, max_bindings>& in_descriptors,
+	const uint64_t in_hash)
 {
 	auto& set_allocator = descriptor_set_allocators[get_resource<VulkanPipelineLayout>(in_pipeline_layout)->allocator_indices[in_set]];
-	return make_result(reinterpret_cast<BackendDeviceResource>(set_allocator.allocate(in_descriptors)));
+	return make_result(reinterpret_cast<BackendDeviceResource>(set_allocator.allocate(in_descriptors, in_hash)));
 }
 
 void VulkanDevice::destroy_buffer(const BackendDeviceResource& in_buffer)
@@ -884,6 +1493,7 @@ void VulkanDevice::destroy_swap_chain(const BackendDeviceResource& in_swap_chain
 
 void VulkanDevice::destroy_shader(const BackendDeviceResource& in_shader)
 {
+	evict_pipeline_libraries(in_shader);
 	free_resource<VulkanShader>(in_shader);
 }
 
@@ -894,6 +1504,7 @@ void VulkanDevice::destroy_pipeline(const BackendDeviceResource& in_pipeline)
 	
 void VulkanDevice::destroy_render_pass(const BackendDeviceResource& in_render_pass)
 {
+	evict_pipeline_libraries(in_render_pass);
 	free_resource<VulkanRenderPass>(in_render_pass);		
 }
 
@@ -929,10 +1540,45 @@ void VulkanDevice::destroy_fence(const BackendDeviceResource& in_fence)
 
 void VulkanDevice::destroy_pipeline_layout(const BackendDeviceResource& in_pipeline_layout)
 {
+	evict_pipeline_libraries(in_pipeline_layout);
 	free_resource<VulkanPipelineLayout>(in_pipeline_layout);				
 }
 
 /** Buffers */
+bool VulkanDevice::supports_linear_blit(const Format in_format)
+{
+	constexpr VkFormatFeatureFlags required_features = VK_FORMAT_FEATURE_BLIT_SRC_BIT |
+		VK_FORMAT_FEATURE_BLIT_DST_BIT |
+		VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+
+	VkFormatProperties properties;
+	vkGetPhysicalDeviceFormatProperties(get_physical_device(),
+		convert_format(in_format),
+		&properties);
+
+	return (properties.optimalTilingFeatures & required_features) == required_features;
+}
+
+bool VulkanDevice::supports_vertex_format(const Format in_format)
+{
+	VkFormatProperties properties;
+	vkGetPhysicalDeviceFormatProperties(get_physical_device(),
+		convert_format(in_format),
+		&properties);
+
+	return properties.bufferFeatures & VK_FORMAT_FEATURE_VERTEX_BUFFER_BIT;
+}
+
+SampleCountFlags VulkanDevice::get_supported_attachment_sample_counts()
+{
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(get_physical_device(), &properties);
+
+	/** SampleCountFlagBits mirror VkSampleCountFlagBits */
+	return SampleCountFlags(static_cast<SampleCountFlags::MaskType>(properties.limits.framebufferColorSampleCounts & 
+		properties.limits.framebufferDepthSampleCounts));
+}
+
 cb::Result<void*, Result> VulkanDevice::map_buffer(const BackendDeviceResource& in_buffer)
 {
 	void* data = nullptr;
@@ -944,15 +1590,27 @@ cb::Result<void*, Result> VulkanDevice::map_buffer(const BackendDeviceResource&
 	if(result != VK_SUCCESS)
 		return make_error(convert_result(result));
 
+	/** GpuToCpu memory may be cached without being coherent, no-op for coherent memory */
+	vmaInvalidateAllocation(allocator, buffer->get_allocation(), 0, VK_WHOLE_SIZE);
+
 	return make_result(data);
 }
 
 void VulkanDevice::unmap_buffer(const BackendDeviceResource& in_buffer)
 {
 	auto buffer = get_resource<VulkanBuffer>(in_buffer);
+
+	/** CpuToGpu memory may not be coherent either, no-op for coherent memory */
+	vmaFlushAllocation(allocator, buffer->get_allocation(), 0, VK_WHOLE_SIZE);
 	vmaUnmapMemory(allocator, buffer->get_allocation());
 }
 
+void VulkanDevice::flush_buffer(const BackendDeviceResource& in_buffer, const uint64_t in_offset, const uint64_t in_size)
+{
+	auto buffer = get_resource<VulkanBuffer>(in_buffer);
+	vmaFlushAllocation(allocator, buffer->get_allocation(), in_offset, in_size);
+}
+
 /** Swapchain */
 std::pair<Result, uint32_t> VulkanDevice::acquire_swapchain_image(const BackendDeviceResource& in_swapchain,
 	const BackendDeviceResource& in_signal_semaphore)
@@ -994,6 +1652,11 @@ Format VulkanDevice::get_swapchain_format(const BackendDeviceResource& in_swapch
 	return get_resource<VulkanSwapChain>(in_swapchain)->get_format();
 }
 
+PresentMode VulkanDevice::get_swapchain_present_mode(const BackendDeviceResource& in_swapchain)
+{
+	return get_resource<VulkanSwapChain>(in_swapchain)->get_present_mode();
+}
+
 /** Fences */
 Result VulkanDevice::wait_for_fences(const std::span<BackendDeviceResource>& in_fences, 
 	const bool in_wait_for_all, 
@@ -1098,25 +1761,101 @@ void VulkanDevice::cmd_draw_indexed(const BackendDeviceResource& in_list,
 		in_first_instance);
 }
 
+void VulkanDevice::cmd_next_subpass(const BackendDeviceResource& in_list)
+{
+	vkCmdNextSubpass(get_resource<VulkanCommandList>(in_list)->get_command_buffer(), VK_SUBPASS_CONTENTS_INLINE);
+}
+
 void VulkanDevice::cmd_end_render_pass(const BackendDeviceResource& in_list)
 {
 	vkCmdEndRenderPass(get_resource<VulkanCommandList>(in_list)->get_command_buffer());
 }
 
+void VulkanDevice::cmd_begin_rendering(const BackendDeviceResource& in_list, const RenderingInfo& in_info)
+{
+	const auto convert_attachment = [](const RenderingAttachmentInfo& in_attachment)
+	{
+		VkRenderingAttachmentInfoKHR attachment = {};
+		attachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+		attachment.pNext = nullptr;
+		attachment.imageView = get_resource<VulkanTextureView>(in_attachment.texture_view)->get_image_view();
+		attachment.imageLayout = convert_texture_layout(in_attachment.layout);
+		attachment.resolveMode = VK_RESOLVE_MODE_NONE;
+		if(in_attachment.resolve_texture_view != null_backend_resource)
+		{
+			attachment.resolveMode = VK_RESOLVE_MODE_AVERAGE_BIT;
+			attachment.resolveImageView = get_resource<VulkanTextureView>(in_attachment.resolve_texture_view)->get_image_view();
+			attachment.resolveImageLayout = convert_texture_layout(in_attachment.resolve_layout);
+		}
+		attachment.loadOp = convert_load_op(in_attachment.load_op);
+		attachment.storeOp = convert_store_op(in_attachment.store_op);
+		attachment.clearValue = *reinterpret_cast<const VkClearValue*>(&in_attachment.clear_value);
+		return attachment;
+	};
+
+	std::array<VkRenderingAttachmentInfoKHR, max_attachments_per_framebuffer> color_attachments;
+	for(size_t i = 0; i < in_info.color_attachments.size(); ++i)
+		color_attachments[i] = convert_attachment(in_info.color_attachments[i]);
+
+	VkRenderingAttachmentInfoKHR depth_attachment = {};
+	if(in_info.depth_attachment.texture_view != null_backend_resource)
+		depth_attachment = convert_attachment(in_info.depth_attachment);
+
+	VkRenderingAttachmentInfoKHR stencil_attachment = {};
+	if(in_info.stencil_attachment.texture_view != null_backend_resource)
+		stencil_attachment = convert_attachment(in_info.stencil_attachment);
+
+	Rect2D render_area = in_info.render_area;
+
+	VkRenderingInfoKHR rendering_info = {};
+	rendering_info.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+	rendering_info.pNext = nullptr;
+	rendering_info.flags = 0;
+	rendering_info.renderArea = *reinterpret_cast<VkRect2D*>(&render_area);
+	rendering_info.layerCount = 1;
+	rendering_info.viewMask = 0;
+	rendering_info.colorAttachmentCount = static_cast<uint32_t>(in_info.color_attachments.size());
+	rendering_info.pColorAttachments = color_attachments.data();
+	rendering_info.pDepthAttachment = depth_attachment.imageView != VK_NULL_HANDLE ? &depth_attachment : nullptr;
+	rendering_info.pStencilAttachment = stencil_attachment.imageView != VK_NULL_HANDLE ? &stencil_attachment : nullptr;
+
+	vkCmdBeginRenderingKHR(get_resource<VulkanCommandList>(in_list)->get_command_buffer(), &rendering_info);
+}
+
+void VulkanDevice::cmd_end_rendering(const BackendDeviceResource& in_list)
+{
+	vkCmdEndRenderingKHR(get_resource<VulkanCommandList>(in_list)->get_command_buffer());
+}
+
 void VulkanDevice::cmd_bind_descriptor_sets(const BackendDeviceResource in_list, 
 	const BackendDeviceResource in_pipeline_layout, 
+	const uint32_t in_first_set,
 	const std::span<BackendDeviceResource> in_descriptor_sets)
 {
 	vkCmdBindDescriptorSets(get_resource<VulkanCommandList>(in_list)->get_command_buffer(),
 		VK_PIPELINE_BIND_POINT_GRAPHICS,
 		get_resource<VulkanPipelineLayout>(in_pipeline_layout)->get_pipeline_layout(),
-		0,
+		in_first_set,
 		static_cast<uint32_t>(in_descriptor_sets.size()),
 		reinterpret_cast<VkDescriptorSet*>(in_descriptor_sets.data()),
 		0,
 		nullptr);
 }
 
+void VulkanDevice::cmd_push_constants(const BackendDeviceResource& in_list,
+	const BackendDeviceResource& in_pipeline_layout,
+	const ShaderStageFlags in_stages,
+	const uint32_t in_offset,
+	const std::span<const uint8_t>& in_data)
+{
+	vkCmdPushConstants(get_resource<VulkanCommandList>(in_list)->get_command_buffer(),
+		get_resource<VulkanPipelineLayout>(in_pipeline_layout)->get_pipeline_layout(),
+		convert_shader_stage_flags(in_stages),
+		in_offset,
+		static_cast<uint32_t>(in_data.size()),
+		in_data.data());
+}
+
 void VulkanDevice::cmd_bind_vertex_buffers(const BackendDeviceResource& in_list, 
 	const uint32_t in_first_binding, 
 	const std::span<BackendDeviceResource> in_buffers, 
@@ -1236,8 +1975,8 @@ void VulkanDevice::cmd_copy_buffer_to_texture(const BackendDeviceResource in_lis
 	for(const auto& region : in_copy_regions)
 		regions.push_back(VkBufferImageCopy {
 			region.buffer_offset,
-			0,
-			0,
+			region.buffer_row_length,
+			region.buffer_image_height,
 			convert_subresource_layers(region.texture_subresource),
 			*reinterpret_cast<const VkOffset3D*>(&region.texture_offset),
 			*reinterpret_cast<const VkExtent3D*>(&region.texture_extent)});
@@ -1250,6 +1989,87 @@ void VulkanDevice::cmd_copy_buffer_to_texture(const BackendDeviceResource in_lis
 		regions.data());
 }
 
+void VulkanDevice::cmd_copy_texture_to_buffer(const BackendDeviceResource in_list, 
+	const BackendDeviceResource in_src_texture, 
+	const TextureLayout in_src_layout, 
+	const BackendDeviceResource in_dst_buffer, 
+	const std::span<BufferTextureCopyRegion>& in_copy_regions)
+{
+	std::vector<VkBufferImageCopy> regions;
+	regions.reserve(in_copy_regions.size());
+
+	for(const auto& region : in_copy_regions)
+		regions.push_back(VkBufferImageCopy {
+			region.buffer_offset,
+			region.buffer_row_length,
+			region.buffer_image_height,
+			convert_subresource_layers(region.texture_subresource),
+			*reinterpret_cast<const VkOffset3D*>(&region.texture_offset),
+			*reinterpret_cast<const VkExtent3D*>(&region.texture_extent)});
+
+	vkCmdCopyImageToBuffer(get_resource<VulkanCommandList>(in_list)->get_command_buffer(),
+		get_resource<VulkanTexture>(in_src_texture)->get_texture(),
+		convert_texture_layout(in_src_layout),
+		get_resource<VulkanBuffer>(in_dst_buffer)->get_buffer(),
+		static_cast<uint32_t>(regions.size()),
+		regions.data());
+
+	cmd_host_read_barrier(in_list);
+}
+
+void VulkanDevice::cmd_host_read_barrier(const BackendDeviceResource in_list)
+{
+	/** Waiting on the fence doesn't make device writes available to the host, the barrier does */
+	VkMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+	vkCmdPipelineBarrier(get_resource<VulkanCommandList>(in_list)->get_command_buffer(),
+		VK_PIPELINE_STAGE_TRANSFER_BIT,
+		VK_PIPELINE_STAGE_HOST_BIT,
+		0,
+		1,
+		&barrier,
+		0,
+		nullptr,
+		0,
+		nullptr);
+}
+
+void VulkanDevice::cmd_blit_texture(const BackendDeviceResource in_list, 
+	const BackendDeviceResource in_src_texture, 
+	const TextureLayout in_src_layout, 
+	const BackendDeviceResource in_dst_texture, 
+	const TextureLayout in_dst_layout, 
+	const std::span<TextureBlitRegion>& in_regions, 
+	const Filter in_filter)
+{
+	std::vector<VkImageBlit> regions;
+	regions.reserve(in_regions.size());
+
+	for(const auto& region : in_regions)
+	{
+		VkImageBlit blit;
+		blit.srcSubresource = convert_subresource_layers(region.src_subresource);
+		blit.dstSubresource = convert_subresource_layers(region.dst_subresource);
+		for(size_t i = 0; i < 2; ++i)
+		{
+			blit.srcOffsets[i] = { region.src_offsets[i].x, region.src_offsets[i].y, region.src_offsets[i].z };
+			blit.dstOffsets[i] = { region.dst_offsets[i].x, region.dst_offsets[i].y, region.dst_offsets[i].z };
+		}
+		regions.push_back(blit);
+	}
+
+	vkCmdBlitImage(get_resource<VulkanCommandList>(in_list)->get_command_buffer(),
+		get_resource<VulkanTexture>(in_src_texture)->get_texture(),
+		convert_texture_layout(in_src_layout),
+		get_resource<VulkanTexture>(in_dst_texture)->get_texture(),
+		convert_texture_layout(in_dst_layout),
+		static_cast<uint32_t>(regions.size()),
+		regions.data(),
+		convert_filter(in_filter));
+}
+
 void VulkanDevice::end_cmd_list(const BackendDeviceResource& in_list)
 {
 	vkEndCommandBuffer(get_resource<VulkanCommandList>(in_list)->get_command_buffer());
@@ -4,13 +4,70 @@
 #include "Vulkan.hpp"
 #include "engine/gfx/VulkanBackend.hpp"
 #include <robin_hood.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include "VulkanDescriptorSet.hpp"
+#include "VulkanSurface.hpp"
 #include "engine/containers/SparseArray.hpp"
 
 namespace cb::gfx
 {
 
 class VulkanSwapChain;
+class VulkanPipelineLibrary;
+
+/**
+ * State a pipeline library is compiled from, create_info only holds the fields of its part
+ * Owns its stages and blend attachments so cached libraries are compared by value on a hit
+ */
+struct VulkanPipelineLibraryKey
+{
+	VkGraphicsPipelineLibraryFlagsEXT flags = 0;
+	std::vector<PipelineShaderStage> stages;
+	std::vector<PipelineColorBlendAttachmentState> color_blend_attachments;
+	GfxPipelineCreateInfo create_info;
+
+	bool operator==(const VulkanPipelineLibraryKey& in_other) const
+	{
+		return flags == in_other.flags &&
+			stages == in_other.stages &&
+			color_blend_attachments == in_other.color_blend_attachments &&
+			create_info == in_other.create_info;
+	}
+};
+
+}
+
+namespace std
+{
+
+template<> struct hash<cb::gfx::VulkanPipelineLibraryKey>
+{
+	uint64_t operator()(const cb::gfx::VulkanPipelineLibraryKey& in_key) const noexcept
+	{
+		uint64_t hash = 0;
+
+		cb::hash_combine(hash, in_key.flags);
+		for(const auto& stage : in_key.stages)
+			cb::hash_combine(hash, stage);
+
+		for(const auto& attachment : in_key.color_blend_attachments)
+			cb::hash_combine(hash, attachment);
+
+		cb::hash_combine(hash, in_key.create_info);
+
+		return hash;
+	}
+};
+
+}
+
+namespace cb::gfx
+{
 
 class VulkanDevice final : public BackendDevice
 {
@@ -45,44 +102,24 @@ class VulkanDevice final : public BackendDevice
 	public:
 		SurfaceManager(VulkanDevice& in_device) : device(in_device) {}
 
-		cb::Result<VkSurfaceKHR, Result> get_or_create(void* in_os_handle)
+		/** Surfaces are keyed by window, every headless swapchain shares the same surface */
+		cb::Result<VkSurfaceKHR, Result> get_or_create(const NativeWindowHandle& in_window)
 		{
 			{
-				if(auto it = surfaces.find(in_os_handle); it != surfaces.end())
+				if(auto it = surfaces.find(in_window.window); it != surfaces.end())
 					return it->second.surface;
 			}
 
-			auto surface = create_surface(in_os_handle);
+			auto surface = create_vulkan_surface(device.get_backend().get_instance(), in_window);
 			if(!surface)
 			{
 				logger::error(log_vulkan, "Failed to create Vulkan surface: {}", surface.get_error());
 				return make_error(Result::ErrorInitializationFailed);
 			}
 			
-			surfaces.insert({ in_os_handle, SurfaceWrapper(device, surface.get_value()) });
+			surfaces.insert({ in_window.window, SurfaceWrapper(device, surface.get_value()) });
 			return make_result(surface.get_value());
 		}
-	private:
-		cb::Result<VkSurfaceKHR, VkResult> create_surface(void* in_os_handle)
-		{
-#if CB_PLATFORM(WINDOWS)
-			VkWin32SurfaceCreateInfoKHR create_info = {};
-			create_info.sType = VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR;
-			create_info.hinstance = nullptr;
-			create_info.hwnd = static_cast<HWND>(in_os_handle);
-			create_info.flags = 0;
-			create_info.pNext = nullptr;
-
-			VkSurfaceKHR handle = VK_NULL_HANDLE;
-			if(VkResult result = vkCreateWin32SurfaceKHR(device.get_backend().get_instance(),
-				&create_info,
-				nullptr,
-				&handle); result != VK_SUCCESS)
-				return make_error(result);
-
-			return make_result(handle);
-#endif
-		}
 	private:
 		VulkanDevice& device;
 		robin_hood::unordered_map<void*, SurfaceWrapper> surfaces;
@@ -119,7 +156,11 @@ class VulkanDevice final : public BackendDevice
 		VkFramebuffer get_or_create(VkRenderPass in_render_pass, const Framebuffer& in_framebuffer);
 	};
 public:
-	explicit VulkanDevice(VulkanBackend& in_backend, vkb::Device&& in_device);
+	explicit VulkanDevice(VulkanBackend& in_backend, 
+		vkb::Device&& in_device, 
+		const bool in_bindless, 
+		const bool in_dynamic_rendering,
+		const bool in_graphics_pipeline_library);
 	~VulkanDevice() override;
 
 	void new_frame() override;
@@ -160,10 +201,26 @@ public:
 
 	cb::Result<BackendDeviceResource, Result> allocate_descriptor_set(const BackendDeviceResource& in_pipeline_layout,
 		const uint32_t in_set,
-		const std::span<Descriptor, max_bindings>& in_descriptors) override;
+		const std::span<Descriptor, max_bindings>& in_descriptors,
+		const uint64_t in_hash) override;
+
+	bool supports_linear_blit(const Format in_format) override;
+	bool supports_vertex_format(const Format in_format) override;
+	SampleCountFlags get_supported_attachment_sample_counts() override;
+
+	bool is_bindless_enabled() override { return bindless.set != VK_NULL_HANDLE; }
+	BackendDeviceResource get_bindless_descriptor_set() override { return reinterpret_cast<BackendDeviceResource>(bindless.set); }
+	void update_bindless_texture_view(const uint32_t in_index, const BackendDeviceResource& in_texture_view,
+		const TextureLayout in_layout) override;
+	void update_bindless_sampler(const uint32_t in_index, const BackendDeviceResource& in_sampler) override;
+	void update_bindless_storage_buffer(const uint32_t in_index, const BackendDeviceResource& in_buffer) override;
+
+	bool supports_dynamic_rendering() override { return vkCmdBeginRenderingKHR != nullptr; }
+	bool supports_graphics_pipeline_library() override { return pipeline_libraries.enabled; }
 
 	cb::Result<void*, Result> map_buffer(const BackendDeviceResource& in_buffer) override;
 	void unmap_buffer(const BackendDeviceResource& in_buffer) override;
+	void flush_buffer(const BackendDeviceResource& in_buffer, const uint64_t in_offset, const uint64_t in_size) override;
 
 	cb::Result<std::vector<BackendDeviceResource>, Result> allocate_command_lists(const BackendDeviceResource& in_pool, 
 		const uint32_t in_count) override;
@@ -190,10 +247,19 @@ public:
 		const uint32_t in_first_index,
 		const int32_t in_vertex_offset,
 		const uint32_t in_first_instance) override;
+	void cmd_next_subpass(const BackendDeviceResource& in_list) override;
 	void cmd_end_render_pass(const BackendDeviceResource& in_list) override;
+	void cmd_begin_rendering(const BackendDeviceResource& in_list, const RenderingInfo& in_info) override;
+	void cmd_end_rendering(const BackendDeviceResource& in_list) override;
 	void cmd_bind_descriptor_sets(const BackendDeviceResource in_list, 
 		const BackendDeviceResource in_pipeline_layout, 
+		const uint32_t in_first_set,
 		const std::span<BackendDeviceResource> in_descriptor_sets) override;
+	void cmd_push_constants(const BackendDeviceResource& in_list,
+		const BackendDeviceResource& in_pipeline_layout,
+		const ShaderStageFlags in_stages,
+		const uint32_t in_offset,
+		const std::span<const uint8_t>& in_data) override;
 	void cmd_bind_vertex_buffers(const BackendDeviceResource& in_list, 
 		const uint32_t in_first_binding, 
 		const std::span<BackendDeviceResource> in_buffers, 
@@ -217,6 +283,19 @@ public:
 		const BackendDeviceResource in_dst_texture,
 		const TextureLayout in_dst_layout,
 		const std::span<BufferTextureCopyRegion>& in_copy_regions);
+	void cmd_copy_texture_to_buffer(const BackendDeviceResource in_list,
+		const BackendDeviceResource in_src_texture,
+		const TextureLayout in_src_layout,
+		const BackendDeviceResource in_dst_buffer,
+		const std::span<BufferTextureCopyRegion>& in_copy_regions) override;
+	void cmd_host_read_barrier(const BackendDeviceResource in_list) override;
+	void cmd_blit_texture(const BackendDeviceResource in_list,
+		const BackendDeviceResource in_src_texture,
+		const TextureLayout in_src_layout,
+		const BackendDeviceResource in_dst_texture,
+		const TextureLayout in_dst_layout,
+		const std::span<TextureBlitRegion>& in_regions,
+		const Filter in_filter) override;
 
 	void end_cmd_list(const BackendDeviceResource& in_list) override;
 
@@ -228,6 +307,7 @@ public:
 	const std::vector<BackendDeviceResource>& get_swapchain_backbuffers(const BackendDeviceResource& in_swapchain) override;
 	BackendDeviceResource get_swapchain_backbuffer_view(const BackendDeviceResource& in_swapchain) override;
 	Format get_swapchain_format(const BackendDeviceResource& in_swapchain) override;
+	PresentMode get_swapchain_present_mode(const BackendDeviceResource& in_swapchain) override;
 	
 	Result wait_for_fences(const std::span<BackendDeviceResource>& in_fences, 
 		const bool in_wait_for_all, 
@@ -249,6 +329,27 @@ public:
 	[[nodiscard]] VkPhysicalDevice get_physical_device() const { return device_wrapper.device.physical_device.physical_device; }
 	[[nodiscard]] VmaAllocator get_allocator() const { return allocator; }
 	[[nodiscard]] VkQueue get_present_queue() { return device_wrapper.device.get_queue(vkb::QueueType::graphics).value(); }
+	[[nodiscard]] VkDescriptorSetLayout get_bindless_set_layout() const { return bindless.set_layout; }
+private:
+	void create_bindless_set();
+
+	/** in_present_mode if the surface supports it, otherwise its closest supported fallback */
+	[[nodiscard]] VkPresentModeKHR select_present_mode(VkSurfaceKHR in_surface, const PresentMode in_present_mode) const;
+	void write_bindless_descriptor(VkWriteDescriptorSet& in_write);
+
+	/**
+	 * Link a pipeline from its vertex input, pre-rasterization, fragment shader and fragment output libraries,
+	 * compiling the missing ones, and queue the compilation of its link-time optimized version
+	 */
+	cb::Result<BackendDeviceResource, Result> create_gfx_pipeline_from_libraries(const GfxPipelineCreateInfo& in_create_info,
+		const VkGraphicsPipelineCreateInfo& in_full_create_info);
+	cb::Result<std::shared_ptr<VulkanPipelineLibrary>, Result> get_or_create_pipeline_library(VulkanPipelineLibraryKey&& in_key,
+		VkGraphicsPipelineCreateInfo in_create_info,
+		std::vector<BackendDeviceResource>&& in_dependencies);
+
+	/** Drop the libraries compiled with in_resource, its handle may be reused by a new resource */
+	void evict_pipeline_libraries(const BackendDeviceResource& in_resource);
+	void compile_optimized_pipelines();
 private:
 	VulkanBackend& backend;
 	VmaAllocator allocator;
@@ -256,6 +357,35 @@ private:
 	SurfaceManager surface_manager;
 	FramebufferManager framebuffer_manager;
 	SparseArray<VulkanDescriptorSetAllocator> descriptor_set_allocators;
+
+	/** VK_KHR_dynamic_rendering, null if unsupported */
+	PFN_vkCmdBeginRenderingKHR vkCmdBeginRenderingKHR;
+	PFN_vkCmdEndRenderingKHR vkCmdEndRenderingKHR;
+
+	/** Global update-after-bind set, writes must be externally synchronized */
+	struct Bindless
+	{
+		VkDescriptorSetLayout set_layout = VK_NULL_HANDLE;
+		VkDescriptorPool pool = VK_NULL_HANDLE;
+		VkDescriptorSet set = VK_NULL_HANDLE;
+		std::mutex mutex;
+	} bindless;
+
+	/**
+	 * VK_EXT_graphics_pipeline_library, pipelines are fully compiled at creation when disabled
+	 * Libraries are keyed by the state they are compiled from and shared by the pipelines linked from it.
+	 * Optimized pipelines are compiled by a single worker, pending jobs are dropped at destruction
+	 */
+	struct PipelineLibraries
+	{
+		bool enabled = false;
+		robin_hood::unordered_map<VulkanPipelineLibraryKey, std::shared_ptr<VulkanPipelineLibrary>> libraries;
+		std::thread worker;
+		std::mutex mutex;
+		std::condition_variable condition;
+		std::deque<std::function<void()>> jobs;
+		bool stop = false;
+	} pipeline_libraries;
 };
 	
 }
\ No newline at end of file
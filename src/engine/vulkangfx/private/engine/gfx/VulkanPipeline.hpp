@@ -1,28 +1,96 @@
 #pragma once
 
 #include "Vulkan.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace cb::gfx
 {
 
+/**
+ * Part of a graphics pipeline compiled on its own with VK_EXT_graphics_pipeline_library,
+ * shared by every pipeline linked from it
+ */
+class VulkanPipelineLibrary final
+{
+public:
+	VulkanPipelineLibrary(VulkanDevice& in_device,
+		VkPipeline in_library,
+		std::vector<BackendDeviceResource>&& in_dependencies) : device(in_device), library(in_library),
+		dependencies(std::move(in_dependencies)) {}
+
+	VulkanPipelineLibrary(const VulkanPipelineLibrary&) = delete;
+	void operator=(const VulkanPipelineLibrary&) = delete;
+
+	~VulkanPipelineLibrary()
+	{
+		vkDestroyPipeline(device.get_device(), library, nullptr);
+	}
+
+	[[nodiscard]] VkPipeline get_library() const { return library; }
+
+	/** Shaders, layout and render pass the library was compiled with, destroying one evicts the library */
+	[[nodiscard]] const std::vector<BackendDeviceResource>& get_dependencies() const { return dependencies; }
+private:
+	VulkanDevice& device;
+	VkPipeline library;
+	std::vector<BackendDeviceResource> dependencies;
+};
+
 class VulkanPipeline final
 {
 public:
+	/**
+	 * Link-time optimized pipeline compiled in the background, replaces the fast-linked one once ready
+	 * Shared with the compile job so the pipeline can be destroyed while it is still compiling
+	 */
+	struct OptimizedPipeline
+	{
+		std::mutex mutex;
+		std::atomic<VkPipeline> pipeline = VK_NULL_HANDLE;
+		bool abandoned = false;
+	};
+
 	VulkanPipeline(VulkanDevice& in_device, 
-		VkPipeline in_pipeline) : device(in_device), pipeline(in_pipeline) {}
+		VkPipeline in_pipeline,
+		std::shared_ptr<OptimizedPipeline> in_optimized_pipeline = nullptr) : device(in_device), pipeline(in_pipeline),
+		optimized_pipeline(std::move(in_optimized_pipeline)) {}
 
 	VulkanPipeline(VulkanPipeline&& in_other) noexcept = delete;
 	
 	~VulkanPipeline()
 	{
+		if(optimized_pipeline)
+		{
+			std::scoped_lock lock(optimized_pipeline->mutex);
+			optimized_pipeline->abandoned = true;
+			if(VkPipeline optimized = optimized_pipeline->pipeline.exchange(VK_NULL_HANDLE); optimized != VK_NULL_HANDLE)
+				vkDestroyPipeline(device.get_device(), optimized, nullptr);
+		}
+
 		vkDestroyPipeline(device.get_device(), pipeline, nullptr);	
 	}
 
 	[[nodiscard]] VulkanDevice& get_device() const { return device; }
-	[[nodiscard]] VkPipeline get_pipeline() const { return pipeline; }
+
+	/** The optimized pipeline when it is ready, the fast-linked one until then */
+	[[nodiscard]] VkPipeline get_pipeline() const 
+	{
+		if(optimized_pipeline)
+		{
+			if(VkPipeline optimized = optimized_pipeline->pipeline.load(std::memory_order_acquire); 
+				optimized != VK_NULL_HANDLE)
+				return optimized;
+		}
+
+		return pipeline; 
+	}
 private:
 	VulkanDevice& device;
 	VkPipeline pipeline;
+	std::shared_ptr<OptimizedPipeline> optimized_pipeline;
 };
 
 inline VkVertexInputRate convert_vertex_input_rate(const VertexInputRate& in_rate)
@@ -292,7 +360,7 @@ inline VkPipelineStageFlags convert_pipeline_stage_flags(const PipelineStageFlag
 		flags |= VK_PIPELINE_STAGE_GEOMETRY_SHADER_BIT;
 	
 	if(in_flags & PipelineStageFlagBits::EarlyFragmentTests)
-		flags |= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+		flags |= VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
 	
 	if(in_flags & PipelineStageFlagBits::FragmentShader)
 		flags |= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
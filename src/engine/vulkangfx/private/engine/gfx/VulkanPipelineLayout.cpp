@@ -9,7 +9,8 @@ namespace cb::gfx
 VulkanPipelineLayout::VulkanPipelineLayout(VulkanDevice& in_device, 
 	VkPipelineLayout in_pipeline_layout,
 	const std::vector<VkDescriptorSetLayout>& in_set_layouts,
-	const uint32_t in_descriptor_type_mask) : device(in_device), pipeline_layout(in_pipeline_layout),
+	const uint32_t in_descriptor_type_mask) : device(in_device), 
+	pipeline_layout(std::make_shared<VulkanSharedPipelineLayout>(in_device.get_device(), in_pipeline_layout)),
 	set_layouts(in_set_layouts), descriptor_type_mask(in_descriptor_type_mask)
 {
 	memset(allocator_indices.data(), 0, sizeof(size_t) * allocator_indices.size());
@@ -24,8 +25,6 @@ VulkanPipelineLayout::~VulkanPipelineLayout()
 		device.free_descriptor_set_allocator(allocator_indices[i]);
 		i++;
 	}
-
-	vkDestroyPipelineLayout(device.get_device(), pipeline_layout, nullptr);	
 }
 
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "Vulkan.hpp"
 #include "engine/gfx/PipelineLayout.hpp"
 #include "engine/gfx/VulkanDevice.hpp"
+#include <memory>
 #include <queue>
 #include <robin_hood.h>
 
@@ -12,6 +13,31 @@ namespace cb::gfx
 class VulkanDevice;
 class VulkanDescriptorSetAllocator;
 
+/**
+ * Owns a VkPipelineLayout, shared with the optimized pipelines still compiling against it
+ * so destroying the layout doesn't have to wait for them
+ */
+class VulkanSharedPipelineLayout final
+{
+public:
+	VulkanSharedPipelineLayout(VkDevice in_device, VkPipelineLayout in_pipeline_layout) : device(in_device),
+		pipeline_layout(in_pipeline_layout) {}
+
+	VulkanSharedPipelineLayout(const VulkanSharedPipelineLayout&) = delete;
+	void operator=(const VulkanSharedPipelineLayout&) = delete;
+
+	~VulkanSharedPipelineLayout()
+	{
+		vkDestroyPipelineLayout(device, pipeline_layout, nullptr);
+	}
+
+	[[nodiscard]] VkPipelineLayout get_pipeline_layout() const { return pipeline_layout->get_pipeline_layout(); }
+	[[nodiscard]] const std::shared_ptr<VulkanSharedPipelineLayout>& get_shared_pipeline_layout() const { return pipeline_layout; }
+private:
+	VkDevice device;
+	VkPipelineLayout pipeline_layout;
+};
+
 class VulkanPipelineLayout final
 {
 	friend class VulkanDevice;
@@ -26,13 +52,14 @@ public:
 	~VulkanPipelineLayout();
 
 	[[nodiscard]] VulkanDevice& get_device() const { return device; }
-	[[nodiscard]] VkPipelineLayout get_pipeline_layout() const { return pipeline_layout; }
+	[[nodiscard]] VkPipelineLayout get_pipeline_layout() const { return pipeline_layout->get_pipeline_layout(); }
+	[[nodiscard]] const std::shared_ptr<VulkanSharedPipelineLayout>& get_shared_pipeline_layout() const { return pipeline_layout; }
 	[[nodiscard]] uint32_t get_descriptor_type_mask() const { return descriptor_type_mask; }
 private:
 	void allocate_pool();
 private:
 	VulkanDevice& device;
-	VkPipelineLayout pipeline_layout;
+	std::shared_ptr<VulkanSharedPipelineLayout> pipeline_layout;
 	std::vector<VkDescriptorSetLayout> set_layouts;
 	uint32_t descriptor_type_mask;
 	std::array<size_t, max_descriptor_sets> allocator_indices;
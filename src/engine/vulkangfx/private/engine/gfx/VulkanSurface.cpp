@@ -0,0 +1,139 @@
+#include "engine/gfx/VulkanSurface.hpp"
+#include <cstdint>
+
+/**
+ * The platform headers only provide the handle types, they are declared here so this file doesn't depend on
+ * the X11/XCB/Wayland development packages or get their macros
+ */
+#if CB_PLATFORM(WINDOWS)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#include <vulkan/vulkan_win32.h>
+#elif CB_PLATFORM(LINUX)
+typedef struct _XDisplay Display;
+typedef unsigned long Window;
+typedef unsigned long VisualID;
+typedef struct xcb_connection_t xcb_connection_t;
+typedef uint32_t xcb_window_t;
+typedef uint32_t xcb_visualid_t;
+struct wl_display;
+struct wl_surface;
+#include <vulkan/vulkan_xlib.h>
+#include <vulkan/vulkan_xcb.h>
+#include <vulkan/vulkan_wayland.h>
+#endif
+
+namespace cb::gfx
+{
+
+namespace
+{
+
+template<typename T>
+T get_instance_proc_addr(VkInstance in_instance, const char* in_name)
+{
+	return reinterpret_cast<T>(vkGetInstanceProcAddr(in_instance, in_name));
+}
+
+}
+
+cb::Result<VkSurfaceKHR, VkResult> create_vulkan_surface(VkInstance in_instance, const NativeWindowHandle& in_window)
+{
+	VkSurfaceKHR handle = VK_NULL_HANDLE;
+	VkResult result = VK_ERROR_EXTENSION_NOT_PRESENT;
+
+	switch(in_window.system)
+	{
+	case WindowSystem::Headless:
+	{
+		auto create_surface = get_instance_proc_addr<PFN_vkCreateHeadlessSurfaceEXT>(in_instance,
+			"vkCreateHeadlessSurfaceEXT");
+		if(!create_surface)
+			break;
+
+		VkHeadlessSurfaceCreateInfoEXT create_info = {};
+		create_info.sType = VK_STRUCTURE_TYPE_HEADLESS_SURFACE_CREATE_INFO_EXT;
+		create_info.pNext = nullptr;
+		create_info.flags = 0;
+		result = create_surface(in_instance, &create_info, nullptr, &handle);
+		break;
+	}
+#if CB_PLATFORM(WINDOWS)
+	case WindowSystem::Win32:
+	{
+		auto create_surface = get_instance_proc_addr<PFN_vkCreateWin32SurfaceKHR>(in_instance,
+			"vkCreateWin32SurfaceKHR");
+		if(!create_surface)
+			break;
+
+		VkWin32SurfaceCreateInfoKHR create_info = {};
+		create_info.sType = VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR;
+		create_info.pNext = nullptr;
+		create_info.flags = 0;
+		create_info.hinstance = nullptr;
+		create_info.hwnd = static_cast<HWND>(in_window.window);
+		result = create_surface(in_instance, &create_info, nullptr, &handle);
+		break;
+	}
+#elif CB_PLATFORM(LINUX)
+	case WindowSystem::Xlib:
+	{
+		auto create_surface = get_instance_proc_addr<PFN_vkCreateXlibSurfaceKHR>(in_instance,
+			"vkCreateXlibSurfaceKHR");
+		if(!create_surface)
+			break;
+
+		VkXlibSurfaceCreateInfoKHR create_info = {};
+		create_info.sType = VK_STRUCTURE_TYPE_XLIB_SURFACE_CREATE_INFO_KHR;
+		create_info.pNext = nullptr;
+		create_info.flags = 0;
+		create_info.dpy = static_cast<Display*>(in_window.display);
+		create_info.window = static_cast<::Window>(reinterpret_cast<uintptr_t>(in_window.window));
+		result = create_surface(in_instance, &create_info, nullptr, &handle);
+		break;
+	}
+	case WindowSystem::Xcb:
+	{
+		auto create_surface = get_instance_proc_addr<PFN_vkCreateXcbSurfaceKHR>(in_instance,
+			"vkCreateXcbSurfaceKHR");
+		if(!create_surface)
+			break;
+
+		VkXcbSurfaceCreateInfoKHR create_info = {};
+		create_info.sType = VK_STRUCTURE_TYPE_XCB_SURFACE_CREATE_INFO_KHR;
+		create_info.pNext = nullptr;
+		create_info.flags = 0;
+		create_info.connection = static_cast<xcb_connection_t*>(in_window.display);
+		create_info.window = static_cast<xcb_window_t>(reinterpret_cast<uintptr_t>(in_window.window));
+		result = create_surface(in_instance, &create_info, nullptr, &handle);
+		break;
+	}
+	case WindowSystem::Wayland:
+	{
+		auto create_surface = get_instance_proc_addr<PFN_vkCreateWaylandSurfaceKHR>(in_instance,
+			"vkCreateWaylandSurfaceKHR");
+		if(!create_surface)
+			break;
+
+		VkWaylandSurfaceCreateInfoKHR create_info = {};
+		create_info.sType = VK_STRUCTURE_TYPE_WAYLAND_SURFACE_CREATE_INFO_KHR;
+		create_info.pNext = nullptr;
+		create_info.flags = 0;
+		create_info.display = static_cast<wl_display*>(in_window.display);
+		create_info.surface = static_cast<wl_surface*>(in_window.window);
+		result = create_surface(in_instance, &create_info, nullptr, &handle);
+		break;
+	}
+#endif
+	default:
+		break;
+	}
+
+	if(result != VK_SUCCESS)
+		return make_error(result);
+
+	return make_result(handle);
+}
+
+}
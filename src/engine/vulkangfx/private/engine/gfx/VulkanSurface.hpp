@@ -0,0 +1,19 @@
+#pragma once
+
+#include "engine/Core.hpp"
+#include "engine/Result.hpp"
+#include "engine/gfx/SwapChain.hpp"
+#include <vulkan/vulkan.h>
+
+namespace cb::gfx
+{
+
+/**
+ * Create a surface for in_window
+ * Platform entry points are loaded from the instance, so a windowing system whose extension isn't enabled
+ * fails with VK_ERROR_EXTENSION_NOT_PRESENT instead of crashing
+ */
+[[nodiscard]] cb::Result<VkSurfaceKHR, VkResult> create_vulkan_surface(VkInstance in_instance,
+	const NativeWindowHandle& in_window);
+
+}
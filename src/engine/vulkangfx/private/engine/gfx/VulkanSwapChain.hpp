@@ -12,7 +12,8 @@ class VulkanSwapChain final
 {
 public:
 	VulkanSwapChain(VulkanDevice& in_device,
-		const vkb::Swapchain& in_swapchain);
+		const vkb::Swapchain& in_swapchain,
+		const VkPresentModeKHR in_present_mode);
 	~VulkanSwapChain();
 
 	[[nodiscard]] VkResult acquire_image(VkSemaphore in_signal_semaphore);
@@ -22,12 +23,14 @@ public:
 	[[nodiscard]] const std::vector<BackendDeviceResource>& get_textures() const { return images; }
 	[[nodiscard]] const std::vector<BackendDeviceResource>& get_texture_views() const { return image_views; }
 	[[nodiscard]] Format get_format() const { return convert_vk_format(swapchain.image_format); }
+	[[nodiscard]] PresentMode get_present_mode() const { return convert_vk_present_mode(present_mode); }
 	[[nodiscard]] uint32_t get_current_image_idx() const { return current_image; }
 	[[nodiscard]] const vkb::Swapchain& get_swapchain() const { return swapchain; }
 private:
 	VulkanDevice& device;
 	vkb::Swapchain swapchain;
 	VkSurfaceKHR surface;
+	VkPresentModeKHR present_mode;
 	uint32_t current_image;
 	std::vector<BackendDeviceResource> images;
 	std::vector<BackendDeviceResource> image_views;
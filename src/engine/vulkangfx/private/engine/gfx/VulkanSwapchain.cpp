@@ -7,7 +7,9 @@ namespace cb::gfx
 {
 
 VulkanSwapChain::VulkanSwapChain(VulkanDevice& in_device,
-	const vkb::Swapchain& in_swapchain) : device(in_device), swapchain(in_swapchain), current_image(0)
+	const vkb::Swapchain& in_swapchain,
+	const VkPresentModeKHR in_present_mode) : device(in_device), swapchain(in_swapchain), present_mode(in_present_mode),
+	current_image(0)
 {
 	auto image_list = swapchain.get_images();
 	auto image_view_list = swapchain.get_image_views();
@@ -25,10 +25,16 @@ public:
 	[[nodiscard]] const std::string& get_error() const { return error; }
 	[[nodiscard]] VkInstance get_instance() const { return instance.instance; }
 	[[nodiscard]] bool has_debug_layers() const { return debug_layers_enabled; }
+private:
+	[[nodiscard]] bool is_bindless_supported(VkPhysicalDevice in_physical_device) const;
+	[[nodiscard]] bool is_dynamic_rendering_supported(VkPhysicalDevice in_physical_device) const;
+	[[nodiscard]] bool is_graphics_pipeline_library_supported(VkPhysicalDevice in_physical_device) const;
 private:
 	vkb::Instance instance;
 	std::string error;
 	bool debug_layers_enabled;
+	bool bindless_requested;
+	bool offscreen;
 public:
 	PFN_vkSetDebugUtilsObjectNameEXT vkSetDebugUtilsObjectNameEXT;
 };
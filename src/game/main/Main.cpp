@@ -6,6 +6,22 @@
 #include "engine/logger/Logger.hpp"
 #include <fstream>
 #include "engine/logger/sinks/StdoutSink.hpp"
+#include "engine/assets/TextureFile.hpp"
+#include "engine/assets/MeshFile.hpp"
+#include "engine/mesh/MeshOptimizer.hpp"
+#include "engine/mesh/VertexQuantization.hpp"
+#include "engine/renderer/InstancedRenderer.hpp"
+#include "engine/renderer/RenderQueue.hpp"
+#include "engine/renderer/FrameCapture.hpp"
+#include "engine/shadercompiler/ShaderCompiler.hpp"
+#include "engine/shadercompiler/ShaderReloader.hpp"
+#include "engine/shadercompiler/PipelineLayoutCache.hpp"
+#include "engine/util/FrameLimiter.hpp"
+#include <filesystem>
+#include <chrono>
+#include <bit>
+#include <thread>
+#include <optional>
 #if CB_PLATFORM(WINDOWS)
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
@@ -15,9 +31,6 @@
 #include <stb_image.h>
 #define TINYOBJLOADER_IMPLEMENTATION
 #include "tinyobjloader.h"
-#include <Windows.h>
-#include <Unknwn.h>
-#include <dxcapi.h>
 #include <engine/imgui/ImGui.hpp>
 #include <backends/imgui_impl_glfw.h>
 
@@ -35,44 +48,16 @@ std::vector<char> read_binary_file(const std::string& in_name)
 	return buffer;
 }
 
-std::vector<char> read_text_file(const std::string& in_name)
-{
-	std::ifstream file(in_name, std::ios::ate | std::ios::binary);
-
-	const size_t file_size = file.tellg();
-	
-	std::vector<char> buffer(file_size);
-	file.seekg(0);
-	file.read(buffer.data(), file_size);
-	file.close();
-
-	return buffer;
-}
-
-
 #include <glm/glm.hpp>
 
 using namespace cb::gfx;
+
+/** Vertex of uncooked meshes, its attributes are reflected from the vertex shader inputs which it must follow */
 struct Vertex
 {
 	glm::vec3 position;
 	glm::vec2 texcoord;
 	glm::vec3 normal;
-
-	static VertexInputBindingDescription get_binding_description()
-	{
-		return VertexInputBindingDescription(0, sizeof(Vertex), VertexInputRate::Vertex);		
-	}
-
-	static std::vector<VertexInputAttributeDescription> get_attribute_descriptions()
-	{
-		return
-		{
-			VertexInputAttributeDescription(0, 0, Format::R32G32B32Sfloat, offsetof(Vertex, position)),
-			VertexInputAttributeDescription(1, 0, Format::R32G32Sfloat, offsetof(Vertex, texcoord)),
-			VertexInputAttributeDescription(2, 0, Format::R32G32B32Sfloat, offsetof(Vertex, normal)),
-		};
-	}
 };
 
 struct UBO
@@ -82,138 +67,202 @@ struct UBO
 	glm::mat4 proj;
 };
 
-std::vector<uint8_t> compile_shader(bool in_vs, std::span<uint8_t> in_source)
+/** Push constants of bindless_preview_fs.hlsl */
+struct BindlessIndices
 {
-	cb::logger::info("Compiling shader");
+	uint32_t texture_view_index;
+	uint32_t sampler_index;
+};
+
+/**
+ * Load a texture cooked by cb-texcook (same name, .cbtex extension) if present,
+ * otherwise decode the source image and generate the mip chain on the GPU
+ * Cooked textures are memory-mapped and uploaded straight from the mapping
+ */
+UniqueTexture load_texture(Device& in_device, const std::string& in_path)
+{
+	using namespace cb;
 
-	std::vector<LPCWSTR> args =
+	const auto start_time = std::chrono::high_resolution_clock::now();
+	const auto get_elapsed_ms = [&]()
 	{
-		L"-E main", L" ",
-		L"-Qstrip_debug", L" ",
-		L"-Qstrip_reflect", L" ",
-		L"-spirv", L" ",
-		L"-WX", L" ",
-		L"-Zpr", L" ",
+		return std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start_time).count();
 	};
 
-	if(in_vs)
-		args.emplace_back(L"-T vs_6_0");
-	else
-		args.emplace_back(L"-T ps_6_0");
-
-	IDxcCompiler3* compiler = nullptr;
-	DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(&compiler));
-
-	IDxcUtils* utils = nullptr;
-	DxcCreateInstance(CLSID_DxcUtils, IID_PPV_ARGS(&utils));
-
-	IDxcBlobEncoding* blob = nullptr;
-	DxcBuffer buffer { in_source.data(), in_source.size(), DXC_CP_UTF8 };
-	IDxcResult* result = nullptr;
-	HRESULT hr = compiler->Compile(&buffer, args.data(), args.size(), nullptr, IID_PPV_ARGS(&result));
-	
-	std::vector<uint8_t> ret;
-
-	IDxcBlobUtf8* errors;
-	result->GetOutput(DXC_OUT_ERRORS, IID_PPV_ARGS(&errors), nullptr);
-	if(errors && errors->GetStringLength() > 0)
-		cb::logger::fatal("Shader compiling error: {}", errors->GetStringPointer());
-
-	IDxcBlob* bytecode;
-	result->GetOutput(DXC_OUT_OBJECT, IID_PPV_ARGS(&bytecode), nullptr);
-	if(bytecode)
-		ret = { (uint8_t*) bytecode->GetBufferPointer(),
-		(uint8_t*) bytecode->GetBufferPointer() + bytecode->GetBufferSize() };
-
-	result->Release();
-	utils->Release();
+	const std::string cooked_path = std::filesystem::path(in_path).replace_extension(".cbtex").string();
+	if(auto file = assets::load_texture_file(cooked_path))
+	{
+		auto& texture_file = file.get_value();
+		auto texture = in_device.create_texture(TextureInfo::make_immutable_2d(texture_file.header.width,
+			texture_file.header.height,
+			texture_file.header.format,
+			texture_file.header.mip_levels,
+			TextureUsageFlags(TextureUsageFlagBits::Sampled),
+			texture_file.data).set_initial_data_mips(texture_file.mips).set_debug_name(cooked_path));
+		if(texture)
+		{
+			logger::info("Loaded {} in {:.2f} ms", cooked_path, get_elapsed_ms());
+			return UniqueTexture(texture.get_value());
+		}
 
-	if(blob)
-		blob->Release();
-	compiler->Release();
+		logger::warn("Cannot create {} ({}), falling back to {}", cooked_path, texture.get_error(), in_path);
+	}
+	else
+	{
+		logger::verbose("Cannot load {} ({}), falling back to {}", cooked_path, std::to_string(file.get_error()), in_path);
+	}
 
-	return ret;
+	int width, height, channels;
+	stbi_uc* pixels = stbi_load(in_path.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+	UniqueTexture texture(in_device.create_texture(TextureInfo::make_immutable_2d_mipmapped(width,
+		height,
+		Format::R8G8B8A8Unorm,
+		TextureUsageFlags(TextureUsageFlagBits::Sampled),
+		{ pixels, pixels + (width * height * 4) }).set_debug_name(in_path)).get_value());
+	stbi_image_free(pixels);
+	logger::info("Loaded {} in {:.2f} ms", in_path, get_elapsed_ms());
+	return texture;
 }
 
-int main()
+struct Mesh
 {
-	using namespace cb;
-
-	logger::set_pattern("[{time}] [{severity}] ({category}) {message}");
-	logger::add_sink(std::make_unique<logger::StdoutSink>());
+	UniqueBuffer vertex_buffer;
+	UniqueBuffer index_buffer;
+	uint32_t index_count = 0;
+	IndexType index_type = IndexType::Uint32;
+	uint32_t stride = sizeof(Vertex);
+	std::vector<VertexInputAttributeDescription> attributes;
+
+	/** Maps quantized positions back to object space, folded into the world matrix */
+	glm::mat4 dequantization = glm::mat4(1.f);
+};
 
-	glfwInit();
-	
-	Window win(1280, 
-		720, 
-		WindowFlags(WindowFlagBits::Centered));
+/**
+ * Cooked meshes may use compact vertex formats (cb-meshcook --quantize), check the device can fetch them
+ * and that they feed every vertex shader input
+ * Octahedral normals are rejected as the shader doesn't decode them
+ */
+bool is_mesh_layout_supported(Device& in_device, 
+	const cb::assets::MeshFile& in_mesh_file,
+	const std::span<const VertexInputAttributeDescription>& in_vertex_inputs)
+{
+	if(in_mesh_file.streams.size() != 1)
+		return false;
 
-#if CB_BUILD(DEBUG)
-	auto result = create_vulkan_backend(gfx::BackendFlags(gfx::BackendFlagBits::DebugLayers));
-#else
-	auto result = create_vulkan_backend(gfx::BackendFlags());
-#endif
-	if(!result)
+	for(const auto& input : in_vertex_inputs)
 	{
-		logger::fatal("Failed to create backend: {}", result.get_error());
-		return -1;
+		if(std::ranges::none_of(in_mesh_file.attributes, [&](const auto& in_attribute)
+		{
+			return in_attribute.location == input.location;
+		}))
+		{
+			logger::warn("The mesh has no attribute for vertex input location {}", input.location);
+			return false;
+		}
 	}
 
-	auto backend_device = result.get_value()->create_device(gfx::ShaderModel::SM6_0);
-	if(!backend_device)
+	for(const auto& attribute : in_mesh_file.attributes)
 	{
-		logger::fatal("Failed to create device: {}", backend_device.get_error());
-		return -1;
-	}
-	
-	auto device = std::make_unique<gfx::Device>(*result.get_value().get(), std::move(backend_device.get_value()));
+		if(!in_device.get_backend_device()->supports_vertex_format(attribute.format))
+		{
+			logger::warn("Vertex format {} is not supported by the device", to_string(attribute.format));
+			return false;
+		}
 
-	using namespace gfx;
-	
-	UniqueSwapchain swapchain(device->create_swapchain(gfx::SwapChainCreateInfo(
-		win.get_native_handle(),
-		win.get_width(),
-		win.get_height())).get_value());
+		if(attribute.location == 2 && attribute.format == Format::R16G16Snorm)
+		{
+			logger::warn("Octahedral normals are not supported by the shader");
+			return false;
+		}
+	}
 
-	auto vert_src = read_text_file("vert.hlsl");
-	auto frag_src = read_text_file("frag.hlsl");
-	auto vert_spv = compile_shader(true, { (uint8_t*) vert_src.data(), (uint8_t*) vert_src.data() + vert_src.size() });
-	auto frag_spv = compile_shader(false, { (uint8_t*) frag_src.data(), (uint8_t*) frag_src.data() + frag_src.size() });
+	return true;
+}
 
-	UniqueShader vert_shader(device->create_shader(ShaderCreateInfo(
-		{ (uint32_t*) vert_spv.data(), vert_spv.size() })).get_value());
-	UniqueShader frag_shader(device->create_shader(ShaderCreateInfo(
-		{ (uint32_t*) frag_spv.data(), frag_spv.size() })).get_value());
+Mesh create_mesh(Device& in_device, 
+	const std::string& in_name,
+	const std::span<const uint8_t>& in_vertices, 
+	const std::span<const uint8_t>& in_indices, 
+	const IndexType in_index_type)
+{
+	Mesh mesh;
+	mesh.vertex_buffer = UniqueBuffer(in_device.create_buffer(BufferInfo(BufferCreateInfo(
+		in_vertices.size(),
+		MemoryUsage::GpuOnly,
+		BufferUsageFlags(BufferUsageFlagBits::VertexBuffer)), 
+		in_vertices).set_debug_name(in_name + " Vertex Buffer")).get_value());
+	mesh.index_buffer = UniqueBuffer(in_device.create_buffer(BufferInfo(BufferCreateInfo(
+		in_indices.size(),
+		MemoryUsage::GpuOnly,
+		BufferUsageFlags(BufferUsageFlagBits::IndexBuffer)), 
+		in_indices).set_debug_name(in_name + " Index Buffer")).get_value());
+	mesh.index_type = in_index_type;
+	mesh.index_count = static_cast<uint32_t>(in_indices.size() / 
+		(in_index_type == IndexType::Uint16 ? sizeof(uint16_t) : sizeof(uint32_t)));
+	return mesh;
+}
 
-	UniqueSemaphore image_available_semaphore(device->create_semaphore(SemaphoreInfo()).get_value()); 
-	UniqueSemaphore render_finished_semaphore(device->create_semaphore(SemaphoreInfo()).get_value()); 
-	std::array render_wait_semaphores = { image_available_semaphore.get() };
-	std::array present_wait_semaphores = { render_finished_semaphore.get() };
-	std::array render_finished_semaphores = { render_finished_semaphore.get() };
+/**
+ * Load a mesh cooked by cb-meshcook (same name, .cbmesh extension) if present, otherwise parse the OBJ file
+ * Cooked meshes are memory-mapped and uploaded straight from the mapping
+ */
+Mesh load_mesh(Device& in_device, 
+	const std::string& in_path, 
+	const std::span<const VertexInputAttributeDescription>& in_vertex_attributes)
+{
+	using namespace cb;
 
-	std::array<DescriptorSetLayoutCreateInfo, 1> layouts;
-	std::vector<DescriptorSetLayoutBinding> bindings =
+	const auto start_time = std::chrono::high_resolution_clock::now();
+	const auto get_elapsed_ms = [&]()
 	{
-		DescriptorSetLayoutBinding(0, DescriptorType::UniformBuffer, 1, ShaderStageFlags(ShaderStageFlagBits::Vertex)),
-		DescriptorSetLayoutBinding(1, DescriptorType::Sampler, 1, ShaderStageFlags(ShaderStageFlagBits::Fragment)),
-		DescriptorSetLayoutBinding(2, DescriptorType::SampledTexture, 1, ShaderStageFlags(ShaderStageFlagBits::Fragment)),
-		DescriptorSetLayoutBinding(3, DescriptorType::SampledTexture, 1, ShaderStageFlags(ShaderStageFlagBits::Fragment)),
+		return std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start_time).count();
 	};
 
-	layouts[0].bindings = bindings;
-	UniquePipelineLayout pipeline_layout(device->create_pipeline_layout(PipelineLayoutCreateInfo(layouts)).get_value());
+	const std::string cooked_path = std::filesystem::path(in_path).replace_extension(".cbmesh").string();
+	if(auto file = assets::load_mesh_file(cooked_path))
+	{
+		const auto& mesh_file = file.get_value();
+		if(is_mesh_layout_supported(in_device, mesh_file, in_vertex_attributes))
+		{
+			Mesh mesh = create_mesh(in_device, 
+				cooked_path, 
+				mesh_file.get_stream_data(0), 
+				mesh_file.indices, 
+				mesh_file.header.index_type);
+			mesh.stride = mesh_file.streams[0].stride;
+			mesh.attributes.assign(mesh_file.attributes.begin(), mesh_file.attributes.end());
+			for(const auto& attribute : mesh.attributes)
+			{
+				if(attribute.location == 0 && attribute.format == Format::R16G16B16A16Snorm)
+				{
+					const cb::mesh::PositionQuantization quantization = cb::mesh::compute_position_quantization(
+						mesh_file.header.bounds_min, 
+						mesh_file.header.bounds_max);
+					mesh.dequantization = glm::translate(glm::mat4(1.f), 
+						glm::vec3(quantization.offset[0], quantization.offset[1], quantization.offset[2])) 
+						* glm::scale(glm::mat4(1.f), glm::vec3(quantization.scale));
+				}
+			}
+			logger::info("Loaded {} in {:.2f} ms", cooked_path, get_elapsed_ms());
+			return mesh;
+		}
 
-	/** Buffer */
+		logger::warn("{} has an unsupported vertex layout, falling back to {}", cooked_path, in_path);
+	}
+	else
+	{
+		logger::verbose("Cannot load {} ({}), falling back to {}", cooked_path, std::to_string(file.get_error()), in_path);
+	}
 
 	tinyobj::attrib_t attrib;
 	std::vector<tinyobj::shape_t> shapes;
 	std::vector<tinyobj::material_t> materials;
 	std::string warn, err;
 
-	tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, "cube.obj");
+	tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, in_path.c_str());
 
+	/** One vertex per corner, welded and reordered by mesh::optimize_mesh */
 	std::vector<Vertex> vertices;
-	std::vector<uint32_t> indices;
 
 	for (const auto& shape : shapes) 
 	{
@@ -239,130 +288,584 @@ int main()
 
 
 		    vertices.push_back(vertex);
-			indices.push_back(indices.size());
 		}
 	}
 
-	tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, "sky.obj");
+	const mesh::OptimizedMesh optimized_mesh = mesh::optimize_mesh(
+		{ reinterpret_cast<const uint8_t*>(vertices.data()), vertices.size() * sizeof(Vertex) },
+		sizeof(Vertex));
+	const IndexType index_type = mesh::select_index_type(optimized_mesh.vertex_count);
+
+	Mesh mesh = create_mesh(in_device,
+		in_path,
+		optimized_mesh.vertices,
+		mesh::encode_indices(optimized_mesh.indices, index_type),
+		index_type);
+	mesh.attributes.assign(in_vertex_attributes.begin(), in_vertex_attributes.end());
+	logger::info("Loaded {} in {:.2f} ms", in_path, get_elapsed_ms());
+	return mesh;
+}
+
+/**
+ * Cubes benchmark: --instances <count> cubes drawn with the InstancedRenderer, or with one UBO and one draw
+ * per cube when --per-object is set (both can also be changed from the UI)
+ * --no-dynamic-rendering begins passes with render pass/framebuffer objects, to compare the per-pass CPU cost
+ * --deferred renders a G-buffer subpass then a lighting subpass reading it through input attachments
+ * --bindless enables the bindless resource model and previews the base color texture through it in a corner
+ * --present-mode <fifo|fifo-relaxed|mailbox|immediate> and --fps-limit <fps> control frame pacing
+ * --frames-in-flight <1-4> sets how many frames are queued, --low-latency waits for the GPU before each frame
+ * --headless renders without window on VK_EXT_headless_surface, --frames <count> exits after count frames
+ * --offscreen renders to an offscreen target (RGBA16F with --hdr) without any window or surface, the camera follows
+ * --camera-path <file> (or a built-in flyover) at a fixed --timestep <seconds> so runs are reproducible
+ * --timings <file.csv> writes per-frame timings, --capture-every <N> writes every Nth offscreen frame to --capture-dir
+ */
+struct BenchmarkOptions
+{
+	int instance_count = 1;
+	bool instanced = true;
+	bool dynamic_rendering = true;
 
-	std::vector<Vertex> sky_vertices;
-	std::vector<uint32_t> sky_indices;
+	/** Requested MSAA sample count, lowered to what the device supports. 1 renders straight to the backbuffer */
+	int msaa_samples = 4;
 
-	for (const auto& shape : shapes) 
+	/** Can't be changed at runtime, render targets depend on it */
+	bool deferred = false;
+
+	/** Ignored if the GPU doesn't support descriptor indexing */
+	bool bindless = false;
+
+	PresentMode present_mode = PresentMode::Fifo;
+
+	/** 0 for no limit */
+	float fps_limit = 0.f;
+
+	/** Can't be changed at runtime, per-frame resources are sized from it */
+	uint32_t frames_in_flight = Device::default_frames_in_flight;
+	bool low_latency = false;
+
+	/** No window nor input, for machines without display */
+	bool headless = false;
+
+	/** 0 runs until the window is closed, headless and offscreen runs default to 1000 frames */
+	uint32_t frame_count = 0;
+
+	/** No swapchain, works with any ICD including software ones. Implies no window */
+	bool offscreen = false;
+
+	/** Offscreen target in RGBA16F, captured as EXR instead of PNG */
+	bool hdr = false;
+
+	/** Simulation step of offscreen runs, in seconds, whatever the frame took */
+	float fixed_timestep = 1.f / 60.f;
+
+	/** Offscreen camera keyframes, the built-in flyover is used if empty */
+	std::string camera_path;
+
+	/** Per-frame timings CSV, disabled if empty */
+	std::string timings_path;
+
+	/** 0 disables captures */
+	uint32_t capture_interval = 0;
+	std::string capture_directory = "captures";
+};
+
+struct CameraKeyframe
+{
+	float time;
+	glm::vec3 position;
+	float yaw;
+	float pitch;
+};
+
+/**
+ * Camera positions and angles linearly interpolated between keyframes, looping over the last keyframe time
+ */
+class CameraPath
+{
+public:
+	explicit CameraPath(std::vector<CameraKeyframe>&& in_keyframes) : keyframes(std::move(in_keyframes)) {}
+
+	/** Flyover of the cubes grid */
+	static CameraPath make_default()
 	{
-		for (const auto& index : shape.mesh.indices) 
+		return CameraPath({
+			{ 0.f, glm::vec3(2.f, 2.f, 3.f), 225.f, -30.f },
+			{ 5.f, glm::vec3(-10.f, 2.f, 4.f), 270.f, -35.f },
+			{ 10.f, glm::vec3(-10.f, -10.f, 6.f), 405.f, -40.f },
+			{ 15.f, glm::vec3(2.f, 2.f, 3.f), 585.f, -30.f },
+		});
+	}
+
+	/** One "time x y z yaw pitch" keyframe per line, sorted by time. Angles are in degrees */
+	static cb::Result<CameraPath, std::string> load(const std::string& in_path)
+	{
+		std::ifstream file(in_path);
+		if(!file)
+			return cb::make_error("Cannot open " + in_path);
+
+		std::vector<CameraKeyframe> keyframes;
+		CameraKeyframe keyframe;
+		while(file >> keyframe.time >> keyframe.position.x >> keyframe.position.y >> keyframe.position.z 
+			>> keyframe.yaw >> keyframe.pitch)
 		{
-			Vertex vertex;
-			vertex.position = {
-			    attrib.vertices[3 * index.vertex_index + 0],
-			    attrib.vertices[3 * index.vertex_index + 1],
-			    attrib.vertices[3 * index.vertex_index + 2]
-			};
+			if(!keyframes.empty() && keyframe.time <= keyframes.back().time)
+				return cb::make_error(fmt::format("{}: keyframe times must increase", in_path));
 
-			vertex.texcoord = {
-			    attrib.texcoords[2 * index.texcoord_index + 0],
-			    1.f - attrib.texcoords[2 * index.texcoord_index + 1]
-			};
+			keyframes.emplace_back(keyframe);
+		}
 
-			vertex.normal = {
-			    attrib.normals[3 * index.normal_index + 0],
-			    attrib.normals[3 * index.normal_index + 1],
-			    attrib.normals[3 * index.normal_index + 2]
-			};
+		if(keyframes.empty())
+			return cb::make_error(fmt::format("{}: no keyframe", in_path));
 
+		return cb::make_result(CameraPath(std::move(keyframes)));
+	}
+
+	[[nodiscard]] CameraKeyframe sample(float in_time) const
+	{
+		if(keyframes.size() == 1 || keyframes.back().time <= 0.f)
+			return keyframes.front();
+
+		in_time = std::fmod(in_time, keyframes.back().time);
+		auto next = std::ranges::upper_bound(keyframes, in_time, {}, &CameraKeyframe::time);
+		if(next == keyframes.begin())
+			return keyframes.front();
+		if(next == keyframes.end())
+			return keyframes.back();
+
+		const CameraKeyframe& previous = *(next - 1);
+		const float t = (in_time - previous.time) / (next->time - previous.time);
+		return { in_time, 
+			glm::mix(previous.position, next->position, t), 
+			glm::mix(previous.yaw, next->yaw, t), 
+			glm::mix(previous.pitch, next->pitch, t) };
+	}
+private:
+	std::vector<CameraKeyframe> keyframes;
+};
+
+std::optional<PresentMode> parse_present_mode(const std::string_view& in_name)
+{
+	if(in_name == "fifo")
+		return PresentMode::Fifo;
+	if(in_name == "fifo-relaxed")
+		return PresentMode::FifoRelaxed;
+	if(in_name == "mailbox")
+		return PresentMode::Mailbox;
+	if(in_name == "immediate")
+		return PresentMode::Immediate;
+
+	return std::nullopt;
+}
 
-		    sky_vertices.push_back(vertex);
-			sky_indices.push_back(sky_indices.size());
+BenchmarkOptions parse_benchmark_options(int argc, char** argv)
+{
+	BenchmarkOptions options;
+	for(int i = 1; i < argc; ++i)
+	{
+		const std::string_view arg = argv[i];
+		if(arg == "--instances" && i + 1 < argc)
+			options.instance_count = std::max(std::atoi(argv[++i]), 0);
+		else if(arg == "--per-object")
+			options.instanced = false;
+		else if(arg == "--no-dynamic-rendering")
+			options.dynamic_rendering = false;
+		else if(arg == "--msaa" && i + 1 < argc)
+			options.msaa_samples = std::max(std::atoi(argv[++i]), 1);
+		else if(arg == "--deferred")
+			options.deferred = true;
+		else if(arg == "--bindless")
+			options.bindless = true;
+		else if(arg == "--present-mode" && i + 1 < argc)
+		{
+			if(auto present_mode = parse_present_mode(argv[++i]))
+				options.present_mode = present_mode.value();
+			else
+				logger::warn("Unknown present mode {}, using fifo", argv[i]);
 		}
+		else if(arg == "--fps-limit" && i + 1 < argc)
+			options.fps_limit = std::max(static_cast<float>(std::atof(argv[++i])), 0.f);
+		else if(arg == "--frames-in-flight" && i + 1 < argc)
+			options.frames_in_flight = static_cast<uint32_t>(std::max(std::atoi(argv[++i]), 0));
+		else if(arg == "--low-latency")
+			options.low_latency = true;
+		else if(arg == "--headless")
+			options.headless = true;
+		else if(arg == "--frames" && i + 1 < argc)
+			options.frame_count = static_cast<uint32_t>(std::max(std::atoi(argv[++i]), 0));
+		else if(arg == "--offscreen")
+			options.offscreen = true;
+		else if(arg == "--hdr")
+			options.hdr = true;
+		else if(arg == "--timestep" && i + 1 < argc)
+			options.fixed_timestep = std::max(static_cast<float>(std::atof(argv[++i])), 0.f);
+		else if(arg == "--camera-path" && i + 1 < argc)
+			options.camera_path = argv[++i];
+		else if(arg == "--timings" && i + 1 < argc)
+			options.timings_path = argv[++i];
+		else if(arg == "--capture-every" && i + 1 < argc)
+			options.capture_interval = static_cast<uint32_t>(std::max(std::atoi(argv[++i]), 0));
+		else if(arg == "--capture-dir" && i + 1 < argc)
+			options.capture_directory = argv[++i];
 	}
 
-	UniqueBuffer vertex_buffer(device->create_buffer(BufferInfo(BufferCreateInfo(
-		sizeof(Vertex) * vertices.size(),
-		MemoryUsage::GpuOnly,
-		BufferUsageFlags(BufferUsageFlagBits::VertexBuffer)), 
-		{ (uint8_t*) vertices.data(), vertices.size() * sizeof(Vertex) })).get_value());
+	if((options.headless || options.offscreen) && options.frame_count == 0)
+		options.frame_count = 1000;
 
-	UniqueBuffer index_buffer(device->create_buffer(BufferInfo(BufferCreateInfo(
-		sizeof(uint32_t) * indices.size(),
-		MemoryUsage::GpuOnly,
-		BufferUsageFlags(BufferUsageFlagBits::IndexBuffer)), 
-		{ (uint8_t*) indices.data(), indices.size() * sizeof(uint32_t) })).get_value());
+	if(options.capture_interval != 0 && !options.offscreen)
+	{
+		logger::warn("Captures require --offscreen, ignoring --capture-every");
+		options.capture_interval = 0;
+	}
 
-	UniqueBuffer sky_vertex_buffer(device->create_buffer(BufferInfo(BufferCreateInfo(
-		sizeof(Vertex) * sky_vertices.size(),
-		MemoryUsage::GpuOnly,
-		BufferUsageFlags(BufferUsageFlagBits::VertexBuffer)), 
-		{ (uint8_t*) sky_vertices.data(), sky_vertices.size() * sizeof(Vertex) })).get_value());
+	return options;
+}
 
-	UniqueBuffer sky_index_buffer(device->create_buffer(BufferInfo(BufferCreateInfo(
-		sizeof(uint32_t) * sky_indices.size(),
-		MemoryUsage::GpuOnly,
-		BufferUsageFlags(BufferUsageFlagBits::IndexBuffer)), 
-		{ (uint8_t*) sky_indices.data(), sky_indices.size() * sizeof(uint32_t) })).get_value());
+/**
+ * Highest sample count usable by the main pass attachments that doesn't exceed in_samples
+ */
+SampleCountFlagBits select_sample_count(Device& in_device, const int in_samples)
+{
+	const SampleCountFlags supported = in_device.get_backend_device()->get_supported_attachment_sample_counts();
+	uint32_t samples = std::bit_floor(static_cast<uint32_t>(std::clamp(in_samples, 1, 64)));
+	while(samples > 1 && !(supported & static_cast<SampleCountFlagBits>(samples)))
+		samples >>= 1;
+
+	return static_cast<SampleCountFlagBits>(samples);
+}
 
-	size_t index_count = indices.size();
-	vertices.clear();
-	indices.clear();
+int main(int argc, char** argv)
+{
+	using namespace cb;
 
-	UniqueSampler sampler(device->create_sampler(SamplerCreateInfo()).get_value());
+	logger::set_pattern("[{time}] [{severity}] ({category}) {message}");
+	logger::add_sink(std::make_unique<logger::StdoutSink>());
 
+	BenchmarkOptions benchmark = parse_benchmark_options(argc, argv);
+
+	const bool windowless = benchmark.headless || benchmark.offscreen;
+	if(!windowless)
+		glfwInit();
 	
-	UniqueTexture texture;
+	Window win(1280, 
+		720, 
+		WindowFlags(windowless ? WindowFlagBits::Headless : WindowFlagBits::Centered));
+
+	gfx::BackendFlags backend_flags;
+#if CB_BUILD(DEBUG)
+	backend_flags |= gfx::BackendFlagBits::DebugLayers;
+#endif
+	if(benchmark.offscreen)
+		backend_flags |= gfx::BackendFlagBits::Offscreen;
+	else if(benchmark.headless)
+		backend_flags |= gfx::BackendFlagBits::Headless;
+	if(benchmark.bindless)
+		backend_flags |= gfx::BackendFlagBits::Bindless;
+	auto result = create_vulkan_backend(backend_flags);
+	if(!result)
 	{
-		int width, height, channels;
-		stbi_uc* pixels = stbi_load("Basecolor_carrelage_mur_zino.png", &width, &height, &channels, STBI_rgb_alpha);
-		texture = UniqueTexture(device->create_texture(TextureInfo::make_immutable_2d(width,
-			height,
-			Format::R8G8B8A8Unorm,
-			1,
-			TextureUsageFlags(TextureUsageFlagBits::Sampled),
-			{ pixels, pixels + (width * height * 4) })).get_value());
-		stbi_image_free(pixels);
+		logger::fatal("Failed to create backend: {}", result.get_error());
+		return -1;
 	}
-	UniqueTextureView texture_view(device->create_texture_view(TextureViewInfo::make_2d(texture.get(),
-		Format::R8G8B8A8Unorm).set_debug_name("basecolor")).get_value());
 
-	UniqueTexture normal_map;
+	auto backend_device = result.get_value()->create_device(gfx::ShaderModel::SM6_0);
+	if(!backend_device)
 	{
-		int width, height, channels;
-		stbi_uc* pixels = stbi_load("Normal_carrelage_mur_zino.png", &width, &height, &channels, STBI_rgb_alpha);
-		normal_map = UniqueTexture(device->create_texture(TextureInfo::make_immutable_2d(width,
-			height,
-			Format::R8G8B8A8Unorm,
-			1,
-			TextureUsageFlags(TextureUsageFlagBits::Sampled),
-			{ pixels, pixels + (width * height * 4) })).get_value());
-		stbi_image_free(pixels);
+		logger::fatal("Failed to create device: {}", backend_device.get_error());
+		return -1;
 	}
+	
+	auto device = std::make_unique<gfx::Device>(*result.get_value().get(), 
+		std::move(backend_device.get_value()),
+		benchmark.frames_in_flight);
+	device->set_latency_mode(benchmark.low_latency ? LatencyMode::LowLatency : LatencyMode::Throughput);
 
-	UniqueTextureView normal_map_view(device->create_texture_view(TextureViewInfo::make_2d(normal_map.get(),
-		Format::R8G8B8A8Unorm).set_debug_name("Normal Map View")).get_value());
+	using namespace gfx;
+	
+	/** Offscreen runs have no swapchain, the main pass renders to offscreen_color_texture instead */
+	UniqueSwapchain swapchain;
+	if(!benchmark.offscreen)
+	{
+		swapchain = UniqueSwapchain(device->create_swapchain(gfx::SwapChainCreateInfo(
+			win.get_native_handle(),
+			win.get_width(),
+			win.get_height(),
+			{},
+			benchmark.present_mode)).get_value());
+		logger::info("Present mode: {}", std::to_string(device->get_swapchain_present_mode(swapchain.get())));
+	}
+	const Format offscreen_format = benchmark.hdr ? Format::R16G16B16A16Sfloat : Format::R8G8B8A8Unorm;
+
+	/** Compiled in parallel, or loaded from the shader cache when they didn't change since the last run */
+	shadercompiler::ShaderCompiler shader_compiler;
+	const std::array shader_infos = {
+		shadercompiler::ShaderCompileInfo("vert.hlsl", ShaderStageFlagBits::Vertex),
+		shadercompiler::ShaderCompileInfo("frag.hlsl", ShaderStageFlagBits::Fragment),
+		shadercompiler::ShaderCompileInfo("assets/shaders/instanced_vs.hlsl", ShaderStageFlagBits::Vertex),
+		shadercompiler::ShaderCompileInfo("assets/shaders/gbuffer_fs.hlsl", ShaderStageFlagBits::Fragment),
+		shadercompiler::ShaderCompileInfo("assets/shaders/deferred_lighting_vs.hlsl", ShaderStageFlagBits::Vertex),
+		shadercompiler::ShaderCompileInfo("assets/shaders/deferred_lighting_fs.hlsl", ShaderStageFlagBits::Fragment),
+		shadercompiler::ShaderCompileInfo("assets/shaders/bindless_preview_vs.hlsl", ShaderStageFlagBits::Vertex),
+		shadercompiler::ShaderCompileInfo("assets/shaders/bindless_preview_fs.hlsl", ShaderStageFlagBits::Fragment),
+	};
+	auto shader_results = shader_compiler.compile(shader_infos, std::max(std::thread::hardware_concurrency(), 1u));
+	bool shaders_compiled = true;
+	for(size_t i = 0; i < shader_results.size(); ++i)
+	{
+		if(!shader_results[i])
+		{
+			logger::fatal("Failed to compile {}: {}", shader_infos[i].path, shader_results[i].get_error());
+			shaders_compiled = false;
+		}
+	}
+
+	if(!shaders_compiled)
+		return -1;
+
+	auto& vert_spv = shader_results[0].get_value();
+	auto& frag_spv = shader_results[1].get_value();
+	auto& instanced_vert_spv = shader_results[2].get_value();
+	auto& gbuffer_frag_spv = shader_results[3].get_value();
+	auto& lighting_vert_spv = shader_results[4].get_value();
+	auto& lighting_frag_spv = shader_results[5].get_value();
+	auto& preview_vert_spv = shader_results[6].get_value();
+	auto& preview_frag_spv = shader_results[7].get_value();
+
+	UniqueShader vert_shader(device->create_shader(ShaderCreateInfo(
+		{ (uint32_t*) vert_spv.data(), vert_spv.size() })).get_value());
+	UniqueShader frag_shader(device->create_shader(ShaderCreateInfo(
+		{ (uint32_t*) frag_spv.data(), frag_spv.size() })).get_value());
+	UniqueShader instanced_vert_shader(device->create_shader(ShaderCreateInfo(
+		{ (uint32_t*) instanced_vert_spv.data(), instanced_vert_spv.size() })).get_value());
+	UniqueShader gbuffer_frag_shader(device->create_shader(ShaderCreateInfo(
+		{ (uint32_t*) gbuffer_frag_spv.data(), gbuffer_frag_spv.size() })).get_value());
+	UniqueShader lighting_vert_shader(device->create_shader(ShaderCreateInfo(
+		{ (uint32_t*) lighting_vert_spv.data(), lighting_vert_spv.size() })).get_value());
+	UniqueShader lighting_frag_shader(device->create_shader(ShaderCreateInfo(
+		{ (uint32_t*) lighting_frag_spv.data(), lighting_frag_spv.size() })).get_value());
+	UniqueShader preview_vert_shader(device->create_shader(ShaderCreateInfo(
+		{ (uint32_t*) preview_vert_spv.data(), preview_vert_spv.size() })).get_value());
+	UniqueShader preview_frag_shader(device->create_shader(ShaderCreateInfo(
+		{ (uint32_t*) preview_frag_spv.data(), preview_frag_spv.size() })).get_value());
+
+	UniqueSemaphore image_available_semaphore(device->create_semaphore(SemaphoreInfo()).get_value()); 
+	UniqueSemaphore render_finished_semaphore(device->create_semaphore(SemaphoreInfo()).get_value()); 
+	std::array render_wait_semaphores = { image_available_semaphore.get() };
+	std::array present_wait_semaphores = { render_finished_semaphore.get() };
+	std::array render_finished_semaphores = { render_finished_semaphore.get() };
 
-	UniqueTexture sky_texture;
+	/** Pipeline layouts are built from the resources the shaders use, identical layouts are shared */
+	std::vector<shadercompiler::ShaderReflection> shader_reflections;
+	shader_reflections.reserve(shader_results.size());
+	for(size_t i = 0; i < shader_results.size(); ++i)
 	{
-		int width, height, channels;
-		stbi_uc* pixels = stbi_load("parking_lot_2k.png", &width, &height, &channels, STBI_rgb_alpha);
-		sky_texture = UniqueTexture(device->create_texture(TextureInfo::make_immutable_2d(width,
-			height,
-			Format::R8G8B8A8Unorm,
-			1,
-			TextureUsageFlags(TextureUsageFlagBits::Sampled),
-			{ pixels, pixels + (width * height * 4) })).get_value());
-		stbi_image_free(pixels);
+		auto reflection = shadercompiler::ShaderReflection::reflect(shader_results[i].get_value());
+		if(!reflection)
+		{
+			logger::fatal("Failed to reflect {}: {}", shader_infos[i].path, reflection.get_error());
+			return -1;
+		}
+
+		shader_reflections.emplace_back(std::move(reflection.get_value()));
+	}
+
+	/** Saving a shader while running reloads it, only the pipelines using it are recreated */
+	shadercompiler::ShaderReloader shader_reloader(*device, shader_compiler, std::max(std::thread::hardware_concurrency(), 1u));
+	const std::array reloaded_shaders = { vert_shader.get(), frag_shader.get(), instanced_vert_shader.get(),
+		gbuffer_frag_shader.get(), lighting_vert_shader.get(), lighting_frag_shader.get(), preview_vert_shader.get(),
+		preview_frag_shader.get() };
+	for(size_t i = 0; i < reloaded_shaders.size(); ++i)
+		shader_reloader.add_shader(reloaded_shaders[i], shader_infos[i], shader_reflections[i]);
+
+	/** 
+	 * Uncooked meshes interleave the scene vertex shader inputs in declaration order, per-instance inputs 
+	 * come from the instance buffer
+	 */
+	uint32_t vertex_stride = 0;
+	auto vertex_attributes = shader_reflections[2].make_vertex_attributes(0, 
+		renderer::InstancedRenderer::instance_attribute_location, 
+		vertex_stride);
+	if(!vertex_attributes)
+	{
+		logger::fatal("Failed to get the vertex inputs of {}: {}", shader_infos[2].path, vertex_attributes.get_error());
+		return -1;
 	}
-	UniqueTextureView sky_texture_view(device->create_texture_view(TextureViewInfo::make_2d(sky_texture.get(),
-		Format::R8G8B8A8Unorm).set_debug_name("Sky Texture View")).get_value());
 
-	UniqueTexture depth_texture(device->create_texture(TextureInfo::make_depth_stencil_attachment(
-		win.get_width(), win.get_height(), Format::D24UnormS8Uint).set_debug_name("Depth Buffer Texture")).get_value());
+	if(vertex_stride != sizeof(Vertex))
+	{
+		logger::fatal("The vertex inputs of {} don't match the Vertex struct", shader_infos[2].path);
+		return -1;
+	}
 
-	UniqueTextureView depth_texture_view(device->create_texture_view(TextureViewInfo::make_depth(depth_texture.get(),
-		Format::D24UnormS8Uint).set_debug_name("Depth Buffer View")).get_value());
+	shadercompiler::PipelineLayoutCache pipeline_layout_cache(*device);
 
-	win.get_window_resized().bind([&](uint32_t width, uint32_t height)
+	/** The scene materials share one layout, the union of the resources of every scene shader */
+	const std::array<const shadercompiler::ShaderReflection*, 4> scene_reflections = { &shader_reflections[0],
+		&shader_reflections[1], &shader_reflections[2], &shader_reflections[3] };
+	auto pipeline_layout_result = pipeline_layout_cache.get_or_create(scene_reflections);
+	if(!pipeline_layout_result)
 	{
-		logger::verbose("Resizing swapchain and recreating resources...");
+		logger::fatal("Failed to create scene pipeline layout: {}", pipeline_layout_result.get_error());
+		return -1;
+	}
+	const PipelineLayoutHandle pipeline_layout = pipeline_layout_result.get_value();
+
+	/** Deferred lighting: G-buffer albedo and normal input attachments */
+	const std::array<const shadercompiler::ShaderReflection*, 2> lighting_reflections = { &shader_reflections[4],
+		&shader_reflections[5] };
+	auto lighting_pipeline_layout_result = pipeline_layout_cache.get_or_create(lighting_reflections);
+	if(!lighting_pipeline_layout_result)
+	{
+		logger::fatal("Failed to create lighting pipeline layout: {}", lighting_pipeline_layout_result.get_error());
+		return -1;
+	}
+	const PipelineLayoutHandle lighting_pipeline_layout = lighting_pipeline_layout_result.get_value();
+
+	std::array lighting_stages = {
+		MaterialShaderStage(gfx::ShaderStageFlagBits::Vertex, lighting_vert_shader.get(), "main"),
+		MaterialShaderStage(gfx::ShaderStageFlagBits::Fragment, lighting_frag_shader.get(), "main"),
+	};
+	PipelineMaterialState lighting_material_state;
+	lighting_material_state.stages = lighting_stages;
+
+	/** Bindless preview: no descriptor is bound, the shader indexes the global bindless set with push constants */
+	if(benchmark.bindless && !device->is_bindless_enabled())
+		logger::warn("Bindless isn't supported by this GPU, the preview is disabled");
+
+	PipelineLayoutHandle preview_pipeline_layout;
+	if(device->is_bindless_enabled())
+	{
+		const std::array<const shadercompiler::ShaderReflection*, 2> preview_reflections = { &shader_reflections[6],
+			&shader_reflections[7] };
+		auto preview_pipeline_layout_result = pipeline_layout_cache.get_or_create(preview_reflections);
+		if(!preview_pipeline_layout_result)
+		{
+			logger::fatal("Failed to create bindless preview pipeline layout: {}", preview_pipeline_layout_result.get_error());
+			return -1;
+		}
+		preview_pipeline_layout = preview_pipeline_layout_result.get_value();
+	}
+
+	std::array preview_stages = {
+		MaterialShaderStage(gfx::ShaderStageFlagBits::Vertex, preview_vert_shader.get(), "main"),
+		MaterialShaderStage(gfx::ShaderStageFlagBits::Fragment, preview_frag_shader.get(), "main"),
+	};
+	PipelineMaterialState preview_material_state;
+	preview_material_state.stages = preview_stages;
+
+	/** Buffer */
+	Mesh cube = load_mesh(*device, "cube.obj", vertex_attributes.get_value());
+	Mesh sky = load_mesh(*device, "sky.obj", vertex_attributes.get_value());
+
+	UniqueSampler sampler(device->create_sampler(SamplerCreateInfo()).get_value());
+
+	
+	UniqueTexture texture = load_texture(*device, "Basecolor_carrelage_mur_zino.png");
+	UniqueTextureView texture_view(device->create_texture_view(TextureViewInfo::make_2d(texture.get(),
+		Device::get_texture_create_info(texture.get()).format,
+		TextureSubresourceRange(TextureAspectFlags(TextureAspectFlagBits::Color),
+			0, Device::get_texture_create_info(texture.get()).mip_levels,
+			0, 1)).set_bindless(true).set_debug_name("basecolor")).get_value());
+
+	/** The shader samples RGB normals, "--usage normal" cooks BC7 for that reason */
+	UniqueTexture normal_map = load_texture(*device, "Normal_carrelage_mur_zino.png");
+	if(const Format normal_map_format = Device::get_texture_create_info(normal_map.get()).format;
+		normal_map_format == Format::Bc5UnormBlock || normal_map_format == Format::Bc5SnormBlock)
+		logger::warn("The normal map only stores XY but the shader reads XYZ, re-cook it with \"--usage normal\"");
+	UniqueTextureView normal_map_view(device->create_texture_view(TextureViewInfo::make_2d(normal_map.get(),
+		Device::get_texture_create_info(normal_map.get()).format,
+		TextureSubresourceRange(TextureAspectFlags(TextureAspectFlagBits::Color),
+			0, Device::get_texture_create_info(normal_map.get()).mip_levels,
+			0, 1)).set_debug_name("Normal Map View")).get_value());
+
+	UniqueTexture sky_texture = load_texture(*device, "parking_lot_2k.png");
+	UniqueTextureView sky_texture_view(device->create_texture_view(TextureViewInfo::make_2d(sky_texture.get(),
+		Device::get_texture_create_info(sky_texture.get()).format,
+		TextureSubresourceRange(TextureAspectFlags(TextureAspectFlagBits::Color),
+			0, Device::get_texture_create_info(sky_texture.get()).mip_levels,
+			0, 1)).set_debug_name("Sky Texture View")).get_value());
+
+	/** The lighting subpass reads one G-buffer sample per pixel, deferred rendering doesn't use MSAA */
+	const SampleCountFlagBits sample_count = select_sample_count(*device, benchmark.deferred ? 1 : benchmark.msaa_samples);
+	logger::info("Main pass: {}, MSAA {}x", benchmark.deferred ? "deferred" : "forward", static_cast<uint32_t>(sample_count));
+
+	/**
+	 * Depth and multisampled color never leave the main pass, they can live in lazily allocated memory
+	 * Multisampled color is resolved to the backbuffer at the end of the pass
+	 */
+	UniqueTexture depth_texture;
+	UniqueTextureView depth_texture_view;
+	UniqueTexture msaa_color_texture;
+	UniqueTextureView msaa_color_texture_view;
+
+	/** The G-buffer only lives during the main pass, tile-based GPUs keep it on chip */
+	UniqueTexture gbuffer_albedo_texture;
+	UniqueTextureView gbuffer_albedo_view;
+	UniqueTexture gbuffer_normal_texture;
+	UniqueTextureView gbuffer_normal_view;
+
+	UniqueTexture offscreen_color_texture;
+	UniqueTextureView offscreen_color_view;
+	const auto create_render_targets = [&](const uint32_t in_width, const uint32_t in_height)
+	{
+		depth_texture = UniqueTexture(device->create_texture(TextureInfo::make_transient_attachment(
+			in_width, in_height, Format::D24UnormS8Uint,
+			TextureUsageFlags(TextureUsageFlagBits::DepthStencilAttachment),
+			sample_count).set_debug_name("Depth Buffer Texture")).get_value());
+
+		depth_texture_view = UniqueTextureView(device->create_texture_view(TextureViewInfo::make_depth(depth_texture.get(),
+			Format::D24UnormS8Uint).set_debug_name("Depth Buffer View")).get_value());
+
+		if(benchmark.deferred)
+		{
+			const TextureUsageFlags gbuffer_usage(TextureUsageFlagBits::ColorAttachment | TextureUsageFlagBits::InputAttachment);
+			gbuffer_albedo_texture = UniqueTexture(device->create_texture(TextureInfo::make_transient_attachment(
+				in_width, in_height, Format::R8G8B8A8Unorm, gbuffer_usage).set_debug_name("G-Buffer Albedo")).get_value());
+			gbuffer_albedo_view = UniqueTextureView(device->create_texture_view(TextureViewInfo::make_2d(
+				gbuffer_albedo_texture.get(), Format::R8G8B8A8Unorm).set_debug_name("G-Buffer Albedo View")).get_value());
+
+			gbuffer_normal_texture = UniqueTexture(device->create_texture(TextureInfo::make_transient_attachment(
+				in_width, in_height, Format::R16G16B16A16Sfloat, gbuffer_usage).set_debug_name("G-Buffer Normal")).get_value());
+			gbuffer_normal_view = UniqueTextureView(device->create_texture_view(TextureViewInfo::make_2d(
+				gbuffer_normal_texture.get(), Format::R16G16B16A16Sfloat).set_debug_name("G-Buffer Normal View")).get_value());
+		}
+
+		if(benchmark.offscreen)
+		{
+			/** Captures copy the texture to a readback buffer */
+			TextureUsageFlags offscreen_usage(TextureUsageFlagBits::ColorAttachment);
+			if(benchmark.capture_interval != 0)
+				offscreen_usage |= TextureUsageFlags(TextureUsageFlagBits::TransferSrc);
+
+			offscreen_color_texture = UniqueTexture(device->create_texture(TextureInfo(TextureCreateInfo(TextureType::Tex2D,
+				MemoryUsage::GpuOnly,
+				offscreen_format,
+				in_width,
+				in_height,
+				1,
+				1,
+				1,
+				SampleCountFlagBits::Count1,
+				offscreen_usage)).set_debug_name("Offscreen Color Texture")).get_value());
+			offscreen_color_view = UniqueTextureView(device->create_texture_view(TextureViewInfo::make_2d(
+				offscreen_color_texture.get(), offscreen_format).set_debug_name("Offscreen Color View")).get_value());
+		}
+
+		if(sample_count == SampleCountFlagBits::Count1)
+			return;
+
+		const Format color_format = benchmark.offscreen ? offscreen_format : device->get_swapchain_format(swapchain.get());
+		msaa_color_texture = UniqueTexture(device->create_texture(TextureInfo::make_transient_attachment(
+			in_width, in_height, color_format,
+			TextureUsageFlags(TextureUsageFlagBits::ColorAttachment),
+			sample_count).set_debug_name("MSAA Color Texture")).get_value());
 
+		msaa_color_texture_view = UniqueTextureView(device->create_texture_view(TextureViewInfo::make_2d(
+			msaa_color_texture.get(), color_format).set_debug_name("MSAA Color View")).get_value());
+	};
+	create_render_targets(win.get_width(), win.get_height());
+
+	auto recreate_swapchain = [&](uint32_t width, uint32_t height)
+	{
 		UniqueSwapchain old_swapchain(swapchain.free());
 
 		device->wait_idle();
@@ -370,64 +873,304 @@ int main()
 			win.get_native_handle(),
 			width,
 			height,
-			device->get_swapchain_backend_handle(old_swapchain.get()))).get_value());
+			device->get_swapchain_backend_handle(old_swapchain.get()),
+			benchmark.present_mode)).get_value());
+	};
 
-		depth_texture = UniqueTexture(device->create_texture(TextureInfo::make_depth_stencil_attachment(
-			width,height, Format::D24UnormS8Uint).set_debug_name("Depth Buffer Texture")).get_value());
+	win.get_window_resized().bind([&](uint32_t width, uint32_t height)
+	{
+		logger::verbose("Resizing swapchain and recreating resources...");
 
-		depth_texture_view = UniqueTextureView(device->create_texture_view(TextureViewInfo::make_depth(depth_texture.get(),
-			Format::D24UnormS8Uint).set_debug_name("Depth Buffer View")).get_value());
+		recreate_swapchain(width, height);
+		create_render_targets(width, height);
 	});
 
+	/** Replaces the fixed sleep that used to throttle the loop, the present mode alone paces it when disabled */
+	FrameLimiter frame_limiter(benchmark.fps_limit);
 
-	std::vector<UniqueBuffer> ubos;
+	/** May differ from the swapchain's mode when unsupported, kept to not recreate the swapchain every frame */
+	PresentMode requested_present_mode = benchmark.present_mode;
 
-	int sylvains = 1;
+	CameraPath camera_path = CameraPath::make_default();
+	if(!benchmark.camera_path.empty())
+	{
+		auto loaded_camera_path = CameraPath::load(benchmark.camera_path);
+		if(!loaded_camera_path)
+		{
+			logger::fatal("Failed to load camera path: {}", loaded_camera_path.get_error());
+			return -1;
+		}
 
-	for(size_t i = 0; i < sylvains; ++i)
-		ubos.emplace_back(device->create_buffer(BufferInfo::make_ubo(sizeof(UBO))).get_value());
+		camera_path = std::move(loaded_camera_path.get_value());
+	}
 
-	UniqueBuffer ubo_sky(device->create_buffer(BufferInfo::make_ubo(sizeof(UBO))).get_value());
+	std::ofstream timings;
+	if(!benchmark.timings_path.empty())
+	{
+		timings.open(benchmark.timings_path);
+		if(!timings)
+		{
+			logger::fatal("Cannot open {}", benchmark.timings_path);
+			return -1;
+		}
+
+		timings << "frame,time_s,frame_ms,cubes_cpu_ms,pass_cpu_us,state_changes\n";
+	}
+
+	/** Frames are read back a few frames later and encoded on another thread, they never stall the GPU */
+	std::unique_ptr<renderer::FrameCapture> frame_capture;
+	if(benchmark.capture_interval != 0)
+	{
+		frame_capture = std::make_unique<renderer::FrameCapture>(*device, benchmark.capture_directory);
+		logger::info("Capturing every {} frame(s) to {}", benchmark.capture_interval, benchmark.capture_directory);
+	}
+
+	/** 
+	 * UBOs are rewritten every frame, each one is a ring of one buffer per frame in flight
+	 * indexed by Device::get_current_frame_index so a frame never overwrites data the GPU may still read
+	 */
+	const uint32_t frames_in_flight = device->get_frames_in_flight();
+	const auto create_ubo_ring = [&]()
+	{
+		std::vector<UniqueBuffer> ring;
+		ring.reserve(frames_in_flight);
+		for(uint32_t i = 0; i < frames_in_flight; ++i)
+			ring.emplace_back(device->create_buffer(BufferInfo::make_ubo(sizeof(UBO))).get_value());
+		return ring;
+	};
+
+	/** Per-object path: one UBO per cube and frame in flight, allocated on demand */
+	std::vector<std::vector<UniqueBuffer>> ubos(frames_in_flight);
+
+	std::vector<UniqueBuffer> ubo_sky = create_ubo_ring();
+
+	/** 
+	 * Instanced path: view/proj and the cube dequantization are shared, transforms are per instance
+	 * The instance buffer is sized for the requested cubes and grows when the count is raised from the UI
+	 */
+	static constexpr uint32_t max_cube_instances = 1000000;
+	benchmark.instance_count = std::min(benchmark.instance_count, static_cast<int>(max_cube_instances));
+	std::vector<UniqueBuffer> ubo_cubes = create_ubo_ring();
+	auto instanced_renderer_result = renderer::InstancedRenderer::create(*device, 
+		benchmark.instanced ? static_cast<uint32_t>(benchmark.instance_count) : 0);
+	if(!instanced_renderer_result)
+	{
+		logger::fatal("Failed to create the instanced renderer: {}", instanced_renderer_result.get_error());
+		return -1;
+	}
+
+	renderer::InstancedRenderer instanced_renderer = std::move(instanced_renderer_result.get_value());
+	/** Scene materials only output surface attributes when rendering deferred */
+	const ShaderHandle scene_frag_shader = benchmark.deferred ? gbuffer_frag_shader.get() : frag_shader.get();
+
+	/** 
+	 * use_normal_map of gbuffer_fs.hlsl, materials sharing the shader get their own pipeline per value
+	 * The forward shader always samples the normal map
+	 */
+	static constexpr uint32_t use_normal_map_constant_id = 0;
+	const auto make_scene_frag_stage = [&](const bool in_use_normal_map)
+	{
+		MaterialShaderStage stage(gfx::ShaderStageFlagBits::Fragment, scene_frag_shader, "main");
+		if(benchmark.deferred)
+			stage.set_specialization_constant(SpecializationConstant::make_bool(use_normal_map_constant_id, 
+				in_use_normal_map));
+		return stage;
+	};
+	/** One batch per UBO of the ring, the batch material binds it */
+	std::vector<renderer::BatchId> cube_batches;
+	cube_batches.reserve(frames_in_flight);
+	for(const auto& ubo : ubo_cubes)
+	{
+		renderer::RenderMaterial material;
+		material.stages = {
+			MaterialShaderStage(gfx::ShaderStageFlagBits::Vertex, 
+				instanced_vert_shader.get(), 
+				"main"),
+			make_scene_frag_stage(true),
+		};
+		material.rasterizer.cull_mode = CullMode::Back;
+		material.rasterizer.front_face = FrontFace::CounterClockwise;
+		material.rasterizer.polygon_mode = PolygonMode::Fill;
+		material.pipeline_layout = pipeline_layout;
+		material.bindings = {
+			renderer::MaterialBinding(0, 0, ubo.get()),
+			renderer::MaterialBinding(0, 1, sampler.get()),
+			renderer::MaterialBinding(0, 2, texture_view.get()),
+			renderer::MaterialBinding(0, 3, normal_map_view.get()),
+		};
+
+		cube_batches.emplace_back(instanced_renderer.register_batch(renderer::RenderMesh(cube.vertex_buffer.get(),
+			cube.index_buffer.get(),
+			cube.index_type,
+			cube.index_count,
+			cube.stride,
+			cube.attributes), std::move(material)));
+	}
+
+	/** 
+	 * Sky and per-object cubes go through the render queue, each draw binds its own UBO (set 0, binding 0)
+	 * The sky is in a later pass so early depth testing rejects the pixels hidden by the cubes
+	 */
+	static constexpr uint32_t opaque_pass = 0;
+	static constexpr uint32_t sky_pass = 1;
+	renderer::RenderQueue render_queue(*device, std::max(std::thread::hardware_concurrency(), 1u));
+	const auto make_material = [&](const TextureViewHandle& in_albedo, const TextureViewHandle& in_normal_map,
+		const bool in_use_normal_map)
+	{
+		renderer::RenderMaterial material;
+		material.stages = {
+			MaterialShaderStage(gfx::ShaderStageFlagBits::Vertex, 
+				vert_shader.get(), 
+				"main"),
+			make_scene_frag_stage(in_use_normal_map),
+		};
+		material.rasterizer.cull_mode = CullMode::Back;
+		material.rasterizer.front_face = FrontFace::CounterClockwise;
+		material.rasterizer.polygon_mode = PolygonMode::Fill;
+		material.pipeline_layout = pipeline_layout;
+		material.bindings = {
+			renderer::MaterialBinding(0, 1, sampler.get()),
+			renderer::MaterialBinding(0, 2, in_albedo),
+			renderer::MaterialBinding(0, 3, in_normal_map),
+		};
+		return material;
+	};
+	const auto make_render_mesh = [](const Mesh& in_mesh)
+	{
+		return renderer::RenderMesh(in_mesh.vertex_buffer.get(),
+			in_mesh.index_buffer.get(),
+			in_mesh.index_type,
+			in_mesh.index_count,
+			in_mesh.stride,
+			in_mesh.attributes);
+	};
+	const renderer::MeshId sky_mesh = render_queue.register_mesh(make_render_mesh(sky));
+	const renderer::MeshId cube_mesh = render_queue.register_mesh(make_render_mesh(cube));
+	const renderer::MaterialId sky_material = render_queue.register_material(make_material(sky_texture_view.get(), 
+		texture_view.get(), false));
+	const renderer::MaterialId cube_material = render_queue.register_material(make_material(texture_view.get(), 
+		normal_map_view.get(), true));
+
+	/** CPU time spent updating and recording the cubes, averaged over the last frames */
+	float cubes_cpu_time_ms = 0.f;
+
+	/** CPU time spent in cmd_begin_render_pass/cmd_end_render_pass, averaged over the last frames */
+	float pass_cpu_time_us = 0.f;
 
 	float cam_pitch = 0.f, cam_yaw = 0.f;
-	glfwSetInputMode(win.get_handle(), GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+	if(win.get_handle())
+		glfwSetInputMode(win.get_handle(), GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
 	ImGui::SetCurrentContext(ImGui::CreateContext());
-	ui::initialize_imgui();
-	ImGui_ImplGlfw_InitForOther(win.get_handle(), true);
-
-	while(!glfwWindowShouldClose(win.get_handle()))
+	ui::initialize_imgui(shader_compiler, pipeline_layout_cache);
+
+	const auto shader_statistics = shader_compiler.get_statistics();
+	logger::info("Shaders: {} loaded from cache, {} compiled ({:.2f} ms in DXC)",
+		shader_statistics.cache_hits,
+		shader_statistics.cache_misses,
+		shader_statistics.compile_time_ms);
+	if(win.get_handle())
+		ImGui_ImplGlfw_InitForOther(win.get_handle(), true);
+
+	uint32_t frame = 0;
+	while(!win.get_handle() || !glfwWindowShouldClose(win.get_handle()))
 	{
-		glfwPollEvents();
+		if(benchmark.frame_count != 0 && frame == benchmark.frame_count)
+			break;
+
+		const auto frame_start_time = std::chrono::high_resolution_clock::now();
 
-		if(device->acquire_swapchain_texture(swapchain.get(), 
+		if(win.get_handle())
+			glfwPollEvents();
+
+		if(!benchmark.offscreen && device->acquire_swapchain_texture(swapchain.get(), 
 			image_available_semaphore.get()) != gfx::Result::Success)
 			continue;
 
 		device->new_frame();
+		const size_t frame_index = device->get_current_frame_index();
+		shader_reloader.update();
+		if(frame_capture)
+			frame_capture->update();
 
 		static auto start_time = std::chrono::high_resolution_clock::now();
 		auto current_time = std::chrono::high_resolution_clock::now();
 		float delta_time = std::chrono::duration<float, std::chrono::seconds::period>(current_time - start_time).count();
 
-		ImGui_ImplGlfw_NewFrame();
+		/** Offscreen frames only depend on their index */
+		if(benchmark.offscreen)
+			delta_time = frame * benchmark.fixed_timestep;
+
+		static auto last_frame_time = current_time;
+		const float frame_delta_time = std::chrono::duration<float>(current_time - last_frame_time).count();
+		last_frame_time = current_time;
+
+		if(win.get_handle())
+		{
+			ImGui_ImplGlfw_NewFrame();
+		}
+		else
+		{
+			/** Normally filled by the GLFW backend */
+			ImGui::GetIO().DisplaySize = ImVec2(static_cast<float>(win.get_width()), static_cast<float>(win.get_height()));
+			ImGui::GetIO().DeltaTime = std::max(frame_delta_time, 1e-4f);
+		}
 		ImGui::NewFrame();
 		ImGui::Text("%s (Shader Model: %s, Shader Format: %s)", result.get_value()->get_name().data(),
 			std::to_string(ShaderModel::SM6_0).c_str(),
 			std::to_string(result.get_value()->get_shader_language()).c_str());
 		ImGui::Text("%.0f FPS", 1.f / ImGui::GetIO().DeltaTime, ImGui::GetIO().DeltaTime );
 		ImGui::Text("%.2f ms", ImGui::GetIO().DeltaTime * 1000);
+		static constexpr std::array present_modes = { PresentMode::Fifo, PresentMode::FifoRelaxed, 
+			PresentMode::Mailbox, PresentMode::Immediate };
+		const PresentMode current_present_mode = swapchain ? device->get_swapchain_present_mode(swapchain.get()) : 
+			PresentMode::Fifo;
+		if(swapchain && ImGui::BeginCombo("Present mode", std::to_string(current_present_mode).c_str()))
+		{
+			for(const auto& present_mode : present_modes)
+			{
+				if(ImGui::Selectable(std::to_string(present_mode).c_str(), present_mode == current_present_mode))
+					benchmark.present_mode = present_mode;
+			}
+			ImGui::EndCombo();
+		}
+		if(ImGui::SliderFloat("FPS limit", &benchmark.fps_limit, 0.f, 500.f, benchmark.fps_limit > 0.f ? "%.0f" : "Off"))
+			frame_limiter.set_target_fps(benchmark.fps_limit);
+		ImGui::Text("%u frame(s) in flight", device->get_frames_in_flight());
+		if(ImGui::Checkbox("Low latency", &benchmark.low_latency))
+			device->set_latency_mode(benchmark.low_latency ? LatencyMode::LowLatency : LatencyMode::Throughput);
+		ImGui::Checkbox("Instanced", &benchmark.instanced);
+		ImGui::InputInt("Cubes", &benchmark.instance_count, 1000, 100000);
+		benchmark.instance_count = std::clamp(benchmark.instance_count, 0, static_cast<int>(max_cube_instances));
+		ImGui::Text("Cubes CPU: %.3f ms (%u draw calls)", cubes_cpu_time_ms, 
+			benchmark.instanced ? instanced_renderer.get_statistics().draw_calls : benchmark.instance_count);
+		ImGui::Text("Render queue: %u packets, %lld state changes saved, sorted in %.3f ms", 
+			render_queue.get_statistics().packets,
+			static_cast<long long>(render_queue.get_statistics().get_saved_state_changes()),
+			render_queue.get_statistics().sort_time_ms);
+		if(device->is_dynamic_rendering_supported())
+			ImGui::Checkbox("Dynamic rendering", &benchmark.dynamic_rendering);
+		ImGui::Text("Render pass begin/end CPU: %.2f us (%s)", pass_cpu_time_us,
+			device->is_dynamic_rendering_enabled() ? "dynamic rendering" : "render pass");
+		ImGui::Text("Command lists: %u state changes issued, %u redundant filtered (%u pipelines, %u descriptors)",
+			device->get_command_list_statistics().issued.get_total(),
+			device->get_command_list_statistics().filtered.get_total(),
+			device->get_command_list_statistics().filtered.pipelines,
+			device->get_command_list_statistics().filtered.descriptors);
 		ImGui::Render();
 
+		device->set_dynamic_rendering_enabled(benchmark.dynamic_rendering);
+
 		double xpos = 0.f, ypos = 0.f;
 		static double last_xpos = 0.f;
 		static double last_ypos = 0.f;
-		glfwGetCursorPos(win.get_handle(), &xpos, &ypos);
+		if(win.get_handle())
+			glfwGetCursorPos(win.get_handle(), &xpos, &ypos);
 
 		float delta_x = ypos - last_ypos;
 		float delta_y = xpos - last_xpos;
 
-		if(glfwGetInputMode(win.get_handle(),GLFW_CURSOR) == GLFW_CURSOR_DISABLED)
+		if(win.get_handle() && glfwGetInputMode(win.get_handle(),GLFW_CURSOR) == GLFW_CURSOR_DISABLED)
 		{
 			cam_yaw += -delta_y * 0.025f * delta_time;
 			cam_pitch -= -delta_x * 0.025f * delta_time;
@@ -442,30 +1185,40 @@ int main()
 		glm::vec3 fwd;
 		static glm::vec3 cam_pos = glm::vec3(0, 0, 2);
 
+		if(benchmark.offscreen)
+		{
+			const CameraKeyframe camera = camera_path.sample(delta_time);
+			cam_pos = camera.position;
+			cam_yaw = camera.yaw;
+			cam_pitch = camera.pitch;
+		}
+
 		fwd.x = glm::cos(glm::radians(cam_yaw)) * glm::cos(glm::radians(cam_pitch));
 		fwd.y = glm::sin(glm::radians(cam_yaw)) * glm::cos(glm::radians(cam_pitch));
 		fwd.z = glm::sin(glm::radians(cam_pitch));
 		fwd = glm::normalize(fwd);
 
 		glm::vec3 right = glm::normalize(glm::cross(fwd, glm::vec3(0, 0, 1)));
-		if (glfwGetKey(win.get_handle(), GLFW_KEY_ESCAPE) == GLFW_PRESS &&
-			!ImGui::GetIO().WantCaptureKeyboard)
-			glfwSetInputMode(win.get_handle(), GLFW_CURSOR, GLFW_CURSOR_NORMAL);
-
-		if(glfwGetMouseButton(win.get_handle(), GLFW_MOUSE_BUTTON_LEFT) &&
-			!ImGui::GetIO().WantCaptureMouse)
-			glfwSetInputMode(win.get_handle(), GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-
-		float cam_speed = 0.0015f;
-		if (glfwGetKey(win.get_handle(), GLFW_KEY_W) == GLFW_PRESS)
-		    cam_pos -= fwd * cam_speed * delta_time;
-		if (glfwGetKey(win.get_handle(), GLFW_KEY_S) == GLFW_PRESS)
-		    cam_pos += fwd * cam_speed * delta_time;
-		if (glfwGetKey(win.get_handle(), GLFW_KEY_A) == GLFW_PRESS)
-		    cam_pos += right * cam_speed * delta_time;
-		if (glfwGetKey(win.get_handle(), GLFW_KEY_D) == GLFW_PRESS)
-		    cam_pos -= right * cam_speed * delta_time;
-	
+		if(win.get_handle())
+		{
+			if (glfwGetKey(win.get_handle(), GLFW_KEY_ESCAPE) == GLFW_PRESS &&
+				!ImGui::GetIO().WantCaptureKeyboard)
+				glfwSetInputMode(win.get_handle(), GLFW_CURSOR, GLFW_CURSOR_NORMAL);
+
+			if(glfwGetMouseButton(win.get_handle(), GLFW_MOUSE_BUTTON_LEFT) &&
+				!ImGui::GetIO().WantCaptureMouse)
+				glfwSetInputMode(win.get_handle(), GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+			float cam_speed = 0.0015f;
+			if (glfwGetKey(win.get_handle(), GLFW_KEY_W) == GLFW_PRESS)
+			    cam_pos -= fwd * cam_speed * delta_time;
+			if (glfwGetKey(win.get_handle(), GLFW_KEY_S) == GLFW_PRESS)
+			    cam_pos += fwd * cam_speed * delta_time;
+			if (glfwGetKey(win.get_handle(), GLFW_KEY_A) == GLFW_PRESS)
+			    cam_pos += right * cam_speed * delta_time;
+			if (glfwGetKey(win.get_handle(), GLFW_KEY_D) == GLFW_PRESS)
+			    cam_pos -= right * cam_speed * delta_time;
+		}
 
 		last_xpos = xpos;
 		last_ypos = ypos;
@@ -484,118 +1237,260 @@ int main()
 		glm::mat4 model = glm::scale(glm::mat4(1.f), glm::vec3(20.f, 20.f, 20.f)) 
 			* glm::rotate(glm::mat4(1.f), delta_time * 0.05f * glm::radians(90.f), glm::vec3(0.f, 0.f, 1.f));
 			UBO ubo_data;
-			ubo_data.world = model;
+			ubo_data.world = model * sky.dequantization;
 			ubo_data.view = view;
 			ubo_data.proj = proj;
 
-			auto ubo_map = device->map_buffer(ubo_sky.get());
+			const BufferHandle ubo = ubo_sky[frame_index].get();
+			auto ubo_map = device->map_buffer(ubo);
 			memcpy(ubo_map.get_value(), &ubo_data, sizeof(ubo_data));
-			device->unmap_buffer(ubo_sky.get());
+			device->unmap_buffer(ubo);
+
+			render_queue.submit(sky_pass, 0.f, renderer::DrawPacket(sky_mesh, sky_material, ubo));
 		}
-		for(size_t i = 0; i < sylvains; ++i)
+
+		const auto cubes_start_time = std::chrono::high_resolution_clock::now();
+
+		/** Cubes are laid out on a square grid */
+		const size_t cubes_per_row = static_cast<size_t>(std::ceil(std::sqrt(static_cast<float>(benchmark.instance_count))));
+		const auto get_cube_model = [&](const size_t in_index)
+		{
+			return glm::translate(glm::mat4(1.f), 
+				glm::vec3((in_index % cubes_per_row) * -0.5f, (in_index / cubes_per_row) * -0.5f, 0));
+		};
+
+		if(benchmark.instanced)
 		{
-			glm::mat4 model = glm::translate(glm::mat4(1.f), glm::vec3(i * -0.5f, 0, 0));
-		
 			UBO ubo_data;
-			ubo_data.world = model;
+			ubo_data.world = cube.dequantization;
 			ubo_data.view = view;
 			ubo_data.proj = proj;
-			//Ss
-			auto ubo_map = device->map_buffer(ubos[i].get());
+
+			auto ubo_map = device->map_buffer(ubo_cubes[frame_index].get());
 			memcpy(ubo_map.get_value(), &ubo_data, sizeof(ubo_data));
-			device->unmap_buffer(ubos[i].get());
+			device->unmap_buffer(ubo_cubes[frame_index].get());
+
+			if(auto reserved = instanced_renderer.reserve(static_cast<uint32_t>(benchmark.instance_count)); !reserved)
+				logger::error("Failed to grow the instance buffer to {} cubes: {}", benchmark.instance_count, reserved.get_error());
+
+			instanced_renderer.begin_frame();
+			auto instances = instanced_renderer.allocate_instances(cube_batches[frame_index], benchmark.instance_count);
+			for(size_t i = 0; i < instances.size(); ++i)
+				instances[i].world = get_cube_model(i);
+		}
+		else
+		{
+			auto& frame_ubos = ubos[frame_index];
+			while(frame_ubos.size() < static_cast<size_t>(benchmark.instance_count))
+				frame_ubos.emplace_back(device->create_buffer(BufferInfo::make_ubo(sizeof(UBO))).get_value());
+
+			for(size_t i = 0; i < static_cast<size_t>(benchmark.instance_count); ++i)
+			{
+				const glm::mat4 model = get_cube_model(i);
+
+				UBO ubo_data;
+				ubo_data.world = model * cube.dequantization;
+				ubo_data.view = view;
+				ubo_data.proj = proj;
+				
+				auto ubo_map = device->map_buffer(frame_ubos[i].get());
+				memcpy(ubo_map.get_value(), &ubo_data, sizeof(ubo_data));
+				device->unmap_buffer(frame_ubos[i].get());
+
+				render_queue.submit(opaque_pass, 
+					glm::length(glm::vec3(model[3]) - cam_pos), 
+					renderer::DrawPacket(cube_mesh, cube_material, frame_ubos[i].get()));
+			}
 		}
 
+		float cubes_frame_cpu_time_ms = std::chrono::duration<float, std::milli>(
+			std::chrono::high_resolution_clock::now() - cubes_start_time).count();
+
 		auto list = device->allocate_cmd_list(QueueType::Gfx);
 
 		std::array clear_values = { ClearValue(ClearColorValue({0, 0, 0, 1})),
 			ClearValue(ClearDepthStencilValue(1.f, 0))};
-		std::array color_attachments = { device->get_swapchain_backbuffer_view(swapchain.get()) };
+		std::array backbuffer_views = { benchmark.offscreen ? offscreen_color_view.get() : 
+			device->get_swapchain_backbuffer_view(swapchain.get()) };
+		std::array msaa_color_views = { msaa_color_texture_view.get() };
+		std::array color_attachment_ops = { AttachmentOps(AttachmentLoadOp::Clear, AttachmentStoreOp::Store) };
+		std::array color_attachments_refs = { 0u };
+		std::array subpasses = { RenderPassInfo::Subpass(color_attachments_refs,
+			{},
+			RenderPassInfo::DepthStencilMode::ReadWrite) };
+
+		/**
+		 * Deferred: subpass 0 writes the G-buffer (attachments 1 and 2), subpass 1 reads it as input attachments
+		 * and lights the backbuffer (attachment 0), which is entirely overwritten so it isn't cleared
+		 */
+		std::array deferred_clear_values = { ClearValue(ClearColorValue({0, 0, 0, 1})),
+			ClearValue(ClearColorValue({0, 0, 0, 0})),
+			ClearValue(ClearColorValue({0, 0, 0, 0})),
+			ClearValue(ClearDepthStencilValue(1.f, 0))};
+		std::array deferred_color_views = { backbuffer_views[0], gbuffer_albedo_view.get(), gbuffer_normal_view.get() };
+		std::array deferred_color_attachment_ops = { AttachmentOps(AttachmentLoadOp::DontCare, AttachmentStoreOp::Store),
+			AttachmentOps(AttachmentLoadOp::Clear, AttachmentStoreOp::DontCare),
+			AttachmentOps(AttachmentLoadOp::Clear, AttachmentStoreOp::DontCare) };
+		std::array gbuffer_refs = { 1u, 2u };
+		std::array lighting_refs = { 0u };
+		std::array deferred_subpasses = { RenderPassInfo::Subpass(gbuffer_refs,
+				{},
+				RenderPassInfo::DepthStencilMode::ReadWrite),
+			RenderPassInfo::Subpass(lighting_refs,
+				gbuffer_refs,
+				RenderPassInfo::DepthStencilMode::ReadOnly) };
 		
 		RenderPassInfo info;
 		info.render_area = Rect2D(0, 0, win.get_width(), win.get_height());
-		info.color_attachments = color_attachments;
-		info.clear_attachment_flags = 1 << 0;
-		info.store_attachment_flags = 1 << 0;
-		info.clear_values = clear_values;
+		if(benchmark.deferred)
+		{
+			info.color_attachments = deferred_color_views;
+			info.color_attachment_ops = deferred_color_attachment_ops;
+			info.clear_values = deferred_clear_values;
+			info.subpasses = deferred_subpasses;
+		}
+		else
+		{
+			if(sample_count != SampleCountFlagBits::Count1)
+			{
+				/** Samples are only needed until they are resolved */
+				info.color_attachments = msaa_color_views;
+				info.resolve_attachments = backbuffer_views;
+				color_attachment_ops[0].store_op = AttachmentStoreOp::DontCare;
+			}
+			else
+			{
+				info.color_attachments = backbuffer_views;
+			}
+			info.color_attachment_ops = color_attachment_ops;
+			info.clear_values = clear_values;
+			info.subpasses = subpasses;
+		}
+		info.depth_stencil_attachment_ops = AttachmentOps(AttachmentLoadOp::Clear, AttachmentStoreOp::DontCare);
 		info.depth_stencil_attachment = depth_texture_view.get();
-		
-		std::array color_attachments_refs = { 0Ui32 };
-		std::array subpasses = { RenderPassInfo::Subpass(color_attachments_refs,
-			{},
-			{},
-			RenderPassInfo::DepthStencilMode::ReadWrite) };
-		info.subpasses = subpasses;
+
+		const auto pass_begin_start_time = std::chrono::high_resolution_clock::now();
 		device->cmd_begin_render_pass(list, info);
+		float pass_frame_cpu_time_us = std::chrono::duration<float, std::micro>(
+			std::chrono::high_resolution_clock::now() - pass_begin_start_time).count();
 
 		PipelineRenderPassState rp_state;
 
 		std::array blends = { PipelineColorBlendAttachmentState() };
-		std::array shaders = {
-			PipelineShaderStage(gfx::ShaderStageFlagBits::Vertex, 
-			Device::get_backend_shader(vert_shader.get()), 
-			"main" ),
-			PipelineShaderStage(gfx::ShaderStageFlagBits::Fragment, 
-			Device::get_backend_shader(frag_shader.get()), 
-			"main" ),
-		};
+		std::array gbuffer_blends = { PipelineColorBlendAttachmentState(), PipelineColorBlendAttachmentState() };
 		 
-		rp_state.color_blend.attachments = blends;
+		if(benchmark.deferred)
+			rp_state.color_blend.attachments = gbuffer_blends;
+		else
+			rp_state.color_blend.attachments = blends;
 		rp_state.depth_stencil.enable_depth_test = true;
 		rp_state.depth_stencil.enable_depth_write = true;
 		rp_state.depth_stencil.enable_stencil_test = false;
 		rp_state.depth_stencil.depth_compare_op = CompareOp::Less;
 
-		PipelineMaterialState mat_state;
-		mat_state.stages = shaders;
-		mat_state.vertex_input.input_binding_descriptions = { Vertex::get_binding_description() };
-		mat_state.vertex_input.input_attribute_descriptions = Vertex::get_attribute_descriptions();
-		mat_state.rasterizer.cull_mode = CullMode::Back;
-		mat_state.rasterizer.front_face = FrontFace::CounterClockwise;
-		mat_state.rasterizer.polygon_mode = PolygonMode::Fill;
-
 		device->cmd_set_render_pass_state(list, rp_state);
-		device->cmd_set_material_state(list, mat_state);
-		device->cmd_bind_pipeline_layout(list, pipeline_layout.get());
 
-		device->cmd_bind_vertex_buffer(list, sky_vertex_buffer.get(), 0);
-		device->cmd_bind_index_buffer(list, sky_index_buffer.get(), 0, IndexType::Uint32);
-		device->cmd_bind_sampler(list, 0, 1, sampler.get());
-		device->cmd_bind_texture_view(list, 0, 2, sky_texture_view.get());
-		device->cmd_bind_texture_view(list, 0, 3, texture_view.get());
-		device->cmd_bind_ubo(list, 0, 0, ubo_sky.get());
-		device->cmd_draw_indexed(list, sky_indices.size(), 1, 0, 0, 0);
+		const auto cubes_record_start_time = std::chrono::high_resolution_clock::now();
+		if(benchmark.instanced)
+			instanced_renderer.flush(list);
+		render_queue.flush(list);
 
-		device->cmd_bind_vertex_buffer(list, vertex_buffer.get(), 0);
-		device->cmd_bind_index_buffer(list, index_buffer.get(), 0, IndexType::Uint32);
+		cubes_frame_cpu_time_ms += std::chrono::duration<float, std::milli>(
+			std::chrono::high_resolution_clock::now() - cubes_record_start_time).count();
+		cubes_cpu_time_ms = cubes_cpu_time_ms * 0.95f + cubes_frame_cpu_time_ms * 0.05f;
 
-		device->cmd_bind_sampler(list, 0, 1, sampler.get());
-		device->cmd_bind_texture_view(list, 0, 2, texture_view.get());
-		device->cmd_bind_texture_view(list, 0, 3, normal_map_view.get());
+		if(benchmark.deferred)
+		{
+			device->cmd_next_subpass(list);
+
+			PipelineRenderPassState lighting_rp_state;
+			lighting_rp_state.color_blend.attachments = blends;
+			device->cmd_set_render_pass_state(list, lighting_rp_state);
+			device->cmd_set_material_state(list, lighting_material_state);
+			device->cmd_bind_pipeline_layout(list, lighting_pipeline_layout);
+			device->cmd_bind_input_attachment(list, "gbuffer_albedo", gbuffer_albedo_view.get());
+			device->cmd_bind_input_attachment(list, "gbuffer_normal", gbuffer_normal_view.get());
+			device->cmd_draw(list, 3, 1, 0, 0);
+		}
 
-		for(size_t i = 0; i < sylvains; ++i)
+		if(preview_pipeline_layout)
 		{
-			device->cmd_bind_ubo(list, 0, 0, ubos[i].get());
-			device->cmd_draw_indexed(list, index_count, 1, 0, 0, 0);
+			PipelineRenderPassState preview_rp_state;
+			preview_rp_state.color_blend.attachments = blends;
+			device->cmd_set_render_pass_state(list, preview_rp_state);
+			device->cmd_set_material_state(list, preview_material_state);
+			device->cmd_bind_pipeline_layout(list, preview_pipeline_layout);
+			device->cmd_push_constants(list, ShaderStageFlags(ShaderStageFlagBits::Fragment), BindlessIndices {
+				Device::get_bindless_index(texture_view.get()),
+				Device::get_bindless_index(sampler.get()) });
+			device->cmd_draw(list, 6, 1, 0, 0);
 		}
 
 		device->cmd_bind_texture_view(list, 0, 3, TextureViewHandle());
-		ui::draw_imgui(list);
 
+		/** The UI shows timings, it would make offscreen frames differ between runs */
+		if(!benchmark.offscreen)
+			ui::draw_imgui(list);
+
+		const auto pass_end_start_time = std::chrono::high_resolution_clock::now();
 		device->cmd_end_render_pass(list);
-		device->submit(list, render_wait_semaphores, render_finished_semaphores);
-		device->end_frame();
+		pass_frame_cpu_time_us += std::chrono::duration<float, std::micro>(
+			std::chrono::high_resolution_clock::now() - pass_end_start_time).count();
+		pass_cpu_time_us = pass_cpu_time_us * 0.95f + pass_frame_cpu_time_us * 0.05f;
+
+		if(frame_capture && frame % benchmark.capture_interval == 0)
+			frame_capture->capture(list, offscreen_color_texture.get(), fmt::format("frame_{:05}", frame));
+
+		if(benchmark.offscreen)
+		{
+			device->submit(list);
+			device->end_frame();
+		}
+		else
+		{
+			device->submit(list, render_wait_semaphores, render_finished_semaphores);
+			device->end_frame();
 		
-		device->present(swapchain.get(), present_wait_semaphores);
+			device->present(swapchain.get(), present_wait_semaphores);
+
+			/** Swapchain images can't be replaced mid-frame, a new present mode is applied once the frame is presented */
+			if(benchmark.present_mode != requested_present_mode)
+			{
+				requested_present_mode = benchmark.present_mode;
+				recreate_swapchain(win.get_width(), win.get_height());
+				logger::info("Present mode: {}", std::to_string(device->get_swapchain_present_mode(swapchain.get())));
+			}
+		}
+
+		frame_limiter.wait();
 
-		using namespace std::chrono_literals;
-		std::this_thread::sleep_for(6ms);
+		/** The frame time includes waiting for the GPU in new_frame, so GPU-bound runs are measured too */
+		if(timings.is_open())
+		{
+			timings << fmt::format("{},{:.4f},{:.3f},{:.3f},{:.2f},{}\n",
+				frame,
+				delta_time,
+				std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - frame_start_time).count(),
+				cubes_frame_cpu_time_ms,
+				pass_frame_cpu_time_us,
+				device->get_command_list_statistics().issued.get_total());
+		}
+
+		frame++;
+	}
+
+	if(frame_capture)
+	{
+		frame_capture->flush();
+		logger::info("{} frame(s) captured to {}", frame_capture->get_written_count(), benchmark.capture_directory);
 	}
 
-	ImGui_ImplGlfw_Shutdown();
+	if(win.get_handle())
+		ImGui_ImplGlfw_Shutdown();
 	ImGui::DestroyContext();
 	ui::destroy_imgui();
-	glfwTerminate();
+	if(!windowless)
+		glfwTerminate();
 
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <fmt/format.h>
+#include <string_view>
+#include <vector>
+
+/**
+ * Minimal test harness, each test file is its own executable registered to CTest
+ * Failed checks are reported and the test keeps running, the executable returns 1 if any check failed
+ */
+namespace cb::test
+{
+
+struct TestCase
+{
+	std::string_view name;
+	void (*function)();
+};
+
+inline std::vector<TestCase>& get_test_cases()
+{
+	static std::vector<TestCase> test_cases;
+	return test_cases;
+}
+
+inline uint32_t failed_checks = 0;
+
+struct TestRegistrar
+{
+	TestRegistrar(const std::string_view& in_name, void (*in_function)())
+	{
+		get_test_cases().push_back({ in_name, in_function });
+	}
+};
+
+inline void report_failure(const std::string_view& in_condition, const std::string_view& in_file, const int in_line)
+{
+	fmt::print(stderr, "Check failed: {} ({}:{})\n", in_condition, in_file, in_line);
+	failed_checks++;
+}
+
+inline int run_tests()
+{
+	uint32_t failed_tests = 0;
+	for(const auto& test_case : get_test_cases())
+	{
+		const uint32_t previous_failed_checks = failed_checks;
+		test_case.function();
+
+		const bool passed = failed_checks == previous_failed_checks;
+		fmt::print("[{}] {}\n", passed ? "PASSED" : "FAILED", test_case.name);
+		if(!passed)
+			failed_tests++;
+	}
+
+	fmt::print("{}/{} tests passed\n", get_test_cases().size() - failed_tests, get_test_cases().size());
+	return failed_tests == 0 ? 0 : 1;
+}
+
+}
+
+#define CB_TEST(Name) \
+	static void cb_test_##Name(); \
+	static const cb::test::TestRegistrar cb_test_registrar_##Name(#Name, &cb_test_##Name); \
+	static void cb_test_##Name()
+
+#define CB_TEST_CHECK(condition) if(!(condition)) { cb::test::report_failure(#condition, __FILE__, __LINE__); }
+
+#define CB_TEST_MAIN() int main() { return cb::test::run_tests(); }
@@ -0,0 +1,224 @@
+#include "Test.hpp"
+#include "engine/assets/MeshFile.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <string>
+
+using namespace cb;
+using namespace cb::assets;
+
+namespace
+{
+
+/** Offsets of the tables, as laid out by save_mesh_file */
+constexpr size_t streams_offset = sizeof(MeshFileHeader);
+constexpr size_t attributes_offset = streams_offset + 2 * sizeof(MeshFileStream);
+constexpr size_t submeshes_offset = attributes_offset + 2 * sizeof(gfx::VertexInputAttributeDescription);
+
+std::string get_test_path(const std::string_view& in_name)
+{
+	return (std::filesystem::temp_directory_path() / in_name).string();
+}
+
+void write_file(const std::string& in_path, const std::vector<uint8_t>& in_data)
+{
+	std::ofstream file(in_path, std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char*>(in_data.data()), in_data.size());
+}
+
+std::vector<uint8_t> read_file(const std::string& in_path)
+{
+	std::ifstream file(in_path, std::ios::binary);
+	return { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+}
+
+template<typename T>
+std::vector<uint8_t> to_bytes(const std::vector<T>& in_values)
+{
+	std::vector<uint8_t> bytes(in_values.size() * sizeof(T));
+	memcpy(bytes.data(), in_values.data(), bytes.size());
+	return bytes;
+}
+
+/** A quad with a position stream (float3) and a texcoord stream (float2) */
+MeshData make_test_mesh()
+{
+	MeshData mesh;
+	mesh.index_type = gfx::IndexType::Uint16;
+	mesh.streams.push_back({ 12, to_bytes<float>({ 0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0 }) });
+	mesh.streams.push_back({ 8, to_bytes<float>({ 0, 0, 1, 0, 1, 1, 0, 1 }) });
+	mesh.attributes.emplace_back(0, 0, gfx::Format::R32G32B32Sfloat, 0);
+	mesh.attributes.emplace_back(1, 1, gfx::Format::R32G32Sfloat, 0);
+	mesh.submeshes.push_back({ 0, 6, 0, 0 });
+	mesh.indices = to_bytes<uint16_t>({ 0, 1, 2, 0, 2, 3 });
+	mesh.bounds_min = { 0, 0, 0 };
+	mesh.bounds_max = { 1, 1, 0 };
+	return mesh;
+}
+
+std::string save_test_mesh(const std::string_view& in_name)
+{
+	const std::string path = get_test_path(in_name);
+	auto result = save_mesh_file(path, make_test_mesh());
+	CB_TEST_CHECK(result && result.get_value() == std::filesystem::file_size(path));
+	return path;
+}
+
+template<typename T>
+void patch(std::vector<uint8_t>& inout_data, const size_t in_offset, const T& in_value)
+{
+	memcpy(inout_data.data() + in_offset, &in_value, sizeof(T));
+}
+
+/** Save the test mesh, let in_patch corrupt it and return the load error */
+template<typename F>
+MeshFileError load_patched_error(const std::string_view& in_name, F&& in_patch)
+{
+	const std::string path = save_test_mesh(in_name);
+	auto data = read_file(path);
+	in_patch(data);
+	write_file(path, data);
+
+	auto result = load_mesh_file(path);
+	CB_TEST_CHECK(!result);
+	return result ? MeshFileError::WriteFailed : result.get_error();
+}
+
+}
+
+CB_TEST(round_trip)
+{
+	const MeshData mesh = make_test_mesh();
+	const std::string path = save_test_mesh("cb_test_round_trip.cbmesh");
+
+	auto result = load_mesh_file(path);
+	CB_TEST_CHECK(result);
+	if(!result)
+		return;
+
+	const MeshFile& file = result.get_value();
+	CB_TEST_CHECK(file.header.vertex_count == 4 && file.header.index_count == 6);
+	CB_TEST_CHECK(file.header.index_type == gfx::IndexType::Uint16);
+	CB_TEST_CHECK(file.header.bounds_min == mesh.bounds_min && file.header.bounds_max == mesh.bounds_max);
+	CB_TEST_CHECK(file.streams.size() == 2 && file.attributes.size() == 2 && file.submeshes.size() == 1);
+
+	for(size_t i = 0; i < file.streams.size(); ++i)
+	{
+		const auto data = file.get_stream_data(i);
+		CB_TEST_CHECK(file.streams[i].offset % MeshFileHeader::section_alignment == 0);
+		CB_TEST_CHECK(file.streams[i].stride == mesh.streams[i].stride);
+		CB_TEST_CHECK(std::equal(data.begin(), data.end(), mesh.streams[i].data.begin(), mesh.streams[i].data.end()));
+	}
+
+	for(size_t i = 0; i < file.attributes.size(); ++i)
+	{
+		CB_TEST_CHECK(file.attributes[i].location == mesh.attributes[i].location);
+		CB_TEST_CHECK(file.attributes[i].binding == mesh.attributes[i].binding);
+		CB_TEST_CHECK(file.attributes[i].format == mesh.attributes[i].format);
+		CB_TEST_CHECK(file.attributes[i].offset == mesh.attributes[i].offset);
+	}
+
+	CB_TEST_CHECK(file.submeshes[0].first_index == 0 && file.submeshes[0].index_count == 6);
+	CB_TEST_CHECK(file.header.index_offset % MeshFileHeader::section_alignment == 0);
+	CB_TEST_CHECK(std::equal(file.indices.begin(), file.indices.end(), mesh.indices.begin(), mesh.indices.end()));
+}
+
+CB_TEST(missing_file)
+{
+	auto result = load_mesh_file(get_test_path("cb_test_missing.cbmesh"));
+	CB_TEST_CHECK(!result && result.get_error() == MeshFileError::CannotOpenFile);
+}
+
+CB_TEST(invalid_magic)
+{
+	CB_TEST_CHECK(load_patched_error("cb_test_invalid_magic.cbmesh", [](auto& data)
+	{
+		patch(data, offsetof(MeshFileHeader, magic), uint32_t(0x12345678));
+	}) == MeshFileError::InvalidMagic);
+}
+
+CB_TEST(unsupported_version)
+{
+	CB_TEST_CHECK(load_patched_error("cb_test_unsupported_version.cbmesh", [](auto& data)
+	{
+		patch(data, offsetof(MeshFileHeader, version), MeshFileHeader::current_version + 1);
+	}) == MeshFileError::UnsupportedVersion);
+}
+
+CB_TEST(truncated_header)
+{
+	CB_TEST_CHECK(load_patched_error("cb_test_truncated_header.cbmesh", [](auto& data)
+	{
+		data.resize(sizeof(MeshFileHeader) - 1);
+	}) == MeshFileError::Truncated);
+}
+
+CB_TEST(truncated_tables)
+{
+	CB_TEST_CHECK(load_patched_error("cb_test_truncated_tables.cbmesh", [](auto& data)
+	{
+		patch(data, offsetof(MeshFileHeader, attribute_count), uint32_t(1000));
+	}) == MeshFileError::Truncated);
+}
+
+CB_TEST(truncated_stream)
+{
+	CB_TEST_CHECK(load_patched_error("cb_test_truncated_stream.cbmesh", [](auto& data)
+	{
+		patch(data, offsetof(MeshFileHeader, vertex_count), uint32_t(5));
+	}) == MeshFileError::Truncated);
+}
+
+CB_TEST(overflowing_stream)
+{
+	CB_TEST_CHECK(load_patched_error("cb_test_overflowing_stream.cbmesh", [](auto& data)
+	{
+		patch(data, streams_offset + offsetof(MeshFileStream, size), std::numeric_limits<uint64_t>::max());
+	}) == MeshFileError::Truncated);
+}
+
+CB_TEST(truncated_indices)
+{
+	CB_TEST_CHECK(load_patched_error("cb_test_truncated_indices.cbmesh", [](auto& data)
+	{
+		data.pop_back();
+	}) == MeshFileError::Truncated);
+}
+
+CB_TEST(submesh_out_of_range)
+{
+	CB_TEST_CHECK(load_patched_error("cb_test_submesh_out_of_range.cbmesh", [](auto& data)
+	{
+		patch(data, submeshes_offset + offsetof(MeshFileSubmesh, first_index), uint32_t(3));
+	}) == MeshFileError::Truncated);
+}
+
+CB_TEST(attribute_binding_out_of_range)
+{
+	CB_TEST_CHECK(load_patched_error("cb_test_attribute_binding.cbmesh", [](auto& data)
+	{
+		patch(data, attributes_offset + offsetof(gfx::VertexInputAttributeDescription, binding), uint32_t(2));
+	}) == MeshFileError::InvalidAttribute);
+}
+
+CB_TEST(attribute_past_stride)
+{
+	/** float3 at offset 4 of a 12 bytes vertex */
+	CB_TEST_CHECK(load_patched_error("cb_test_attribute_past_stride.cbmesh", [](auto& data)
+	{
+		patch(data, attributes_offset + offsetof(gfx::VertexInputAttributeDescription, offset), uint32_t(4));
+	}) == MeshFileError::InvalidAttribute);
+
+	/** Offsets that would wrap offset + size around */
+	CB_TEST_CHECK(load_patched_error("cb_test_attribute_wrapping_offset.cbmesh", [](auto& data)
+	{
+		patch(data, attributes_offset + offsetof(gfx::VertexInputAttributeDescription, offset),
+			std::numeric_limits<uint32_t>::max() - 4);
+	}) == MeshFileError::InvalidAttribute);
+}
+
+CB_TEST_MAIN()
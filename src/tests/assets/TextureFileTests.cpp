@@ -0,0 +1,152 @@
+#include "Test.hpp"
+#include "engine/assets/TextureFile.hpp"
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <string>
+
+using namespace cb;
+using namespace cb::assets;
+
+namespace
+{
+
+std::string get_test_path(const std::string_view& in_name)
+{
+	return (std::filesystem::temp_directory_path() / in_name).string();
+}
+
+void write_file(const std::string& in_path, const std::vector<uint8_t>& in_data)
+{
+	std::ofstream file(in_path, std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char*>(in_data.data()), in_data.size());
+}
+
+std::vector<uint8_t> read_file(const std::string& in_path)
+{
+	std::ifstream file(in_path, std::ios::binary);
+	return { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+}
+
+/** A 4x4 RGBA8 texture with its 2x2 and 1x1 mips, every byte set to its level index */
+std::string save_test_texture(const std::string_view& in_name)
+{
+	const std::string path = get_test_path(in_name);
+	const std::array<std::vector<uint8_t>, 3> levels = {
+		std::vector<uint8_t>(4 * 4 * 4, 0),
+		std::vector<uint8_t>(2 * 2 * 4, 1),
+		std::vector<uint8_t>(1 * 1 * 4, 2),
+	};
+
+	auto result = save_texture_file(path, TextureFileHeader(gfx::Format::R8G8B8A8Unorm, 4, 4, 1, 3), levels);
+	CB_TEST_CHECK(result && result.get_value() == sizeof(TextureFileHeader) + 3 * sizeof(TextureFileMip) + 84);
+	return path;
+}
+
+template<typename T>
+void patch(std::vector<uint8_t>& inout_data, const size_t in_offset, const T& in_value)
+{
+	memcpy(inout_data.data() + in_offset, &in_value, sizeof(T));
+}
+
+TextureFileError load_error(const std::string& in_path)
+{
+	auto result = load_texture_file(in_path);
+	CB_TEST_CHECK(!result);
+	return result ? TextureFileError::WriteFailed : result.get_error();
+}
+
+}
+
+CB_TEST(round_trip)
+{
+	const std::string path = save_test_texture("cb_test_round_trip.cbtex");
+
+	auto result = load_texture_file(path);
+	CB_TEST_CHECK(result);
+	if(!result)
+		return;
+
+	const TextureFile& file = result.get_value();
+	CB_TEST_CHECK(file.header.format == gfx::Format::R8G8B8A8Unorm);
+	CB_TEST_CHECK(file.header.width == 4 && file.header.height == 4 && file.header.depth == 1);
+	CB_TEST_CHECK(file.header.mip_levels == 3 && file.header.array_layers == 1);
+	CB_TEST_CHECK(file.mips.size() == 3);
+	CB_TEST_CHECK(file.data.size() == 84);
+
+	uint64_t offset = 0;
+	for(size_t level = 0; level < file.mips.size(); ++level)
+	{
+		const uint64_t size = gfx::get_mip_level_size(gfx::Format::R8G8B8A8Unorm, 4, 4, 1, static_cast<uint32_t>(level));
+		CB_TEST_CHECK(file.mips[level].offset == offset && file.mips[level].size == size);
+		for(uint64_t i = 0; i < size; ++i)
+			CB_TEST_CHECK(file.data[offset + i] == level);
+		offset += size;
+	}
+}
+
+CB_TEST(missing_file)
+{
+	CB_TEST_CHECK(load_error(get_test_path("cb_test_missing.cbtex")) == TextureFileError::CannotOpenFile);
+}
+
+CB_TEST(invalid_magic)
+{
+	const std::string path = save_test_texture("cb_test_invalid_magic.cbtex");
+	auto data = read_file(path);
+	patch(data, offsetof(TextureFileHeader, magic), uint32_t(0x12345678));
+	write_file(path, data);
+	CB_TEST_CHECK(load_error(path) == TextureFileError::InvalidMagic);
+}
+
+CB_TEST(unsupported_version)
+{
+	const std::string path = save_test_texture("cb_test_unsupported_version.cbtex");
+	auto data = read_file(path);
+	patch(data, offsetof(TextureFileHeader, version), TextureFileHeader::current_version + 1);
+	write_file(path, data);
+	CB_TEST_CHECK(load_error(path) == TextureFileError::UnsupportedVersion);
+}
+
+CB_TEST(truncated_header)
+{
+	const std::string path = get_test_path("cb_test_truncated_header.cbtex");
+	write_file(path, std::vector<uint8_t>(sizeof(TextureFileHeader) - 1, 0));
+	CB_TEST_CHECK(load_error(path) == TextureFileError::Truncated);
+}
+
+CB_TEST(truncated_mip_table)
+{
+	const std::string path = save_test_texture("cb_test_truncated_mip_table.cbtex");
+	auto data = read_file(path);
+	patch(data, offsetof(TextureFileHeader, mip_levels), uint32_t(1000));
+	write_file(path, data);
+	CB_TEST_CHECK(load_error(path) == TextureFileError::Truncated);
+}
+
+CB_TEST(truncated_data)
+{
+	const std::string path = save_test_texture("cb_test_truncated_data.cbtex");
+	auto data = read_file(path);
+	data.pop_back();
+	write_file(path, data);
+	CB_TEST_CHECK(load_error(path) == TextureFileError::Truncated);
+}
+
+CB_TEST(overflowing_mip)
+{
+	const std::string path = save_test_texture("cb_test_overflowing_mip.cbtex");
+	auto data = read_file(path);
+
+	/** offset + size wraps around to a small value */
+	const size_t mip_offset = sizeof(TextureFileHeader) + sizeof(TextureFileMip);
+	patch(data, mip_offset + offsetof(TextureFileMip, offset), uint64_t(16));
+	patch(data, mip_offset + offsetof(TextureFileMip, size), std::numeric_limits<uint64_t>::max());
+	write_file(path, data);
+	CB_TEST_CHECK(load_error(path) == TextureFileError::Truncated);
+}
+
+CB_TEST_MAIN()
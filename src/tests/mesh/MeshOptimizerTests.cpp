@@ -0,0 +1,200 @@
+#include "Test.hpp"
+#include "engine/mesh/MeshOptimizer.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+using namespace cb;
+using namespace cb::mesh;
+
+namespace
+{
+
+using Triangle = std::array<uint32_t, 3>;
+
+/** A grid of in_size * in_size quads whose triangles are shuffled with a fixed seed */
+std::vector<uint32_t> make_shuffled_grid(const uint32_t in_size)
+{
+	std::vector<Triangle> triangles;
+	for(uint32_t y = 0; y < in_size; ++y)
+	{
+		for(uint32_t x = 0; x < in_size; ++x)
+		{
+			const uint32_t corner = y * (in_size + 1) + x;
+			triangles.push_back({ corner, corner + 1, corner + in_size + 1 });
+			triangles.push_back({ corner + 1, corner + in_size + 2, corner + in_size + 1 });
+		}
+	}
+
+	/** Fisher-Yates with a LCG so that the result doesn't depend on the standard library */
+	uint32_t state = 1234;
+	for(size_t i = triangles.size() - 1; i > 0; --i)
+	{
+		state = state * 1664525u + 1013904223u;
+		std::swap(triangles[i], triangles[state % (i + 1)]);
+	}
+
+	std::vector<uint32_t> indices;
+	for(const auto& triangle : triangles)
+		indices.insert(indices.end(), triangle.begin(), triangle.end());
+	return indices;
+}
+
+/** Triangles rotated so that their smallest index comes first (keeping the winding), then sorted */
+std::vector<Triangle> get_canonical_triangles(const std::span<const uint32_t>& in_indices)
+{
+	std::vector<Triangle> triangles;
+	for(size_t i = 0; i < in_indices.size(); i += 3)
+	{
+		Triangle triangle = { in_indices[i], in_indices[i + 1], in_indices[i + 2] };
+		std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+		triangles.push_back(triangle);
+	}
+	std::sort(triangles.begin(), triangles.end());
+	return triangles;
+}
+
+template<typename T>
+std::vector<uint8_t> to_bytes(const std::vector<T>& in_values)
+{
+	std::vector<uint8_t> bytes(in_values.size() * sizeof(T));
+	memcpy(bytes.data(), in_values.data(), bytes.size());
+	return bytes;
+}
+
+constexpr uint32_t grid_size = 32;
+constexpr size_t grid_vertex_count = (grid_size + 1) * (grid_size + 1);
+
+}
+
+CB_TEST(optimize_vertex_cache_preserves_triangles)
+{
+	const auto indices = make_shuffled_grid(grid_size);
+	std::vector<uint32_t> optimized(indices.size());
+	optimize_vertex_cache(optimized, indices, grid_vertex_count);
+
+	CB_TEST_CHECK(get_canonical_triangles(optimized) == get_canonical_triangles(indices));
+}
+
+CB_TEST(optimize_vertex_cache_reduces_acmr)
+{
+	const auto indices = make_shuffled_grid(grid_size);
+	std::vector<uint32_t> optimized(indices.size());
+	optimize_vertex_cache(optimized, indices, grid_vertex_count);
+
+	const VertexCacheStatistics before = analyze_vertex_cache(indices, grid_vertex_count);
+	const VertexCacheStatistics after = analyze_vertex_cache(optimized, grid_vertex_count);
+	CB_TEST_CHECK(after.vertices_transformed < before.vertices_transformed);
+	CB_TEST_CHECK(after.acmr < before.acmr);
+
+	/** A regular grid is close to 0.5 when optimized, random orders are above 2 */
+	CB_TEST_CHECK(before.acmr > 2.f);
+	CB_TEST_CHECK(after.acmr < 1.f);
+	CB_TEST_CHECK(after.atvr >= 1.f);
+}
+
+CB_TEST(optimize_vertex_cache_is_deterministic)
+{
+	const auto indices = make_shuffled_grid(grid_size);
+	std::vector<uint32_t> first(indices.size());
+	std::vector<uint32_t> second(indices.size());
+	optimize_vertex_cache(first, indices, grid_vertex_count);
+	optimize_vertex_cache(second, indices, grid_vertex_count);
+
+	CB_TEST_CHECK(first == second);
+}
+
+CB_TEST(analyze_vertex_cache_counts_misses)
+{
+	/** Two triangles sharing an edge: 4 unique vertices, all of them fit in the cache */
+	const std::vector<uint32_t> indices = { 0, 1, 2, 2, 1, 3 };
+	const VertexCacheStatistics statistics = analyze_vertex_cache(indices, 4);
+	CB_TEST_CHECK(statistics.vertices_transformed == 4);
+	CB_TEST_CHECK(statistics.acmr == 2.f);
+	CB_TEST_CHECK(statistics.atvr == 1.f);
+
+	/** FIFO of 3 vertices: transforming 3 evicts 0, transforming 0 again evicts 1, 3 is still cached */
+	const std::vector<uint32_t> revisit = { 0, 1, 2, 1, 2, 3, 0, 1, 3 };
+	CB_TEST_CHECK(analyze_vertex_cache(revisit, 4, 3).vertices_transformed == 6);
+}
+
+CB_TEST(generate_vertex_remap_welds_duplicates)
+{
+	/** An unindexed quad, corners 0 and 3 and corners 2 and 4 are identical */
+	const auto vertices = to_bytes<float>({ 0, 0, 1, 0, 1, 1, 0, 0, 1, 1, 0, 1 });
+	std::vector<uint32_t> remap(6);
+	const size_t unique_count = generate_vertex_remap(remap, {}, vertices, 2 * sizeof(float));
+
+	CB_TEST_CHECK(unique_count == 4);
+	CB_TEST_CHECK(remap == std::vector<uint32_t>({ 0, 1, 2, 0, 2, 3 }));
+
+	std::vector<uint8_t> welded(unique_count * 2 * sizeof(float));
+	remap_vertex_buffer(welded, vertices, 2 * sizeof(float), remap);
+	CB_TEST_CHECK(welded == to_bytes<float>({ 0, 0, 1, 0, 1, 1, 0, 1 }));
+
+	std::vector<uint32_t> indices(remap.size());
+	remap_index_buffer(indices, {}, remap);
+	CB_TEST_CHECK(indices == remap);
+}
+
+CB_TEST(generate_vertex_remap_skips_unreferenced_vertices)
+{
+	const auto vertices = to_bytes<float>({ 0, 1, 2, 1 });
+	const std::vector<uint32_t> indices = { 3, 1, 3 };
+	std::vector<uint32_t> remap(4);
+	const size_t unique_count = generate_vertex_remap(remap, indices, vertices, sizeof(float));
+
+	/** 1 and 3 are identical, 0 and 2 are never referenced */
+	CB_TEST_CHECK(unique_count == 1);
+	CB_TEST_CHECK(remap == std::vector<uint32_t>({ ~0u, 0, ~0u, 0 }));
+
+	std::vector<uint32_t> remapped(indices.size());
+	remap_index_buffer(remapped, indices, remap);
+	CB_TEST_CHECK(remapped == std::vector<uint32_t>({ 0, 0, 0 }));
+}
+
+CB_TEST(optimize_vertex_fetch_remap_orders_by_first_use)
+{
+	const std::vector<uint32_t> indices = { 5, 2, 5, 7, 2, 0 };
+	std::vector<uint32_t> remap(8);
+	const size_t vertex_count = optimize_vertex_fetch_remap(remap, indices);
+
+	CB_TEST_CHECK(vertex_count == 4);
+	CB_TEST_CHECK(remap == std::vector<uint32_t>({ 3, ~0u, 1, ~0u, ~0u, 0, ~0u, 2 }));
+}
+
+CB_TEST(optimize_mesh_keeps_triangles)
+{
+	/** Every corner of the grid gets its own vertex, storing its grid index so triangles can be compared */
+	const auto indices = make_shuffled_grid(grid_size);
+	const auto vertices = to_bytes(indices);
+	const OptimizedMesh mesh = optimize_mesh(vertices, sizeof(uint32_t));
+
+	CB_TEST_CHECK(mesh.vertex_count == grid_vertex_count);
+	CB_TEST_CHECK(mesh.vertices.size() == grid_vertex_count * sizeof(uint32_t));
+	CB_TEST_CHECK(mesh.indices.size() == indices.size());
+
+	std::vector<uint32_t> resolved(mesh.indices.size());
+	for(size_t i = 0; i < mesh.indices.size(); ++i)
+		memcpy(&resolved[i], mesh.vertices.data() + mesh.indices[i] * sizeof(uint32_t), sizeof(uint32_t));
+	CB_TEST_CHECK(get_canonical_triangles(resolved) == get_canonical_triangles(indices));
+
+	/** Vertices are ordered by first use */
+	for(size_t i = 0, next_vertex = 0; i < mesh.indices.size(); ++i)
+	{
+		CB_TEST_CHECK(mesh.indices[i] <= next_vertex);
+		next_vertex = std::max<size_t>(next_vertex, mesh.indices[i] + 1);
+	}
+}
+
+CB_TEST(encode_indices_uses_the_index_type)
+{
+	CB_TEST_CHECK(select_index_type(65536) == gfx::IndexType::Uint16);
+	CB_TEST_CHECK(select_index_type(65537) == gfx::IndexType::Uint32);
+
+	const std::vector<uint32_t> indices = { 0, 1, 65535 };
+	CB_TEST_CHECK(encode_indices(indices, gfx::IndexType::Uint16) == to_bytes<uint16_t>({ 0, 1, 65535 }));
+	CB_TEST_CHECK(encode_indices(indices, gfx::IndexType::Uint32) == to_bytes(indices));
+}
+
+CB_TEST_MAIN()
@@ -0,0 +1,214 @@
+#include "Test.hpp"
+#include "engine/mesh/VertexQuantization.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace cb;
+using namespace cb::mesh;
+
+namespace
+{
+
+/** Reference decoders, following the Vulkan specification conversion rules */
+
+float decode_snorm(const int32_t in_value, const uint32_t in_bits)
+{
+	return std::max(static_cast<float>(in_value) / static_cast<float>((1 << (in_bits - 1)) - 1), -1.f);
+}
+
+int32_t sign_extend(const uint32_t in_value, const uint32_t in_bits)
+{
+	const uint32_t sign_bit = 1u << (in_bits - 1);
+	return static_cast<int32_t>(in_value ^ sign_bit) - static_cast<int32_t>(sign_bit);
+}
+
+float decode_half(const uint16_t in_value)
+{
+	const float sign = (in_value & 0x8000) ? -1.f : 1.f;
+	const int32_t exponent = (in_value >> 10) & 0x1f;
+	const int32_t mantissa = in_value & 0x3ff;
+	if(exponent == 0x1f)
+		return mantissa ? std::numeric_limits<float>::quiet_NaN() : sign * std::numeric_limits<float>::infinity();
+	if(exponent == 0)
+		return sign * std::ldexp(static_cast<float>(mantissa), -24);
+	return sign * std::ldexp(static_cast<float>(mantissa + 1024), exponent - 25);
+}
+
+std::array<float, 3> decode_octahedral(const std::array<float, 2>& in_encoded)
+{
+	std::array<float, 3> normal = { in_encoded[0], in_encoded[1],
+		1.f - std::abs(in_encoded[0]) - std::abs(in_encoded[1]) };
+	const float t = std::max(-normal[2], 0.f);
+	normal[0] += normal[0] >= 0.f ? -t : t;
+	normal[1] += normal[1] >= 0.f ? -t : t;
+
+	const float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+	return { normal[0] / length, normal[1] / length, normal[2] / length };
+}
+
+float get_angle(const std::array<float, 3>& in_a, const std::array<float, 3>& in_b)
+{
+	const float dot = in_a[0] * in_b[0] + in_a[1] * in_b[1] + in_a[2] * in_b[2];
+	return std::acos(std::clamp(dot, -1.f, 1.f));
+}
+
+/** Fibonacci sphere, plus the axes and the octahedron edges where the folding is the most fragile */
+std::vector<std::array<float, 3>> get_test_directions()
+{
+	std::vector<std::array<float, 3>> directions = {
+		{ 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 },
+		{ 0.70710678f, 0.70710678f, 0 }, { -0.70710678f, 0, -0.70710678f }, { 0, -0.70710678f, -0.70710678f },
+	};
+
+	constexpr size_t count = 1000;
+	const float golden_angle = 2.39996323f;
+	for(size_t i = 0; i < count; ++i)
+	{
+		const float z = 1.f - 2.f * (static_cast<float>(i) + 0.5f) / count;
+		const float radius = std::sqrt(1.f - z * z);
+		const float phi = golden_angle * static_cast<float>(i);
+		directions.push_back({ radius * std::cos(phi), radius * std::sin(phi), z });
+	}
+
+	return directions;
+}
+
+}
+
+CB_TEST(compute_position_quantization_bounds)
+{
+	const PositionQuantization quantization = compute_position_quantization({ -1, 0, 2 }, { 3, 1, 4 });
+	CB_TEST_CHECK((quantization.offset == std::array<float, 3>{ 1, 0.5f, 3 }));
+	CB_TEST_CHECK(quantization.scale == 2.f);
+
+	/** Every position of the bounds round-trips through snorm16 */
+	for(const auto& position : { std::array<float, 3>{ -1, 0, 2 }, std::array<float, 3>{ 3, 1, 4 },
+		std::array<float, 3>{ 0.123f, 0.456f, 3.789f } })
+	{
+		for(size_t i = 0; i < 3; ++i)
+		{
+			const int16_t quantized = quantize_snorm16((position[i] - quantization.offset[i]) / quantization.scale);
+			const float decoded = quantization.offset[i] + decode_snorm(quantized, 16) * quantization.scale;
+			CB_TEST_CHECK(std::abs(decoded - position[i]) <= quantization.scale / 32767.f);
+		}
+	}
+
+	const PositionQuantization point = compute_position_quantization({ 5, 5, 5 }, { 5, 5, 5 });
+	CB_TEST_CHECK((point.offset == std::array<float, 3>{ 5, 5, 5 }));
+	CB_TEST_CHECK(point.scale == 1.f);
+}
+
+CB_TEST(quantize_snorm16_round_trip)
+{
+	CB_TEST_CHECK(quantize_snorm16(1.f) == 32767);
+	CB_TEST_CHECK(quantize_snorm16(-1.f) == -32767);
+	CB_TEST_CHECK(quantize_snorm16(0.f) == 0);
+	CB_TEST_CHECK(quantize_snorm16(2.f) == 32767);
+	CB_TEST_CHECK(quantize_snorm16(-2.f) == -32767);
+
+	for(int32_t i = -10000; i <= 10000; ++i)
+	{
+		const float value = static_cast<float>(i) / 10000.f;
+		CB_TEST_CHECK(std::abs(decode_snorm(quantize_snorm16(value), 16) - value) <= 0.5f / 32767.f + 1e-7f);
+	}
+}
+
+CB_TEST(quantize_half_exact_values)
+{
+	CB_TEST_CHECK(quantize_half(0.f) == 0x0000);
+	CB_TEST_CHECK(quantize_half(-0.f) == 0x8000);
+	CB_TEST_CHECK(quantize_half(1.f) == 0x3c00);
+	CB_TEST_CHECK(quantize_half(0.5f) == 0x3800);
+	CB_TEST_CHECK(quantize_half(-2.f) == 0xc000);
+	CB_TEST_CHECK(quantize_half(65504.f) == 0x7bff);
+	CB_TEST_CHECK(quantize_half(std::ldexp(1.f, -14)) == 0x0400);
+	CB_TEST_CHECK(quantize_half(std::ldexp(1.f, -24)) == 0x0001);
+}
+
+CB_TEST(quantize_half_rounds_to_nearest_even)
+{
+	/** Halfway between 1 and the next half rounds down to the even mantissa, halfway above it rounds up */
+	CB_TEST_CHECK(quantize_half(1.f + std::ldexp(1.f, -11)) == 0x3c00);
+	CB_TEST_CHECK(quantize_half(1.f + 3.f * std::ldexp(1.f, -11)) == 0x3c02);
+	CB_TEST_CHECK(quantize_half(1.f + std::ldexp(1.f, -11) + std::ldexp(1.f, -20)) == 0x3c01);
+
+	/** Same in the subnormal range */
+	CB_TEST_CHECK(quantize_half(std::ldexp(1.f, -25)) == 0x0000);
+	CB_TEST_CHECK(quantize_half(3.f * std::ldexp(1.f, -25)) == 0x0002);
+	CB_TEST_CHECK(quantize_half(std::ldexp(1.f, -26)) == 0x0000);
+
+	/** The largest subnormal rounds up into the smallest normal, the largest half rounds up to infinity */
+	CB_TEST_CHECK(quantize_half(std::ldexp(1.f, -14) - std::ldexp(1.f, -25)) == 0x0400);
+	CB_TEST_CHECK(quantize_half(65520.f) == 0x7c00);
+	CB_TEST_CHECK(quantize_half(65519.f) == 0x7bff);
+}
+
+CB_TEST(quantize_half_special_values)
+{
+	CB_TEST_CHECK(quantize_half(std::numeric_limits<float>::infinity()) == 0x7c00);
+	CB_TEST_CHECK(quantize_half(-std::numeric_limits<float>::infinity()) == 0xfc00);
+	CB_TEST_CHECK(quantize_half(1e10f) == 0x7c00);
+	CB_TEST_CHECK(quantize_half(-1e10f) == 0xfc00);
+	CB_TEST_CHECK(quantize_half(1e-10f) == 0x0000);
+	CB_TEST_CHECK(quantize_half(-1e-10f) == 0x8000);
+
+	const uint16_t nan = quantize_half(std::numeric_limits<float>::quiet_NaN());
+	CB_TEST_CHECK((nan & 0x7c00) == 0x7c00 && (nan & 0x3ff) != 0);
+}
+
+CB_TEST(quantize_half_round_trip)
+{
+	/** Every finite half is exactly representable as a float and must encode back to itself */
+	for(uint32_t i = 0; i <= 0xffff; ++i)
+	{
+		const uint16_t half = static_cast<uint16_t>(i);
+		if((half & 0x7c00) == 0x7c00)
+			continue;
+
+		CB_TEST_CHECK(quantize_half(decode_half(half)) == half);
+	}
+}
+
+CB_TEST(pack_snorm_10_10_10_2_round_trip)
+{
+	const uint32_t packed = pack_snorm_10_10_10_2(1.f, -1.f, 0.f, -1.f);
+	CB_TEST_CHECK((packed & 0x3ff) == 511);
+	CB_TEST_CHECK(sign_extend((packed >> 10) & 0x3ff, 10) == -511);
+	CB_TEST_CHECK(((packed >> 20) & 0x3ff) == 0);
+	CB_TEST_CHECK(sign_extend(packed >> 30, 2) == -1);
+
+	CB_TEST_CHECK(sign_extend(pack_snorm_10_10_10_2(0.f, 0.f, 0.f, 1.f) >> 30, 2) == 1);
+	CB_TEST_CHECK((pack_snorm_10_10_10_2(0.f, 0.f, 0.f) >> 30) == 0);
+
+	for(int32_t i = -1000; i <= 1000; ++i)
+	{
+		const float value = static_cast<float>(i) / 1000.f;
+		const uint32_t vector = pack_snorm_10_10_10_2(value, -value, value * 0.5f);
+		CB_TEST_CHECK(std::abs(decode_snorm(sign_extend(vector & 0x3ff, 10), 10) - value) <= 0.5f / 511.f + 1e-6f);
+		CB_TEST_CHECK(std::abs(decode_snorm(sign_extend((vector >> 10) & 0x3ff, 10), 10) + value) <= 0.5f / 511.f + 1e-6f);
+		CB_TEST_CHECK(std::abs(decode_snorm(sign_extend((vector >> 20) & 0x3ff, 10), 10) - value * 0.5f) <= 0.5f / 511.f + 1e-6f);
+	}
+}
+
+CB_TEST(encode_octahedral_round_trip)
+{
+	for(const auto& direction : get_test_directions())
+	{
+		const std::array<float, 2> encoded = encode_octahedral(direction[0], direction[1], direction[2]);
+		CB_TEST_CHECK(std::abs(encoded[0]) <= 1.f && std::abs(encoded[1]) <= 1.f);
+		CB_TEST_CHECK(get_angle(decode_octahedral(encoded), direction) < 1e-3f);
+
+		/** Stored as R16G16Snorm */
+		const std::array<float, 2> quantized = { decode_snorm(quantize_snorm16(encoded[0]), 16),
+			decode_snorm(quantize_snorm16(encoded[1]), 16) };
+		CB_TEST_CHECK(get_angle(decode_octahedral(quantized), direction) < 1e-3f);
+	}
+
+	/** Non-normalized inputs are accepted */
+	CB_TEST_CHECK(get_angle(decode_octahedral(encode_octahedral(0.f, -3.f, -4.f)), { 0.f, -0.6f, -0.8f }) < 1e-3f);
+	CB_TEST_CHECK((encode_octahedral(0.f, 0.f, 0.f) == std::array<float, 2>{ 0.f, 0.f }));
+}
+
+CB_TEST_MAIN()
@@ -0,0 +1,154 @@
+#include "Test.hpp"
+#include "engine/shadercompiler/ShaderCompiler.hpp"
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace cb;
+using namespace cb::shadercompiler;
+
+namespace
+{
+
+/** Cache keys only read the sources, DXC isn't required (its version is hashed as "unavailable") */
+
+const std::filesystem::path& get_test_dir()
+{
+	static const std::filesystem::path dir = []()
+	{
+		const auto path = std::filesystem::temp_directory_path() / "cb_test_shadercompiler";
+		std::filesystem::create_directories(path / "include");
+		return path;
+	}();
+
+	return dir;
+}
+
+std::string write_source(const std::string_view& in_name, const std::string_view& in_source)
+{
+	const auto path = get_test_dir() / in_name;
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	file.write(in_source.data(), in_source.size());
+	return path.string();
+}
+
+/** A fragment shader including a local file, which includes a file from the include directory */
+ShaderCompileInfo make_test_shader()
+{
+	write_source("include/common.hlsli", "float4 get_color() { return 1; }\n");
+	write_source("local.hlsli", "#include <common.hlsli>\n");
+	return ShaderCompileInfo(write_source("shader.hlsl", "#include \"local.hlsli\"\nfloat4 main() : SV_Target { return get_color(); }\n"),
+		gfx::ShaderStageFlagBits::Fragment);
+}
+
+std::vector<std::string> get_include_dirs()
+{
+	return { (get_test_dir() / "include").string() };
+}
+
+uint64_t get_key(const ShaderCompiler& in_compiler, const ShaderCompileInfo& in_info)
+{
+	auto key = in_compiler.get_key(in_info);
+	CB_TEST_CHECK(key);
+	return key ? key.get_value() : 0;
+}
+
+}
+
+CB_TEST(key_is_stable)
+{
+	const ShaderCompileInfo info = make_test_shader();
+	const ShaderCompiler compiler("", get_include_dirs());
+	const ShaderCompiler other_compiler("", get_include_dirs());
+
+	const uint64_t key = get_key(compiler, info);
+	CB_TEST_CHECK(get_key(compiler, info) == key);
+	CB_TEST_CHECK(get_key(other_compiler, info) == key);
+}
+
+CB_TEST(key_changes_with_the_source)
+{
+	ShaderCompileInfo info = make_test_shader();
+	const ShaderCompiler compiler("", get_include_dirs());
+	const uint64_t key = get_key(compiler, info);
+
+	write_source("shader.hlsl", "#include \"local.hlsli\"\nfloat4 main() : SV_Target { return get_color() * 2; }\n");
+	CB_TEST_CHECK(get_key(compiler, info) != key);
+
+	/** Back to the original source */
+	info = make_test_shader();
+	CB_TEST_CHECK(get_key(compiler, info) == key);
+}
+
+CB_TEST(key_changes_with_the_includes)
+{
+	const ShaderCompileInfo info = make_test_shader();
+	const ShaderCompiler compiler("", get_include_dirs());
+	const uint64_t key = get_key(compiler, info);
+
+	write_source("local.hlsli", "#include <common.hlsli>\n#define LOCAL 1\n");
+	const uint64_t local_key = get_key(compiler, info);
+	CB_TEST_CHECK(local_key != key);
+
+	/** Nested include, found through the include directories */
+	write_source("include/common.hlsli", "float4 get_color() { return 0.5; }\n");
+	CB_TEST_CHECK(get_key(compiler, info) != local_key);
+	CB_TEST_CHECK(get_key(compiler, info) != key);
+
+	/** Files that aren't included don't matter */
+	const ShaderCompileInfo restored = make_test_shader();
+	write_source("unrelated.hlsli", "#error unused\n");
+	CB_TEST_CHECK(get_key(compiler, restored) == key);
+}
+
+CB_TEST(key_changes_with_the_compile_info)
+{
+	const ShaderCompileInfo info = make_test_shader();
+	const ShaderCompiler compiler("", get_include_dirs());
+	const uint64_t key = get_key(compiler, info);
+
+	ShaderCompileInfo entry_point = info;
+	entry_point.entry_point = "main2";
+	CB_TEST_CHECK(get_key(compiler, entry_point) != key);
+
+	ShaderCompileInfo stage = info;
+	stage.stage = gfx::ShaderStageFlagBits::Vertex;
+	CB_TEST_CHECK(get_key(compiler, stage) != key);
+
+	ShaderCompileInfo shader_model = info;
+	shader_model.shader_model = gfx::ShaderModel::SM6_5;
+	CB_TEST_CHECK(get_key(compiler, shader_model) != key);
+
+	ShaderCompileInfo define = info;
+	define.defines = { ShaderDefine("USE_FOG") };
+	const uint64_t define_key = get_key(compiler, define);
+	CB_TEST_CHECK(define_key != key);
+
+	define.defines = { ShaderDefine("USE_FOG", "0") };
+	CB_TEST_CHECK(get_key(compiler, define) != define_key);
+
+	/** Fields are size prefixed, moving characters from a name to a value changes the key */
+	ShaderCompileInfo split_a = info;
+	split_a.defines = { ShaderDefine("ab", "c") };
+	ShaderCompileInfo split_b = info;
+	split_b.defines = { ShaderDefine("a", "bc") };
+	CB_TEST_CHECK(get_key(compiler, split_a) != get_key(compiler, split_b));
+}
+
+CB_TEST(key_changes_with_the_include_dirs)
+{
+	const ShaderCompileInfo info = make_test_shader();
+	const ShaderCompiler compiler("", get_include_dirs());
+	const ShaderCompiler other_compiler("", { (get_test_dir() / "include").string(), get_test_dir().string() });
+	CB_TEST_CHECK(get_key(compiler, info) != get_key(other_compiler, info));
+}
+
+CB_TEST(key_of_a_missing_file)
+{
+	const ShaderCompiler compiler("", {});
+	auto key = compiler.get_key(ShaderCompileInfo((get_test_dir() / "missing.hlsl").string()));
+	CB_TEST_CHECK(!key && !key.get_error().empty());
+}
+
+CB_TEST_MAIN()
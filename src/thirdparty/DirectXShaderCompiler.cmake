@@ -2,14 +2,22 @@
 # It was working but every CMake invocation required a full rebuild)
 # And I don't want to manage a seperate build system to build 3rd party libs
 
-CPMAddPackage(
-	NAME DirectXShaderCompiler 
-	URL https://github.com/microsoft/DirectXShaderCompiler/releases/download/v1.6.2106/dxc_2021_07_01.zip)
+if(WIN32)
+	CPMAddPackage(
+		NAME DirectXShaderCompiler 
+		URL https://github.com/microsoft/DirectXShaderCompiler/releases/download/v1.6.2106/dxc_2021_07_01.zip)
 
-file(COPY ${DirectXShaderCompiler_SOURCE_DIR}/bin/x64/dxcompiler.dll DESTINATION ${CB_BIN_DIR})
-set(DXC_ROOT_DIR ${DirectXShaderCompiler_SOURCE_DIR} CACHE STRING "" FORCE)
-set(DXC_INCLUDE_DIR ${DXC_ROOT_DIR}/inc CACHE STRING "" FORCE)
-set(DXC_LIB_DIR ${DXC_ROOT_DIR}/lib/x64 CACHE STRING "" FORCE)
+	file(COPY ${DirectXShaderCompiler_SOURCE_DIR}/bin/x64/dxcompiler.dll DESTINATION ${CB_BIN_DIR})
+	set(DXC_ROOT_DIR ${DirectXShaderCompiler_SOURCE_DIR} CACHE STRING "" FORCE)
+	set(DXC_INCLUDE_DIR ${DXC_ROOT_DIR}/inc CACHE STRING "" FORCE)
+	set(DXC_LIB_DIR ${DXC_ROOT_DIR}/lib/x64 CACHE STRING "" FORCE)
+else()
+	# Use the DXC shipped with the Vulkan SDK (include/dxc/dxcapi.h and libdxcompiler.so), it is loaded at runtime
+	find_path(DXC_INCLUDE_DIR dxcapi.h HINTS $ENV{VULKAN_SDK}/include PATH_SUFFIXES dxc REQUIRED)
+	find_library(DXC_LIBRARY dxcompiler HINTS $ENV{VULKAN_SDK}/lib REQUIRED)
+	get_filename_component(DXC_LIB_DIR ${DXC_LIBRARY} DIRECTORY)
+	set(DXC_LIB_DIR ${DXC_LIB_DIR} CACHE STRING "" FORCE)
+endif()
 #file(DOWNLOAD https://raw.githubusercontent.com/microsoft/DirectXShaderCompiler/master/include/dxc/Support/dxcapi.use.h 
 #	${DXC_INCLUDE_DIR}/dxcapi.use.h)
 
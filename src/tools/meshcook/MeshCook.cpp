@@ -0,0 +1,318 @@
+#include "engine/logger/Logger.hpp"
+#include "engine/logger/sinks/StdoutSink.hpp"
+#include "engine/assets/MeshFile.hpp"
+#include "engine/mesh/MeshOptimizer.hpp"
+#include "engine/mesh/VertexQuantization.hpp"
+#include <glm/glm.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#define TINYOBJLOADER_IMPLEMENTATION
+#include "tinyobjloader.h"
+
+/**
+ * cb-meshcook: offline mesh cooker
+ * Converts an OBJ file to a .cbmesh container that can be memory-mapped and uploaded as-is
+ * Vertices are welded, then triangles of each submesh are reordered for the post-transform cache and vertices
+ * for fetch locality
+ * --quantize stores 16-byte vertices: snorm16 positions relative to the bounds (see mesh::PositionQuantization),
+ * half texcoords and 10-10-10-2 normals. --oct-normals stores octahedral normals instead, which must be decoded
+ * by the vertex shader
+ */
+
+using namespace cb;
+
+CB_DEFINE_LOG_CATEGORY(meshcook);
+
+/** Matches the vertex layout expected by the game shaders */
+struct Vertex
+{
+	glm::vec3 position;
+	glm::vec2 texcoord;
+	glm::vec3 normal;
+};
+
+struct QuantizedVertex
+{
+	/** W is padding, keeps the attribute a 4 components format */
+	std::array<int16_t, 4> position;
+	std::array<uint16_t, 2> texcoord;
+
+	/** A2B10G10R10 or octahedral RG16 */
+	uint32_t normal;
+};
+
+static_assert(sizeof(QuantizedVertex) == 16);
+
+enum class NormalEncoding
+{
+	Packed,
+	Octahedral,
+};
+
+struct Options
+{
+	std::string input;
+	std::string output;
+	bool optimize = true;
+	bool quantize = false;
+	NormalEncoding normal_encoding = NormalEncoding::Packed;
+};
+
+void print_usage()
+{
+	logger::info(log_meshcook, "Usage: cb-meshcook <input.obj> <output.cbmesh> [--no-optimize] [--quantize] [--oct-normals]");
+}
+
+bool parse_options(int argc, char** argv, Options& out_options)
+{
+	if(argc < 3)
+		return false;
+
+	out_options.input = argv[1];
+	out_options.output = argv[2];
+
+	for(int i = 3; i < argc; ++i)
+	{
+		const std::string_view arg = argv[i];
+		if(arg == "--no-optimize")
+		{
+			out_options.optimize = false;
+		}
+		else if(arg == "--quantize")
+		{
+			out_options.quantize = true;
+		}
+		else if(arg == "--oct-normals")
+		{
+			out_options.quantize = true;
+			out_options.normal_encoding = NormalEncoding::Octahedral;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+std::vector<uint8_t> quantize_vertices(const std::span<const Vertex>& in_vertices,
+	const mesh::PositionQuantization& in_quantization,
+	const NormalEncoding in_normal_encoding)
+{
+	std::vector<uint8_t> data(in_vertices.size() * sizeof(QuantizedVertex));
+	QuantizedVertex* vertices = reinterpret_cast<QuantizedVertex*>(data.data());
+	for(size_t i = 0; i < in_vertices.size(); ++i)
+	{
+		const Vertex& vertex = in_vertices[i];
+		QuantizedVertex& quantized_vertex = vertices[i];
+		quantized_vertex.position = {
+			mesh::quantize_snorm16((vertex.position.x - in_quantization.offset[0]) / in_quantization.scale),
+			mesh::quantize_snorm16((vertex.position.y - in_quantization.offset[1]) / in_quantization.scale),
+			mesh::quantize_snorm16((vertex.position.z - in_quantization.offset[2]) / in_quantization.scale),
+			0
+		};
+		quantized_vertex.texcoord = { 
+			mesh::quantize_half(vertex.texcoord.x), 
+			mesh::quantize_half(vertex.texcoord.y) 
+		};
+
+		if(in_normal_encoding == NormalEncoding::Octahedral)
+		{
+			const auto octahedral = mesh::encode_octahedral(vertex.normal.x, vertex.normal.y, vertex.normal.z);
+			quantized_vertex.normal = static_cast<uint16_t>(mesh::quantize_snorm16(octahedral[0])) |
+				(static_cast<uint32_t>(static_cast<uint16_t>(mesh::quantize_snorm16(octahedral[1]))) << 16);
+		}
+		else
+		{
+			quantized_vertex.normal = mesh::pack_snorm_10_10_10_2(vertex.normal.x, vertex.normal.y, vertex.normal.z);
+		}
+	}
+
+	return data;
+}
+
+int main(int argc, char** argv)
+{
+	logger::set_pattern("[{time}] [{severity}] ({category}) {message}");
+	logger::add_sink(std::make_unique<logger::StdoutSink>());
+
+	Options options;
+	if(!parse_options(argc, argv, options))
+	{
+		print_usage();
+		return -1;
+	}
+
+	const std::string& input = options.input;
+	const std::string& output = options.output;
+
+	const auto start_time = std::chrono::high_resolution_clock::now();
+
+	tinyobj::attrib_t attrib;
+	std::vector<tinyobj::shape_t> shapes;
+	std::vector<tinyobj::material_t> materials;
+	std::string warn, err;
+	if(!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, input.c_str()))
+	{
+		logger::error(log_meshcook, "Failed to load {}: {}", input, err);
+		return -1;
+	}
+
+	if(!warn.empty())
+		logger::warn(log_meshcook, "{}", warn);
+
+	std::vector<Vertex> vertices;
+	std::vector<uint32_t> indices;
+	std::vector<assets::MeshFileSubmesh> submeshes;
+
+	glm::vec3 bounds_min(std::numeric_limits<float>::max());
+	glm::vec3 bounds_max(std::numeric_limits<float>::lowest());
+
+	for(const auto& shape : shapes)
+	{
+		assets::MeshFileSubmesh submesh;
+		submesh.first_index = static_cast<uint32_t>(indices.size());
+		submesh.index_count = static_cast<uint32_t>(shape.mesh.indices.size());
+		submesh.vertex_offset = 0;
+		submesh.material_index = shape.mesh.material_ids.empty() ? 0 : std::max(shape.mesh.material_ids[0], 0);
+		submeshes.push_back(submesh);
+
+		for(const auto& index : shape.mesh.indices)
+		{
+			Vertex vertex = {};
+			vertex.position = {
+				attrib.vertices[3 * index.vertex_index + 0],
+				attrib.vertices[3 * index.vertex_index + 1],
+				attrib.vertices[3 * index.vertex_index + 2]
+			};
+
+			if(index.texcoord_index >= 0)
+			{
+				vertex.texcoord = {
+					attrib.texcoords[2 * index.texcoord_index + 0],
+					1.f - attrib.texcoords[2 * index.texcoord_index + 1]
+				};
+			}
+
+			if(index.normal_index >= 0)
+			{
+				vertex.normal = {
+					attrib.normals[3 * index.normal_index + 0],
+					attrib.normals[3 * index.normal_index + 1],
+					attrib.normals[3 * index.normal_index + 2]
+				};
+			}
+
+			bounds_min = glm::min(bounds_min, vertex.position);
+			bounds_max = glm::max(bounds_max, vertex.position);
+
+			indices.push_back(static_cast<uint32_t>(vertices.size()));
+			vertices.push_back(vertex);
+		}
+	}
+
+	if(vertices.empty())
+	{
+		logger::error(log_meshcook, "{} doesn't contain any triangle", input);
+		return -1;
+	}
+
+	const std::span<const uint8_t> corner_data(reinterpret_cast<const uint8_t*>(vertices.data()), 
+		vertices.size() * sizeof(Vertex));
+	const mesh::VertexCacheStatistics source_statistics = mesh::analyze_vertex_cache(indices, vertices.size());
+
+	std::vector<uint8_t> vertex_data(corner_data.begin(), corner_data.end());
+	size_t vertex_count = vertices.size();
+	if(options.optimize)
+	{
+		std::vector<uint32_t> remap(vertex_count);
+		const size_t unique_count = mesh::generate_vertex_remap(remap, indices, corner_data, sizeof(Vertex));
+		mesh::remap_index_buffer(indices, indices, remap);
+		vertex_data.resize(unique_count * sizeof(Vertex));
+		mesh::remap_vertex_buffer(vertex_data, corner_data, sizeof(Vertex), remap);
+
+		/** Reorder each submesh separately so their index ranges are preserved */
+		std::vector<uint32_t> cache_optimized_indices(indices.size());
+		for(const auto& submesh : submeshes)
+		{
+			mesh::optimize_vertex_cache(std::span(cache_optimized_indices).subspan(submesh.first_index, submesh.index_count),
+				std::span<const uint32_t>(indices).subspan(submesh.first_index, submesh.index_count),
+				unique_count);
+		}
+
+		remap.resize(unique_count);
+		vertex_count = mesh::optimize_vertex_fetch_remap(remap, cache_optimized_indices);
+		mesh::remap_index_buffer(indices, cache_optimized_indices, remap);
+
+		const std::vector<uint8_t> welded_data = std::move(vertex_data);
+		vertex_data.resize(vertex_count * sizeof(Vertex));
+		mesh::remap_vertex_buffer(vertex_data, welded_data, sizeof(Vertex), remap);
+	}
+
+	const mesh::VertexCacheStatistics statistics = mesh::analyze_vertex_cache(indices, vertex_count);
+
+	assets::MeshData mesh_data;
+	mesh_data.index_type = mesh::select_index_type(vertex_count);
+	mesh_data.submeshes = std::move(submeshes);
+	mesh_data.indices = mesh::encode_indices(indices, mesh_data.index_type);
+	mesh_data.bounds_min = { bounds_min.x, bounds_min.y, bounds_min.z };
+	mesh_data.bounds_max = { bounds_max.x, bounds_max.y, bounds_max.z };
+
+	if(options.quantize)
+	{
+		const mesh::PositionQuantization quantization = mesh::compute_position_quantization(mesh_data.bounds_min, 
+			mesh_data.bounds_max);
+		mesh_data.streams.push_back({ sizeof(QuantizedVertex), 
+			quantize_vertices({ reinterpret_cast<const Vertex*>(vertex_data.data()), vertex_count }, 
+				quantization, 
+				options.normal_encoding) });
+		mesh_data.attributes = {
+			gfx::VertexInputAttributeDescription(0, 0, gfx::Format::R16G16B16A16Snorm, offsetof(QuantizedVertex, position)),
+			gfx::VertexInputAttributeDescription(1, 0, gfx::Format::R16G16Sfloat, offsetof(QuantizedVertex, texcoord)),
+			gfx::VertexInputAttributeDescription(2, 0, 
+				options.normal_encoding == NormalEncoding::Octahedral ? gfx::Format::R16G16Snorm : gfx::Format::A2B10G10R10SnormPack32, 
+				offsetof(QuantizedVertex, normal)),
+		};
+	}
+	else
+	{
+		mesh_data.streams.push_back({ sizeof(Vertex), std::move(vertex_data) });
+		mesh_data.attributes = {
+			gfx::VertexInputAttributeDescription(0, 0, gfx::Format::R32G32B32Sfloat, offsetof(Vertex, position)),
+			gfx::VertexInputAttributeDescription(1, 0, gfx::Format::R32G32Sfloat, offsetof(Vertex, texcoord)),
+			gfx::VertexInputAttributeDescription(2, 0, gfx::Format::R32G32B32Sfloat, offsetof(Vertex, normal)),
+		};
+	}
+
+	auto result = assets::save_mesh_file(output, mesh_data);
+	if(!result)
+	{
+		logger::error(log_meshcook, "Failed to write {}: {}", output, std::to_string(result.get_error()));
+		return -1;
+	}
+
+	const auto cook_time = std::chrono::duration<float, std::milli>(
+		std::chrono::high_resolution_clock::now() - start_time).count();
+
+	logger::info(log_meshcook, "{} -> {} ({} -> {} vertices of {} bytes, {} indices ({}), {} submeshes): {} KiB in {:.2f} ms",
+		input,
+		output,
+		vertices.size(),
+		vertex_count,
+		mesh_data.streams[0].stride,
+		indices.size(),
+		mesh_data.index_type == gfx::IndexType::Uint16 ? "16-bit" : "32-bit",
+		mesh_data.submeshes.size(),
+		result.get_value() / 1024,
+		cook_time);
+	logger::info(log_meshcook, "ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f} (FIFO 16)",
+		source_statistics.acmr,
+		statistics.acmr,
+		source_statistics.atvr,
+		statistics.atvr);
+
+	return 0;
+}
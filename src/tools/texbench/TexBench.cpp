@@ -0,0 +1,139 @@
+#include "engine/logger/Logger.hpp"
+#include "engine/logger/sinks/StdoutSink.hpp"
+#include "engine/assets/TextureFile.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+/**
+ * cb-texbench: texture loading benchmark
+ * Compares the CPU side of the startup texture path: decoding a source image with stb_image versus mapping the
+ * .cbtex cooked by cb-texcook, both followed by the copy to a staging buffer done by Device::create_texture
+ * The first iteration is reported separately as it is the closest to a cold start
+ */
+
+using namespace cb;
+
+CB_DEFINE_LOG_CATEGORY(texbench);
+
+struct Timings
+{
+	float first_ms = 0.f;
+	std::vector<float> samples_ms;
+	uint64_t uploaded_bytes = 0;
+};
+
+template<typename F>
+bool run(const uint32_t in_iterations, Timings& out_timings, F&& in_func)
+{
+	for(uint32_t i = 0; i < in_iterations; ++i)
+	{
+		const auto start_time = std::chrono::high_resolution_clock::now();
+		if(!in_func())
+			return false;
+		const float elapsed = std::chrono::duration<float, std::milli>(
+			std::chrono::high_resolution_clock::now() - start_time).count();
+
+		if(i == 0)
+			out_timings.first_ms = elapsed;
+		else
+			out_timings.samples_ms.push_back(elapsed);
+	}
+
+	return true;
+}
+
+void report(const std::string_view& in_name, Timings& in_timings)
+{
+	float median = in_timings.first_ms;
+	float average = in_timings.first_ms;
+	if(!in_timings.samples_ms.empty())
+	{
+		std::sort(in_timings.samples_ms.begin(), in_timings.samples_ms.end());
+		median = in_timings.samples_ms[in_timings.samples_ms.size() / 2];
+
+		average = 0.f;
+		for(const float sample : in_timings.samples_ms)
+			average += sample;
+		average /= static_cast<float>(in_timings.samples_ms.size());
+	}
+
+	logger::info(log_texbench, "{}: first {:.3f} ms, median {:.3f} ms, average {:.3f} ms, {} KiB uploaded",
+		in_name,
+		in_timings.first_ms,
+		median,
+		average,
+		in_timings.uploaded_bytes / 1024);
+}
+
+int main(int argc, char** argv)
+{
+	logger::set_pattern("[{time}] [{severity}] ({category}) {message}");
+	logger::add_sink(std::make_unique<logger::StdoutSink>());
+
+	if(argc < 2)
+	{
+		logger::info(log_texbench, "Usage: cb-texbench <image> [iterations] (compares with <image>.cbtex)");
+		return -1;
+	}
+
+	const std::string image_path = argv[1];
+	const std::string cooked_path = std::filesystem::path(image_path).replace_extension(".cbtex").string();
+	const uint32_t iterations = argc > 2 ? std::max(std::stoi(argv[2]), 1) : 10;
+
+	/** Staging memory is reused across iterations, like a persistent staging allocator would */
+	std::vector<uint8_t> staging;
+
+	Timings image_timings;
+	const bool image_success = run(iterations, image_timings, [&]()
+	{
+		int width, height, channels;
+		stbi_uc* pixels = stbi_load(image_path.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+		if(!pixels)
+		{
+			logger::error(log_texbench, "Failed to load {}: {}", image_path, stbi_failure_reason());
+			return false;
+		}
+
+		image_timings.uploaded_bytes = static_cast<uint64_t>(width) * height * 4;
+		staging.resize(image_timings.uploaded_bytes);
+		memcpy(staging.data(), pixels, image_timings.uploaded_bytes);
+		stbi_image_free(pixels);
+		return true;
+	});
+
+	Timings cooked_timings;
+	const bool cooked_success = run(iterations, cooked_timings, [&]()
+	{
+		auto file = assets::load_texture_file(cooked_path);
+		if(!file)
+		{
+			logger::error(log_texbench, "Failed to load {}: {}", cooked_path, std::to_string(file.get_error()));
+			return false;
+		}
+
+		const auto& data = file.get_value().data;
+		cooked_timings.uploaded_bytes = data.size();
+		staging.resize(data.size());
+		memcpy(staging.data(), data.data(), data.size());
+		return true;
+	});
+
+	if(image_success)
+		report(image_path, image_timings);
+
+	if(cooked_success)
+		report(cooked_path, cooked_timings);
+
+	if(image_success && cooked_success && !cooked_timings.samples_ms.empty() && !image_timings.samples_ms.empty())
+		logger::info(log_texbench, "Cooked path is {:.1f}x faster (median), mips are already included in the cooked upload",
+			image_timings.samples_ms[image_timings.samples_ms.size() / 2] / 
+				cooked_timings.samples_ms[cooked_timings.samples_ms.size() / 2]);
+
+	return image_success && cooked_success ? 0 : -1;
+}
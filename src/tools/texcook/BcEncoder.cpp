@@ -0,0 +1,459 @@
+#include "BcEncoder.hpp"
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+/** SSE2 is part of x86-64, use it to evaluate 4 texels at once when searching palettes */
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define CB_TEXCOOK_SSE2 1
+#else
+#define CB_TEXCOOK_SSE2 0
+#endif
+
+namespace cb::texcook
+{
+
+namespace
+{
+
+/** Block texels stored per channel, so 4 texels can be processed per SIMD register */
+struct BlockSoA
+{
+	alignas(16) float channels[4][16];
+};
+
+BlockSoA to_soa(const uint8_t* in_rgba)
+{
+	BlockSoA block;
+	for(size_t i = 0; i < 16; ++i)
+		for(size_t c = 0; c < 4; ++c)
+			block.channels[c][i] = in_rgba[i * 4 + c];
+
+	return block;
+}
+
+/**
+ * Find the nearest palette entry of each texel of the block
+ */
+void find_nearest_indices(const BlockSoA& in_block,
+	const float (*in_palette)[4],
+	const size_t in_palette_size,
+	const size_t in_channel_count,
+	uint8_t* out_indices)
+{
+#if CB_TEXCOOK_SSE2
+	for(size_t i = 0; i < 16; i += 4)
+	{
+		__m128 best_dist = _mm_set1_ps(FLT_MAX);
+		__m128i best_idx = _mm_setzero_si128();
+
+		for(size_t p = 0; p < in_palette_size; ++p)
+		{
+			__m128 dist = _mm_setzero_ps();
+			for(size_t c = 0; c < in_channel_count; ++c)
+			{
+				const __m128 delta = _mm_sub_ps(_mm_load_ps(&in_block.channels[c][i]),
+					_mm_set1_ps(in_palette[p][c]));
+				dist = _mm_add_ps(dist, _mm_mul_ps(delta, delta));
+			}
+
+			const __m128i closer = _mm_castps_si128(_mm_cmplt_ps(dist, best_dist));
+			best_dist = _mm_min_ps(dist, best_dist);
+			best_idx = _mm_or_si128(_mm_andnot_si128(closer, best_idx),
+				_mm_and_si128(closer, _mm_set1_epi32(static_cast<int32_t>(p))));
+		}
+
+		alignas(16) int32_t indices[4];
+		_mm_store_si128(reinterpret_cast<__m128i*>(indices), best_idx);
+		for(size_t j = 0; j < 4; ++j)
+			out_indices[i + j] = static_cast<uint8_t>(indices[j]);
+	}
+#else
+	for(size_t i = 0; i < 16; ++i)
+	{
+		float best_dist = FLT_MAX;
+		for(size_t p = 0; p < in_palette_size; ++p)
+		{
+			float dist = 0.f;
+			for(size_t c = 0; c < in_channel_count; ++c)
+			{
+				const float delta = in_block.channels[c][i] - in_palette[p][c];
+				dist += delta * delta;
+			}
+
+			if(dist < best_dist)
+			{
+				best_dist = dist;
+				out_indices[i] = static_cast<uint8_t>(p);
+			}
+		}
+	}
+#endif
+}
+
+/**
+ * Fit a line through the block texels (principal axis) and return its extremities
+ */
+void fit_endpoints(const BlockSoA& in_block,
+	const size_t in_channel_count,
+	float out_min[4],
+	float out_max[4])
+{
+	float mean[4] = {};
+	float box_min[4] = { 255.f, 255.f, 255.f, 255.f };
+	float box_max[4] = {};
+	for(size_t c = 0; c < in_channel_count; ++c)
+	{
+		for(size_t i = 0; i < 16; ++i)
+		{
+			mean[c] += in_block.channels[c][i];
+			box_min[c] = std::min(box_min[c], in_block.channels[c][i]);
+			box_max[c] = std::max(box_max[c], in_block.channels[c][i]);
+		}
+		mean[c] /= 16.f;
+	}
+
+	float covariance[4][4] = {};
+	for(size_t i = 0; i < 16; ++i)
+		for(size_t a = 0; a < in_channel_count; ++a)
+			for(size_t b = 0; b < in_channel_count; ++b)
+				covariance[a][b] += (in_block.channels[a][i] - mean[a]) * (in_block.channels[b][i] - mean[b]);
+
+	/** Power iteration, starting from the bounding box diagonal */
+	float axis[4] = {};
+	for(size_t c = 0; c < in_channel_count; ++c)
+		axis[c] = box_max[c] - box_min[c];
+
+	for(size_t iteration = 0; iteration < 8; ++iteration)
+	{
+		float next[4] = {};
+		float max_component = 0.f;
+		for(size_t a = 0; a < in_channel_count; ++a)
+		{
+			for(size_t b = 0; b < in_channel_count; ++b)
+				next[a] += covariance[a][b] * axis[b];
+			max_component = std::max(max_component, std::abs(next[a]));
+		}
+
+		if(max_component <= FLT_EPSILON)
+			break;
+
+		for(size_t c = 0; c < in_channel_count; ++c)
+			axis[c] = next[c] / max_component;
+	}
+
+	float length = 0.f;
+	for(size_t c = 0; c < in_channel_count; ++c)
+		length += axis[c] * axis[c];
+	length = std::sqrt(length);
+
+	/** Uniform block */
+	if(length <= FLT_EPSILON)
+	{
+		for(size_t c = 0; c < 4; ++c)
+		{
+			out_min[c] = mean[c];
+			out_max[c] = mean[c];
+		}
+		return;
+	}
+
+	for(size_t c = 0; c < in_channel_count; ++c)
+		axis[c] /= length;
+
+	float min_t = FLT_MAX;
+	float max_t = -FLT_MAX;
+	for(size_t i = 0; i < 16; ++i)
+	{
+		float t = 0.f;
+		for(size_t c = 0; c < in_channel_count; ++c)
+			t += (in_block.channels[c][i] - mean[c]) * axis[c];
+		min_t = std::min(min_t, t);
+		max_t = std::max(max_t, t);
+	}
+
+	for(size_t c = 0; c < 4; ++c)
+	{
+		out_min[c] = std::clamp(mean[c] + axis[c] * min_t, 0.f, 255.f);
+		out_max[c] = std::clamp(mean[c] + axis[c] * max_t, 0.f, 255.f);
+	}
+}
+
+uint16_t pack_565(const float in_color[4])
+{
+	const auto r = static_cast<uint16_t>(std::lround(in_color[0] * 31.f / 255.f));
+	const auto g = static_cast<uint16_t>(std::lround(in_color[1] * 63.f / 255.f));
+	const auto b = static_cast<uint16_t>(std::lround(in_color[2] * 31.f / 255.f));
+	return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+void unpack_565(const uint16_t in_color, float out_color[4])
+{
+	const uint32_t r = (in_color >> 11) & 31;
+	const uint32_t g = (in_color >> 5) & 63;
+	const uint32_t b = in_color & 31;
+	out_color[0] = static_cast<float>((r << 3) | (r >> 2));
+	out_color[1] = static_cast<float>((g << 2) | (g >> 4));
+	out_color[2] = static_cast<float>((b << 3) | (b >> 2));
+	out_color[3] = 255.f;
+}
+
+void encode_bc1_color(const BlockSoA& in_block, uint8_t* out_block)
+{
+	float min_color[4];
+	float max_color[4];
+	fit_endpoints(in_block, 3, min_color, max_color);
+
+	/** Inset the endpoints a bit, the extremities are rarely hit exactly and the interpolated colors benefit from it */
+	for(size_t c = 0; c < 3; ++c)
+	{
+		const float inset = (max_color[c] - min_color[c]) / 16.f;
+		min_color[c] += inset;
+		max_color[c] -= inset;
+	}
+
+	uint16_t color0 = pack_565(max_color);
+	uint16_t color1 = pack_565(min_color);
+
+	/** color0 > color1 selects the opaque 4-color mode */
+	if(color0 < color1)
+		std::swap(color0, color1);
+
+	uint32_t index_bits = 0;
+	if(color0 != color1)
+	{
+		float palette[4][4];
+		unpack_565(color0, palette[0]);
+		unpack_565(color1, palette[1]);
+		for(size_t c = 0; c < 3; ++c)
+		{
+			palette[2][c] = (2.f * palette[0][c] + palette[1][c]) / 3.f;
+			palette[3][c] = (palette[0][c] + 2.f * palette[1][c]) / 3.f;
+		}
+
+		uint8_t indices[16];
+		find_nearest_indices(in_block, palette, 4, 3, indices);
+		for(size_t i = 0; i < 16; ++i)
+			index_bits |= static_cast<uint32_t>(indices[i]) << (i * 2);
+	}
+
+	out_block[0] = static_cast<uint8_t>(color0);
+	out_block[1] = static_cast<uint8_t>(color0 >> 8);
+	out_block[2] = static_cast<uint8_t>(color1);
+	out_block[3] = static_cast<uint8_t>(color1 >> 8);
+	for(size_t i = 0; i < 4; ++i)
+		out_block[4 + i] = static_cast<uint8_t>(index_bits >> (i * 8));
+}
+
+/** BC7 4-bit index interpolation weights */
+constexpr std::array<uint32_t, 16> bc7_weights = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+/**
+ * Quantize an endpoint to 7 bits per channel and pick the p-bit (shared LSB) minimizing the error
+ */
+void quantize_bc7_mode6_endpoint(const float in_color[4], uint8_t out_values[4], uint8_t& out_pbit)
+{
+	float best_error = FLT_MAX;
+	for(uint8_t pbit = 0; pbit < 2; ++pbit)
+	{
+		float error = 0.f;
+		uint8_t values[4];
+		for(size_t c = 0; c < 4; ++c)
+		{
+			const long quantized = std::clamp<long>(std::lround((in_color[c] - pbit) / 2.f), 0, 127);
+			const float delta = static_cast<float>((quantized << 1) | pbit) - in_color[c];
+			values[c] = static_cast<uint8_t>(quantized);
+			error += delta * delta;
+		}
+
+		if(error < best_error)
+		{
+			best_error = error;
+			out_pbit = pbit;
+			std::copy(values, values + 4, out_values);
+		}
+	}
+}
+
+/** LSB-first bit writer, the output must be zero-initialized */
+struct BitWriter
+{
+	uint8_t* data;
+	uint32_t position;
+
+	explicit BitWriter(uint8_t* in_data) : data(in_data), position(0) {}
+
+	void write(const uint32_t in_value, const uint32_t in_bit_count)
+	{
+		for(uint32_t i = 0; i < in_bit_count; ++i, ++position)
+			if((in_value >> i) & 1)
+				data[position >> 3] |= static_cast<uint8_t>(1 << (position & 7));
+	}
+};
+
+}
+
+void encode_bc1_block(const uint8_t* in_rgba, uint8_t* out_block)
+{
+	encode_bc1_color(to_soa(in_rgba), out_block);
+}
+
+void encode_bc3_block(const uint8_t* in_rgba, uint8_t* out_block)
+{
+	encode_bc4_block(in_rgba, 3, out_block);
+	encode_bc1_color(to_soa(in_rgba), out_block + 8);
+}
+
+void encode_bc4_block(const uint8_t* in_rgba, const size_t in_channel, uint8_t* out_block)
+{
+	uint8_t min_value = 255;
+	uint8_t max_value = 0;
+	for(size_t i = 0; i < 16; ++i)
+	{
+		min_value = std::min(min_value, in_rgba[i * 4 + in_channel]);
+		max_value = std::max(max_value, in_rgba[i * 4 + in_channel]);
+	}
+
+	/** value0 > value1 selects the 8 values mode */
+	out_block[0] = max_value;
+	out_block[1] = min_value;
+
+	/**
+	 * Palette is evenly spaced so the nearest entry is found by rounding
+	 * Index 0 is max, 1 is min and 2-7 go from max to min
+	 */
+	uint64_t index_bits = 0;
+	if(max_value > min_value)
+	{
+		const float scale = 7.f / static_cast<float>(max_value - min_value);
+		for(size_t i = 0; i < 16; ++i)
+		{
+			const auto step = static_cast<uint64_t>(std::lround((in_rgba[i * 4 + in_channel] - min_value) * scale));
+			const uint64_t index = step == 7 ? 0 : step == 0 ? 1 : 8 - step;
+			index_bits |= index << (i * 3);
+		}
+	}
+
+	for(size_t i = 0; i < 6; ++i)
+		out_block[2 + i] = static_cast<uint8_t>(index_bits >> (i * 8));
+}
+
+void encode_bc5_block(const uint8_t* in_rgba, uint8_t* out_block)
+{
+	encode_bc4_block(in_rgba, 0, out_block);
+	encode_bc4_block(in_rgba, 1, out_block + 8);
+}
+
+void encode_bc7_block(const uint8_t* in_rgba, uint8_t* out_block)
+{
+	const BlockSoA block = to_soa(in_rgba);
+
+	float min_color[4];
+	float max_color[4];
+	fit_endpoints(block, 4, min_color, max_color);
+
+	uint8_t endpoints[2][4];
+	uint8_t pbits[2] = {};
+	quantize_bc7_mode6_endpoint(min_color, endpoints[0], pbits[0]);
+	quantize_bc7_mode6_endpoint(max_color, endpoints[1], pbits[1]);
+
+	float palette[16][4];
+	for(size_t i = 0; i < 16; ++i)
+	{
+		for(size_t c = 0; c < 4; ++c)
+		{
+			const uint32_t e0 = (endpoints[0][c] << 1) | pbits[0];
+			const uint32_t e1 = (endpoints[1][c] << 1) | pbits[1];
+			palette[i][c] = static_cast<float>(((64 - bc7_weights[i]) * e0 + bc7_weights[i] * e1 + 32) >> 6);
+		}
+	}
+
+	uint8_t indices[16];
+	find_nearest_indices(block, palette, 16, 4, indices);
+
+	/** The anchor (texel 0) index MSB is implicitly 0, swap the endpoints to satisfy it */
+	if(indices[0] & 8)
+	{
+		std::swap(endpoints[0], endpoints[1]);
+		std::swap(pbits[0], pbits[1]);
+		for(auto& index : indices)
+			index = static_cast<uint8_t>(15 - index);
+	}
+
+	std::memset(out_block, 0, 16);
+	BitWriter writer(out_block);
+	writer.write(1 << 6, 7);
+	for(size_t c = 0; c < 4; ++c)
+	{
+		writer.write(endpoints[0][c], 7);
+		writer.write(endpoints[1][c], 7);
+	}
+	writer.write(pbits[0], 1);
+	writer.write(pbits[1], 1);
+	writer.write(indices[0], 3);
+	for(size_t i = 1; i < 16; ++i)
+		writer.write(indices[i], 4);
+}
+
+std::vector<uint8_t> encode_image(const gfx::Format in_format,
+	const uint8_t* in_rgba,
+	const uint32_t in_width,
+	const uint32_t in_height)
+{
+	using BlockEncoder = void(*)(const uint8_t*, uint8_t*);
+
+	BlockEncoder encoder = nullptr;
+	switch(in_format)
+	{
+	case gfx::Format::Bc1RgbUnormBlock:
+	case gfx::Format::Bc1RgbSrgbBlock:
+	case gfx::Format::Bc1RgbaUnormBlock:
+	case gfx::Format::Bc1RgbaSrgbBlock:
+		encoder = &encode_bc1_block;
+		break;
+	case gfx::Format::Bc3UnormBlock:
+	case gfx::Format::Bc3SrgbBlock:
+		encoder = &encode_bc3_block;
+		break;
+	case gfx::Format::Bc5UnormBlock:
+		encoder = &encode_bc5_block;
+		break;
+	case gfx::Format::Bc7UnormBlock:
+	case gfx::Format::Bc7SrgbBlock:
+		encoder = &encode_bc7_block;
+		break;
+	default:
+		return {};
+	}
+
+	const uint32_t blocks_x = (in_width + 3) / 4;
+	const uint32_t blocks_y = (in_height + 3) / 4;
+	const uint32_t block_size = gfx::get_format_block_size(in_format);
+
+	std::vector<uint8_t> blocks(static_cast<size_t>(blocks_x) * blocks_y * block_size);
+	for(uint32_t block_y = 0; block_y < blocks_y; ++block_y)
+	{
+		for(uint32_t block_x = 0; block_x < blocks_x; ++block_x)
+		{
+			uint8_t texels[64];
+			for(uint32_t y = 0; y < 4; ++y)
+			{
+				for(uint32_t x = 0; x < 4; ++x)
+				{
+					const uint32_t src_x = std::min(block_x * 4 + x, in_width - 1);
+					const uint32_t src_y = std::min(block_y * 4 + y, in_height - 1);
+					std::memcpy(&texels[(y * 4 + x) * 4], &in_rgba[(static_cast<size_t>(src_y) * in_width + src_x) * 4], 4);
+				}
+			}
+
+			encoder(texels, &blocks[(static_cast<size_t>(block_y) * blocks_x + block_x) * block_size]);
+		}
+	}
+
+	return blocks;
+}
+
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "engine/Core.hpp"
+#include "engine/gfx/Format.hpp"
+#include <vector>
+
+namespace cb::texcook
+{
+
+/**
+ * Block encoders, every function takes a 4x4 block of RGBA8 texels (row-major, 64 bytes)
+ */
+
+/** BC1 (opaque, 4-color mode), writes 8 bytes */
+void encode_bc1_block(const uint8_t* in_rgba, uint8_t* out_block);
+
+/** BC3 (BC4 alpha + BC1 color), writes 16 bytes */
+void encode_bc3_block(const uint8_t* in_rgba, uint8_t* out_block);
+
+/** BC4 on a single channel, writes 8 bytes */
+void encode_bc4_block(const uint8_t* in_rgba, const size_t in_channel, uint8_t* out_block);
+
+/** BC5 (BC4 red + BC4 green), writes 16 bytes */
+void encode_bc5_block(const uint8_t* in_rgba, uint8_t* out_block);
+
+/** BC7 using mode 6 (single subset, RGBA endpoints), writes 16 bytes */
+void encode_bc7_block(const uint8_t* in_rgba, uint8_t* out_block);
+
+/**
+ * Encode a whole RGBA8 image, edge blocks are padded by replicating the last row/column
+ * \return Blocks laid out row by row, empty if the format is not supported
+ */
+std::vector<uint8_t> encode_image(const gfx::Format in_format,
+	const uint8_t* in_rgba,
+	const uint32_t in_width,
+	const uint32_t in_height);
+
+}
@@ -0,0 +1,276 @@
+#include "engine/logger/Logger.hpp"
+#include "engine/logger/sinks/StdoutSink.hpp"
+#include "engine/gfx/Texture.hpp"
+#include "engine/assets/TextureFile.hpp"
+#include "BcEncoder.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+/**
+ * cb-texcook: offline texture cooker
+ * Encodes a source image and its mip chain to a block-compressed .cbtex container
+ */
+
+using namespace cb;
+
+CB_DEFINE_LOG_CATEGORY(texcook);
+
+/** What the texture is used for, drives the default block format and the mip filtering */
+enum class TextureUsage
+{
+	Albedo,
+	Normal,
+	Mask,
+};
+
+struct Options
+{
+	std::string input;
+	std::string output;
+	TextureUsage usage = TextureUsage::Albedo;
+	gfx::Format format = gfx::Format::Undefined;
+	bool generate_mips = true;
+};
+
+void print_usage()
+{
+	logger::info(log_texcook, "Usage: cb-texcook <input> <output.cbtex> [--usage albedo|normal|mask] [--format bc1|bc3|bc5|bc7] [--no-mips]");
+}
+
+bool parse_options(int argc, char** argv, Options& out_options)
+{
+	if(argc < 3)
+		return false;
+
+	out_options.input = argv[1];
+	out_options.output = argv[2];
+
+	for(int i = 3; i < argc; ++i)
+	{
+		const std::string_view arg = argv[i];
+		if(arg == "--no-mips")
+		{
+			out_options.generate_mips = false;
+		}
+		else if(arg == "--usage" && i + 1 < argc)
+		{
+			const std::string_view value = argv[++i];
+			if(value == "albedo")
+				out_options.usage = TextureUsage::Albedo;
+			else if(value == "normal")
+				out_options.usage = TextureUsage::Normal;
+			else if(value == "mask")
+				out_options.usage = TextureUsage::Mask;
+			else
+				return false;
+		}
+		else if(arg == "--format" && i + 1 < argc)
+		{
+			const std::string_view value = argv[++i];
+			if(value == "bc1")
+				out_options.format = gfx::Format::Bc1RgbUnormBlock;
+			else if(value == "bc3")
+				out_options.format = gfx::Format::Bc3UnormBlock;
+			else if(value == "bc5")
+				out_options.format = gfx::Format::Bc5UnormBlock;
+			else if(value == "bc7")
+				out_options.format = gfx::Format::Bc7UnormBlock;
+			else
+				return false;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Albedo: BC1, or BC3 when alpha is used
+ * Normal: BC7, the sample shaders read RGB normals. BC5 (--format bc5) halves the size but stores only XY,
+ * it requires shaders rebuilding Z as sqrt(1 - dot(xy, xy))
+ * Mask: BC7, keeps independent channels intact
+ */
+gfx::Format select_format(const TextureUsage in_usage, const std::span<const uint8_t>& in_rgba)
+{
+	switch(in_usage)
+	{
+	case TextureUsage::Albedo:
+		for(size_t i = 3; i < in_rgba.size(); i += 4)
+			if(in_rgba[i] != 255)
+				return gfx::Format::Bc3UnormBlock;
+		return gfx::Format::Bc1RgbUnormBlock;
+	case TextureUsage::Normal:
+		return gfx::Format::Bc7UnormBlock;
+	case TextureUsage::Mask:
+		return gfx::Format::Bc7UnormBlock;
+	}
+
+	return gfx::Format::Undefined;
+}
+
+float srgb_to_linear(const float in_value)
+{
+	return in_value <= 0.04045f ? in_value / 12.92f : std::pow((in_value + 0.055f) / 1.055f, 2.4f);
+}
+
+float linear_to_srgb(const float in_value)
+{
+	return in_value <= 0.0031308f ? in_value * 12.92f : 1.055f * std::pow(in_value, 1.f / 2.4f) - 0.055f;
+}
+
+uint8_t to_unorm8(const float in_value)
+{
+	return static_cast<uint8_t>(std::lround(std::clamp(in_value, 0.f, 1.f) * 255.f));
+}
+
+/**
+ * 2x2 box filter, albedo color is averaged in linear space and normals are renormalized
+ */
+std::vector<uint8_t> downsample(const std::vector<uint8_t>& in_rgba,
+	const uint32_t in_width,
+	const uint32_t in_height,
+	const TextureUsage in_usage)
+{
+	const uint32_t width = gfx::get_mip_dimension(in_width, 1);
+	const uint32_t height = gfx::get_mip_dimension(in_height, 1);
+
+	std::vector<uint8_t> rgba(static_cast<size_t>(width) * height * 4);
+	for(uint32_t y = 0; y < height; ++y)
+	{
+		for(uint32_t x = 0; x < width; ++x)
+		{
+			float sum[4] = {};
+			for(uint32_t i = 0; i < 4; ++i)
+			{
+				const uint32_t src_x = std::min(x * 2 + (i & 1), in_width - 1);
+				const uint32_t src_y = std::min(y * 2 + (i >> 1), in_height - 1);
+				const uint8_t* texel = &in_rgba[(static_cast<size_t>(src_y) * in_width + src_x) * 4];
+				for(size_t c = 0; c < 4; ++c)
+				{
+					const float value = texel[c] / 255.f;
+					switch(in_usage)
+					{
+					case TextureUsage::Albedo:
+						sum[c] += c < 3 ? srgb_to_linear(value) : value;
+						break;
+					case TextureUsage::Normal:
+						sum[c] += c < 3 ? value * 2.f - 1.f : value;
+						break;
+					case TextureUsage::Mask:
+						sum[c] += value;
+						break;
+					}
+				}
+			}
+
+			uint8_t* texel = &rgba[(static_cast<size_t>(y) * width + x) * 4];
+			switch(in_usage)
+			{
+			case TextureUsage::Albedo:
+				for(size_t c = 0; c < 3; ++c)
+					texel[c] = to_unorm8(linear_to_srgb(sum[c] / 4.f));
+				break;
+			case TextureUsage::Normal:
+			{
+				const float length = std::sqrt(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+				for(size_t c = 0; c < 3; ++c)
+					texel[c] = to_unorm8(length > 0.f ? sum[c] / length * 0.5f + 0.5f : 0.5f);
+				break;
+			}
+			case TextureUsage::Mask:
+				for(size_t c = 0; c < 3; ++c)
+					texel[c] = to_unorm8(sum[c] / 4.f);
+				break;
+			}
+
+			texel[3] = to_unorm8(sum[3] / 4.f);
+		}
+	}
+
+	return rgba;
+}
+
+int main(int argc, char** argv)
+{
+	logger::set_pattern("[{time}] [{severity}] ({category}) {message}");
+	logger::add_sink(std::make_unique<logger::StdoutSink>());
+
+	Options options;
+	if(!parse_options(argc, argv, options))
+	{
+		print_usage();
+		return -1;
+	}
+
+	int width = 0;
+	int height = 0;
+	int channels = 0;
+	stbi_uc* pixels = stbi_load(options.input.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+	if(!pixels)
+	{
+		logger::error(log_texcook, "Failed to load {}: {}", options.input, stbi_failure_reason());
+		return -1;
+	}
+
+	std::vector<uint8_t> level(pixels, pixels + static_cast<size_t>(width) * height * 4);
+	stbi_image_free(pixels);
+
+	if(options.format == gfx::Format::Undefined)
+		options.format = select_format(options.usage, level);
+
+	const auto start_time = std::chrono::high_resolution_clock::now();
+
+	const uint32_t mip_levels = options.generate_mips ? gfx::get_mip_chain_length(width, height) : 1;
+	std::vector<std::vector<uint8_t>> encoded_levels;
+	encoded_levels.reserve(mip_levels);
+
+	uint32_t level_width = width;
+	uint32_t level_height = height;
+	for(uint32_t i = 0; i < mip_levels; ++i)
+	{
+		encoded_levels.emplace_back(texcook::encode_image(options.format, level.data(), level_width, level_height));
+		if(encoded_levels.back().empty())
+		{
+			logger::error(log_texcook, "Format {} is not supported by the encoder", gfx::to_string(options.format));
+			return -1;
+		}
+
+		if(i + 1 < mip_levels)
+		{
+			level = downsample(level, level_width, level_height, options.usage);
+			level_width = gfx::get_mip_dimension(level_width, 1);
+			level_height = gfx::get_mip_dimension(level_height, 1);
+		}
+	}
+
+	const auto encode_time = std::chrono::duration<float, std::milli>(
+		std::chrono::high_resolution_clock::now() - start_time).count();
+
+	auto result = assets::save_texture_file(options.output,
+		assets::TextureFileHeader(options.format, width, height, 1, mip_levels, 1),
+		encoded_levels);
+	if(!result)
+	{
+		logger::error(log_texcook, "Failed to write {}: {}", options.output, std::to_string(result.get_error()));
+		return -1;
+	}
+
+	logger::info(log_texcook, "{} -> {} ({}x{}, {} mips, {}): {} KiB -> {} KiB in {:.2f} ms",
+		options.input,
+		options.output,
+		width,
+		height,
+		mip_levels,
+		gfx::to_string(options.format),
+		static_cast<size_t>(width) * height * 4 / 1024,
+		result.get_value() / 1024,
+		encode_time);
+
+	return 0;
+}